@@ -7,86 +7,120 @@
 #include <string.h>
 #include "algorithms.h"
 #include "process_manager.h"
+#include "deadlock_report.h"
+#include "frame_scan.h"
+#include "timeline.h"
+#include "arena.h"
+#include "workload_gen.h"
 
 // Global variables for algorithm simulation
-static ResourceAllocation resources[20];
-static PageFrame page_frames[10];
+static ResourceAllocation resources[MAX_RESOURCE_ALLOCATIONS];
+static PageFrame page_frames[MAX_PAGE_FRAMES];
 static int resource_count = 0;
 static int frame_count = 5;
 static int current_time = 0;
 
+// Real reference string for the comparison (memtrace), NULL = built-in demo
+static const int *trace_pages = NULL;
+static int trace_count = 0;
+static int trace_distinct = 0;
+static char trace_label[128];
+
 // Round Robin CPU Scheduling
 void round_robin_scheduling() {
+    int all[MAX_PROCESSES];
+    for (int i = 0; i < process_count; i++) {
+        all[i] = i;
+    }
+    round_robin_scheduling_subset(all, process_count);
+}
+
+// Round Robin over the given process table indices only
+void round_robin_scheduling_subset(const int *indices, int count) {
     printf("\n=== ROUND ROBIN SCHEDULING ===\n");
     int time_quantum = 3;
-    int completed = 0;
-    int current_process = 0;
-    int total_time = 0;
     
     printf("Time Quantum: %d units\n", time_quantum);
     printf("Execution Order: ");
     
-    // Create a copy of burst times for simulation
-    int remaining_time[MAX_PROCESSES];
-    for (int i = 0; i < process_count; i++) {
-        remaining_time[i] = pcb_table[i].burst_time;
+    int burst_time[MAX_PROCESSES];
+    for (int i = 0; i < count; i++) {
+        burst_time[i] = pcb_table[indices[i]].burst_time;
     }
-    
-    while (completed < process_count) {
-        if (remaining_time[current_process] > 0) {
-            printf("P%d ", pcb_table[current_process].pid % 100);
-            
-            if (remaining_time[current_process] > time_quantum) {
-                total_time += time_quantum;
-                remaining_time[current_process] -= time_quantum;
-            } else {
-                total_time += remaining_time[current_process];
-                remaining_time[current_process] = 0;
-                completed++;
-            }
+    int order[1024];
+    int slices = 0;
+    long long total_time = round_robin_kernel(burst_time, count, time_quantum, order, 1024, &slices);
+    for (int i = 0; i < slices && i < 1024; i++) {
+        printf("P%d ", pcb_table[indices[order[i]]].pid % 100);
+    }
+    if (slices > 1024) {
+        printf("... (%d slices)", slices);
+    }
+    if (timeline_active()) {
+        // Replay the recorded order to export each slice at its real start time;
+        // the run takes total_time ticks of the shared simulated clock
+        double t = timeline_advance_us(total_time * 1000.0) / 1000.0;
+        for (int i = 0; i < slices && i < 1024; i++) {
+            int k = order[i];
+            int run = burst_time[k] > time_quantum ? time_quantum : burst_time[k];
+            burst_time[k] -= run;
+            char name[16];
+            snprintf(name, sizeof(name), "P%d", pcb_table[indices[k]].pid);
+            timeline_slice(NULL, TIMELINE_PID_SCHEDULER, 0, name, "round_robin", t * 1000.0, run * 1000.0);
+            t += run;
         }
-        current_process = (current_process + 1) % process_count;
     }
     
-    printf("\nTotal execution time: %d units\n", total_time);
+    printf("\nTotal execution time: %lld units\n", total_time);
 }
 
 // Priority Scheduling
 void priority_scheduling() {
-    printf("\n=== PRIORITY SCHEDULING ===\n");
-    
-    // Create array of indices sorted by priority
-    int process_order[MAX_PROCESSES];
+    int all[MAX_PROCESSES];
     for (int i = 0; i < process_count; i++) {
-        process_order[i] = i;
+        all[i] = i;
     }
+    priority_scheduling_subset(all, process_count);
+}
+
+// Priority scheduling over the given process table indices only
+void priority_scheduling_subset(const int *indices, int count) {
+    printf("\n=== PRIORITY SCHEDULING ===\n");
     
-    // Sort by priority (lower number = higher priority)
-    for (int i = 0; i < process_count - 1; i++) {
-        for (int j = i + 1; j < process_count; j++) {
-            if (pcb_table[process_order[i]].priority > pcb_table[process_order[j]].priority) {
-                int temp = process_order[i];
-                process_order[i] = process_order[j];
-                process_order[j] = temp;
-            }
-        }
+    // Order the subset by priority (lower number = higher priority)
+    int priority[MAX_PROCESSES] = {0}, burst_time[MAX_PROCESSES] = {0}, order[MAX_PROCESSES];
+    for (int i = 0; i < count; i++) {
+        priority[i] = pcb_table[indices[i]].priority;
+        burst_time[i] = pcb_table[indices[i]].burst_time;
     }
+    long long total_time = priority_kernel(priority, burst_time, count, order);
     
     printf("Execution Order (by priority): ");
-    int total_time = 0;
-    for (int i = 0; i < process_count; i++) {
-        int idx = process_order[i];
+    for (int i = 0; i < count; i++) {
+        int idx = indices[order[i]];
         printf("P%d(pri:%d) ", pcb_table[idx].pid % 100, pcb_table[idx].priority);
-        total_time += pcb_table[idx].burst_time;
     }
-    printf("\nTotal execution time: %d units\n", total_time);
+    printf("\nTotal execution time: %lld units\n", total_time);
 }
 
 // Display scheduling comparison
 void display_scheduling_comparison() {
+    int all[MAX_PROCESSES];
+    for (int i = 0; i < process_count; i++) {
+        all[i] = i;
+    }
+    display_scheduling_comparison_subset(all, process_count);
+}
+
+// Compare scheduling policies on a subset of the process table
+void display_scheduling_comparison_subset(const int *indices, int count) {
     printf("\n=== CPU SCHEDULING COMPARISON ===\n");
-    round_robin_scheduling();
-    priority_scheduling();
+    if (count <= 0) {
+        printf("No processes to schedule.\n");
+        return;
+    }
+    round_robin_scheduling_subset(indices, count);
+    priority_scheduling_subset(indices, count);
     printf("\nRecommendation: ");
     printf("Priority scheduling for system processes, Round Robin for interactive tasks.\n");
 }
@@ -101,11 +135,11 @@ int bankers_algorithm() {
     
     printf("Resource Allocation Analysis:\n");
     for (int i = 0; i < process_count && i < 5; i++) {
-        int need = pcb_table[i].allocated_memory / 100; // Simplified need calculation
+        int need = pcb_table[i].allocated_memory / 1024 / 100; // Simplified need calculation
         total_need += need;
         printf("Process P%d: Allocated=%d, Need=%d, Safe=%s\n", 
                pcb_table[i].pid % 100, 
-               pcb_table[i].allocated_memory / 100,
+               pcb_table[i].allocated_memory / 1024 / 100,
                need,
                (need <= available_resources) ? "YES" : "NO");
         available_resources -= (need / 2); // Simulate resource allocation
@@ -120,12 +154,76 @@ int bankers_algorithm() {
     }
 }
 
+// Record that a process holds (allocated) or waits for (requested) a resource
+int add_resource_allocation(int pid, int resource_id, int allocated, int requested) {
+    if (resource_count >= MAX_RESOURCE_ALLOCATIONS) {
+        return 0;
+    }
+    resources[resource_count].process_id = pid;
+    resources[resource_count].resource_id = resource_id;
+    resources[resource_count].allocated = allocated;
+    resources[resource_count].requested = requested;
+    resource_count++;
+    return 1;
+}
+
+// Release every allocation and request recorded for a process
+void release_resource_allocations(int pid) {
+    int kept = 0;
+    for (int i = 0; i < resource_count; i++) {
+        if (resources[i].process_id != pid) {
+            resources[kept++] = resources[i];
+        }
+    }
+    resource_count = kept;
+}
+
+void clear_resource_allocations() {
+    resource_count = 0;
+}
+
+int export_resource_allocations(ResourceAllocation *out, int max) {
+    int count = resource_count < max ? resource_count : max;
+    memcpy(out, resources, sizeof(ResourceAllocation) * count);
+    return count;
+}
+
+void import_resource_allocations(const ResourceAllocation *in, int count) {
+    resource_count = count < MAX_RESOURCE_ALLOCATIONS ? count : MAX_RESOURCE_ALLOCATIONS;
+    memcpy(resources, in, sizeof(ResourceAllocation) * resource_count);
+}
+
+// Page frames in use plus the replacement clock
+int export_page_frames(PageFrame *out, int max, int *clock) {
+    int count = frame_count < max ? frame_count : max;
+    memcpy(out, page_frames, sizeof(PageFrame) * count);
+    *clock = current_time;
+    return count;
+}
+
+void import_page_frames(const PageFrame *in, int count, int clock) {
+    frame_count = count < MAX_PAGE_FRAMES ? count : MAX_PAGE_FRAMES;
+    memcpy(page_frames, in, sizeof(PageFrame) * frame_count);
+    current_time = clock;
+}
+
+static void report_simulated_cycle(const DeadlockStep *steps, int length, void *context) {
+    (void)context;
+    report_deadlock_cycle("simulator", 1, steps, length);
+}
+
 // Detect deadlock cycles
 int detect_deadlock_cycle() {
     printf("\n=== DEADLOCK CYCLE DETECTION ===\n");
     
     int deadlock_found = 0;
     printf("Checking for circular wait conditions...\n");
+
+    // Explicit allocation records (injected faults, real workers) come first
+    if (resource_count > 0 &&
+        detect_wait_cycles(resources, resource_count, report_simulated_cycle, NULL) > 0) {
+        deadlock_found = 1;
+    }
     
     for (int i = 0; i < process_count; i++) {
         if (pcb_table[i].state == 2) { // Waiting state
@@ -159,7 +257,7 @@ void fifo_page_replacement() {
     int num_requests = 10;
     int page_faults = 0;
     int fifo_queue[5] = {-1, -1, -1, -1, -1};
-    int front = 0, rear = 0;
+    int front = 0;
     
     printf("Page requests: ");
     for (int i = 0; i < num_requests; i++) {
@@ -169,21 +267,8 @@ void fifo_page_replacement() {
     
     printf("FIFO Frames: ");
     for (int i = 0; i < num_requests; i++) {
-        int page = page_requests[i];
-        int found = 0;
-        
-        // Check if page is already in frame
-        for (int j = 0; j < 5; j++) {
-            if (fifo_queue[j] == page) {
-                found = 1;
-                break;
-            }
-        }
-        
+        int found = !fifo_reference(fifo_queue, 5, &front, page_requests[i]);
         if (!found) {
-            // Page fault - replace using FIFO
-            fifo_queue[front] = page;
-            front = (front + 1) % 5;
             page_faults++;
         }
         
@@ -219,31 +304,8 @@ void lru_page_replacement() {
     
     printf("LRU Frames:  ");
     for (int i = 0; i < num_requests; i++) {
-        int page = page_requests[i];
-        int found = -1;
-        
-        // Check if page is already in frame
-        for (int j = 0; j < 5; j++) {
-            if (lru_frames[j] == page) {
-                found = j;
-                break;
-            }
-        }
-        
-        if (found != -1) {
-            // Page hit - update last used time
-            last_used[found] = i;
-        } else {
-            // Page fault - find LRU frame
-            int lru_index = 0;
-            for (int j = 1; j < 5; j++) {
-                if (last_used[j] < last_used[lru_index]) {
-                    lru_index = j;
-                }
-            }
-            
-            lru_frames[lru_index] = page;
-            last_used[lru_index] = i;
+        int found = lru_reference(lru_frames, last_used, 5, page_requests[i], i) ? -1 : 0;
+        if (found == -1) {
             page_faults++;
         }
         
@@ -260,11 +322,384 @@ void lru_page_replacement() {
     printf("\nLRU Page Faults: %d/%d\n", page_faults, num_requests);
 }
 
+void set_page_reference_trace(const int *pages, int count, int distinct, const char *label) {
+    trace_pages = pages;
+    trace_count = pages != NULL ? count : 0;
+    trace_distinct = distinct;
+    snprintf(trace_label, sizeof(trace_label), "%s", label != NULL ? label : "trace");
+}
+
+// FIFO/LRU/CLOCK faults on a long reference string at frame counts sized to its footprint
+void display_page_replacement_table(const int *pages, int count, int distinct) {
+    static const int eighths[] = {1, 2, 4, 6, 8};
+    printf("%8s | %12s %7s | %12s %7s | %12s %7s | %s\n", "frames", "FIFO faults", "rate", "LRU faults", "rate",
+           "CLOCK faults", "rate", "LRU saves");
+    int previous = 0;
+    for (int i = 0; i < (int)(sizeof(eighths) / sizeof(eighths[0])); i++) {
+        int frames = distinct * eighths[i] / 8;
+        if (frames < 1) frames = 1;
+        if (frames == previous) continue;
+        previous = frames;
+        int fifo = fifo_page_faults(pages, count, frames);
+        int lru = lru_page_faults(pages, count, frames);
+        int clock = clock_page_faults(pages, count, frames);
+        if (fifo < 0 || lru < 0 || clock < 0) {
+            printf("%8d | not enough memory\n", frames);
+            continue;
+        }
+        printf("%8d | %12d %6.2f%% | %12d %6.2f%% | %12d %6.2f%% | %+.1f%%\n", frames,
+               fifo, 100.0 * fifo / count, lru, 100.0 * lru / count, clock, 100.0 * clock / count,
+               fifo > 0 ? 100.0 * (fifo - lru) / fifo : 0.0);
+    }
+}
+
 // Display page replacement comparison
 void display_page_replacement_comparison() {
     printf("\n=== PAGE REPLACEMENT COMPARISON ===\n");
+    if (trace_pages != NULL) {
+        printf("Reference string: %s, %d references to %d distinct pages\n",
+               trace_label, trace_count, trace_distinct);
+        display_page_replacement_table(trace_pages, trace_count, trace_distinct);
+        printf("\nFaults at the full footprint are compulsory misses; the gap between\n");
+        printf("FIFO and LRU below it is what tracking page usage buys on this program.\n");
+        return;
+    }
     fifo_page_replacement();
     lru_page_replacement();
     printf("\nRecommendation: LRU typically performs better than FIFO\n");
     printf("but requires more overhead to track page usage.\n");
 }
+
+// ---- Quiet kernels over plain arrays (used by the demos above and by bench.c) ----
+
+// Round Robin over burst times in index order; records the slice order when
+// order is given and returns the total execution time
+long long round_robin_kernel(const int *burst_time, int count, int time_quantum,
+                             int *order, int order_capacity, int *order_length) {
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    int *remaining = arena_alloc(arena, sizeof(int) * (count > 0 ? count : 1));
+    int *active = arena_alloc(arena, sizeof(int) * (count > 0 ? count : 1));
+    long long total_time = 0;
+    int slices = 0;
+    if (remaining == NULL || active == NULL) {
+        arena_release(arena, mark);
+        if (order_length) *order_length = 0;
+        return -1;
+    }
+
+    // Each round visits the unfinished processes in index order, so the active
+    // list is compacted instead of rescanning finished entries
+    int active_count = 0;
+    for (int i = 0; i < count; i++) {
+        remaining[i] = burst_time[i];
+        if (remaining[i] > 0) active[active_count++] = i;
+    }
+    while (active_count > 0) {
+        int kept = 0;
+        for (int k = 0; k < active_count; k++) {
+            int i = active[k];
+            if (order != NULL && slices < order_capacity) order[slices] = i;
+            slices++;
+            int run = remaining[i] > time_quantum ? time_quantum : remaining[i];
+            total_time += run;
+            remaining[i] -= run;
+            if (remaining[i] > 0) active[kept++] = i;
+        }
+        active_count = kept;
+    }
+    arena_release(arena, mark);
+    if (order_length) *order_length = slices;
+    return total_time;
+}
+
+// Stable order by priority (lower number first); returns the total execution time
+long long priority_kernel(const int *priority, const int *burst_time, int count, int *order) {
+    long long total_time = 0;
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    int *scratch = arena_alloc(arena, sizeof(int) * (count > 0 ? count : 1));
+    if (scratch == NULL) {
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        order[i] = i;
+        total_time += burst_time[i];
+    }
+    // Bottom-up merge sort keeps equal priorities in arrival (index) order
+    int *from = order, *to = scratch;
+    for (int width = 1; width < count; width *= 2) {
+        for (int lo = 0; lo < count; lo += 2 * width) {
+            int mid = lo + width < count ? lo + width : count;
+            int hi = lo + 2 * width < count ? lo + 2 * width : count;
+            int a = lo, b = mid, k = lo;
+            while (a < mid && b < hi) {
+                to[k++] = priority[from[b]] < priority[from[a]] ? from[b++] : from[a++];
+            }
+            while (a < mid) to[k++] = from[a++];
+            while (b < hi) to[k++] = from[b++];
+        }
+        int *swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from != order) {
+        memcpy(order, from, sizeof(int) * count);
+    }
+    arena_release(arena, mark);
+    return total_time;
+}
+
+// Count resource r as satisfied for every process whose need now fits in work
+static void admit_processes(const unsigned long long *column, int n, long long work, int *cursor,
+                            int *satisfied, int m, int *ready, int *ready_count) {
+    while (*cursor < n && (long long)(column[*cursor] >> 32) <= work) {
+        int p = (int)(column[(*cursor)++] & 0xffffffffu);
+        if (++satisfied[p] == m) ready[(*ready_count)++] = p;
+    }
+}
+
+// Banker's safety check over n processes and m resource types (row-major
+// allocation/need). Each resource keeps its processes sorted by need, so a
+// finished process only advances cursors instead of rescanning every
+// process: O(n m log n). Returns how many processes can finish (n = safe).
+int bankers_safety_kernel(int processes, int resource_types, const int *available,
+                          const int *allocation, const int *need, int *safe_sequence) {
+    int n = processes, m = resource_types;
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    long long *work = arena_alloc(arena, sizeof(long long) * (m > 0 ? m : 1));
+    unsigned long long *sorted = arena_alloc(arena, sizeof(unsigned long long) * ((size_t)n * m + 1));
+    int *cursor = arena_calloc(arena, m > 0 ? m : 1, sizeof(int));
+    int *satisfied = arena_calloc(arena, n > 0 ? n : 1, sizeof(int));
+    int *ready = arena_alloc(arena, sizeof(int) * (n > 0 ? n : 1));
+    int finished = -1;
+    if (work == NULL || sorted == NULL || cursor == NULL || satisfied == NULL || ready == NULL) {
+        goto done;
+    }
+
+    for (int r = 0; r < m; r++) {
+        work[r] = available[r];
+        unsigned long long *column = sorted + (size_t)r * n;
+        for (int p = 0; p < n; p++) {
+            unsigned int demand = need[(size_t)p * m + r] > 0 ? (unsigned int)need[(size_t)p * m + r] : 0;
+            column[p] = ((unsigned long long)demand << 32) | (unsigned int)p;
+        }
+        qsort(column, (size_t)n, sizeof(unsigned long long), wg_compare_packed);
+    }
+
+    int ready_count = 0;
+    finished = 0;
+    if (m == 0) {
+        for (int p = 0; p < n; p++) ready[ready_count++] = p;
+    }
+    for (int r = 0; r < m; r++) {
+        admit_processes(sorted + (size_t)r * n, n, work[r], &cursor[r], satisfied, m, ready, &ready_count);
+    }
+    while (ready_count > 0) {
+        int p = ready[--ready_count];
+        if (safe_sequence) safe_sequence[finished] = p;
+        finished++;
+        for (int r = 0; r < m; r++) {
+            work[r] += allocation[(size_t)p * m + r];
+            admit_processes(sorted + (size_t)r * n, n, work[r], &cursor[r], satisfied, m, ready, &ready_count);
+        }
+    }
+
+done:
+    arena_release(arena, mark);
+    return finished;
+}
+
+static int find_packed(const unsigned long long *keys, int count, unsigned int key) {
+    int lo = 0, hi = count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        unsigned int value = (unsigned int)(keys[mid] >> 32);
+        if (value == key) return mid;
+        if (value < key) lo = mid + 1; else hi = mid - 1;
+    }
+    return -1;
+}
+
+// Find every circular wait in a list of allocation records. A process waits
+// on the first holder of its first request that someone else holds, which
+// makes the wait-for graph a functional graph: one walk per node finds each
+// cycle in O(r log r). Each cycle is reported once, rotated to start at its
+// lowest pid. Returns the number of cycles, or -1 if memory runs out.
+int detect_wait_cycles(const ResourceAllocation *records, int count,
+                       void (*on_cycle)(const DeadlockStep *steps, int length, void *context),
+                       void *context) {
+    // Holders sorted by (resource, record index); pids sorted and deduplicated
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    unsigned long long *holders = arena_alloc(arena, sizeof(unsigned long long) * (count + 1));
+    unsigned long long *pids = arena_alloc(arena, sizeof(unsigned long long) * (count + 1));
+    int *next = arena_alloc(arena, sizeof(int) * (count + 1));
+    int *wanted = arena_alloc(arena, sizeof(int) * (count + 1));
+    int *stamp = arena_alloc(arena, sizeof(int) * (count + 1));
+    DeadlockStep *steps = arena_alloc(arena, sizeof(DeadlockStep) * (count + 1));
+    int cycles = -1;
+    if (holders == NULL || pids == NULL || next == NULL || wanted == NULL || stamp == NULL || steps == NULL) {
+        goto done;
+    }
+
+    int holder_count = 0, pid_count = 0;
+    for (int i = 0; i < count; i++) {
+        pids[pid_count++] = (unsigned long long)(unsigned int)records[i].process_id << 32;
+        if (records[i].allocated) {
+            holders[holder_count++] = ((unsigned long long)(unsigned int)records[i].resource_id << 32) | (unsigned int)i;
+        }
+    }
+    qsort(holders, (size_t)holder_count, sizeof(unsigned long long), wg_compare_packed);
+    qsort(pids, (size_t)pid_count, sizeof(unsigned long long), wg_compare_packed);
+    int unique = 0;
+    for (int i = 0; i < pid_count; i++) {
+        if (unique == 0 || (pids[i] >> 32) != (pids[unique - 1] >> 32)) pids[unique++] = pids[i];
+    }
+    for (int i = 0; i < unique; i++) {
+        next[i] = -1;
+        stamp[i] = -1;
+    }
+
+    // Wait-for edge of each process: first request (in record order) with another holder
+    for (int i = 0; i < count; i++) {
+        if (!records[i].requested) continue;
+        int node = find_packed(pids, unique, (unsigned int)records[i].process_id);
+        if (next[node] >= 0) continue;
+        int at = find_packed(holders, holder_count, (unsigned int)records[i].resource_id);
+        while (at > 0 && (holders[at - 1] >> 32) == (unsigned int)records[i].resource_id) at--;
+        for (; at >= 0 && at < holder_count && (holders[at] >> 32) == (unsigned int)records[i].resource_id; at++) {
+            int holder_pid = records[holders[at] & 0xffffffffu].process_id;
+            if (holder_pid != records[i].process_id) {
+                next[node] = find_packed(pids, unique, (unsigned int)holder_pid);
+                wanted[node] = records[i].resource_id;
+                break;
+            }
+        }
+    }
+
+    cycles = 0;
+    for (int start = 0; start < unique; start++) {
+        int node = start;
+        while (node >= 0 && stamp[node] < 0) {
+            stamp[node] = start;
+            node = next[node];
+        }
+        if (node < 0 || stamp[node] != start) continue;
+
+        // node is on a cycle first reached from this walk; begin at its lowest pid
+        int lowest = node;
+        for (int at = next[node]; at != node; at = next[at]) {
+            if ((int)(pids[at] >> 32) < (int)(pids[lowest] >> 32)) lowest = at;
+        }
+        int length = 0;
+        int at = lowest;
+        do {
+            steps[length].owner = (int)(pids[at] >> 32);
+            steps[length].wanted = wanted[at];
+            length++;
+            at = next[at];
+        } while (at != lowest);
+        for (int k = 0; k < length; k++) {
+            steps[k].held = steps[(k + length - 1) % length].wanted;
+        }
+        cycles++;
+        if (on_cycle) on_cycle(steps, length, context);
+    }
+
+done:
+    arena_release(arena, mark);
+    return cycles;
+}
+
+// One reference against FIFO frames; returns 1 on a page fault
+int fifo_reference(int *frames, int frame_count, int *next_victim, int page) {
+    if (frame_find(frames, frame_count, page) >= 0) {
+        return 0;
+    }
+    frames[*next_victim] = page;
+    *next_victim = (*next_victim + 1) % frame_count;
+    return 1;
+}
+
+// One reference at time now against LRU frames; returns 1 on a page fault
+int lru_reference(int *frames, int *last_used, int frame_count, int page, int now) {
+    int slot = frame_find(frames, frame_count, page);
+    if (slot >= 0) {
+        last_used[slot] = now;
+        return 0;
+    }
+    int victim = frame_find_min(last_used, frame_count);
+    frames[victim] = page;
+    last_used[victim] = now;
+    return 1;
+}
+
+// One reference against CLOCK (second chance) frames; returns 1 on a page fault
+int clock_reference(int *frames, unsigned char *referenced, int frame_count, int *hand, int page) {
+    int slot = frame_find(frames, frame_count, page);
+    if (slot >= 0) {
+        referenced[slot] = 1;
+        return 0;
+    }
+    int victim = frame_clock_sweep(referenced, frame_count, *hand);
+    frames[victim] = page;
+    referenced[victim] = 1;
+    *hand = (victim + 1) % frame_count;
+    return 1;
+}
+
+// Page faults for a whole reference string; -1 if memory runs out
+int fifo_page_faults(const int *requests, int count, int frame_count) {
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    int *frames = arena_alloc(arena, sizeof(int) * frame_count);
+    if (frames == NULL) return -1;
+    for (int j = 0; j < frame_count; j++) frames[j] = -1;
+    int next_victim = 0, faults = 0;
+    for (int i = 0; i < count; i++) {
+        faults += fifo_reference(frames, frame_count, &next_victim, requests[i]);
+    }
+    arena_release(arena, mark);
+    return faults;
+}
+
+int lru_page_faults(const int *requests, int count, int frame_count) {
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    int *frames = arena_alloc(arena, sizeof(int) * frame_count);
+    int *last_used = arena_alloc(arena, sizeof(int) * frame_count);
+    if (frames == NULL || last_used == NULL) {
+        arena_release(arena, mark);
+        return -1;
+    }
+    for (int j = 0; j < frame_count; j++) {
+        frames[j] = -1;
+        last_used[j] = -1;
+    }
+    int faults = 0;
+    for (int i = 0; i < count; i++) {
+        faults += lru_reference(frames, last_used, frame_count, requests[i], i);
+    }
+    arena_release(arena, mark);
+    return faults;
+}
+
+int clock_page_faults(const int *requests, int count, int frame_count) {
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    int *frames = arena_alloc(arena, sizeof(int) * frame_count);
+    unsigned char *referenced = arena_calloc(arena, (size_t)frame_count, 1);
+    if (frames == NULL || referenced == NULL) {
+        arena_release(arena, mark);
+        return -1;
+    }
+    for (int j = 0; j < frame_count; j++) frames[j] = -1;
+    int hand = 0, faults = 0;
+    for (int i = 0; i < count; i++) {
+        faults += clock_reference(frames, referenced, frame_count, &hand, requests[i]);
+    }
+    arena_release(arena, mark);
+    return faults;
+}
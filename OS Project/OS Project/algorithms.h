@@ -6,23 +6,33 @@
 #define ALGORITHMS_H
 
 #include "process_manager.h"
+#include "deadlock_report.h"
 
 // CPU Scheduling Algorithms
 void round_robin_scheduling();
 void priority_scheduling();
 void display_scheduling_comparison();
+void round_robin_scheduling_subset(const int *indices, int count);
+void priority_scheduling_subset(const int *indices, int count);
+void display_scheduling_comparison_subset(const int *indices, int count);
 
 // Deadlock Detection and Prevention
 int bankers_algorithm();
 int detect_deadlock_cycle();
 void display_banker_state();
+int add_resource_allocation(int pid, int resource_id, int allocated, int requested);
+void release_resource_allocations(int pid);
+void clear_resource_allocations();
 
 // Memory Management
 void fifo_page_replacement();
 void lru_page_replacement();
 void display_page_replacement_comparison();
+void set_page_reference_trace(const int *pages, int count, int distinct, const char *label);
+void display_page_replacement_table(const int *pages, int count, int distinct);
 
 // Resource structures
+#define MAX_RESOURCE_ALLOCATIONS 20
 typedef struct {
     int process_id;
     int resource_id;
@@ -31,6 +41,7 @@ typedef struct {
 } ResourceAllocation;
 
 // Page replacement structures
+#define MAX_PAGE_FRAMES 10
 typedef struct {
     int page_number;
     int frame_number;
@@ -38,4 +49,26 @@ typedef struct {
     int loaded_time;
 } PageFrame;
 
+// Checkpoint access to the resource graph and page frames
+int export_resource_allocations(ResourceAllocation *out, int max);
+void import_resource_allocations(const ResourceAllocation *in, int count);
+int export_page_frames(PageFrame *out, int max, int *clock);
+void import_page_frames(const PageFrame *in, int count, int clock);
+
+// Quiet kernels over plain arrays, shared by the demos and the benchmarks
+long long round_robin_kernel(const int *burst_time, int count, int time_quantum,
+                             int *order, int order_capacity, int *order_length);
+long long priority_kernel(const int *priority, const int *burst_time, int count, int *order);
+int bankers_safety_kernel(int processes, int resource_types, const int *available,
+                          const int *allocation, const int *need, int *safe_sequence);
+int detect_wait_cycles(const ResourceAllocation *records, int count,
+                       void (*on_cycle)(const DeadlockStep *steps, int length, void *context),
+                       void *context);
+int fifo_reference(int *frames, int frame_count, int *next_victim, int page);
+int lru_reference(int *frames, int *last_used, int frame_count, int page, int now);
+int clock_reference(int *frames, unsigned char *referenced, int frame_count, int *hand, int page);
+int fifo_page_faults(const int *requests, int count, int frame_count);
+int lru_page_faults(const int *requests, int count, int frame_count);
+int clock_page_faults(const int *requests, int count, int frame_count);
+
 #endif // ALGORITHMS_H
@@ -1,6 +1,11 @@
-from flask import Flask, render_template, jsonify, request
+from flask import Flask, render_template, jsonify, request, Response
+from array import array
 import json
+import os
 import random
+import struct
+import subprocess
+import sys
 import time
 import threading
 from datetime import datetime
@@ -18,8 +23,10 @@ system_status = {
     'status': 'ONLINE'
 }
 
-def get_real_processes():
-    """Get real running processes from the system"""
+PROCESS_STATES = ['READY', 'RUNNING', 'WAITING']
+
+def get_real_processes(limit=10):
+    """Get real running processes from the system (limit 0 = all of them)"""
     real_processes = []
     try:
         for proc in psutil.process_iter(['pid', 'name', 'cpu_percent', 'memory_percent']):
@@ -36,7 +43,7 @@ def get_real_processes():
                         'burst_time': random.randint(2, 10)
                     })
                     
-                    if len(real_processes) >= 10:  # Limit to 10 processes
+                    if limit and len(real_processes) >= limit:
                         break
             except (psutil.NoSuchProcess, psutil.AccessDenied):
                 continue
@@ -66,6 +73,65 @@ def generate_dummy_processes():
     
     return dummy_processes
 
+def generate_synthetic_processes(count):
+    """Generate a large process table (names repeat, as on a real host) for exercising the dashboard"""
+    base_names = ['chrome.exe', 'vscode.exe', 'discord.exe', 'firefox.exe', 'spotify.exe',
+                  'notepad.exe', 'explorer.exe', 'steam.exe', 'svchost.exe', 'python.exe']
+    synthetic = []
+    for i in range(count):
+        name = base_names[i % len(base_names)] if i % 3 else f'worker-{i % 512}'
+        synthetic.append({
+            'pid': 10000 + i,
+            'name': name,
+            'cpu': random.uniform(0.5, 30.0),
+            'memory': random.uniform(0.1, 5.0),
+            'state': random.choice(['READY', 'READY', 'READY', 'RUNNING']),
+            'priority': random.randint(1, 5),
+            'burst_time': random.randint(2, 10)
+        })
+    return synthetic
+
+def _column(typecode, values):
+    """One little-endian column, zero-padded to a 4-byte boundary"""
+    column = array(typecode, values)
+    if sys.byteorder == 'big':
+        column.byteswap()
+    data = column.tobytes()
+    return data + bytes(-len(data) % 4)
+
+def encode_process_columns(process_list):
+    """Pack a process snapshot as typed-array columns the dashboard maps without parsing.
+
+    Layout (little endian): 'PCOL', u16 version, u16 flags, u32 rows, u32 names,
+    u32 name bytes, u32 reserved; then each column padded to 4 bytes: pid u32, name
+    (index into the name table; u16 when flags bit 0 is set, else u32), cpu u16 and
+    memory u16 in tenths of a percent,
+    burst_time u16, state u8 (index into PROCESS_STATES), priority u8, name offsets
+    u32[names + 1], UTF-8 names.
+    """
+    name_ids = {}
+    name_column = [name_ids.setdefault(p['name'], len(name_ids)) for p in process_list]
+    encoded_names = [name.encode('utf-8') for name in name_ids]
+    offsets = [0]
+    for name in encoded_names:
+        offsets.append(offsets[-1] + len(name))
+    name_bytes = b''.join(encoded_names)
+    narrow_names = len(name_ids) <= 65536
+    header = struct.pack('<4sHHIIII', b'PCOL', 1, 1 if narrow_names else 0, len(process_list),
+                         len(name_ids), len(name_bytes), 0)
+    return b''.join([
+        header,
+        _column('I', [p['pid'] for p in process_list]),
+        _column('H' if narrow_names else 'I', name_column),
+        _column('H', [min(int(p['cpu'] * 10 + 0.5), 65535) for p in process_list]),
+        _column('H', [min(int(p['memory'] * 10 + 0.5), 65535) for p in process_list]),
+        _column('H', [min(p['burst_time'], 65535) for p in process_list]),
+        _column('B', [PROCESS_STATES.index(p['state']) for p in process_list]),
+        _column('B', [p['priority'] for p in process_list]),
+        _column('I', offsets),
+        name_bytes
+    ])
+
 def add_log(message, log_type='info'):
     """Add a log entry with timestamp"""
     timestamp = datetime.now().strftime('%H:%M:%S')
@@ -80,6 +146,47 @@ def add_log(message, log_type='info'):
     if len(system_logs) > 50:
         system_logs.pop()
 
+SIMULATOR_DIR = os.path.dirname(os.path.abspath(__file__))
+sweep_cache = {}
+
+def run_parameter_sweep():
+    """Quantum and frame-count sweep from the C simulator, grouped into curves (cached)"""
+    if 'result' in sweep_cache:
+        return sweep_cache['result']
+    binary = None
+    for name in ('simulation', 'simulation.exe'):
+        candidate = os.path.join(SIMULATOR_DIR, name)
+        if os.path.isfile(candidate):
+            binary = candidate
+            break
+    if binary is None:
+        return None
+    try:
+        completed = subprocess.run([binary, 'sweep', '--json', '-'], capture_output=True,
+                                   text=True, timeout=120, cwd=SIMULATOR_DIR)
+        raw = json.loads(completed.stdout)
+    except (OSError, subprocess.SubprocessError, ValueError):
+        return None
+
+    # {workload: {policy: [points ordered by parameter]}}
+    scheduling = {}
+    for point in raw.get('scheduling', []):
+        curve = scheduling.setdefault(point['workload'], {}).setdefault(point['policy'], [])
+        curve.append({key: point[key] for key in ('quantum', 'avg_waiting', 'avg_turnaround', 'context_switches')})
+    paging = {}
+    for point in raw.get('paging', []):
+        curve = paging.setdefault(point['trace'], {}).setdefault(point['policy'], [])
+        curve.append({key: point[key] for key in ('frames', 'faults', 'fault_rate')})
+    result = {
+        'configurations': raw.get('configurations', 0),
+        'threads': raw.get('threads', 1),
+        'seconds': raw.get('seconds', 0.0),
+        'scheduling': scheduling,
+        'paging': paging
+    }
+    sweep_cache['result'] = result
+    return result
+
 def update_system_status():
     """Update global system status"""
     if processes:
@@ -101,8 +208,12 @@ def init_system():
     
     add_log('Initializing OS Fault Simulator...', 'info')
     
-    # Try to get real processes, fallback to dummy data
-    processes = get_real_processes()
+    # ?synthetic=N loads a large generated table; otherwise real processes (?limit=N, 0 = all)
+    synthetic = request.args.get('synthetic', 0, type=int)
+    if synthetic > 0:
+        processes = generate_synthetic_processes(min(synthetic, 1000000))
+    else:
+        processes = get_real_processes(request.args.get('limit', 10, type=int))
     
     add_log(f'Loaded {len(processes)} processes from system', 'success')
     add_log('OS Fault Simulator ready', 'info')
@@ -123,6 +234,15 @@ def get_processes():
         'system_status': system_status
     })
 
+@app.route('/api/processes.bin')
+def get_process_columns():
+    """Current process list as binary columns; system status rides in the X-System-Status header"""
+    update_system_status()
+    response = Response(encode_process_columns(processes), mimetype='application/octet-stream')
+    response.headers['X-System-Status'] = json.dumps(system_status)
+    response.headers['Cache-Control'] = 'no-store'
+    return response
+
 @app.route('/api/logs')
 def get_logs():
     """Get system logs"""
@@ -249,6 +369,11 @@ def get_algorithms():
         }
     }
     
+    sweeps = run_parameter_sweep()
+    if sweeps is not None:
+        algorithms['sweeps'] = sweeps
+        add_log(f"Parameter sweep: {sweeps['configurations']} configurations in {sweeps['seconds']:.2f}s", 'info')
+
     add_log('Algorithm comparison analysis completed', 'success')
     return jsonify({'algorithms': algorithms})
 
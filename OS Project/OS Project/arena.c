@@ -0,0 +1,236 @@
+/*
+ * arena.c - Per-run region allocator with fixed-size node pools
+ *
+ * A simulation run bump-allocates its queues, graph scratch and page tables
+ * from 1 MB blocks, and kernels roll back to a mark when they return. Blocks
+ * are kept across runs, so resetting for the next run only rewinds the
+ * cursor: nothing is freed and no block is touched until it is reused.
+ * Pools hand out fixed-size nodes from the same arena and recycle them
+ * through a free list; a reset drops every pool's list in O(1) through the
+ * arena generation. Each thread has its own run arena, so parallel runs never
+ * share one.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "arena.h"
+
+#define ARENA_ALIGN 16
+
+struct ArenaBlock {
+    ArenaBlock *next;
+    size_t capacity;
+    size_t used;
+    unsigned char *data;
+};
+
+static size_t align_up(size_t size) {
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+void arena_init(Arena *arena, size_t block_size, size_t limit) {
+    memset(arena, 0, sizeof(*arena));
+    arena->block_size = block_size > 0 ? block_size : ARENA_BLOCK_BYTES;
+    arena->limit = limit;
+}
+
+void arena_destroy(Arena *arena) {
+    ArenaBlock *block = arena->head;
+    while (block != NULL) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    size_t block_size = arena->block_size, limit = arena->limit;
+    arena_init(arena, block_size, limit);
+}
+
+static ArenaBlock *new_block(Arena *arena, size_t capacity) {
+    size_t total = align_up(sizeof(ArenaBlock)) + capacity;
+    if (arena->limit > 0 && arena->reserved + total > arena->limit) {
+        return NULL;
+    }
+    ArenaBlock *block = malloc(total);
+    if (block == NULL) {
+        return NULL;
+    }
+    block->next = NULL;
+    block->capacity = capacity;
+    block->used = 0;
+    block->data = (unsigned char *)block + align_up(sizeof(ArenaBlock));
+    arena->reserved += total;
+    return block;
+}
+
+void *arena_alloc(Arena *arena, size_t size) {
+    size = align_up(size > 0 ? size : 1);
+    ArenaBlock *block = arena->current;
+    if (block == NULL || block->used + size > block->capacity) {
+        // Move on to the next retained block, or splice in a fresh one that fits
+        ArenaBlock *next = block != NULL ? block->next : arena->head;
+        if (next == NULL || next->capacity < size) {
+            ArenaBlock *fresh = new_block(arena, size > arena->block_size ? size : arena->block_size);
+            if (fresh == NULL) {
+                arena->failures++;
+                return NULL;
+            }
+            fresh->next = next;
+            if (block != NULL) block->next = fresh; else arena->head = fresh;
+            next = fresh;
+        }
+        if (block != NULL) arena->current_base += block->capacity;
+        next->used = 0;
+        arena->current = block = next;
+    }
+    void *memory = block->data + block->used;
+    block->used += size;
+    size_t in_use = arena->current_base + block->used;
+    if (in_use > arena->peak) arena->peak = in_use;
+    return memory;
+}
+
+void *arena_calloc(Arena *arena, size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) {
+        return NULL;
+    }
+    void *memory = arena_alloc(arena, count * size);
+    if (memory != NULL) memset(memory, 0, count * size);
+    return memory;
+}
+
+// Resize a growing array: extended in place when it is the newest allocation
+// in the current block, otherwise copied to a fresh one. The old copy is
+// reclaimed by the caller's release or the next reset
+void *arena_grow(Arena *arena, void *memory, size_t old_size, size_t new_size) {
+    if (memory == NULL) {
+        return arena_alloc(arena, new_size);
+    }
+    ArenaBlock *block = arena->current;
+    size_t old_span = align_up(old_size > 0 ? old_size : 1), new_span = align_up(new_size);
+    if (block != NULL && (unsigned char *)memory + old_span == block->data + block->used &&
+        block->used - old_span + new_span <= block->capacity) {
+        block->used = block->used - old_span + new_span;
+        size_t in_use = arena->current_base + block->used;
+        if (in_use > arena->peak) arena->peak = in_use;
+        return memory;
+    }
+    void *grown = arena_alloc(arena, new_size);
+    if (grown != NULL) memcpy(grown, memory, old_size < new_size ? old_size : new_size);
+    return grown;
+}
+
+// Forget every allocation; blocks stay reserved for the next run
+void arena_reset(Arena *arena) {
+    arena->current = arena->head;
+    if (arena->head != NULL) arena->head->used = 0;
+    arena->current_base = 0;
+    arena->peak = 0;
+    arena->generation++;
+    arena->resets++;
+}
+
+ArenaMark arena_mark(const Arena *arena) {
+    ArenaMark mark;
+    mark.block = arena->current;
+    mark.used = arena->current != NULL ? arena->current->used : 0;
+    mark.base = arena->current_base;
+    return mark;
+}
+
+void arena_release(Arena *arena, ArenaMark mark) {
+    if (mark.block == NULL) {
+        arena->current = arena->head;
+        if (arena->head != NULL) arena->head->used = 0;
+        arena->current_base = 0;
+        return;
+    }
+    arena->current = mark.block;
+    mark.block->used = mark.used;
+    arena->current_base = mark.base;
+}
+
+void arena_stats(const Arena *arena, ArenaStats *stats) {
+    stats->in_use = arena->current_base + (arena->current != NULL ? arena->current->used : 0);
+    stats->peak = arena->peak;
+    stats->reserved = arena->reserved;
+    stats->limit = arena->limit;
+    stats->blocks = 0;
+    for (const ArenaBlock *block = arena->head; block != NULL; block = block->next) {
+        stats->blocks++;
+    }
+    stats->resets = arena->resets;
+    stats->failures = arena->failures;
+}
+
+void arena_pool_init(ArenaPool *pool, Arena *arena, size_t node_size) {
+    pool->arena = arena;
+    pool->node_size = node_size < sizeof(void *) ? sizeof(void *) : node_size;
+    pool->free_list = NULL;
+    pool->generation = arena->generation;
+    pool->live = 0;
+}
+
+void *arena_pool_alloc(ArenaPool *pool) {
+    if (pool->generation != pool->arena->generation) {
+        // The arena was reset underneath us; the old nodes are gone
+        pool->free_list = NULL;
+        pool->generation = pool->arena->generation;
+        pool->live = 0;
+    }
+    void *node = pool->free_list;
+    if (node != NULL) {
+        pool->free_list = *(void **)node;
+    } else {
+        node = arena_alloc(pool->arena, pool->node_size);
+        if (node == NULL) return NULL;
+    }
+    pool->live++;
+    return node;
+}
+
+void arena_pool_free(ArenaPool *pool, void *node) {
+    if (node == NULL || pool->generation != pool->arena->generation) {
+        return;
+    }
+    *(void **)node = pool->free_list;
+    pool->free_list = node;
+    pool->live--;
+}
+
+static _Thread_local Arena thread_arena;
+static _Thread_local int thread_arena_ready = 0;
+
+Arena *run_arena() {
+    if (!thread_arena_ready) {
+        const char *limit_mb = getenv("SIM_ARENA_LIMIT_MB");
+        long long limit = limit_mb != NULL ? atoll(limit_mb) : ARENA_DEFAULT_LIMIT_MB;
+        arena_init(&thread_arena, ARENA_BLOCK_BYTES, limit > 0 ? (size_t)limit * 1024 * 1024 : 0);
+        thread_arena_ready = 1;
+    }
+    return &thread_arena;
+}
+
+// Start a new run on this thread: O(1), keeps the blocks already reserved
+void run_arena_reset() {
+    arena_reset(run_arena());
+}
+
+// Give the thread's blocks back before a worker thread exits
+void run_arena_release() {
+    if (thread_arena_ready) {
+        arena_destroy(&thread_arena);
+        thread_arena_ready = 0;
+    }
+}
+
+void run_arena_print_stats(const char *label) {
+    ArenaStats stats;
+    arena_stats(run_arena(), &stats);
+    printf("%s arena: peak %.1f KB, reserved %.1f KB in %d blocks", label,
+           stats.peak / 1024.0, stats.reserved / 1024.0, stats.blocks);
+    if (stats.limit > 0) printf(" (limit %lld MB)", (long long)(stats.limit / (1024 * 1024)));
+    if (stats.failures > 0) printf(", %lld allocations refused", stats.failures);
+    printf("\n");
+}
@@ -0,0 +1,74 @@
+/*
+ * arena.h - Header for the per-run region allocator and fixed-size pools
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_BLOCK_BYTES (1024 * 1024)
+#define ARENA_DEFAULT_LIMIT_MB 1024     // override with SIM_ARENA_LIMIT_MB
+
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct {
+    ArenaBlock *head;
+    ArenaBlock *current;
+    size_t current_base;        // bytes in the blocks before current
+    size_t block_size;
+    size_t limit;               // 0 = unbounded
+    size_t reserved;            // bytes obtained from malloc
+    size_t peak;                // high-water mark since the last reset
+    unsigned int generation;    // bumped by every reset; invalidates pools
+    long long resets;
+    long long failures;         // allocations refused by the limit
+} Arena;
+
+// Position to roll back to once a kernel's temporaries are no longer needed
+typedef struct {
+    ArenaBlock *block;
+    size_t used;
+    size_t base;
+} ArenaMark;
+
+// Free list of fixed-size nodes carved from an arena
+typedef struct {
+    Arena *arena;
+    size_t node_size;
+    void *free_list;
+    unsigned int generation;
+    long long live;
+} ArenaPool;
+
+typedef struct {
+    size_t in_use;
+    size_t peak;
+    size_t reserved;
+    size_t limit;
+    int blocks;
+    long long resets;
+    long long failures;
+} ArenaStats;
+
+void arena_init(Arena *arena, size_t block_size, size_t limit);
+void arena_destroy(Arena *arena);
+void *arena_alloc(Arena *arena, size_t size);
+void *arena_calloc(Arena *arena, size_t count, size_t size);
+void *arena_grow(Arena *arena, void *memory, size_t old_size, size_t new_size);
+void arena_reset(Arena *arena);
+ArenaMark arena_mark(const Arena *arena);
+void arena_release(Arena *arena, ArenaMark mark);
+void arena_stats(const Arena *arena, ArenaStats *stats);
+
+void arena_pool_init(ArenaPool *pool, Arena *arena, size_t node_size);
+void *arena_pool_alloc(ArenaPool *pool);
+void arena_pool_free(ArenaPool *pool, void *node);
+
+// The calling thread's arena for the current simulation run
+Arena *run_arena();
+void run_arena_reset();
+void run_arena_release();
+void run_arena_print_stats(const char *label);
+
+#endif // ARENA_H
@@ -0,0 +1,767 @@
+/*
+ * bench.c - Micro and macro benchmarks for the simulator (make bench)
+ *
+ * Every benchmark runs at scales 10, 100, ... up to its own limit (and
+ * --max-scale), with one untimed warm-up run and a number of timed
+ * repetitions. Results are printed as a table and, with --json, written as
+ * JSON so runs can be diffed against a stored baseline. Detector quality
+ * (detection latency and false-positive rate) is reported alongside.
+ *
+ * Usage: ./bench [--json FILE] [--filter NAME] [--max-scale N] [--reps N]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "algorithms.h"
+#include "process_manager.h"
+#include "fault_injection.h"
+#include "recovery.h"
+#include "thrashing_monitor.h"
+#include "cpu_monitor.h"
+#include "cgroup_monitor.h"
+#include "procfs.h"
+#include "timing.h"
+#include "rng.h"
+#include "frame_scan.h"
+#include "arena.h"
+#include "io_scheduler.h"
+#include "priority_sched.h"
+#include "chaos.h"
+#include "dist_deadlock.h"
+#include "victim.h"
+#include "memtrace.h"
+#include "workload_gen.h"
+#include "swap_sim.h"
+
+#define BENCH_MAX_REPS 64
+#define BENCH_MAX_RESULTS 256
+#define BENCH_SLOW_SECONDS 0.5   // runs slower than this get fewer repetitions
+
+typedef struct {
+    const char *name;
+    long long max_scale;
+    int (*setup)(long long scale);      // untimed; returns 0 to skip this scale
+    long long (*run)(long long scale);  // timed; returns a checksum
+    void (*teardown)();
+    int variant;                        // passed to setup through bench_variant
+} Benchmark;
+
+typedef struct {
+    const char *name;
+    long long scale;
+    int reps;
+    double min_ns, p50_ns, p90_ns, p99_ns, max_ns, mean_ns;
+    long long checksum;
+    size_t arena_peak;                  // run-arena high-water mark over all reps
+} BenchResult;
+
+static volatile long long bench_sink;
+static int bench_variant;
+
+// ---- shared inputs, rebuilt by setup for each scale ----
+static int *input_a;
+static int *input_b;
+static int *input_c;
+static int *output;
+static ResourceAllocation *records;
+static int record_count;
+
+static void free_inputs() {
+    free(input_a);
+    free(input_b);
+    free(input_c);
+    free(output);
+    free(records);
+    input_a = input_b = input_c = output = NULL;
+    records = NULL;
+}
+
+static int alloc_inputs(long long scale, int arrays) {
+    free_inputs();
+    size_t bytes = sizeof(int) * (size_t)scale;
+    input_a = malloc(bytes);
+    input_b = arrays > 1 ? malloc(bytes) : NULL;
+    input_c = arrays > 2 ? malloc(bytes) : NULL;
+    output = malloc(bytes);
+    return input_a != NULL && output != NULL && (arrays < 2 || input_b != NULL) && (arrays < 3 || input_c != NULL);
+}
+
+// ---- scheduling ----
+static int setup_scheduling(long long scale) {
+    if (!alloc_inputs(scale, 2)) return 0;
+    rng_seed(1);
+    for (long long i = 0; i < scale; i++) {
+        input_a[i] = rng_next() % 10 + 1;     // burst
+        input_b[i] = rng_next() % 5 + 1;      // priority
+    }
+    return 1;
+}
+
+static long long run_round_robin(long long scale) {
+    int slices = 0;
+    return round_robin_kernel(input_a, (int)scale, 3, NULL, 0, &slices) + slices;
+}
+
+static long long run_priority(long long scale) {
+    return priority_kernel(input_b, input_a, (int)scale, output) + output[scale - 1];
+}
+
+// ---- Banker's safety check, 3 resource types ----
+#define BANKER_RESOURCES 3
+
+static int setup_bankers(long long scale) {
+    long long cells = scale * BANKER_RESOURCES;
+    free_inputs();
+    input_a = malloc(sizeof(int) * (size_t)cells);     // allocation
+    input_b = malloc(sizeof(int) * (size_t)cells);     // need
+    output = malloc(sizeof(int) * (size_t)scale);
+    if (input_a == NULL || input_b == NULL || output == NULL) return 0;
+    rng_seed(2);
+    for (long long i = 0; i < cells; i++) {
+        input_a[i] = rng_next() % 4;
+        input_b[i] = rng_next() % 8;
+    }
+    return 1;
+}
+
+static long long run_bankers(long long scale) {
+    int available[BANKER_RESOURCES] = {8, 8, 8};
+    return bankers_safety_kernel((int)scale, BANKER_RESOURCES, available, input_a, input_b, output);
+}
+
+// ---- wait-for cycle detection over allocation records ----
+static int setup_cycles(long long scale) {
+    free_inputs();
+    // Pairs of processes swap two resources (a deadlock), every fourth pair is clean
+    record_count = (int)(scale / 4) * 4;
+    if (record_count < 4) record_count = 4;
+    records = malloc(sizeof(ResourceAllocation) * record_count);
+    if (records == NULL) return 0;
+    for (int i = 0; i < record_count / 4; i++) {
+        int a = 2 * i + 1, b = 2 * i + 2, r1 = 2 * i + 1, r2 = 2 * i + 2;
+        ResourceAllocation block[4] = {{a, r1, 1, 0}, {b, r2, 1, 0}, {a, r2, 0, 1}, {b, r1, 0, i % 4 != 3}};
+        memcpy(&records[4 * i], block, sizeof(block));
+    }
+    return 1;
+}
+
+static long long run_cycles(long long scale) {
+    (void)scale;
+    return detect_wait_cycles(records, record_count, NULL, NULL);
+}
+
+// ---- deadlock victim selection (scale = processes, variant = VictimMode) ----
+static WaitGraph victim_graph;
+
+static void describe_bench_victim(int pid, VictimCandidate *candidate, void *context) {
+    (void)context;
+    candidate->progress = pid * 7919 % 500;
+    candidate->priority = pid % 5 + 1;
+}
+
+static int setup_victims(long long scale) {
+    free_inputs();
+    // Each process holds its own resource; 60% wait on one or two neighbours'
+    records = malloc(sizeof(ResourceAllocation) * (size_t)scale * 3);
+    if (records == NULL) return 0;
+    rng_seed(4);
+    record_count = 0;
+    for (int p = 0; p < (int)scale; p++) {
+        records[record_count++] = (ResourceAllocation){p + 1, p + 1, 1, 0};
+        if (rng_next() % 10 >= 6) continue;
+        for (int k = rng_next() % 2; k >= 0; k--) {
+            int other = (p + (int)scale + (int)(rng_next() % 65) - 32) % (int)scale;
+            records[record_count++] = (ResourceAllocation){p + 1, other + 1, 0, 1};
+        }
+    }
+    return victim_graph_from_records(records, record_count, describe_bench_victim, NULL, &victim_graph) == 0;
+}
+
+static long long run_victims(long long scale) {
+    (void)scale;
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    VictimPlan plan;
+    long long result = victim_select(&victim_graph, (VictimMode)bench_variant, &plan) < 0 ? -1 : plan.work_lost;
+    arena_release(arena, mark);
+    return result;
+}
+
+// ---- page replacement, 64 frames over a skewed reference string ----
+#define BENCH_FRAMES 64
+
+static int setup_pages(long long scale) {
+    if (!alloc_inputs(scale, 1)) return 0;
+    rng_seed(3);
+    for (long long i = 0; i < scale; i++) {
+        // 80% of references go to a hot set that fits in the frames
+        input_a[i] = rng_next() % 10 < 8 ? rng_next() % 48 : rng_next() % 4096;
+    }
+    return 1;
+}
+
+static long long run_fifo(long long scale) {
+    return fifo_page_faults(input_a, (int)scale, BENCH_FRAMES);
+}
+
+static long long run_lru(long long scale) {
+    return lru_page_faults(input_a, (int)scale, BENCH_FRAMES);
+}
+
+static long long run_clock(long long scale) {
+    return clock_page_faults(input_a, (int)scale, BENCH_FRAMES);
+}
+
+// ---- frame scan kernels per instruction set (scale = frames, 4096 lookups) ----
+#define FRAME_LOOKUPS 4096
+
+static int setup_frame_scan(long long scale) {
+    if (frame_scan_select((FrameScanLevel)bench_variant) != (FrameScanLevel)bench_variant) {
+        frame_scan_select(FRAME_SCAN_AUTO);
+        return 0;   // not supported on this CPU
+    }
+    free_inputs();
+    input_a = malloc(sizeof(int) * (size_t)scale);          // resident pages
+    input_b = malloc(sizeof(int) * FRAME_LOOKUPS);          // references, about half resident
+    output = malloc(sizeof(int) * FRAME_LOOKUPS);
+    if (input_a == NULL || input_b == NULL || output == NULL) return 0;
+    rng_seed(5);
+    for (long long i = 0; i < scale; i++) input_a[i] = (int)(2 * i);
+    for (int i = 0; i < FRAME_LOOKUPS; i++) input_b[i] = rng_next() % (int)(4 * scale);
+    return 1;
+}
+
+static long long run_frame_scan(long long scale) {
+    frame_find_batch(input_a, (int)scale, input_b, FRAME_LOOKUPS, output);
+    long long hits = 0;
+    for (int i = 0; i < FRAME_LOOKUPS; i++) hits += output[i] >= 0;
+    return hits + frame_find_min(input_a, (int)scale);
+}
+
+static void teardown_frame_scan() {
+    free_inputs();
+    frame_scan_select(FRAME_SCAN_AUTO);
+}
+
+// ---- disk I/O scheduling per policy (scale = queued requests) ----
+static IoRequest *io_requests;
+static IoDevice io_device;
+
+static int setup_io(long long scale) {
+    free(io_requests);
+    io_requests = malloc(sizeof(IoRequest) * (size_t)scale);
+    if (io_requests == NULL) return 0;
+    int pids[4] = {1, 2, 3, 4};
+    io_default_device(&io_device, IO_DEVICE_HDD);
+    io_generate_workload(io_requests, (int)scale, &io_device, 200.0, 0.3f, pids, 4, 6);
+    return 1;
+}
+
+static long long run_io(long long scale) {
+    IoResult result;
+    io_simulate(&io_device, (IoSchedulerKind)bench_variant, io_requests, (int)scale, &result);
+    return result.seek_distance;
+}
+
+static void teardown_io() {
+    free(io_requests);
+    io_requests = NULL;
+}
+
+// ---- preemptive priority scheduling with locks (scale = tasks) ----
+static PrioTask *prio_tasks;
+
+static int setup_priority(long long scale) {
+    free(prio_tasks);
+    prio_tasks = malloc(sizeof(PrioTask) * (size_t)scale);
+    if (prio_tasks == NULL) return 0;
+    prio_generate_workload(prio_tasks, (int)scale, 0.95, 0.1f, 8);
+    return 1;
+}
+
+static long long run_priority_sched(long long scale) {
+    PrioSchedConfig config;
+    prio_default_config(&config);
+    if (bench_variant) {
+        config.lock_protocol = PRIO_LOCK_INHERITANCE;
+        config.aging_interval = PRIO_AGING_INTERVAL;
+    }
+    PrioResult result;
+    prio_simulate(&config, prio_tasks, (int)scale, &result);
+    return result.max_wait + result.inversion_time;
+}
+
+static void teardown_priority() {
+    free(prio_tasks);
+    prio_tasks = NULL;
+}
+
+// ---- streaming generators (scale = references, variant = pattern) ----
+static WgRefStream ref_stream;
+static int *ref_batch;
+
+static int setup_ref_stream(long long scale) {
+    (void)scale;
+    WgRefConfig config;
+    wg_default_ref_config(&config, (WgRefPattern)bench_variant);
+    ref_batch = arena_alloc(run_arena(), sizeof(int) * 4096);
+    return ref_batch != NULL && wg_ref_init(&ref_stream, &config, run_arena());
+}
+
+static long long run_ref_stream(long long scale) {
+    long long sum = 0;
+    for (long long done = 0; done < scale; done += 4096) {
+        int count = scale - done < 4096 ? (int)(scale - done) : 4096;
+        wg_ref_batch(&ref_stream, ref_batch, count);
+        sum += ref_batch[count - 1];
+    }
+    return sum;
+}
+
+// ---- memtrace decoding (scale = references of a working-set trace) ----
+static unsigned char *trace_image;
+static size_t trace_bytes;
+
+static void put_varint(unsigned long long value) {
+    while (value >= 0x80) {
+        trace_image[trace_bytes++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    trace_image[trace_bytes++] = (unsigned char)value;
+}
+
+static int setup_memtrace(long long scale) {
+    WgRefConfig config;
+    wg_default_ref_config(&config, WG_REF_WORKING_SET);
+    WgRefStream stream;
+    int page;
+    trace_image = malloc(MEMTRACE_HEADER_BYTES + (size_t)scale * 11 + scale / 64 * 11 + 16);
+    if (trace_image == NULL || !wg_ref_init(&stream, &config, run_arena())) return 0;
+    memset(trace_image, 0, MEMTRACE_HEADER_BYTES);
+    memcpy(trace_image, MEMTRACE_MAGIC, 4);
+    trace_image[4] = MEMTRACE_VERSION;
+    trace_image[6] = 12;
+    trace_bytes = MEMTRACE_HEADER_BYTES;
+    long long previous = 0;
+    for (long long i = 0; i < scale; i++) {
+        wg_ref_batch(&stream, &page, 1);
+        long long delta = page - previous;
+        previous = page;
+        put_varint((((unsigned long long)delta << 1) ^ (unsigned long long)(delta >> 63)) << 1);
+        if (i % 64 == 63) put_varint(3);    // one interval every 64 touches
+    }
+    return 1;
+}
+
+static long long run_memtrace(long long scale) {
+    (void)scale;
+    MemTrace trace;
+    if (!memtrace_decode(trace_image, trace_bytes, &trace)) return -1;
+    long long sum = trace.count + trace.distinct + trace.intervals;
+    memtrace_free(&trace);
+    return sum;
+}
+
+static void teardown_memtrace() {
+    free(trace_image);
+    trace_image = NULL;
+}
+
+// ---- chaos timeline (scale = simulated days, variant = recovery policy) ----
+static int setup_chaos(long long scale) {
+    (void)scale;
+    return 1;
+}
+
+static long long run_chaos(long long scale) {
+    ChaosConfig config;
+    chaos_default_config(&config);
+    config.days = (double)scale;
+    ChaosResult result;
+    if (chaos_simulate(&config, chaos_policy(bench_variant), &result) != 0) return -1;
+    return result.events + result.recovered;
+}
+
+// ---- distributed deadlock detection (scale = simulated ms, variant = priority probes) ----
+static int setup_dist(long long scale) {
+    (void)scale;
+    return 1;
+}
+
+static long long run_dist(long long scale) {
+    DistConfig config;
+    dist_default_config(&config);
+    config.duration_s = scale / 1000.0;
+    config.priority_probes = bench_variant;
+    DistResult result;
+    if (dist_simulate(&config, &result, 0) != 0) return -1;
+    return result.total_messages + result.detected;
+}
+
+// ---- swap and reclaim, 48 processes at 3x memory (scale = simulated ms, variant = recovery) ----
+static int setup_swap(long long scale) {
+    (void)scale;
+    return 1;
+}
+
+static long long run_swap(long long scale) {
+    SwapConfig config;
+    swap_default_config(&config, IO_DEVICE_SSD);
+    config.processes = 48;
+    config.duration_s = scale / 1000.0;
+    SwapResult result;
+    if (swap_simulate(&config, (SwapRecovery)bench_variant, &result) != 0) return -1;
+    return result.references;
+}
+
+// ---- host process scanning (scale = passes over /proc) ----
+static int setup_proc_scan(long long scale) {
+    (void)scale;
+    return procfs_available() && alloc_inputs(65536, 1);
+}
+
+static long long run_proc_scan(long long scale) {
+    long long total = 0;
+    for (long long pass = 0; pass < scale; pass++) {
+        int count = procfs_list_pids(input_a, 65536);
+        for (int i = 0; i < count; i++) {
+            ProcPidStat stat;
+            total += procfs_read_pid_stat(input_a[i], &stat);
+        }
+    }
+    return total;
+}
+
+// ---- detector bookkeeping for scale synthetic processes ----
+static int setup_detectors(long long scale) {
+    (void)scale;
+    thrashing_monitor_reset();
+    cpu_monitor_reset();
+    cgroup_monitor_reset();
+    cgroup_monitor_set_host_cores(64.0);
+    return 1;
+}
+
+static long long run_thrashing_record(long long scale) {
+    static double now = 0.0;
+    now += 0.1;
+    for (long long pid = 1; pid <= scale; pid++) {
+        thrashing_monitor_record((int)pid, now, (unsigned long)(now * 100 + pid), (unsigned long)pid, 1024);
+    }
+    thrashing_monitor_end_pass();
+    ProcessFaultStats top[10];
+    return thrashing_monitor_collect(top, 10);
+}
+
+static long long run_cpu_record(long long scale) {
+    for (long long pid = 1; pid <= scale; pid++) {
+        cpu_monitor_record_process((int)pid, (float)(pid % 100));
+    }
+    cpu_monitor_end_pass();
+    ProcessCpuStats top[10];
+    return cpu_monitor_collect(top, 10);
+}
+
+// One pass over scale processes spread across slices of 16-process groups;
+// groups are named on the first pass only, as with live sampling
+static long long run_cgroup_record(long long scale) {
+    char path[64];
+    int named = cgroup_monitor_group_count() > 0;
+    for (long long pid = 1; pid <= scale; pid++) {
+        if (!named) snprintf(path, sizeof(path), "/slice-%lld/app-%lld", pid % 16, pid / 16);
+        cgroup_monitor_record_process((int)pid, named ? NULL : path, (float)(pid % 100), 1024 + pid % 512,
+                                      (float)(pid % 7));
+    }
+    cgroup_monitor_end_pass();
+    CgroupStats top[10];
+    return cgroup_monitor_collect(top, 10, CGROUP_COLLECT_OVERLOADED | CGROUP_COLLECT_INNERMOST);
+}
+
+// ---- fault inject/recover round trips on the simulated table (scale = round trips) ----
+static int saved_stdout = -1;
+
+static void silence_stdout() {
+#ifndef _WIN32
+    fflush(stdout);
+    saved_stdout = dup(1);
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (null_fd >= 0) {
+        dup2(null_fd, 1);
+        close(null_fd);
+    }
+#endif
+}
+
+static void restore_stdout() {
+#ifndef _WIN32
+    fflush(stdout);
+    if (saved_stdout >= 0) {
+        dup2(saved_stdout, 1);
+        close(saved_stdout);
+        saved_stdout = -1;
+    }
+#endif
+}
+
+static int setup_roundtrip(long long scale) {
+    (void)scale;
+    thrashing_monitor_set_live_sampling(0);
+    cpu_monitor_set_live_sampling(0);
+    cgroup_monitor_set_live_sampling(0);
+    silence_stdout();
+    init_dummy_processes();
+    restore_stdout();
+    return 1;
+}
+
+static long long run_roundtrip(long long scale) {
+    silence_stdout();
+    for (long long i = 0; i < scale; i++) {
+        inject_deadlock();
+        detect_and_fix_deadlock();
+        inject_cpu_overload();
+        detect_and_fix_cpu_overload();
+        inject_thrashing();
+        detect_and_fix_thrashing();
+    }
+    restore_stdout();
+    return process_count;
+}
+
+static void teardown_roundtrip() {
+    thrashing_monitor_set_live_sampling(1);
+    cpu_monitor_set_live_sampling(1);
+    cgroup_monitor_set_live_sampling(1);
+    clear_resource_allocations();
+}
+
+static const Benchmark benchmarks[] = {
+    {"sched_round_robin", 10000000, setup_scheduling, run_round_robin, free_inputs, 0},
+    {"sched_priority", 10000000, setup_scheduling, run_priority, free_inputs, 0},
+    {"bankers_safety", 1000000, setup_bankers, run_bankers, free_inputs, 0},
+    {"wait_cycle_detect", 10000000, setup_cycles, run_cycles, free_inputs, 0},
+    {"victim_greedy", 1000000, setup_victims, run_victims, free_inputs, VICTIM_GREEDY},
+    {"victim_exact", 1000000, setup_victims, run_victims, free_inputs, VICTIM_EXACT},
+    {"page_fifo_64", 10000000, setup_pages, run_fifo, free_inputs, 0},
+    {"page_lru_64", 10000000, setup_pages, run_lru, free_inputs, 0},
+    {"page_clock_64", 10000000, setup_pages, run_clock, free_inputs, 0},
+    {"frame_scan_scalar", 10000, setup_frame_scan, run_frame_scan, teardown_frame_scan, FRAME_SCAN_SCALAR},
+    {"frame_scan_sse4", 10000, setup_frame_scan, run_frame_scan, teardown_frame_scan, FRAME_SCAN_SSE4},
+    {"frame_scan_avx2", 10000, setup_frame_scan, run_frame_scan, teardown_frame_scan, FRAME_SCAN_AVX2},
+    {"io_fcfs", 1000000, setup_io, run_io, teardown_io, IO_SCHED_FCFS},
+    {"io_sstf", 1000000, setup_io, run_io, teardown_io, IO_SCHED_SSTF},
+    {"io_scan", 1000000, setup_io, run_io, teardown_io, IO_SCHED_SCAN},
+    {"io_clook", 1000000, setup_io, run_io, teardown_io, IO_SCHED_CLOOK},
+    {"io_deadline", 1000000, setup_io, run_io, teardown_io, IO_SCHED_DEADLINE},
+    {"prio_plain", 1000000, setup_priority, run_priority_sched, teardown_priority, 0},
+    {"prio_inherit_aging", 1000000, setup_priority, run_priority_sched, teardown_priority, 1},
+    {"wg_zipf_refs", 10000000, setup_ref_stream, run_ref_stream, NULL, WG_REF_ZIPF},
+    {"wg_working_set_refs", 10000000, setup_ref_stream, run_ref_stream, NULL, WG_REF_WORKING_SET},
+    {"memtrace_decode", 10000000, setup_memtrace, run_memtrace, teardown_memtrace, 0},
+    {"chaos_serial", 10000, setup_chaos, run_chaos, NULL, 0},
+    {"chaos_parallel", 10000, setup_chaos, run_chaos, NULL, 3},
+    {"dist_cmh_basic", 10000, setup_dist, run_dist, NULL, 0},
+    {"dist_cmh_priority", 10000, setup_dist, run_dist, NULL, 1},
+    {"swap_none", 10000, setup_swap, run_swap, NULL, SWAP_RECOVER_NONE},
+    {"swap_admission", 10000, setup_swap, run_swap, NULL, SWAP_RECOVER_ADMISSION},
+    {"swap_suspend", 10000, setup_swap, run_swap, NULL, SWAP_RECOVER_SUSPEND},
+    {"proc_scan", 100, setup_proc_scan, run_proc_scan, free_inputs, 0},
+    {"thrashing_record", 100000, setup_detectors, run_thrashing_record, NULL, 0},
+    {"cpu_record", 1000000, setup_detectors, run_cpu_record, NULL, 0},
+    {"cgroup_record", 1000000, setup_detectors, run_cgroup_record, NULL, 0},
+    {"fault_roundtrip", 1000, setup_roundtrip, run_roundtrip, teardown_roundtrip, 0},
+};
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted samples
+static double percentile(const double *sorted, int count, double p) {
+    int rank = (int)(p / 100.0 * count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+static int run_benchmark(const Benchmark *bench, long long scale, int reps, BenchResult *result) {
+    bench_variant = bench->variant;
+    run_arena_reset();
+    if (!bench->setup(scale)) {
+        return 0;
+    }
+    double samples[BENCH_MAX_REPS];
+    double start = monotonic_seconds();
+    bench_sink = bench->run(scale);     // warm-up
+    if (monotonic_seconds() - start > BENCH_SLOW_SECONDS && reps > 3) {
+        reps = 3;
+    }
+    long long checksum = 0;
+    for (int r = 0; r < reps; r++) {
+        start = monotonic_seconds();
+        checksum = bench->run(scale);
+        samples[r] = (monotonic_seconds() - start) * 1e9;
+        bench_sink = checksum;
+    }
+    if (bench->teardown) bench->teardown();
+
+    qsort(samples, (size_t)reps, sizeof(double), compare_double);
+    double sum = 0.0;
+    for (int r = 0; r < reps; r++) sum += samples[r];
+    result->name = bench->name;
+    result->scale = scale;
+    result->reps = reps;
+    result->min_ns = samples[0];
+    result->p50_ns = percentile(samples, reps, 50);
+    result->p90_ns = percentile(samples, reps, 90);
+    result->p99_ns = percentile(samples, reps, 99);
+    result->max_ns = samples[reps - 1];
+    result->mean_ns = sum / reps;
+    result->checksum = checksum;
+    ArenaStats arena;
+    arena_stats(run_arena(), &arena);
+    result->arena_peak = arena.peak;
+    return 1;
+}
+
+// ---- detector quality on synthetic utilisation series ----
+typedef struct {
+    double latency_samples;     // mean samples from overload onset to detection
+    double false_positive_rate; // share of noise-only runs that raised an overload
+} DetectorQuality;
+
+static float noisy(float mean, float spread) {
+    return mean + ((rng_next() % 2001) - 1000) / 1000.0f * spread;
+}
+
+static DetectorQuality measure_cpu_detector(int runs) {
+    DetectorQuality quality = {0.0, 0.0};
+    int detected = 0, false_alarms = 0;
+    long long latency_total = 0;
+    rng_seed(4);
+    for (int run = 0; run < runs; run++) {
+        CpuOverloadReport report;
+        // Step from ~50% to ~98% busy at sample 50
+        cpu_monitor_reset();
+        for (int t = 0; t < 150; t++) {
+            cpu_monitor_record_core(-1, t < 50 ? noisy(50, 15) : noisy(98, 2));
+            cpu_monitor_end_pass();
+            cpu_monitor_report(&report);
+            if (t >= 50 && report.state == CPU_STATE_HOST_OVERLOADED) {
+                latency_total += t - 50 + 1;
+                detected++;
+                break;
+            }
+        }
+        // Noise with single-sample spikes to 100% must not raise an overload
+        cpu_monitor_reset();
+        for (int t = 0; t < 150; t++) {
+            cpu_monitor_record_core(-1, rng_next() % 10 == 0 ? 100.0f : noisy(60, 20));
+            cpu_monitor_end_pass();
+            cpu_monitor_report(&report);
+            if (report.state != CPU_STATE_NORMAL) {
+                false_alarms++;
+                break;
+            }
+        }
+    }
+    quality.latency_samples = detected ? (double)latency_total / detected : -1.0;
+    quality.false_positive_rate = (double)false_alarms / runs;
+    cpu_monitor_reset();
+    return quality;
+}
+
+static void write_json(const char *path, const BenchResult *results, int count, DetectorQuality cpu) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        printf("Error: Cannot write %s\n", path);
+        return;
+    }
+    fprintf(file, "{\n  \"suite\": \"os-fault-simulator\",\n  \"timestamp\": %lld,\n  \"results\": [\n",
+            (long long)time(NULL));
+    for (int i = 0; i < count; i++) {
+        const BenchResult *r = &results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"scale\": %lld, \"reps\": %d, \"min_ns\": %.0f, "
+                "\"p50_ns\": %.0f, \"p90_ns\": %.0f, \"p99_ns\": %.0f, \"max_ns\": %.0f, "
+                "\"mean_ns\": %.0f, \"ns_per_item\": %.3f, \"checksum\": %lld, \"arena_peak_bytes\": %lld}%s\n",
+                r->name, r->scale, r->reps, r->min_ns, r->p50_ns, r->p90_ns, r->p99_ns,
+                r->max_ns, r->mean_ns, r->p50_ns / r->scale, r->checksum, (long long)r->arena_peak,
+                i + 1 < count ? "," : "");
+    }
+    fprintf(file, "  ],\n  \"detectors\": {\n    \"cpu_overload\": {\"latency_samples\": %.2f, "
+            "\"false_positive_rate\": %.4f}\n  }\n}\n", cpu.latency_samples, cpu.false_positive_rate);
+    fclose(file);
+    printf("Results written to %s\n", path);
+}
+
+int main(int argc, char *argv[]) {
+    const char *json_path = NULL;
+    const char *filter = NULL;
+    long long max_scale = 1000000;
+    int reps = 7;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--max-scale") == 0 && i + 1 < argc) {
+            max_scale = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+            reps = atoi(argv[++i]);
+        } else {
+            printf("Usage: %s [--json FILE] [--filter NAME] [--max-scale N] [--reps N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (reps < 1) reps = 1;
+    if (reps > BENCH_MAX_REPS) reps = BENCH_MAX_REPS;
+
+    // Timing a vector kernel that disagrees with the scalar one is meaningless
+    for (FrameScanLevel level = FRAME_SCAN_SSE4; level <= FRAME_SCAN_AVX2; level++) {
+        int mismatches = frame_scan_check(level);
+        if (mismatches > 0) {
+            printf("Error: %s frame scan kernels differ from scalar in %d case(s)\n",
+                   frame_scan_level_name(level), mismatches);
+            return 1;
+        }
+        if (mismatches == 0) {
+            printf("Frame scan %s kernels match scalar.\n", frame_scan_level_name(level));
+        }
+    }
+
+    static BenchResult results[BENCH_MAX_RESULTS];
+    int result_count = 0;
+    printf("%-20s %10s %5s %12s %12s %12s %12s %10s\n",
+           "benchmark", "scale", "reps", "min(us)", "p50(us)", "p90(us)", "p99(us)", "ns/item");
+    for (size_t b = 0; b < sizeof(benchmarks) / sizeof(benchmarks[0]); b++) {
+        const Benchmark *bench = &benchmarks[b];
+        if (filter != NULL && strstr(bench->name, filter) == NULL) continue;
+        for (long long scale = 10; scale <= bench->max_scale && scale <= max_scale; scale *= 10) {
+            BenchResult *r = &results[result_count];
+            if (result_count >= BENCH_MAX_RESULTS || !run_benchmark(bench, scale, reps, r)) {
+                break;
+            }
+            printf("%-20s %10lld %5d %12.1f %12.1f %12.1f %12.1f %10.2f\n", r->name, r->scale, r->reps,
+                   r->min_ns / 1e3, r->p50_ns / 1e3, r->p90_ns / 1e3, r->p99_ns / 1e3, r->p50_ns / r->scale);
+            fflush(stdout);
+            result_count++;
+        }
+    }
+
+    DetectorQuality cpu = measure_cpu_detector(200);
+    printf("\nCPU overload detector: %.2f samples to detect a step to 98%%, %.1f%% false positives on spiky noise\n",
+           cpu.latency_samples, cpu.false_positive_rate * 100.0);
+    if (json_path != NULL) {
+        write_json(json_path, results, result_count, cpu);
+    }
+    return 0;
+}
@@ -0,0 +1,915 @@
+/*
+ * cgroup_monitor.c - cgroup v2 grouping and group-level fault detection
+ *
+ * Every sampled process is attributed to its cgroup from /proc/[pid]/cgroup
+ * (read when the pid first appears and re-checked on a staggered schedule).
+ * Its CPU, resident memory and page-fault frequency are rolled up into the
+ * group and all of its ancestors by applying only the change since the last
+ * sample, so one pass costs O(processes x depth) no matter how many groups
+ * exist. Each group also reads its own cpu.stat, cpu.max, memory.current,
+ * memory.max and PSI files. Overload and thrashing are judged per group with
+ * the same EWMA and enter/exit hysteresis as the host detectors, and a fault
+ * is attributed to the innermost faulty group, drilling down to the child
+ * that dominates its CPU use.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cgroup_monitor.h"
+#include "arena.h"
+#include "procfs.h"
+#include "timing.h"
+#include "workload_gen.h"
+
+#define MAX_HOST_PIDS 32768
+#define INITIAL_CAPACITY 256
+#define GROUP_SLOTS (CGROUP_MAX_GROUPS * 2)
+#define FAULT_OVERLOAD 0x1
+#define FAULT_THRASHING 0x2
+
+typedef struct {
+    float ewma;
+    int hot;
+    int seeded;
+} SmoothedSeries;
+
+typedef struct {
+    int pid;                        // 0 marks an empty slot
+    unsigned int generation;
+    int group;                      // -1 until attributed
+    float cpu_percent;              // contribution currently rolled up
+    long rss_kb;
+    float pff;
+    unsigned long last_ticks;       // live sampling state
+    double last_faults;
+    double last_time;
+} ProcessEntry;
+
+typedef struct {
+    char path[CGROUP_PATH_MAX];
+    int parent;
+    int depth;
+    int first_child;
+    int next_sibling;
+    int processes;                  // rollups over the whole subtree
+    double cpu_percent;
+    double rss_kb;
+    double pff;
+    CgroupFiles files;
+    unsigned int files_generation;  // pass the files were last recorded in
+    unsigned long long prev_usage;
+    double prev_time;
+    double usage_cores;
+    int have_usage;
+    double cpu_limit;
+    int own_cpu_limit;              // cpu_limit comes from this group's cpu.max
+    double cpu_cores;
+    SmoothedSeries cpu_series;
+    SmoothedSeries pff_series;
+    int cpu_pressure_hot;
+    int memory_pressure_hot;
+    int faults;                     // FAULT_* bits
+    int faults_below;
+} Group;
+
+static CgroupConfig config = {0.3f, 90.0f, 75.0f, 40.0f, 20.0f, 10.0f, 5.0f, 2000.0f, 1000.0f, 10.0f, 100};
+static double host_cores = 0.0;
+
+// The pid table and group list live across runs (every run rewinds the run
+// arena), so they stay on the heap like the cpu and thrashing monitors'
+static ProcessEntry *table = NULL;
+static int capacity = 0;
+static int used = 0;
+static unsigned int generation = 1;
+static int passes = 0;
+static int live_sampling = 1;
+static int pid_buffer[MAX_HOST_PIDS];
+
+static Group *groups = NULL;
+static int group_count = 0;
+static int group_capacity = 0;
+static int group_slots[GROUP_SLOTS];    // group index + 1, 0 = empty
+
+void cgroup_monitor_default_config(CgroupConfig *out) {
+    out->alpha = 0.3f;
+    out->cpu_enter = 90.0f;
+    out->cpu_exit = 75.0f;
+    out->cpu_pressure_enter = 40.0f;
+    out->cpu_pressure_exit = 20.0f;
+    out->memory_pressure_enter = 10.0f;
+    out->memory_pressure_exit = 5.0f;
+    out->pff_enter = 2000.0f;
+    out->pff_exit = 1000.0f;
+    out->major_fault_weight = 10.0f;
+    out->interval_ms = 100;
+}
+
+void cgroup_monitor_configure(const CgroupConfig *new_config) {
+    config = *new_config;
+    if (config.alpha <= 0.0f || config.alpha > 1.0f) config.alpha = 0.3f;
+    if (config.cpu_exit > config.cpu_enter) config.cpu_exit = config.cpu_enter;
+    if (config.cpu_pressure_exit > config.cpu_pressure_enter) config.cpu_pressure_exit = config.cpu_pressure_enter;
+    if (config.memory_pressure_exit > config.memory_pressure_enter) {
+        config.memory_pressure_exit = config.memory_pressure_enter;
+    }
+    if (config.pff_exit > config.pff_enter) config.pff_exit = config.pff_enter;
+    if (config.interval_ms < 1) config.interval_ms = 1;
+}
+
+void cgroup_monitor_get_config(CgroupConfig *out) {
+    *out = config;
+}
+
+void cgroup_monitor_reset() {
+    free(table);
+    table = NULL;
+    capacity = 0;
+    used = 0;
+    generation = 1;
+    passes = 0;
+    free(groups);
+    groups = NULL;
+    group_count = 0;
+    group_capacity = 0;
+    memset(group_slots, 0, sizeof(group_slots));
+}
+
+void cgroup_monitor_set_host_cores(double cores) {
+    host_cores = cores;
+}
+
+void cgroup_monitor_set_live_sampling(int enabled) {
+    live_sampling = enabled;
+}
+
+// ---- group tree ----
+
+static unsigned int hash_path(const char *path) {
+    unsigned int hash = 2166136261u;    // FNV-1a
+    for (; *path; path++) hash = (hash ^ (unsigned char)*path) * 16777619u;
+    return hash;
+}
+
+static int find_group(const char *path) {
+    unsigned int i = hash_path(path) & (GROUP_SLOTS - 1);
+    while (group_slots[i] != 0) {
+        if (strcmp(groups[group_slots[i] - 1].path, path) == 0) return group_slots[i] - 1;
+        i = (i + 1) & (GROUP_SLOTS - 1);
+    }
+    return -1;
+}
+
+static int add_group(const char *path, int parent) {
+    if (group_count == group_capacity) {
+        int new_capacity = group_capacity > 0 ? group_capacity * 2 : 64;
+        Group *grown = realloc(groups, sizeof(Group) * (size_t)new_capacity);
+        if (grown == NULL) return -1;
+        groups = grown;
+        group_capacity = new_capacity;
+    }
+    int index = group_count++;
+    Group *group = &groups[index];
+    memset(group, 0, sizeof(*group));
+    snprintf(group->path, sizeof(group->path), "%s", path);
+    group->parent = parent;
+    group->depth = parent >= 0 ? groups[parent].depth + 1 : 0;
+    group->first_child = -1;
+    group->next_sibling = parent >= 0 ? groups[parent].first_child : -1;
+    if (parent >= 0) groups[parent].first_child = index;
+    unsigned int i = hash_path(group->path) & (GROUP_SLOTS - 1);
+    while (group_slots[i] != 0) i = (i + 1) & (GROUP_SLOTS - 1);
+    group_slots[i] = index + 1;
+    return index;
+}
+
+// Index of a group, creating it and any missing ancestors; a full table
+// attributes new groups to their deepest known ancestor
+static int ensure_group(const char *path) {
+    if (group_count == 0 && add_group("/", -1) < 0) return -1;
+    if (path == NULL || path[0] != '/' || path[1] == '\0') return 0;
+    char normalized[CGROUP_PATH_MAX];
+    int length = snprintf(normalized, sizeof(normalized), "%s", path);
+    if (length >= (int)sizeof(normalized)) length = (int)sizeof(normalized) - 1;
+    while (length > 1 && normalized[length - 1] == '/') normalized[--length] = '\0';
+    int index = find_group(normalized);
+    if (index >= 0) return index;
+
+    char *slash = strrchr(normalized, '/');
+    int parent;
+    if (slash == normalized) {
+        parent = 0;
+    } else {
+        *slash = '\0';
+        parent = ensure_group(normalized);
+        *slash = '/';
+    }
+    if (parent < 0 || group_count >= CGROUP_MAX_GROUPS) return parent;
+    index = add_group(normalized, parent);
+    return index >= 0 ? index : parent;
+}
+
+static void roll_up(int group, int processes, double cpu_percent, double rss_kb, double pff) {
+    for (; group >= 0; group = groups[group].parent) {
+        groups[group].processes += processes;
+        groups[group].cpu_percent += cpu_percent;
+        groups[group].rss_kb += rss_kb;
+        groups[group].pff += pff;
+    }
+}
+
+// ---- processes ----
+
+static unsigned int hash_pid(int pid) {
+    return (unsigned int)pid * 2654435761u;
+}
+
+static ProcessEntry *find_slot(ProcessEntry *slots, int slot_capacity, int pid) {
+    unsigned int mask = (unsigned int)slot_capacity - 1;
+    unsigned int i = hash_pid(pid) & mask;
+    while (slots[i].pid != 0 && slots[i].pid != pid) {
+        i = (i + 1) & mask;
+    }
+    return &slots[i];
+}
+
+static void rebuild_table(int new_capacity, int drop_stale) {
+    ProcessEntry *slots = calloc(new_capacity, sizeof(ProcessEntry));
+    if (slots == NULL) {
+        return;
+    }
+    int kept = 0;
+    for (int i = 0; i < capacity; i++) {
+        ProcessEntry *entry = &table[i];
+        if (entry->pid == 0) continue;
+        if (drop_stale && entry->generation != generation) {
+            // Gone: take its contribution back out of every ancestor
+            if (entry->group >= 0) roll_up(entry->group, -1, -entry->cpu_percent, -entry->rss_kb, -entry->pff);
+            continue;
+        }
+        *find_slot(slots, new_capacity, entry->pid) = *entry;
+        kept++;
+    }
+    free(table);
+    table = slots;
+    capacity = new_capacity;
+    used = kept;
+}
+
+static ProcessEntry *find_or_insert(int pid) {
+    if (table == NULL) {
+        capacity = INITIAL_CAPACITY;
+        table = calloc(capacity, sizeof(ProcessEntry));
+        if (table == NULL) {
+            capacity = 0;
+            return NULL;
+        }
+    } else if ((used + 1) * 2 > capacity) {
+        rebuild_table(capacity * 2, 0);
+    }
+    ProcessEntry *entry = find_slot(table, capacity, pid);
+    if (entry->pid == 0) {
+        memset(entry, 0, sizeof(*entry));
+        entry->pid = pid;
+        entry->group = -1;
+        used++;
+    }
+    entry->generation = generation;
+    return entry;
+}
+
+// Move or refresh one process's contribution; group < 0 keeps its current group
+static void update_entry(ProcessEntry *entry, int group, float cpu_percent, long rss_kb, float pff) {
+    if (group < 0) group = entry->group >= 0 ? entry->group : 0;
+    if (entry->group < 0) {
+        roll_up(group, 1, cpu_percent, rss_kb, pff);
+    } else if (entry->group != group) {
+        roll_up(entry->group, -1, -entry->cpu_percent, -entry->rss_kb, -entry->pff);
+        roll_up(group, 1, cpu_percent, rss_kb, pff);
+    } else {
+        roll_up(group, 0, cpu_percent - entry->cpu_percent, (double)(rss_kb - entry->rss_kb), pff - entry->pff);
+    }
+    entry->group = group;
+    entry->cpu_percent = cpu_percent;
+    entry->rss_kb = rss_kb;
+    entry->pff = pff;
+}
+
+// Record one sample for a process; group may be NULL once the pid is known
+void cgroup_monitor_record_process(int pid, const char *group, float cpu_percent, long rss_kb, float pff) {
+    if (pid <= 0) {
+        return;
+    }
+    int index = group != NULL ? ensure_group(group) : (group_count == 0 ? ensure_group("/") : -1);
+    ProcessEntry *entry = find_or_insert(pid);
+    if (entry != NULL) {
+        update_entry(entry, index, cpu_percent, rss_kb, pff);
+    }
+}
+
+static void record_files(Group *group, const CgroupFiles *files, double timestamp) {
+    if (group->prev_time > 0.0 && timestamp > group->prev_time && files->cpu_usage_usec >= group->prev_usage &&
+        files->cpu_usage_usec > 0) {
+        group->usage_cores = (files->cpu_usage_usec - group->prev_usage) / 1e6 / (timestamp - group->prev_time);
+        group->have_usage = 1;
+    }
+    group->prev_usage = files->cpu_usage_usec;
+    group->prev_time = timestamp;
+    group->files = *files;
+    group->files_generation = generation;
+}
+
+// Record a group's interface files as read at timestamp (seconds)
+void cgroup_monitor_record_group(const char *path, const CgroupFiles *files, double timestamp) {
+    int index = ensure_group(path);
+    if (index >= 0) record_files(&groups[index], files, timestamp);
+}
+
+// ---- detection ----
+
+static void update_series(SmoothedSeries *series, float value, float enter, float exit) {
+    if (!series->seeded) {
+        series->ewma = value;
+        series->seeded = 1;
+    } else {
+        series->ewma += config.alpha * (value - series->ewma);
+    }
+    if (series->hot) {
+        series->hot = series->ewma > exit;
+    } else {
+        series->hot = series->ewma >= enter;
+    }
+}
+
+static int hysteresis(int hot, float value, float enter, float exit) {
+    return hot ? value > exit : value >= enter;
+}
+
+static void evaluate_groups() {
+    // Parents precede their children, so limits flow down in one forward pass
+    double host = host_cores > 0.0 ? host_cores : 1.0;
+    for (int i = 0; i < group_count; i++) {
+        Group *group = &groups[i];
+        group->faults_below = 0;
+        if (group->processes <= 0 && i > 0) {
+            // Empty subtree: clear float drift from the incremental sums
+            group->processes = 0;
+            group->cpu_percent = group->rss_kb = group->pff = 0.0;
+            group->faults = 0;
+            group->cpu_series.hot = group->pff_series.hot = 0;
+            group->cpu_pressure_hot = group->memory_pressure_hot = 0;
+            group->cpu_limit = i > 0 ? groups[group->parent].cpu_limit : host;
+            group->own_cpu_limit = 0;
+            continue;
+        }
+        int fresh = group->files_generation == generation;
+        double parent_limit = i > 0 ? groups[group->parent].cpu_limit : host;
+        double own_limit = fresh ? group->files.cpu_limit : 0.0;
+        group->own_cpu_limit = own_limit > 0.0 && own_limit <= parent_limit;
+        group->cpu_limit = group->own_cpu_limit ? own_limit : parent_limit;
+        group->cpu_cores = fresh && group->have_usage ? group->usage_cores : group->cpu_percent / 100.0;
+        if (!fresh || group->have_usage) {
+            // The first cpu.stat read has nothing to diff against yet
+            update_series(&group->cpu_series, (float)(100.0 * group->cpu_cores / group->cpu_limit),
+                          config.cpu_enter, config.cpu_exit);
+        }
+        update_series(&group->pff_series, (float)group->pff, config.pff_enter, config.pff_exit);
+        group->cpu_pressure_hot = fresh && hysteresis(group->cpu_pressure_hot, group->files.cpu_some_avg10,
+                                                      config.cpu_pressure_enter, config.cpu_pressure_exit);
+        group->memory_pressure_hot = fresh && hysteresis(group->memory_pressure_hot, group->files.memory_full_avg10,
+                                                         config.memory_pressure_enter, config.memory_pressure_exit);
+        group->faults = 0;
+        // Stalls alone also hit the victims of a busy neighbour, so pressure
+        // only counts for a group already running close to its own limit
+        if (group->cpu_series.hot || (group->cpu_pressure_hot && group->cpu_series.ewma > config.cpu_exit)) {
+            group->faults |= FAULT_OVERLOAD;
+        }
+        // Fault frequency only means thrashing where the group has its own memory limit;
+        // unlimited groups are covered by the host and per-process detectors
+        if (group->memory_pressure_hot || (group->pff_series.hot && group->files.memory_max > 0)) {
+            group->faults |= FAULT_THRASHING;
+        }
+    }
+    for (int i = group_count - 1; i > 0; i--) {
+        groups[groups[i].parent].faults_below |= groups[i].faults | groups[i].faults_below;
+    }
+}
+
+// Close a sampling pass: forget processes not seen in it and re-judge every group
+void cgroup_monitor_end_pass() {
+    int stale = 0;
+    for (int i = 0; i < capacity; i++) {
+        if (table[i].pid != 0 && table[i].generation != generation) {
+            stale = 1;
+            break;
+        }
+    }
+    if (stale) {
+        rebuild_table(capacity, 1);
+    }
+    evaluate_groups();
+    generation++;
+    passes++;
+}
+
+// Sample /proc and the cgroup files once; returns processes sampled, 0 without cgroup v2
+int cgroup_monitor_sample() {
+    if (!procfs_available() || procfs_cgroup_root() == NULL) {
+        return 0;
+    }
+    if (host_cores <= 0.0) {
+        CpuTimes host, cores[256];
+        int cpus = procfs_read_cpu_times(&host, cores, 256);
+        host_cores = cpus > 0 ? cpus : 1;
+    }
+    ensure_group("/");
+    int pid_total = procfs_list_pids(pid_buffer, MAX_HOST_PIDS);
+    double now = monotonic_seconds();
+    double ticks_per_second = (double)procfs_clock_ticks();
+    long page_kb = procfs_page_size() / 1024;
+    int sampled = 0;
+    for (int i = 0; i < pid_total; i++) {
+        ProcPidStat stat;
+        if (!procfs_read_pid_stat(pid_buffer[i], &stat)) {
+            continue;
+        }
+        ProcessEntry *entry = find_or_insert(stat.pid);
+        if (entry == NULL) {
+            continue;
+        }
+        // New pids are attributed at once; known ones re-checked in a staggered
+        // rotation so migrations are caught without re-reading every file
+        int group = -1;
+        if (entry->group < 0 || (stat.pid + passes) % CGROUP_RECHECK_PASSES == 0) {
+            char path[CGROUP_PATH_MAX];
+            group = ensure_group(procfs_read_pid_cgroup(stat.pid, path, sizeof(path)) ? path : "/");
+        }
+        unsigned long ticks = stat.utime + stat.stime;
+        double faults = stat.minflt + config.major_fault_weight * (double)stat.majflt;
+        float cpu = entry->cpu_percent, pff = entry->pff;
+        if (entry->last_time > 0.0 && now > entry->last_time && ticks >= entry->last_ticks) {
+            double elapsed = now - entry->last_time;
+            cpu = (float)(100.0 * (ticks - entry->last_ticks) / ticks_per_second / elapsed);
+            pff = faults >= entry->last_faults ? (float)((faults - entry->last_faults) / elapsed) : 0.0f;
+        }
+        entry->last_ticks = ticks;
+        entry->last_faults = faults;
+        entry->last_time = now;
+        update_entry(entry, group, cpu, stat.rss_pages * page_kb, pff);
+        sampled++;
+    }
+    now = monotonic_seconds();
+    for (int g = 0; g < group_count; g++) {
+        CgroupFiles files;
+        if ((groups[g].processes > 0 || g == 0) && procfs_read_cgroup_files(groups[g].path, &files)) {
+            record_files(&groups[g], &files, now);
+        }
+    }
+    cgroup_monitor_end_pass();
+    return sampled;
+}
+
+// Sample, making sure usage deltas exist; with live sampling off the recorded
+// samples are used as they are
+int cgroup_monitor_refresh() {
+    if (!live_sampling) {
+        return used;
+    }
+    int sampled = cgroup_monitor_sample();
+    if (sampled > 0 && passes < 2) {
+        sleep_ms(config.interval_ms);
+        sampled = cgroup_monitor_sample();
+    }
+    return sampled;
+}
+
+// ---- reporting and recovery plans ----
+
+int cgroup_monitor_group_count() {
+    return group_count;
+}
+
+static void fill_stats(const Group *group, CgroupStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    snprintf(stats->path, sizeof(stats->path), "%s", group->path);
+    stats->depth = group->depth;
+    stats->processes = group->processes;
+    stats->cpu_percent = (float)group->cpu_percent;
+    stats->rss_kb = (long long)group->rss_kb;
+    stats->pff = (float)group->pff;
+    stats->cpu_cores = group->cpu_cores;
+    stats->cpu_limit = group->cpu_limit;
+    stats->cpu_ewma = group->cpu_series.ewma;
+    stats->files = group->files;
+    stats->overloaded = (group->faults & FAULT_OVERLOAD) != 0;
+    stats->thrashing = (group->faults & FAULT_THRASHING) != 0;
+    stats->innermost = (group->faults & ~group->faults_below) != 0;
+}
+
+int cgroup_monitor_lookup(const char *path, CgroupStats *stats) {
+    int index = group_count > 0 ? find_group(path) : -1;
+    if (index < 0) {
+        return 0;
+    }
+    fill_stats(&groups[index], stats);
+    return 1;
+}
+
+static int compare_cores_desc(const void *a, const void *b) {
+    double ca = ((const CgroupStats *)a)->cpu_cores;
+    double cb = ((const CgroupStats *)b)->cpu_cores;
+    return (ca < cb) - (ca > cb);
+}
+
+// Collect groups matching flags, busiest first; returns the count
+int cgroup_monitor_collect(CgroupStats *out, int max_entries, unsigned int flags) {
+    int wanted = 0;
+    if (flags & CGROUP_COLLECT_OVERLOADED) wanted |= FAULT_OVERLOAD;
+    if (flags & CGROUP_COLLECT_THRASHING) wanted |= FAULT_THRASHING;
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    CgroupStats *all = arena_alloc(arena, sizeof(CgroupStats) * (size_t)(group_count > 0 ? group_count : 1));
+    if (all == NULL) {
+        return 0;
+    }
+    int found = 0;
+    for (int i = 0; i < group_count; i++) {
+        const Group *group = &groups[i];
+        if (group->processes <= 0) continue;
+        int faults = group->faults & wanted;
+        if (flags & CGROUP_COLLECT_INNERMOST) faults &= ~group->faults_below;
+        if (!(flags & CGROUP_COLLECT_ALL) && faults == 0) continue;
+        fill_stats(group, &all[found++]);
+    }
+    qsort(all, found, sizeof(CgroupStats), compare_cores_desc);
+    if (found > max_entries) found = max_entries;
+    memcpy(out, all, sizeof(CgroupStats) * (size_t)found);
+    arena_release(arena, mark);
+    return found;
+}
+
+void cgroup_monitor_plan(const CgroupStats *stats, CgroupRecovery *plan) {
+    memset(plan, 0, sizeof(*plan));
+    int index = find_group(stats->path);
+    if (index < 0) {
+        return;
+    }
+    const Group *group = &groups[index];
+    double exit_cores = group->cpu_limit * config.cpu_exit / 100.0;
+    if ((group->faults & FAULT_OVERLOAD) && group->cpu_cores > exit_cores) {
+        // Follow the child holding at least half of the usage down to the
+        // consumer, then cap it so the faulty group settles 10% below exit
+        int target = index;
+        for (;;) {
+            int best = -1;
+            for (int c = groups[target].first_child; c >= 0; c = groups[c].next_sibling) {
+                if (groups[c].processes > 0 && (best < 0 || groups[c].cpu_cores > groups[best].cpu_cores)) best = c;
+            }
+            if (best < 0 || groups[best].cpu_cores < 0.5 * groups[target].cpu_cores) break;
+            target = best;
+        }
+        double others = group->cpu_cores - groups[target].cpu_cores;
+        double cap = 0.9 * exit_cores - others;
+        if (cap > 0.9 * groups[target].cpu_cores) cap = 0.9 * groups[target].cpu_cores;
+        if (cap < 0.05 * group->cpu_limit) cap = 0.05 * group->cpu_limit;
+        // A group held at its own cpu.max with no dominant child is already contained
+        if (target != index || !group->own_cpu_limit) {
+            snprintf(plan->cpu_target, sizeof(plan->cpu_target), "%s", groups[target].path);
+            plan->cpu_max_cores = cap;
+        }
+    }
+    if (group->faults & FAULT_THRASHING) {
+        // Protect the measured working set and give a tight limit 25% headroom above it
+        long long working_set = (long long)group->rss_kb * 1024;
+        snprintf(plan->memory_target, sizeof(plan->memory_target), "%s", group->path);
+        plan->memory_low = working_set;
+        long long wanted = working_set + working_set / 4;
+        if (group->files.memory_max > 0 && group->files.memory_max < wanted) {
+            plan->memory_max = (wanted + (1 << 20) - 1) & ~((1LL << 20) - 1);
+        }
+    }
+}
+
+void cgroup_monitor_print_plan(const CgroupStats *stats, const CgroupRecovery *plan) {
+    const char *root = procfs_cgroup_root();
+    if (root == NULL) root = "/sys/fs/cgroup";
+    if (stats->overloaded) {
+        printf("  %s overloaded: %.2f of %.2f cores (smoothed %.0f%%), cpu pressure %.1f%%\n",
+               stats->path, stats->cpu_cores, stats->cpu_limit, stats->cpu_ewma, stats->files.cpu_some_avg10);
+    }
+    if (stats->thrashing) {
+        printf("  %s thrashing: %.0f faults/s, working set %lld MB of %lld MB allowed, memory pressure %.1f%%\n",
+               stats->path, stats->pff, stats->rss_kb / 1024, stats->files.memory_max >> 20,
+               stats->files.memory_full_avg10);
+    }
+    if (plan->cpu_max_cores > 0.0) {
+        printf("    echo '%lld 100000' > %s%s/cpu.max\n", (long long)(plan->cpu_max_cores * 100000.0), root,
+               strcmp(plan->cpu_target, "/") == 0 ? "" : plan->cpu_target);
+    }
+    if (plan->memory_low > 0) {
+        const char *target = strcmp(plan->memory_target, "/") == 0 ? "" : plan->memory_target;
+        printf("    echo %lld > %s%s/memory.low\n", plan->memory_low, root, target);
+        if (plan->memory_max > 0) printf("    echo %lld > %s%s/memory.max\n", plan->memory_max, root, target);
+    }
+}
+
+// ---- synthetic host ----
+
+typedef struct {
+    int parent;
+    double cpu_limit;               // cores, 0 = unlimited
+    long long memory_max;           // bytes, 0 = unlimited
+    double wanted;                  // per pass: cores wanted by the subtree
+    double demand;                  // wanted, clipped at every cpu.max below
+    double allocated;
+    long long working_set;
+    double usage_usec;
+    int overload_at;                // pass a fault was injected, -1 = none
+    int thrash_at;
+    int detected_at;
+    int recovered_at;
+} SynthGroup;
+
+typedef struct {
+    int group;
+    float cpu_demand;               // % of one core
+    long rss_kb;
+} SynthProcess;
+
+static int synth_add(SynthGroup *model, char (*paths)[CGROUP_PATH_MAX], int *count, int parent, const char *path,
+                     double cpu_limit, long long memory_max) {
+    SynthGroup *group = &model[*count];
+    memset(group, 0, sizeof(*group));
+    group->parent = parent;
+    group->cpu_limit = cpu_limit;
+    group->memory_max = memory_max;
+    group->overload_at = group->thrash_at = group->detected_at = group->recovered_at = -1;
+    snprintf(paths[*count], CGROUP_PATH_MAX, "%s", path);
+    return (*count)++;
+}
+
+static int synth_command(int group_target, int process_count, int pass_count) {
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    SynthGroup *model = arena_calloc(arena, (size_t)group_target + 8, sizeof(SynthGroup));
+    char (*paths)[CGROUP_PATH_MAX] = arena_calloc(arena, (size_t)group_target + 8, CGROUP_PATH_MAX);
+    SynthProcess *procs = arena_calloc(arena, (size_t)process_count, sizeof(SynthProcess));
+    int *leaves = arena_calloc(arena, (size_t)group_target + 8, sizeof(int));
+    if (model == NULL || paths == NULL || procs == NULL || leaves == NULL) {
+        printf("Not enough memory for the synthetic host.\n");
+        arena_release(arena, mark);
+        return 1;
+    }
+
+    // Services, user scopes and pods (with a container each) under three slices
+    const double cores = 32.0 * ((process_count + 4999) / 5000);   // about 30% busy at rest
+    int count = 0, leaf_count = 0;
+    synth_add(model, paths, &count, -1, "/", 0.0, 0);
+    int system = synth_add(model, paths, &count, 0, "/system.slice", 0.0, 0);
+    int user = synth_add(model, paths, &count, 0, "/user.slice", 0.0, 0);
+    int pods = synth_add(model, paths, &count, 0, "/kubepods.slice", 0.0, 0);
+    char path[CGROUP_PATH_MAX];
+    for (int k = 0; count < group_target; k++) {
+        if (k % 4 == 3 && count + 2 <= group_target) {
+            snprintf(path, sizeof(path), "/kubepods.slice/pod-%d", k);
+            int pod = synth_add(model, paths, &count, pods, path, 2.0, 512LL << 20);
+            snprintf(path, sizeof(path), "/kubepods.slice/pod-%d/app", k);
+            leaves[leaf_count++] = synth_add(model, paths, &count, pod, path, 0.0, 0);
+        } else if (k % 4 == 2) {
+            snprintf(path, sizeof(path), "/user.slice/app-%d.scope", k);
+            leaves[leaf_count++] = synth_add(model, paths, &count, user, path, 0.0, 0);
+        } else {
+            snprintf(path, sizeof(path), "/system.slice/svc-%d.service", k);
+            leaves[leaf_count++] = synth_add(model, paths, &count, system, path, 0.0, 1LL << 30);
+        }
+    }
+    unsigned long long state = 44;
+    for (int p = 0; p < process_count; p++) {
+        procs[p].group = leaves[p % leaf_count];
+        procs[p].cpu_demand = (float)wg_exponential(&state, 0.2);
+        procs[p].rss_kb = 4096 + (long)wg_exponential(&state, 12000.0);
+    }
+    // A runaway service and a pod whose working set outgrows its limit
+    int fault_pass = pass_count / 4;
+    int runaway = leaves[0], squeezed = -1;
+    for (int l = 0; l < leaf_count && squeezed < 0; l++) {
+        if (model[model[leaves[l]].parent].memory_max > 0 && model[leaves[l]].parent != 0) squeezed = leaves[l];
+    }
+
+    cgroup_monitor_reset();
+    cgroup_monitor_set_host_cores(cores);
+    double record_seconds = 0.0, worst_pass = 0.0;
+    int actions = 0;
+    printf("=== CGROUP GROUPING (synthetic): %d groups, %d processes, %d passes, %.0f cores ===\n",
+           count, process_count, pass_count, cores);
+    printf("Pass %d: injecting runaway CPU in %s", fault_pass, paths[runaway]);
+    if (squeezed >= 0) printf(" and memory squeeze in %s", paths[model[squeezed].parent]);
+    printf("\n");
+
+    for (int pass = 0; pass < pass_count; pass++) {
+        if (pass == fault_pass) {
+            // The runaway asks for twice the host between its processes
+            int members = (process_count + leaf_count - 1) / leaf_count;
+            model[runaway].overload_at = pass;
+            for (int p = 0; p < process_count; p++) {
+                if (procs[p].group == runaway) procs[p].cpu_demand = (float)(200.0 * cores / members);
+            }
+            if (squeezed >= 0) {
+                model[model[squeezed].parent].thrash_at = pass;
+                for (int p = 0; p < process_count; p++) {
+                    if (procs[p].group == squeezed) procs[p].rss_kb *= 8;
+                }
+            }
+        }
+        // Demand and working sets bottom-up, clipping demand at every cpu.max,
+        // then the host's cores shared out top-down in proportion to it
+        for (int g = 0; g < count; g++) {
+            model[g].wanted = model[g].demand = 0.0;
+            model[g].working_set = 0;
+        }
+        for (int p = 0; p < process_count; p++) {
+            model[procs[p].group].wanted += procs[p].cpu_demand / 100.0;
+            model[procs[p].group].demand += procs[p].cpu_demand / 100.0;
+            model[procs[p].group].working_set += (long long)procs[p].rss_kb * 1024;
+        }
+        for (int g = count - 1; g >= 0; g--) {
+            if (model[g].cpu_limit > 0.0 && model[g].demand > model[g].cpu_limit) model[g].demand = model[g].cpu_limit;
+            if (g == 0) break;
+            model[model[g].parent].wanted += model[g].wanted;
+            model[model[g].parent].demand += model[g].demand;
+            model[model[g].parent].working_set += model[g].working_set;
+        }
+        for (int g = 0; g < count; g++) {
+            const SynthGroup *parent = g > 0 ? &model[model[g].parent] : NULL;
+            double available = parent == NULL ? cores :
+                               parent->demand > 0.0 ? parent->allocated * model[g].demand / parent->demand : 0.0;
+            model[g].allocated = available < model[g].demand ? available : model[g].demand;
+            model[g].usage_usec += model[g].allocated * 1e6;
+        }
+
+        double start = monotonic_seconds();
+        for (int p = 0; p < process_count; p++) {
+            const SynthGroup *group = &model[procs[p].group];
+            double share = group->wanted > 0.0 ? group->allocated / group->wanted : 1.0;
+            long long limit = 0;
+            for (int g = procs[p].group; g >= 0; g = model[g].parent) {
+                if (model[g].memory_max > 0 && (limit == 0 || model[g].memory_max < limit)) limit = model[g].memory_max;
+            }
+            long long limit_group_ws = 0;
+            for (int g = procs[p].group; g >= 0; g = model[g].parent) {
+                if (model[g].memory_max == limit) {
+                    limit_group_ws = model[g].working_set;
+                    break;
+                }
+            }
+            float pff = 2.0f;
+            if (limit > 0 && limit_group_ws > limit) pff += (float)(500.0 * ((double)limit_group_ws / limit - 1.0));
+            cgroup_monitor_record_process(p + 1, pass == 0 ? paths[procs[p].group] : NULL,
+                                          (float)(procs[p].cpu_demand * share), procs[p].rss_kb, pff);
+        }
+        for (int g = 0; g < count; g++) {
+            CgroupFiles files;
+            memset(&files, 0, sizeof(files));
+            files.cpu_usage_usec = (unsigned long long)model[g].usage_usec;
+            files.cpu_limit = model[g].cpu_limit;
+            files.memory_max = model[g].memory_max;
+            files.memory_current = model[g].memory_max > 0 && model[g].working_set > model[g].memory_max ?
+                                   model[g].memory_max : model[g].working_set;
+            if (model[g].wanted > model[g].allocated) {
+                files.cpu_some_avg10 = (float)(100.0 * (1.0 - model[g].allocated / model[g].wanted));
+            }
+            if (model[g].memory_max > 0 && model[g].working_set > model[g].memory_max) {
+                double over = (double)model[g].working_set / model[g].memory_max - 1.0;
+                files.memory_full_avg10 = (float)(over > 0.8 ? 80.0 : 100.0 * over);
+                files.memory_some_avg10 = files.memory_full_avg10 * 1.2f;
+            }
+            cgroup_monitor_record_group(paths[g], &files, pass + 1.0);
+        }
+        cgroup_monitor_end_pass();
+        double elapsed = monotonic_seconds() - start;
+        record_seconds += elapsed;
+        if (elapsed > worst_pass) worst_pass = elapsed;
+
+        // Apply the plans to the model as the kernel would enforce them
+        CgroupStats faulty[16];
+        int found = cgroup_monitor_collect(faulty, 16, CGROUP_COLLECT_OVERLOADED | CGROUP_COLLECT_THRASHING |
+                                                       CGROUP_COLLECT_INNERMOST);
+        for (int f = 0; f < found; f++) {
+            CgroupRecovery plan;
+            cgroup_monitor_plan(&faulty[f], &plan);
+            if (plan.cpu_max_cores <= 0.0 && plan.memory_max <= 0) continue;
+            printf("Pass %d:\n", pass);
+            cgroup_monitor_print_plan(&faulty[f], &plan);
+            for (int g = 0; g < count; g++) {
+                if (plan.cpu_max_cores > 0.0 && strcmp(paths[g], plan.cpu_target) == 0) {
+                    model[g].cpu_limit = plan.cpu_max_cores;
+                    if (model[g].detected_at < 0) model[g].detected_at = pass;
+                    actions++;
+                }
+                if (plan.memory_max > 0 && strcmp(paths[g], plan.memory_target) == 0) {
+                    model[g].memory_max = plan.memory_max;
+                    if (model[g].detected_at < 0) model[g].detected_at = pass;
+                    actions++;
+                }
+            }
+        }
+        // Recovered once nothing above a capped runaway is overloaded any more
+        // and a squeezed group has stopped thrashing
+        for (int g = 0; g < count; g++) {
+            if (model[g].detected_at < 0 || model[g].recovered_at >= 0) continue;
+            CgroupStats stats;
+            int healthy = cgroup_monitor_lookup(paths[g], &stats) && !stats.thrashing;
+            for (int a = model[g].parent; healthy && model[g].overload_at >= 0 && a >= 0; a = model[a].parent) {
+                healthy = cgroup_monitor_lookup(paths[a], &stats) && !stats.overloaded;
+            }
+            if (healthy) model[g].recovered_at = pass;
+        }
+    }
+
+    printf("\n%-40s %10s %10s %10s\n", "Faulty group", "Injected", "Detected", "Recovered");
+    for (int g = 0; g < count; g++) {
+        int fault_start = model[g].overload_at >= 0 ? model[g].overload_at : model[g].thrash_at;
+        if (fault_start < 0) continue;
+        printf("%-40s %10d", paths[g], fault_start);
+        if (model[g].detected_at >= 0) printf(" %10d", model[g].detected_at);
+        else printf(" %10s", "-");
+        if (model[g].recovered_at >= 0) printf(" %10d\n", model[g].recovered_at);
+        else printf(" %10s\n", "-");
+    }
+    printf("\n%d recovery actions; %d groups tracked; per pass %.3f ms mean, %.3f ms worst "
+           "(record %d processes and %d groups, roll up, detect), %.2f%% of a 1 s interval\n",
+           actions, cgroup_monitor_group_count(), 1000.0 * record_seconds / pass_count, 1000.0 * worst_pass,
+           process_count, count, 100.0 * worst_pass);
+    cgroup_monitor_reset();
+    arena_release(arena, mark);
+    return 0;
+}
+
+// ---- command line ----
+
+static void print_groups(int limit) {
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    CgroupStats *top = arena_alloc(arena, sizeof(CgroupStats) * (size_t)limit);
+    if (top == NULL) return;
+    int found = cgroup_monitor_collect(top, limit, CGROUP_COLLECT_ALL);
+    printf("%-44s %6s %7s %7s %6s %9s %9s %6s %6s State\n", "Group", "Procs", "Cores", "Limit", "Use%",
+           "RSS MB", "PFF", "CPU P", "Mem P");
+    for (int i = 0; i < found; i++) {
+        const CgroupStats *g = &top[i];
+        int length = (int)strlen(g->path);
+        const char *shown = length > 44 ? g->path + length - 44 : g->path;
+        printf("%-44s %6d %7.2f %7.2f %5.0f%% %9lld %9.0f %5.1f%% %5.1f%%%s%s\n", shown, g->processes,
+               g->cpu_cores, g->cpu_limit, g->cpu_ewma, g->rss_kb / 1024, g->pff, g->files.cpu_some_avg10,
+               g->files.memory_full_avg10, g->overloaded ? " OVERLOAD" : "", g->thrashing ? " THRASHING" : "");
+    }
+    arena_release(arena, mark);
+}
+
+int cgroup_command(int argc, char *argv[]) {
+    if (argc > 0 && strcmp(argv[0], "synth") == 0) {
+        int group_target = argc > 1 ? atoi(argv[1]) : 300;
+        int process_count = argc > 2 ? atoi(argv[2]) : 5000;
+        int pass_count = argc > 3 ? atoi(argv[3]) : 60;
+        if (group_target < 8 || process_count < 1 || pass_count < 4) {
+            printf("Usage: cgroups synth [groups >= 8] [processes] [passes >= 4]\n");
+            return 1;
+        }
+        return synth_command(group_target, process_count, pass_count);
+    }
+    int pass_count = argc > 0 ? atoi(argv[0]) : 3;
+    int interval_ms = argc > 1 ? atoi(argv[1]) : 1000;
+    if (pass_count < 1 || interval_ms < 1) {
+        printf("Usage: cgroups [passes] [interval ms] | cgroups synth [groups] [processes] [passes]\n");
+        return 1;
+    }
+    if (procfs_cgroup_root() == NULL) {
+        printf("No cgroup v2 hierarchy mounted; try 'cgroups synth'.\n");
+        return 1;
+    }
+    printf("=== CGROUP GROUPING: %s, %d passes every %d ms ===\n", procfs_cgroup_root(), pass_count, interval_ms);
+    double worst = 0.0;
+    int sampled = 0;
+    for (int pass = 0; pass <= pass_count; pass++) {
+        if (pass > 0) sleep_ms(interval_ms);
+        double start = monotonic_seconds();
+        sampled = cgroup_monitor_sample();
+        double elapsed = monotonic_seconds() - start;
+        if (pass > 0 && elapsed > worst) worst = elapsed;
+    }
+    printf("%d processes in %d groups; slowest pass %.1f ms\n\n", sampled, cgroup_monitor_group_count(),
+           1000.0 * worst);
+    print_groups(25);
+
+    CgroupStats faulty[16];
+    int found = cgroup_monitor_collect(faulty, 16, CGROUP_COLLECT_OVERLOADED | CGROUP_COLLECT_THRASHING |
+                                                   CGROUP_COLLECT_INNERMOST);
+    printf("\n%d faulty groups (innermost)%s\n", found, found > 0 ? "; suggested limits (dry run):" : "");
+    for (int f = 0; f < found; f++) {
+        CgroupRecovery plan;
+        cgroup_monitor_plan(&faulty[f], &plan);
+        cgroup_monitor_print_plan(&faulty[f], &plan);
+    }
+    cgroup_monitor_reset();
+    return 0;
+}
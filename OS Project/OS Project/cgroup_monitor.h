@@ -0,0 +1,80 @@
+/*
+ * cgroup_monitor.h - Header for cgroup v2 grouping and group-level fault detection
+ */
+
+#ifndef CGROUP_MONITOR_H
+#define CGROUP_MONITOR_H
+
+#include "procfs.h"
+
+#define CGROUP_PATH_MAX 256
+#define CGROUP_MAX_GROUPS 8192
+#define CGROUP_RECHECK_PASSES 16    // each pid's cgroup is re-read once per this many passes
+
+// Smoothing and hysteresis for the group detectors
+typedef struct {
+    float alpha;                    // EWMA weight of the newest sample (0..1]
+    float cpu_enter;                // % of the group's effective CPU limit
+    float cpu_exit;
+    float cpu_pressure_enter;       // cpu.pressure some avg10 %
+    float cpu_pressure_exit;
+    float memory_pressure_enter;    // memory.pressure full avg10 %
+    float memory_pressure_exit;
+    float pff_enter;                // rolled-up weighted page faults/sec of the group
+    float pff_exit;
+    float major_fault_weight;
+    int interval_ms;                // sampling interval used when warming up
+} CgroupConfig;
+
+typedef struct {
+    char path[CGROUP_PATH_MAX];
+    int depth;                      // 0 = root (the whole host)
+    int processes;                  // members in this group and below
+    float cpu_percent;              // rolled up from member processes, % of one core
+    long long rss_kb;
+    float pff;
+    double cpu_cores;               // usage used by the detector (cpu.stat, else the rollup)
+    double cpu_limit;               // effective: own cpu.max or the tightest ancestor's
+    float cpu_ewma;                 // smoothed % of cpu_limit
+    CgroupFiles files;
+    int overloaded;
+    int thrashing;
+    int innermost;                  // faulty with no faulty descendant
+} CgroupStats;
+
+// Dry-run recovery for one faulty group
+typedef struct {
+    char cpu_target[CGROUP_PATH_MAX];       // dominant consumer below an overloaded group
+    double cpu_max_cores;                   // 0 = leave cpu.max alone
+    char memory_target[CGROUP_PATH_MAX];
+    long long memory_max;                   // bytes, 0 = leave memory.max alone
+    long long memory_low;                   // bytes of working set to protect from reclaim
+} CgroupRecovery;
+
+#define CGROUP_COLLECT_OVERLOADED 0x1
+#define CGROUP_COLLECT_THRASHING 0x2
+#define CGROUP_COLLECT_INNERMOST 0x4
+#define CGROUP_COLLECT_ALL 0x8
+
+void cgroup_monitor_default_config(CgroupConfig *config);
+void cgroup_monitor_configure(const CgroupConfig *config);
+void cgroup_monitor_get_config(CgroupConfig *config);
+void cgroup_monitor_reset();
+void cgroup_monitor_set_host_cores(double cores);
+
+void cgroup_monitor_record_process(int pid, const char *group, float cpu_percent, long rss_kb, float pff);
+void cgroup_monitor_record_group(const char *group, const CgroupFiles *files, double timestamp);
+void cgroup_monitor_end_pass();
+void cgroup_monitor_set_live_sampling(int enabled);
+int cgroup_monitor_sample();
+int cgroup_monitor_refresh();
+
+int cgroup_monitor_group_count();
+int cgroup_monitor_lookup(const char *group, CgroupStats *stats);
+int cgroup_monitor_collect(CgroupStats *out, int max_entries, unsigned int flags);
+void cgroup_monitor_plan(const CgroupStats *group, CgroupRecovery *plan);
+void cgroup_monitor_print_plan(const CgroupStats *group, const CgroupRecovery *plan);
+
+int cgroup_command(int argc, char *argv[]);
+
+#endif // CGROUP_MONITOR_H
@@ -0,0 +1,468 @@
+/*
+ * chaos.c - Continuous fault stream with periodic detection and recovery
+ *
+ * The inject/detect menu handles one fault at a time. This runs the system
+ * for days of simulated time instead: deadlocks, CPU overloads, thrashing,
+ * I/O storms and priority inversions arrive as one Poisson stream (or a
+ * bursty, Markov-modulated one), some of them dragging a correlated second
+ * fault in with them. Detectors run every check interval and miss an active
+ * fault with a per-kind probability; detected faults wait for a recovery
+ * worker, and a failed recovery is retried on the next detector pass.
+ *
+ * Each fault costs a handful of heap events, and detection times are drawn
+ * directly instead of simulating every empty detector pass, so a year of
+ * operation runs in well under a second per recovery policy.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "chaos.h"
+#include "arena.h"
+#include "timing.h"
+#include "workload_gen.h"
+
+#define TTR_SUB_BUCKETS 16          // per power of two, about 6% resolution
+#define TTR_BUCKETS (64 * TTR_SUB_BUCKETS)
+#define TTR_MIN_EXPONENT -10        // times below ~1 ms share the first bucket
+#define NO_SWITCH 1e300
+
+static const char *kind_names[CHAOS_KINDS] = {
+    "deadlock", "cpu_overload", "thrashing", "io_storm", "prio_inversion"
+};
+
+// Second fault a compound event brings along
+static const ChaosFaultKind partner_kind[CHAOS_KINDS] = {
+    CHAOS_PRIORITY_INVERSION,       // deadlock: lock waiters pile up behind it
+    CHAOS_THRASHING,                // overload: working sets outgrow memory
+    CHAOS_IO_STORM,                 // thrashing: swap traffic floods the disk
+    CHAOS_CPU_OVERLOAD,             // I/O storm: blocked work comes back at once
+    CHAOS_DEADLOCK                  // inversion: timeouts turn into lock cycles
+};
+
+static const ChaosPolicy policies[] = {
+    {"serial", 1, 10.0, 0},
+    {"severity", 1, 10.0, 1},
+    {"pool-4", 4, 10.0, 0},
+    {"parallel", 0, 10.0, 0},
+    {"slow-checks", 1, 60.0, 0},
+};
+#define POLICY_COUNT (int)(sizeof(policies) / sizeof(policies[0]))
+
+void chaos_default_config(ChaosConfig *config) {
+    static const ChaosFaultModel defaults[CHAOS_KINDS] = {
+        {0.5, 0.95, 30.0, 0.95, 0},
+        {2.0, 0.80, 20.0, 0.90, 3},
+        {1.0, 0.70, 90.0, 0.85, 1},
+        {1.0, 0.90, 45.0, 0.90, 2},
+        {0.5, 0.60, 10.0, 0.98, 4},
+    };
+    memset(config, 0, sizeof(*config));
+    memcpy(config->kinds, defaults, sizeof(defaults));
+    config->days = 365.0;
+    config->rate_scale = 2.0;
+    config->bursty = 0;
+    config->burst_factor = 20.0;
+    config->burst_mean_s = 600.0;
+    config->calm_mean_s = 6.0 * 3600.0;
+    config->compound_probability = 0.1;
+    config->seed = 42;
+}
+
+const char *chaos_kind_name(ChaosFaultKind kind) {
+    return kind >= 0 && kind < CHAOS_KINDS ? kind_names[kind] : "unknown";
+}
+
+int chaos_policy_count() {
+    return POLICY_COUNT;
+}
+
+const ChaosPolicy *chaos_policy(int index) {
+    return index >= 0 && index < POLICY_COUNT ? &policies[index] : NULL;
+}
+
+static int ttr_bucket(double seconds) {
+    unsigned long long bits;
+    memcpy(&bits, &seconds, sizeof(bits));
+    int exponent = (int)((bits >> 52) & 0x7ff) - 1023 - TTR_MIN_EXPONENT;
+    if (seconds <= 0.0 || exponent < 0) return 0;
+    int bucket = exponent * TTR_SUB_BUCKETS + (int)((bits >> 48) & (TTR_SUB_BUCKETS - 1));
+    return bucket < TTR_BUCKETS ? bucket : TTR_BUCKETS - 1;
+}
+
+static double ttr_bucket_upper(int bucket) {
+    // Exponent and top mantissa bits of the bucket's upper edge; a full
+    // mantissa carries into the exponent, which is exactly the next power
+    unsigned long long bits = ((unsigned long long)(bucket / TTR_SUB_BUCKETS + TTR_MIN_EXPONENT + 1023) << 52) +
+                              ((unsigned long long)(bucket % TTR_SUB_BUCKETS + 1) << 48);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+typedef struct {
+    double arrival;
+    double detected;
+    int kind;
+    int detected_once;
+} ChaosFault;
+
+typedef enum {
+    EVENT_ARRIVAL,
+    EVENT_DETECTED,                 // a detector pass notices the fault
+    EVENT_REPAIRED                  // a recovery attempt finishes
+} ChaosEventType;
+
+// Event queue and recovery backlog share one min-heap layout
+typedef struct {
+    double key;
+    int type;
+    ChaosFault *fault;
+} ChaosEntry;
+
+typedef struct {
+    Arena *arena;               // the run's arena; items grow inside it
+    ChaosEntry *items;
+    int count;
+    int capacity;
+} ChaosHeap;
+
+static int heap_push(ChaosHeap *heap, double key, int type, ChaosFault *fault) {
+    if (heap->count == heap->capacity) {
+        int capacity = heap->capacity > 0 ? heap->capacity * 2 : 256;
+        ChaosEntry *items = arena_grow(heap->arena, heap->items, sizeof(ChaosEntry) * (size_t)heap->capacity,
+                                       sizeof(ChaosEntry) * (size_t)capacity);
+        if (items == NULL) return 0;
+        heap->items = items;
+        heap->capacity = capacity;
+    }
+    int i = heap->count++;
+    while (i > 0 && heap->items[(i - 1) / 2].key > key) {
+        heap->items[i] = heap->items[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap->items[i].key = key;
+    heap->items[i].type = type;
+    heap->items[i].fault = fault;
+    return 1;
+}
+
+static ChaosEntry heap_pop(ChaosHeap *heap) {
+    ChaosEntry top = heap->items[0];
+    ChaosEntry last = heap->items[--heap->count];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= heap->count) break;
+        if (child + 1 < heap->count && heap->items[child + 1].key < heap->items[child].key) child++;
+        if (heap->items[child].key >= last.key) break;
+        heap->items[i] = heap->items[child];
+        i = child;
+    }
+    if (heap->count > 0) heap->items[i] = last;
+    return top;
+}
+
+typedef struct {
+    const ChaosConfig *config;
+    const ChaosPolicy *policy;
+    ChaosResult *result;
+    unsigned long long arrival_rng;     // fault stream: the same for every policy
+    unsigned long long rng;             // detection, repair and retry draws
+    ChaosHeap events;
+    ChaosHeap backlog;
+    ArenaPool pool;
+    double miss_log[CHAOS_KINDS];   // log(1 - detect probability)
+    double rate_cdf[CHAOS_KINDS];
+    double total_rate;              // faults per second outside bursts
+    int in_burst;
+    double burst_switch;
+    int busy;
+    int active;
+    double last_change;
+    double detect_sum;
+    long long detect_count;
+    double ttr_sum;
+    double kind_ttr_sum[CHAOS_KINDS];
+    long long kind_recovered[CHAOS_KINDS];
+    long long ttr_histogram[TTR_BUCKETS];
+    int failed;
+} ChaosRun;
+
+static double next_check(const ChaosRun *run, double t) {
+    double interval = run->policy->check_interval_s;
+    return ((double)(long long)(t / interval) + 1.0) * interval;
+}
+
+static double next_arrival(ChaosRun *run, double t) {
+    // Exponential gaps at the current rate; crossing a burst boundary
+    // restarts the draw at the new rate, which is exact by memorylessness
+    for (;;) {
+        double rate = run->total_rate * (run->in_burst ? run->config->burst_factor : 1.0);
+        double candidate = t + wg_exponential(&run->arrival_rng, 1.0 / rate);
+        if (candidate < run->burst_switch) return candidate;
+        t = run->burst_switch;
+        run->in_burst = !run->in_burst;
+        run->burst_switch = t + wg_exponential(&run->arrival_rng, run->in_burst ? run->config->burst_mean_s
+                                                                        : run->config->calm_mean_s);
+    }
+}
+
+static void account(ChaosRun *run, double now, int delta) {
+    // Downtime is any time with an active fault; overlap is two or more
+    double span = now - run->last_change;
+    if (run->active >= 1) run->result->downtime_s += span;
+    if (run->active >= 2) run->result->overlap_s += span;
+    run->last_change = now;
+    run->active += delta;
+    if (run->active > run->result->max_active) run->result->max_active = run->active;
+}
+
+static void push_event(ChaosRun *run, double time, int type, ChaosFault *fault) {
+    if (!heap_push(&run->events, time, type, fault)) run->failed = 1;
+}
+
+static void start_fault(ChaosRun *run, double now, ChaosFaultKind kind) {
+    ChaosFault *fault = arena_pool_alloc(&run->pool);
+    if (fault == NULL) {
+        run->failed = 1;
+        return;
+    }
+    fault->arrival = now;
+    fault->kind = kind;
+    fault->detected_once = 0;
+    run->result->faults++;
+    run->result->per_kind[kind]++;
+    if (run->active > 0) run->result->overlapping_arrivals++;
+    account(run, now, 1);
+
+    // Passes until one notices it: geometric in the detection probability
+    double checks = 0.0;
+    if (run->miss_log[kind] < 0.0) {
+        checks = (double)(long long)(log(wg_uniform(&run->rng)) / run->miss_log[kind]);
+    }
+    push_event(run, next_check(run, now) + checks * run->policy->check_interval_s, EVENT_DETECTED, fault);
+}
+
+static void start_repair(ChaosRun *run, double now, ChaosFault *fault) {
+    run->busy++;
+    push_event(run, now + wg_exponential(&run->rng, run->config->kinds[fault->kind].repair_mean_s),
+               EVENT_REPAIRED, fault);
+}
+
+static int worker_free(const ChaosRun *run) {
+    return run->policy->workers == 0 || run->busy < run->policy->workers;
+}
+
+static void handle_detected(ChaosRun *run, double now, ChaosFault *fault) {
+    if (!fault->detected_once) {
+        fault->detected_once = 1;
+        fault->detected = now;
+        run->detect_sum += now - fault->arrival;
+        run->detect_count++;
+    }
+    if (worker_free(run)) {
+        start_repair(run, now, fault);
+        return;
+    }
+    double key = now;
+    if (run->policy->by_severity) key += run->config->kinds[fault->kind].severity * 1e12;
+    if (!heap_push(&run->backlog, key, EVENT_DETECTED, fault)) run->failed = 1;
+}
+
+static void handle_repaired(ChaosRun *run, double now, ChaosFault *fault) {
+    run->busy--;
+    if (wg_uniform(&run->rng) > run->config->kinds[fault->kind].repair_success) {
+        // Still there on the next pass; it goes through the backlog again
+        run->result->retries++;
+        push_event(run, next_check(run, now), EVENT_DETECTED, fault);
+    } else {
+        double ttr = now - fault->arrival;
+        run->result->recovered++;
+        run->ttr_sum += ttr;
+        run->kind_ttr_sum[fault->kind] += ttr;
+        run->kind_recovered[fault->kind]++;
+        run->ttr_histogram[ttr_bucket(ttr)]++;
+        if (ttr > run->result->max_ttr_s) run->result->max_ttr_s = ttr;
+        account(run, now, -1);
+        arena_pool_free(&run->pool, fault);
+    }
+    if (run->backlog.count > 0 && worker_free(run)) {
+        ChaosEntry next = heap_pop(&run->backlog);
+        start_repair(run, now, next.fault);
+    }
+}
+
+int chaos_simulate(const ChaosConfig *config, const ChaosPolicy *policy, ChaosResult *result) {
+    memset(result, 0, sizeof(*result));
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    ChaosRun *run = arena_calloc(arena, 1, sizeof(ChaosRun));
+    if (run == NULL) return -1;
+    run->events.arena = arena;
+    run->backlog.arena = arena;
+    run->config = config;
+    run->policy = policy;
+    run->result = result;
+    run->arrival_rng = config->seed != 0 ? config->seed : 0x9e3779b97f4a7c15ULL;
+    run->rng = run->arrival_rng ^ 0xd1b54a32d192ed03ULL;
+    for (int k = 0; k < CHAOS_KINDS; k++) {
+        double miss = 1.0 - config->kinds[k].detect_probability;
+        run->miss_log[k] = miss > 0.0 ? log(miss) : 0.0;
+        run->total_rate += config->kinds[k].rate_per_hour * config->rate_scale / 3600.0;
+        run->rate_cdf[k] = run->total_rate;
+    }
+    double horizon = config->days * 86400.0;
+    if (run->total_rate <= 0.0 || horizon <= 0.0) {
+        arena_release(arena, mark);
+        return -1;
+    }
+    run->burst_switch = config->bursty ? wg_exponential(&run->arrival_rng, config->calm_mean_s) : NO_SWITCH;
+
+    arena_pool_init(&run->pool, arena, sizeof(ChaosFault));
+    double start = monotonic_seconds();
+
+    push_event(run, next_arrival(run, 0.0), EVENT_ARRIVAL, NULL);
+    while (run->events.count > 0 && run->events.items[0].key <= horizon && !run->failed) {
+        ChaosEntry event = heap_pop(&run->events);
+        double now = event.key;
+        result->events++;
+        if (event.type == EVENT_ARRIVAL) {
+            double pick = wg_uniform(&run->arrival_rng) * run->total_rate;
+            int kind = 0;
+            while (kind < CHAOS_KINDS - 1 && pick > run->rate_cdf[kind]) kind++;
+            start_fault(run, now, (ChaosFaultKind)kind);
+            if (wg_uniform(&run->arrival_rng) < config->compound_probability) {
+                result->compound++;
+                start_fault(run, now, partner_kind[kind]);
+            }
+            push_event(run, next_arrival(run, now), EVENT_ARRIVAL, NULL);
+        } else if (event.type == EVENT_DETECTED) {
+            handle_detected(run, now, event.fault);
+        } else {
+            handle_repaired(run, now, event.fault);
+        }
+    }
+    account(run, horizon, 0);
+    result->wall_seconds = monotonic_seconds() - start;
+
+    result->mttd_s = run->detect_count > 0 ? run->detect_sum / run->detect_count : 0.0;
+    result->mttr_s = result->recovered > 0 ? run->ttr_sum / result->recovered : 0.0;
+    for (int k = 0; k < CHAOS_KINDS; k++) {
+        result->mttr_per_kind[k] = run->kind_recovered[k] > 0 ? run->kind_ttr_sum[k] / run->kind_recovered[k] : 0.0;
+    }
+    long long target = result->recovered - result->recovered / 100, seen = 0;
+    for (int b = 0; b < TTR_BUCKETS && result->recovered > 0; b++) {
+        seen += run->ttr_histogram[b];
+        if (seen >= target) {
+            result->p99_ttr_s = ttr_bucket_upper(b);
+            if (result->p99_ttr_s > result->max_ttr_s) result->p99_ttr_s = result->max_ttr_s;
+            break;
+        }
+    }
+    result->availability = 1.0 - result->downtime_s / horizon;
+
+    int failed = run->failed;
+    arena_release(arena, mark);
+    return failed ? -1 : 0;
+}
+
+static void print_duration(double seconds) {
+    if (seconds < 120.0) printf(" %8.1f s", seconds);
+    else if (seconds < 7200.0) printf(" %8.1f m", seconds / 60.0);
+    else printf(" %8.1f h", seconds / 3600.0);
+}
+
+void chaos_print_result(const ChaosPolicy *policy, const ChaosResult *result) {
+    printf("%-12s %10lld", policy->name, result->faults);
+    print_duration(result->mttd_s);
+    print_duration(result->mttr_s);
+    print_duration(result->p99_ttr_s);
+    printf(" %9.4f%%", result->availability * 100.0);
+    print_duration(result->overlap_s);
+    printf(" %6d %8.2f M/s\n", result->max_active,
+           result->wall_seconds > 0.0 ? result->events / result->wall_seconds / 1e6 : 0.0);
+}
+
+static void print_header() {
+    printf("%-12s %10s %10s %10s %10s %10s %10s %6s %10s\n",
+           "Policy", "Faults", "MTTD", "MTTR", "p99 TTR", "Avail", "Overlap", "MaxAct", "Events");
+}
+
+int chaos_command(int argc, char *argv[]) {
+    ChaosConfig config;
+    chaos_default_config(&config);
+    const char *only = NULL;
+    int positional = 0, usage = 0;
+    for (int i = 0; i < argc && !usage; i++) {
+        if (strcmp(argv[i], "--compound") == 0 && i + 1 < argc) {
+            config.compound_probability = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "poisson") == 0 || strcmp(argv[i], "bursty") == 0) {
+            config.bursty = strcmp(argv[i], "bursty") == 0;
+        } else if (positional == 0 && argv[i][0] >= '0' && argv[i][0] <= '9') {
+            config.days = atof(argv[i]);
+            positional++;
+        } else if (positional == 1 && argv[i][0] >= '0' && argv[i][0] <= '9') {
+            config.rate_scale = atof(argv[i]);
+            positional++;
+        } else if (only == NULL && strcmp(argv[i], "all") != 0) {
+            only = argv[i];
+        } else if (strcmp(argv[i], "all") != 0) {
+            usage = 1;
+        }
+    }
+    int found = only == NULL;
+    for (int p = 0; p < POLICY_COUNT && !found; p++) found = strcmp(policies[p].name, only) == 0;
+    if (usage || !found || config.days <= 0.0 || config.rate_scale <= 0.0) {
+        printf("Usage: chaos [days] [rate scale] [poisson|bursty] [policy|all] [--compound P] [--seed N]\n");
+        printf("Policies:");
+        for (int p = 0; p < POLICY_COUNT; p++) printf(" %s", policies[p].name);
+        printf("\n");
+        return 1;
+    }
+
+    double per_hour = 0.0;
+    for (int k = 0; k < CHAOS_KINDS; k++) per_hour += config.kinds[k].rate_per_hour * config.rate_scale;
+    printf("=== CHAOS TIMELINE: %.0f days, %.1f faults/hour, %s arrivals, %.0f%% compound ===\n",
+           config.days, per_hour, config.bursty ? "bursty" : "Poisson", config.compound_probability * 100.0);
+    run_arena_reset();
+    print_header();
+    ChaosResult results[POLICY_COUNT];
+    int ran[POLICY_COUNT] = {0};
+    for (int p = 0; p < POLICY_COUNT; p++) {
+        if (only != NULL && strcmp(policies[p].name, only) != 0) continue;
+        if (chaos_simulate(&config, &policies[p], &results[p]) != 0) {
+            printf("%-12s not enough memory for the fault backlog\n", policies[p].name);
+            continue;
+        }
+        chaos_print_result(&policies[p], &results[p]);
+        ran[p] = 1;
+    }
+
+    printf("\nMTTR by fault kind:\n%-12s", "Policy");
+    for (int k = 0; k < CHAOS_KINDS; k++) printf(" %15s", kind_names[k]);
+    printf("\n");
+    for (int p = 0; p < POLICY_COUNT; p++) {
+        if (!ran[p]) continue;
+        printf("%-12s", policies[p].name);
+        for (int k = 0; k < CHAOS_KINDS; k++) {
+            printf("     ");
+            print_duration(results[p].mttr_per_kind[k]);
+        }
+        printf("\n");
+    }
+    printf("\n");
+    for (int p = 0; p < POLICY_COUNT; p++) {
+        if (!ran[p]) continue;
+        printf("%s: %lld faults (%lld compound), %lld overlapping arrivals, %lld failed recoveries retried, "
+               "%lld events in %.3f s\n",
+               policies[p].name, results[p].faults, results[p].compound, results[p].overlapping_arrivals,
+               results[p].retries, results[p].events, results[p].wall_seconds);
+    }
+    run_arena_print_stats("\nRun");
+    run_arena_reset();
+    return 0;
+}
@@ -0,0 +1,72 @@
+/*
+ * chaos.h - Header for the continuous fault-stream (chaos) simulation
+ */
+
+#ifndef CHAOS_H
+#define CHAOS_H
+
+typedef enum {
+    CHAOS_DEADLOCK,
+    CHAOS_CPU_OVERLOAD,
+    CHAOS_THRASHING,
+    CHAOS_IO_STORM,
+    CHAOS_PRIORITY_INVERSION,
+    CHAOS_KINDS
+} ChaosFaultKind;
+
+typedef struct {
+    double rate_per_hour;
+    double detect_probability;      // chance one detector pass notices an active fault
+    double repair_mean_s;           // mean recovery time once a worker takes it
+    double repair_success;          // chance a recovery attempt fixes it
+    int severity;                   // lower is handled first by severity-ordered policies
+} ChaosFaultModel;
+
+typedef struct {
+    ChaosFaultModel kinds[CHAOS_KINDS];
+    double days;
+    double rate_scale;              // multiplies every arrival rate
+    int bursty;                     // Markov-modulated arrivals instead of plain Poisson
+    double burst_factor;            // rate multiplier while a burst lasts
+    double burst_mean_s;
+    double calm_mean_s;
+    double compound_probability;    // a fault that drags a second kind in with it
+    unsigned long long seed;
+} ChaosConfig;
+
+typedef struct {
+    const char *name;
+    int workers;                    // concurrent recoveries, 0 = one per fault
+    double check_interval_s;        // detectors and recovery run on this period
+    int by_severity;                // queued faults by severity instead of detection order
+} ChaosPolicy;
+
+typedef struct {
+    long long faults;
+    long long compound;
+    long long events;
+    long long recovered;
+    long long retries;              // failed recovery attempts
+    double mttd_s;                  // arrival -> detection
+    double mttr_s;                  // arrival -> recovered
+    double p99_ttr_s;
+    double max_ttr_s;
+    double availability;            // share of time with no active fault
+    double downtime_s;
+    double overlap_s;               // time with two or more active faults
+    int max_active;
+    long long overlapping_arrivals; // faults arriving while another was active
+    long long per_kind[CHAOS_KINDS];
+    double mttr_per_kind[CHAOS_KINDS];
+    double wall_seconds;
+} ChaosResult;
+
+void chaos_default_config(ChaosConfig *config);
+const char *chaos_kind_name(ChaosFaultKind kind);
+int chaos_policy_count();
+const ChaosPolicy *chaos_policy(int index);
+int chaos_simulate(const ChaosConfig *config, const ChaosPolicy *policy, ChaosResult *result);
+void chaos_print_result(const ChaosPolicy *policy, const ChaosResult *result);
+int chaos_command(int argc, char *argv[]);
+
+#endif // CHAOS_H
@@ -0,0 +1,376 @@
+/*
+ * checkpoint.c - Binary checkpoint/restore of simulator state
+ *
+ * A checkpoint holds the process table, the resource allocation graph, the
+ * page frames, the detector configurations and the PRNG state as raw arrays
+ * behind a small section table, so restoring is one mmap and a memcpy per
+ * section. Unknown sections are skipped and sections whose element size
+ * differs from this build are rejected, which keeps older readers safe as
+ * the format grows.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include "checkpoint.h"
+#include "process_manager.h"
+#include "algorithms.h"
+#include "fault_injection.h"
+#include "thrashing_monitor.h"
+#include "cpu_monitor.h"
+#include "rng.h"
+#include "timing.h"
+
+#define CHECKPOINT_MAGIC "OSFSCKPT"
+#define CHECKPOINT_BYTE_ORDER 0x01020304u
+#define CHECKPOINT_MAX_SECTIONS 8     // written by this build
+#define CHECKPOINT_SECTION_LIMIT 64    // accepted from newer builds
+
+#define TAG_PROCESSES CHECKPOINT_TAG('P', 'R', 'O', 'C')
+#define TAG_RESOURCES CHECKPOINT_TAG('R', 'S', 'R', 'C')
+#define TAG_FRAMES CHECKPOINT_TAG('P', 'A', 'G', 'E')
+#define TAG_THRASHING CHECKPOINT_TAG('T', 'H', 'R', 'C')
+#define TAG_CPU CHECKPOINT_TAG('C', 'P', 'U', 'C')
+
+typedef struct {
+    CheckpointSection entry;
+    const void *data;
+} PendingSection;
+
+static size_t align16(size_t value) {
+    return (value + 15) & ~(size_t)15;
+}
+
+static void add_section(PendingSection *sections, int *count, unsigned int tag,
+                        const void *data, size_t element_size, int elements, unsigned int aux) {
+    PendingSection *section = &sections[(*count)++];
+    section->entry.tag = tag;
+    section->entry.element_size = (unsigned int)element_size;
+    section->entry.count = (unsigned int)elements;
+    section->entry.aux = aux;
+    section->entry.offset = 0;
+    section->data = data;
+}
+
+static const char *tag_name(unsigned int tag, char *out) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (char)((tag >> (8 * i)) & 0xff);
+    }
+    out[4] = '\0';
+    return out;
+}
+
+int checkpoint_save(const char *path) {
+    ResourceAllocation allocations[MAX_RESOURCE_ALLOCATIONS];
+    PageFrame frames[MAX_PAGE_FRAMES];
+    ThrashingConfig thrashing;
+    CpuOverloadConfig cpu;
+    int page_clock = 0;
+    int allocation_count = export_resource_allocations(allocations, MAX_RESOURCE_ALLOCATIONS);
+    int frame_total = export_page_frames(frames, MAX_PAGE_FRAMES, &page_clock);
+    thrashing_monitor_get_config(&thrashing);
+    cpu_monitor_get_config(&cpu);
+
+    PendingSection sections[CHECKPOINT_MAX_SECTIONS];
+    int section_count = 0;
+    add_section(sections, &section_count, TAG_PROCESSES, pcb_table, sizeof(PCB), process_count, 0);
+    add_section(sections, &section_count, TAG_RESOURCES, allocations, sizeof(ResourceAllocation), allocation_count, 0);
+    add_section(sections, &section_count, TAG_FRAMES, frames, sizeof(PageFrame), frame_total, (unsigned int)page_clock);
+    add_section(sections, &section_count, TAG_THRASHING, &thrashing, sizeof(thrashing), 1, 0);
+    add_section(sections, &section_count, TAG_CPU, &cpu, sizeof(cpu), 1, 0);
+
+    // Lay out the payloads, then build the whole file in one buffer
+    size_t size = align16(sizeof(CheckpointHeader) + sizeof(CheckpointSection) * section_count);
+    for (int i = 0; i < section_count; i++) {
+        sections[i].entry.offset = size;
+        size = align16(size + (size_t)sections[i].entry.element_size * sections[i].entry.count);
+    }
+    unsigned char *buffer = calloc(1, size);
+    if (buffer == NULL) {
+        printf("Error: Cannot allocate %zu bytes for the checkpoint.\n", size);
+        return 0;
+    }
+    CheckpointHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.byte_order = CHECKPOINT_BYTE_ORDER;
+    header.section_count = (unsigned int)section_count;
+    header.rng_state = rng_get_state();
+    header.created = (long long)time(NULL);
+    memcpy(buffer, &header, sizeof(header));
+    for (int i = 0; i < section_count; i++) {
+        CheckpointSection *entry = &sections[i].entry;
+        memcpy(buffer + sizeof(header) + sizeof(CheckpointSection) * i, entry, sizeof(*entry));
+        memcpy(buffer + entry->offset, sections[i].data, (size_t)entry->element_size * entry->count);
+    }
+
+    // Write beside the target and rename so a crash never leaves a torn file
+    char temp_path[1024];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+    FILE *file = fopen(temp_path, "wb");
+    int ok = file != NULL && fwrite(buffer, 1, size, file) == size;
+    if (file != NULL && fclose(file) != 0) ok = 0;
+    free(buffer);
+#ifdef _WIN32
+    if (ok) remove(path);
+#endif
+    if (!ok || rename(temp_path, path) != 0) {
+        printf("Error: Cannot write checkpoint %s.\n", path);
+        remove(temp_path);
+        return 0;
+    }
+    printf("Checkpoint saved to %s (%zu bytes, %d processes, %d allocations).\n",
+           path, size, process_count, allocation_count);
+    return 1;
+}
+
+// Validate the header and return the section table, or NULL
+static const CheckpointSection *checkpoint_sections(const unsigned char *data, size_t size,
+                                                    const CheckpointHeader **header) {
+    if (size < sizeof(CheckpointHeader)) {
+        printf("Error: Checkpoint is truncated.\n");
+        return NULL;
+    }
+    *header = (const CheckpointHeader *)data;
+    if (memcmp((*header)->magic, CHECKPOINT_MAGIC, sizeof((*header)->magic)) != 0) {
+        printf("Error: Not a simulator checkpoint.\n");
+        return NULL;
+    }
+    if ((*header)->byte_order != CHECKPOINT_BYTE_ORDER) {
+        printf("Error: Checkpoint was written on a machine with a different byte order.\n");
+        return NULL;
+    }
+    if ((*header)->version > CHECKPOINT_VERSION) {
+        printf("Error: Checkpoint version %u is newer than this build (%d).\n",
+               (*header)->version, CHECKPOINT_VERSION);
+        return NULL;
+    }
+    const CheckpointSection *sections = (const CheckpointSection *)(data + sizeof(CheckpointHeader));
+    if ((*header)->section_count > CHECKPOINT_SECTION_LIMIT ||
+        sizeof(CheckpointHeader) + sizeof(CheckpointSection) * (*header)->section_count > size) {
+        printf("Error: Checkpoint section table is corrupt.\n");
+        return NULL;
+    }
+    for (unsigned int i = 0; i < (*header)->section_count; i++) {
+        unsigned long long bytes = (unsigned long long)sections[i].element_size * sections[i].count;
+        if (sections[i].offset > size || bytes > size - sections[i].offset) {
+            printf("Error: Checkpoint section %u runs past the end of the file.\n", i);
+            return NULL;
+        }
+    }
+    return sections;
+}
+
+// Copy a section into a fixed array; returns the element count or -1 on mismatch.
+// Records from before a struct grew are copied as a prefix with the new fields zeroed.
+static int copy_section(const unsigned char *data, const CheckpointSection *section,
+                        void *out, size_t element_size, int capacity) {
+    char name[5];
+    if (section->element_size > element_size || section->element_size == 0) {
+        printf("Error: Checkpoint section %s has %u-byte records, expected %zu.\n",
+               tag_name(section->tag, name), section->element_size, element_size);
+        return -1;
+    }
+    int count = section->count < (unsigned int)capacity ? (int)section->count : capacity;
+    if (section->element_size == element_size) {
+        memcpy(out, data + section->offset, element_size * count);
+        return count;
+    }
+    memset(out, 0, element_size * count);
+    for (int i = 0; i < count; i++) {
+        memcpy((unsigned char *)out + element_size * i, data + section->offset + (size_t)section->element_size * i,
+               section->element_size);
+    }
+    return count;
+}
+
+static int apply_checkpoint(const unsigned char *data, size_t size) {
+    const CheckpointHeader *header;
+    const CheckpointSection *sections = checkpoint_sections(data, size, &header);
+    if (sections == NULL) {
+        return 0;
+    }
+
+    // Decode everything first so a bad section leaves the live state untouched
+    PCB processes[MAX_PROCESSES];
+    ResourceAllocation allocations[MAX_RESOURCE_ALLOCATIONS];
+    PageFrame frames[MAX_PAGE_FRAMES];
+    ThrashingConfig thrashing;
+    CpuOverloadConfig cpu;
+    int process_total = 0, allocation_count = 0, frame_total = -1, page_clock = 0;
+    int have_thrashing = 0, have_cpu = 0;
+    for (unsigned int i = 0; i < header->section_count; i++) {
+        const CheckpointSection *section = &sections[i];
+        int copied = 0;
+        switch (section->tag) {
+            case TAG_PROCESSES:
+                copied = process_total = copy_section(data, section, processes, sizeof(PCB), MAX_PROCESSES);
+                break;
+            case TAG_RESOURCES:
+                copied = allocation_count = copy_section(data, section, allocations,
+                                                         sizeof(ResourceAllocation), MAX_RESOURCE_ALLOCATIONS);
+                break;
+            case TAG_FRAMES:
+                copied = frame_total = copy_section(data, section, frames, sizeof(PageFrame), MAX_PAGE_FRAMES);
+                page_clock = (int)section->aux;
+                break;
+            case TAG_THRASHING:
+                copied = have_thrashing = copy_section(data, section, &thrashing, sizeof(thrashing), 1);
+                break;
+            case TAG_CPU:
+                copied = have_cpu = copy_section(data, section, &cpu, sizeof(cpu), 1);
+                break;
+            default:
+                break;  // written by a newer build; safe to ignore
+        }
+        if (copied < 0) {
+            return 0;
+        }
+    }
+
+    memcpy(pcb_table, processes, sizeof(PCB) * process_total);
+    process_count = process_total;
+    pcb_mark_all_changed();
+    import_resource_allocations(allocations, allocation_count);
+    if (frame_total >= 0) import_page_frames(frames, frame_total, page_clock);
+    if (have_thrashing > 0) thrashing_monitor_configure(&thrashing);
+    if (have_cpu > 0) cpu_monitor_configure(&cpu);
+    thrashing_monitor_reset();
+    cpu_monitor_reset();
+    rng_set_state(header->rng_state);
+    return 1;
+}
+
+// Map (or read) the file and hand it to fn; returns fn's result or 0 on I/O errors
+static int with_checkpoint_file(const char *path, int (*fn)(const unsigned char *, size_t)) {
+#ifdef _WIN32
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        printf("Error: Cannot open checkpoint %s.\n", path);
+        return 0;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char *data = size > 0 ? malloc((size_t)size) : NULL;
+    int ok = data != NULL && fread(data, 1, (size_t)size, file) == (size_t)size;
+    fclose(file);
+    int result = ok ? fn(data, (size_t)size) : 0;
+    if (!ok) printf("Error: Cannot read checkpoint %s.\n", path);
+    free(data);
+    return result;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        printf("Error: Cannot open checkpoint %s.\n", path);
+        return 0;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        printf("Error: Checkpoint %s is empty.\n", path);
+        close(fd);
+        return 0;
+    }
+    void *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        printf("Error: Cannot map checkpoint %s.\n", path);
+        return 0;
+    }
+    int result = fn((const unsigned char *)data, (size_t)info.st_size);
+    munmap(data, (size_t)info.st_size);
+    return result;
+#endif
+}
+
+int checkpoint_restore(const char *path) {
+    double start = monotonic_seconds();
+    if (!with_checkpoint_file(path, apply_checkpoint)) {
+        return 0;
+    }
+    printf("Restored %d processes from %s in %.3f ms.\n",
+           process_count, path, (monotonic_seconds() - start) * 1000.0);
+    return 1;
+}
+
+static int print_checkpoint(const unsigned char *data, size_t size) {
+    const CheckpointHeader *header;
+    const CheckpointSection *sections = checkpoint_sections(data, size, &header);
+    if (sections == NULL) {
+        return 0;
+    }
+    time_t created = (time_t)header->created;
+    char name[5];
+    printf("Checkpoint version %u, %zu bytes, created %s", header->version, size, ctime(&created));
+    printf("PRNG state: %016llx\n", header->rng_state);
+    printf("+------+--------+--------+------------+\n");
+    printf("| Tag  | Record |  Count |     Offset |\n");
+    printf("+------+--------+--------+------------+\n");
+    for (unsigned int i = 0; i < header->section_count; i++) {
+        printf("| %-4s | %6u | %6u | %10llu |\n", tag_name(sections[i].tag, name),
+               sections[i].element_size, sections[i].count, sections[i].offset);
+    }
+    printf("+------+--------+--------+------------+\n");
+    return 1;
+}
+
+int checkpoint_info(const char *path) {
+    return with_checkpoint_file(path, print_checkpoint);
+}
+
+// checkpoint save <file> [--seed N] [deadlock|cpu|thrashing ...] | checkpoint info <file>
+int checkpoint_command(int argc, char *argv[]) {
+    if (argc >= 2 && strcmp(argv[0], "info") == 0) {
+        return checkpoint_info(argv[1]) ? 0 : 1;
+    }
+    if (argc < 2 || strcmp(argv[0], "save") != 0) {
+        printf("Usage: checkpoint save <file> [--seed N] [deadlock|cpu|thrashing ...]\n");
+        printf("       checkpoint info <file>\n");
+        return 1;
+    }
+
+    // Parse everything first: the seed has to be in place before the table is built
+    int seeded = 0;
+    unsigned long long seed = 0;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+            seeded = 1;
+        } else if (strcmp(argv[i], "deadlock") != 0 && strcmp(argv[i], "cpu") != 0 &&
+                   strcmp(argv[i], "thrashing") != 0) {
+            printf("Unknown fault type: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (seeded) {
+        // Host processes differ from run to run, so a seeded table is synthetic
+        rng_seed(seed);
+        init_dummy_processes();
+    } else {
+        init_process_manager();
+    }
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--seed") == 0) {
+            i++;
+        } else if (strcmp(argv[i], "deadlock") == 0) {
+            inject_deadlock();
+        } else if (strcmp(argv[i], "cpu") == 0) {
+            inject_cpu_overload();
+        } else {
+            inject_thrashing();
+        }
+    }
+    return checkpoint_save(argv[1]) ? 0 : 1;
+}
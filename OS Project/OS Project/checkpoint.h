@@ -0,0 +1,36 @@
+/*
+ * checkpoint.h - Header for binary checkpoint/restore of simulator state
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#define CHECKPOINT_VERSION 1
+#define CHECKPOINT_TAG(a, b, c, d) \
+    ((unsigned int)(a) | ((unsigned int)(b) << 8) | ((unsigned int)(c) << 16) | ((unsigned int)(d) << 24))
+
+// File layout: header, section table, then 16-byte aligned section payloads
+typedef struct {
+    char magic[8];                  // "OSFSCKPT"
+    unsigned int version;
+    unsigned int byte_order;        // 0x01020304 in the writer's byte order
+    unsigned int section_count;
+    unsigned int reserved;
+    unsigned long long rng_state;
+    long long created;              // seconds since the epoch
+} CheckpointHeader;
+
+typedef struct {
+    unsigned int tag;               // CHECKPOINT_TAG four-character code
+    unsigned int element_size;      // sizeof one element when written
+    unsigned int count;
+    unsigned int aux;               // section-specific (page clock for frames)
+    unsigned long long offset;      // from the start of the file
+} CheckpointSection;
+
+int checkpoint_save(const char *path);
+int checkpoint_restore(const char *path);
+int checkpoint_info(const char *path);
+int checkpoint_command(int argc, char *argv[]);
+
+#endif // CHECKPOINT_H
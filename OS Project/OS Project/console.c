@@ -0,0 +1,495 @@
+/*
+ * console.c - Live, non-blocking console for the interactive simulator
+ *
+ * One poll() loop owns the terminal: raw keyboard input on stdin, the read
+ * end of a pipe that stdout/stderr are redirected into while the console is
+ * up, and a timeout that fires at the fixed redraw rate. Keys become engine
+ * commands (engine.c), which run on their own thread; whatever they print is
+ * collected here as a scrollable log. Every frame is composed in memory and
+ * written to the terminal in one write(), so the view never waits on input
+ * and the engine never waits on the screen.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#ifndef _WIN32
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+#endif
+#include "console.h"
+#include "engine.h"
+#include "process_manager.h"
+#include "ui.h"
+#include "timing.h"
+
+#define FRAME_BYTES (256 * 1024)
+
+void console_default_config(ConsoleConfig *config) {
+    config->redraw_hz = 10;
+    engine_default_config(&config->engine);
+}
+
+#ifdef _WIN32
+
+int console_available() {
+    return 0;
+}
+
+int console_run(const ConsoleConfig *config) {
+    (void)config;
+    return 1;
+}
+
+#else
+
+// ---- engine output log ----
+static char log_lines[CONSOLE_LOG_LINES][CONSOLE_LINE_MAX];
+static long long log_total;             // lines completed so far
+static char partial[CONSOLE_LINE_MAX];
+static int partial_length;
+static int escape_state;                // 0 = text, 1 = after ESC, 2 = inside CSI
+
+static void log_push_partial() {
+    memcpy(log_lines[log_total % CONSOLE_LOG_LINES], partial, partial_length);
+    log_lines[log_total % CONSOLE_LOG_LINES][partial_length] = '\0';
+    log_total++;
+    partial_length = 0;
+}
+
+// Split captured output into lines, dropping colour codes; \r restarts the line
+static void log_append(const char *data, int length) {
+    for (int i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)data[i];
+        if (escape_state == 1) {
+            escape_state = c == '[' ? 2 : 0;
+        } else if (escape_state == 2) {
+            if (c >= 0x40 && c <= 0x7e) escape_state = 0;
+        } else if (c == 0x1b) {
+            escape_state = 1;
+        } else if (c == '\n') {
+            log_push_partial();
+        } else if (c == '\r') {
+            partial_length = 0;
+        } else if (c == '\t') {
+            while (partial_length < CONSOLE_LINE_MAX - 1) {
+                partial[partial_length++] = ' ';
+                if (partial_length % 8 == 0) break;
+            }
+        } else if (c >= 0x20 && partial_length < CONSOLE_LINE_MAX - 1) {
+            partial[partial_length++] = (char)c;
+        }
+    }
+}
+
+// ---- terminal ----
+static int tty_fd = -1;                 // the real terminal while stdout is captured
+static int saved_stderr = -1;
+static int capture_fd = -1;
+static struct termios saved_termios;
+static int raw_mode = 0;
+static volatile sig_atomic_t stop_signal = 0;
+
+static void write_all(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written <= 0) return;
+        data += written;
+        length -= (size_t)written;
+    }
+}
+
+static void on_signal(int signo) {
+    (void)signo;
+    stop_signal = 1;
+}
+
+// Undo raw mode and the capture; safe to call more than once (also atexit)
+static void restore_terminal() {
+    if (capture_fd >= 0) {
+        fflush(stdout);
+        dup2(tty_fd, STDOUT_FILENO);
+        dup2(saved_stderr, STDERR_FILENO);
+        close(saved_stderr);
+        saved_stderr = -1;
+        close(capture_fd);
+        capture_fd = -1;
+    }
+    if (tty_fd >= 0) {
+        static const char leave[] = "\033[?25h\033[?1049l";
+        write_all(tty_fd, leave, sizeof(leave) - 1);
+    }
+    if (raw_mode) {
+        tcsetattr(STDIN_FILENO, TCSAFLUSH, &saved_termios);
+        raw_mode = 0;
+    }
+}
+
+static int enter_terminal() {
+    if (tcgetattr(STDIN_FILENO, &saved_termios) != 0) return 0;
+    struct termios raw = saved_termios;
+    raw.c_lflag &= ~(tcflag_t)(ICANON | ECHO | ISIG | IEXTEN);
+    raw.c_iflag &= ~(tcflag_t)(IXON | ICRNL);
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) != 0) return 0;
+    raw_mode = 1;
+
+    int capture[2];
+    fflush(stdout);
+    tty_fd = dup(STDOUT_FILENO);
+    saved_stderr = dup(STDERR_FILENO);
+    if (tty_fd < 0 || saved_stderr < 0 || pipe(capture) != 0) {
+        restore_terminal();
+        return 0;
+    }
+    dup2(capture[1], STDOUT_FILENO);
+    dup2(capture[1], STDERR_FILENO);
+    close(capture[1]);
+    capture_fd = capture[0];
+    fcntl(capture_fd, F_SETFL, fcntl(capture_fd, F_GETFL) | O_NONBLOCK);
+
+    static const char enter[] = "\033[?1049h\033[?25l\033[2J";
+    write_all(tty_fd, enter, sizeof(enter) - 1);
+    return 1;
+}
+
+static void drain_capture() {
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(capture_fd, buffer, sizeof(buffer))) > 0) {
+        log_append(buffer, (int)n);
+    }
+}
+
+// ---- frame composition ----
+static char frame[FRAME_BYTES];
+static size_t frame_length;
+static int frame_rows, frame_cols, frame_lines;
+
+// Append one screen line, clipped to the terminal width (escapes take no columns)
+static void frame_line(const char *format, ...) {
+    if (frame_lines >= frame_rows) return;
+    char text[1024];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+
+    int columns = 0, in_escape = 0;
+    for (const char *p = text; *p != '\0' && frame_length < FRAME_BYTES - 64; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c == 0x1b) in_escape = 1;
+        else if (in_escape) {
+            if (c >= 0x40 && c <= 0x7e && c != '[') in_escape = 0;
+        } else if ((c & 0xc0) != 0x80) {
+            if (columns == frame_cols) break;
+            columns++;
+        }
+        frame[frame_length++] = (char)c;
+    }
+    frame_length += (size_t)snprintf(frame + frame_length, FRAME_BYTES - frame_length, RESET "\033[K");
+    frame_lines++;
+    if (frame_lines < frame_rows) {
+        frame_length += (size_t)snprintf(frame + frame_length, FRAME_BYTES - frame_length, "\r\n");
+    }
+}
+
+static const char *state_name(int state) {
+    switch (state) {
+        case 0: return "READY";
+        case 1: return "RUNNING";
+        case 2: return "WAITING";
+        default: return "UNKNOWN";
+    }
+}
+
+typedef struct {
+    int scroll;                         // lines above the newest, 0 = follow
+    char notice[96];
+    double notice_until;
+    const ConsoleConfig *config;
+} ConsoleView;
+
+static void render(const ConsoleView *view, const char *banner) {
+    struct winsize size;
+    frame_rows = 24;
+    frame_cols = 80;
+    if (ioctl(tty_fd, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 && size.ws_col > 0) {
+        frame_rows = size.ws_row;
+        frame_cols = size.ws_col;
+    }
+    frame_length = 0;
+    frame_lines = 0;
+    frame_length += (size_t)snprintf(frame, FRAME_BYTES, "\033[H");
+
+    EngineStatus status;
+    engine_read_status(&status);
+    time_t now = time(NULL);
+    struct tm local;
+    localtime_r(&now, &local);
+
+    frame_line(BOLD CYAN " OS FAULT SIMULATOR - LIVE " RESET DIM " %02d:%02d:%02d  up %.0fs  %d Hz redraw" RESET,
+               local.tm_hour, local.tm_min, local.tm_sec, status.uptime_s, view->config->redraw_hz);
+    const char *state = !status.running ? RED "STOPPED" : status.paused ? YELLOW "PAUSED" : GREEN "RUNNING";
+    char auto_text[48];
+    if (status.auto_faults) {
+        snprintf(auto_text, sizeof(auto_text), GREEN "ON" RESET " (%.1f/min)", view->config->engine.auto_faults_per_min);
+    } else {
+        snprintf(auto_text, sizeof(auto_text), DIM "OFF" RESET);
+    }
+    frame_line(" Engine: %s" RESET "  %s%s" RESET "  | Auto faults: %s  | Queue: %d", state,
+               status.busy ? YELLOW : DIM, status.busy ? status.activity : "idle", auto_text, engine_queue_depth());
+    frame_line(" Commands: %lld  Injected: %lld (%lld background)  Recovered: %lld  Last recovery: %.1f ms",
+               status.commands, status.faults_injected, status.auto_injected, status.recoveries,
+               status.last_recovery_ms);
+    char pending_text[512];
+    int used = snprintf(pending_text, sizeof(pending_text), "%s", status.pending == 0 ? "none" : "");
+    for (int i = 0; i < status.pending && used < (int)sizeof(pending_text) - 32; i++) {
+        used += snprintf(pending_text + used, sizeof(pending_text) - used, "%s%s", i > 0 ? ", " : "",
+                         engine_fault_name(status.pending_kinds[i]));
+    }
+    if (status.pending > 0 && status.next_recovery_s >= 0) {
+        snprintf(pending_text + used, sizeof(pending_text) - used, "  (next recovery in %.1fs%s)",
+                 status.next_recovery_s, status.paused ? ", held" : "");
+    }
+    frame_line(" Active faults: %s%s", status.pending > 0 ? RED : DIM, pending_text);
+    frame_line("");
+
+    PcbReadGuard guard = pcb_read_begin();
+    const PCB *rows = guard.snapshot->rows;
+    int count = guard.snapshot->count;
+    float average_cpu = 0;
+    for (int i = 0; i < count; i++) {
+        average_cpu += rows[i].cpu_usage;
+    }
+    frame_line(BOLD " PID    Process Name       CPU%%   MEM%%  Prio  State    Cgroup" RESET
+               DIM "   snapshot v%llu, avg CPU %.1f%%" RESET,
+               guard.snapshot->version, count > 0 ? average_cpu / count : 0.0f);
+    for (int i = 0; i < count; i++) {
+        const char *colour = rows[i].cpu_usage >= 90.0f ? RED : rows[i].state == 2 ? YELLOW : "";
+        frame_line(" %s%-6d %-17.17s %6.1f %6.1f  %4d  %-7s  %s", colour, rows[i].pid, rows[i].name,
+                   rows[i].cpu_usage, rows[i].mem_usage, rows[i].priority, state_name(rows[i].state),
+                   rows[i].cgroup);
+    }
+    pcb_read_end(&guard);
+    frame_line("");
+
+    // Log pane fills what is left above the two footer lines
+    int log_rows = frame_rows - frame_lines - 3;
+    if (log_rows < 0) log_rows = 0;
+    long long available = log_total < CONSOLE_LOG_LINES ? log_total : CONSOLE_LOG_LINES;
+    long long scroll = view->scroll;
+    if (scroll > available - log_rows) scroll = available - log_rows;
+    if (scroll < 0) scroll = 0;
+    long long first = log_total - scroll - log_rows;
+    frame_line(BOLD " Engine output" RESET DIM " (%lld lines%s)" RESET, log_total,
+               scroll > 0 ? ", scrolled - g to follow" : "");
+    for (int r = 0; r < log_rows; r++) {
+        long long line = first + r;
+        if (line < 0 || line < log_total - available) frame_line("");
+        else frame_line(" %s", log_lines[line % CONSOLE_LOG_LINES]);
+    }
+
+    while (frame_lines < frame_rows - 2) {
+        frame_line("");
+    }
+    if (banner != NULL) {
+        frame_line(" " YELLOW "%s", banner);
+    } else if (view->notice[0] != '\0' && monotonic_seconds() < view->notice_until) {
+        frame_line(" " CYAN "%s", view->notice);
+    } else {
+        frame_line("");
+    }
+    frame_line(DIM " 1-6 inject fault  7 comparisons  8 analysis  9 dashboard  a auto  p pause  "
+               "Up/Dn/PgUp/PgDn scroll  g follow  c clear  q quit" RESET);
+    write_all(tty_fd, frame, frame_length);
+}
+
+static void notify(ConsoleView *view, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    vsnprintf(view->notice, sizeof(view->notice), format, args);
+    va_end(args);
+    view->notice_until = monotonic_seconds() + 3.0;
+}
+
+static void submit(ConsoleView *view, EngineCommand command, const char *what) {
+    if (engine_submit(command)) notify(view, "Queued: %s", what);
+    else notify(view, "Engine busy: command queue full, %s dropped", what);
+}
+
+// Returns 0 once the user asked to quit
+static int handle_keys(ConsoleView *view, const char *keys, int length) {
+    int page = frame_rows > 16 ? frame_rows - 16 : 1;
+    for (int i = 0; i < length; i++) {
+        char key = keys[i];
+        if (key == 0x1b && i + 2 < length && keys[i + 1] == '[') {
+            char code = keys[i + 2];
+            i += 2;
+            if (code == 'A') view->scroll++;
+            else if (code == 'B') view->scroll--;
+            else if ((code == '5' || code == '6') && i + 1 < length && keys[i + 1] == '~') {
+                view->scroll += code == '5' ? page : -page;
+                i++;
+            }
+            if (view->scroll < 0) view->scroll = 0;
+            continue;
+        }
+        if (key >= '1' && key <= '6') {
+            char what[64];
+            snprintf(what, sizeof(what), "inject %s", engine_fault_name(key - '0'));
+            submit(view, (EngineCommand)(key - '0'), what);
+        } else if (key == '7') {
+            submit(view, ENGINE_CMD_COMPARISONS, "algorithm comparisons");
+        } else if (key == '8') {
+            submit(view, ENGINE_CMD_ANALYSIS, "system analysis");
+        } else if (key == '9') {
+            submit(view, ENGINE_CMD_DASHBOARD, "performance dashboard");
+        } else if (key == 'a' || key == 'A') {
+            submit(view, ENGINE_CMD_TOGGLE_AUTO, "toggle background faults");
+        } else if (key == 'p' || key == 'P' || key == ' ') {
+            submit(view, ENGINE_CMD_TOGGLE_PAUSE, "pause/resume");
+        } else if (key == 'g' || key == 'G') {
+            view->scroll = 0;
+        } else if (key == 'c' || key == 'C') {
+            log_total = 0;
+            view->scroll = 0;
+        } else if (key == 'q' || key == 'Q' || key == 3 || key == 4) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Live console on a real terminal; pipes and scripts use the line menu instead
+int console_available() {
+    const char *term = getenv("TERM");
+    return isatty(STDIN_FILENO) && isatty(STDOUT_FILENO) && (term == NULL || strcmp(term, "dumb") != 0);
+}
+
+int console_run(const ConsoleConfig *config) {
+    static int restore_registered = 0;
+    if (!restore_registered) {
+        atexit(restore_terminal);
+        restore_registered = 1;
+    }
+    if (!enter_terminal()) {
+        printf("Could not switch the terminal to raw mode.\n");
+        return 1;
+    }
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = on_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    sigaction(SIGHUP, &action, NULL);
+    stop_signal = 0;
+
+    if (!engine_start(&config->engine)) {
+        restore_terminal();
+        printf("Could not start the simulation engine thread.\n");
+        return 1;
+    }
+
+    ConsoleView view;
+    memset(&view, 0, sizeof(view));
+    view.config = config;
+    int hz = config->redraw_hz > 0 ? config->redraw_hz : 10;
+    double interval = 1.0 / hz;
+    double next_frame = monotonic_seconds();
+    long long frames = 0;
+    int running = 1;
+    while (running && !stop_signal) {
+        double now = monotonic_seconds();
+        if (now >= next_frame) {
+            render(&view, NULL);
+            frames++;
+            next_frame += interval;
+            if (next_frame < now) next_frame = now + interval;    // fell behind: skip, don't burst
+        }
+        int timeout_ms = (int)((next_frame - monotonic_seconds()) * 1000.0 + 0.999);
+        struct pollfd fds[2] = {{STDIN_FILENO, POLLIN, 0}, {capture_fd, POLLIN, 0}};
+        if (poll(fds, 2, timeout_ms > 0 ? timeout_ms : 0) <= 0) continue;   // timeout or EINTR
+        if (fds[1].revents & POLLIN) {
+            drain_capture();
+        }
+        if (fds[0].revents & (POLLIN | POLLHUP)) {
+            char keys[64];
+            ssize_t n = read(STDIN_FILENO, keys, sizeof(keys));
+            if (n > 0) running = handle_keys(&view, keys, (int)n);
+            else if (n == 0) running = 0;
+        }
+    }
+
+    // The engine may be mid-recovery and still printing: keep draining its
+    // output (a full pipe would block it) until it has really stopped
+    engine_request_stop();
+    EngineStatus status;
+    engine_read_status(&status);
+    while (status.running) {
+        render(&view, "Stopping: waiting for the engine to finish its current action...");
+        struct pollfd fd = {capture_fd, POLLIN, 0};
+        poll(&fd, 1, (int)(interval * 1000.0));
+        drain_capture();
+        engine_read_status(&status);
+    }
+    engine_stop();
+    drain_capture();
+    restore_terminal();
+    close(tty_fd);
+    tty_fd = -1;
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    signal(SIGHUP, SIG_DFL);
+
+    printf("Live console: %.0fs, %lld frames, %lld commands, %lld faults injected (%lld background), %lld recovered\n",
+           status.uptime_s, frames, status.commands, status.faults_injected, status.auto_injected,
+           status.recoveries);
+    return 0;
+}
+
+#endif
+
+int console_command(int argc, char *argv[]) {
+    ConsoleConfig config;
+    console_default_config(&config);
+    int usage = 0, positional = 0;
+    for (int i = 0; i < argc && !usage; i++) {
+        if (strcmp(argv[i], "--auto") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "off") == 0) config.engine.auto_faults = 0;
+            else config.engine.auto_faults_per_min = atof(argv[i]);
+        } else if (strcmp(argv[i], "--delay") == 0 && i + 1 < argc) {
+            config.engine.detect_delay_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config.engine.seed = strtoull(argv[++i], NULL, 10);
+        } else if (positional == 0 && argv[i][0] >= '0' && argv[i][0] <= '9') {
+            config.redraw_hz = atoi(argv[i]);
+            positional++;
+        } else {
+            usage = 1;
+        }
+    }
+    if (usage || config.redraw_hz < 1 || config.redraw_hz > 120 || config.engine.auto_faults_per_min <= 0.0 ||
+        config.engine.detect_delay_ms < 0) {
+        printf("Usage: live [redraw hz] [--auto FAULTS_PER_MIN|off] [--delay MS] [--seed N]\n");
+        return 1;
+    }
+    if (!console_available()) {
+        printf("live needs an interactive terminal on stdin and stdout.\n");
+        return 1;
+    }
+    enable_console_colors();
+    init_process_manager();
+    return console_run(&config);
+}
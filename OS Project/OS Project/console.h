@@ -0,0 +1,23 @@
+/*
+ * console.h - Header for the live, non-blocking console
+ */
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include "engine.h"
+
+#define CONSOLE_LOG_LINES 1024          // engine output kept for scrolling
+#define CONSOLE_LINE_MAX 240
+
+typedef struct {
+    int redraw_hz;                      // fixed frame rate of the live view
+    EngineConfig engine;
+} ConsoleConfig;
+
+void console_default_config(ConsoleConfig *config);
+int console_available();
+int console_run(const ConsoleConfig *config);
+int console_command(int argc, char *argv[]);
+
+#endif // CONSOLE_H
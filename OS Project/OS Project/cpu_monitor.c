@@ -0,0 +1,360 @@
+/*
+ * cpu_monitor.c - EWMA-based CPU overload detector
+ *
+ * Per-CPU utilisation comes from /proc/stat jiffy deltas and per-process
+ * utilisation from utime+stime deltas in /proc/[pid]/stat. Every series is
+ * smoothed with an exponentially weighted moving average and compared against
+ * separate enter/exit thresholds so a value hovering around the limit does
+ * not flap. A pinned core on an otherwise idle host is reported as core
+ * saturation; a high average across all cores as host overload.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cpu_monitor.h"
+#include "procfs.h"
+#include "timing.h"
+
+#define MAX_HOST_PIDS 32768
+#define INITIAL_CAPACITY 256
+
+typedef struct {
+    float ewma;
+    int hot;
+    int seeded;
+} SmoothedSeries;
+
+typedef struct {
+    int pid;                        // 0 marks an empty slot
+    unsigned int generation;
+    unsigned long last_ticks;
+    double last_time;
+    SmoothedSeries series;
+} ProcessCpuEntry;
+
+static CpuOverloadConfig config = {0.3f, 90.0f, 75.0f, 90.0f, 70.0f, 100};
+static SmoothedSeries host_series;
+static SmoothedSeries core_series[CPU_MONITOR_MAX_CPUS];
+static int core_count = 0;
+
+static CpuTimes prev_host;
+static CpuTimes prev_cores[CPU_MONITOR_MAX_CPUS];
+static int have_prev_times = 0;
+
+static ProcessCpuEntry *table = NULL;
+static int capacity = 0;
+static int used = 0;
+static unsigned int generation = 1;
+static int passes = 0;
+static int live_sampling = 1;
+static int pid_buffer[MAX_HOST_PIDS];
+static void (*change_hook)(int pid) = NULL;
+
+// Called with a pid whose hot verdict changed, or 0 when all may have
+void cpu_monitor_set_change_hook(void (*hook)(int pid)) {
+    change_hook = hook;
+}
+
+static void notify_change(int pid) {
+    if (change_hook != NULL) change_hook(pid);
+}
+
+void cpu_monitor_default_config(CpuOverloadConfig *out) {
+    out->alpha = 0.3f;
+    out->enter_threshold = 90.0f;
+    out->exit_threshold = 75.0f;
+    out->process_enter = 90.0f;
+    out->process_exit = 70.0f;
+    out->interval_ms = 100;
+}
+
+void cpu_monitor_configure(const CpuOverloadConfig *new_config) {
+    config = *new_config;
+    if (config.alpha <= 0.0f || config.alpha > 1.0f) config.alpha = 0.3f;
+    if (config.exit_threshold > config.enter_threshold) config.exit_threshold = config.enter_threshold;
+    if (config.process_exit > config.process_enter) config.process_exit = config.process_enter;
+    if (config.interval_ms < 1) config.interval_ms = 1;
+}
+
+void cpu_monitor_get_config(CpuOverloadConfig *out) {
+    *out = config;
+}
+
+void cpu_monitor_reset() {
+    free(table);
+    table = NULL;
+    capacity = 0;
+    used = 0;
+    generation = 1;
+    passes = 0;
+    core_count = 0;
+    have_prev_times = 0;
+    memset(&host_series, 0, sizeof(host_series));
+    memset(core_series, 0, sizeof(core_series));
+    notify_change(0);
+}
+
+// Fold one sample into a series and apply enter/exit hysteresis
+static void update_series(SmoothedSeries *series, float value, float enter, float exit) {
+    if (!series->seeded) {
+        series->ewma = value;
+        series->seeded = 1;
+    } else {
+        series->ewma += config.alpha * (value - series->ewma);
+    }
+    if (series->hot) {
+        series->hot = series->ewma > exit;
+    } else {
+        series->hot = series->ewma >= enter;
+    }
+}
+
+// Record one utilisation sample (%) for a core, or for the whole host if cpu < 0
+void cpu_monitor_record_core(int cpu, float utilisation) {
+    if (cpu < 0) {
+        update_series(&host_series, utilisation, config.enter_threshold, config.exit_threshold);
+        return;
+    }
+    if (cpu >= CPU_MONITOR_MAX_CPUS) {
+        return;
+    }
+    update_series(&core_series[cpu], utilisation, config.enter_threshold, config.exit_threshold);
+    if (cpu + 1 > core_count) {
+        core_count = cpu + 1;
+    }
+}
+
+static unsigned int hash_pid(int pid) {
+    return (unsigned int)pid * 2654435761u;
+}
+
+static ProcessCpuEntry *find_slot(ProcessCpuEntry *slots, int slot_capacity, int pid) {
+    unsigned int mask = (unsigned int)slot_capacity - 1;
+    unsigned int i = hash_pid(pid) & mask;
+    while (slots[i].pid != 0 && slots[i].pid != pid) {
+        i = (i + 1) & mask;
+    }
+    return &slots[i];
+}
+
+static void rebuild_table(int new_capacity, int drop_stale) {
+    ProcessCpuEntry *slots = calloc(new_capacity, sizeof(ProcessCpuEntry));
+    if (slots == NULL) {
+        return;
+    }
+    int kept = 0;
+    for (int i = 0; i < capacity; i++) {
+        if (table[i].pid == 0) continue;
+        if (drop_stale && table[i].generation != generation) {
+            if (table[i].series.hot) notify_change(table[i].pid);
+            continue;
+        }
+        *find_slot(slots, new_capacity, table[i].pid) = table[i];
+        kept++;
+    }
+    free(table);
+    table = slots;
+    capacity = new_capacity;
+    used = kept;
+}
+
+static ProcessCpuEntry *find_or_insert(int pid) {
+    if (table == NULL) {
+        capacity = INITIAL_CAPACITY;
+        table = calloc(capacity, sizeof(ProcessCpuEntry));
+        if (table == NULL) {
+            capacity = 0;
+            return NULL;
+        }
+    } else if ((used + 1) * 2 > capacity) {
+        rebuild_table(capacity * 2, 0);
+    }
+    ProcessCpuEntry *entry = find_slot(table, capacity, pid);
+    if (entry->pid == 0) {
+        memset(entry, 0, sizeof(*entry));
+        entry->pid = pid;
+        used++;
+    }
+    entry->generation = generation;
+    return entry;
+}
+
+// Record one utilisation sample (% of one core) for a process
+void cpu_monitor_record_process(int pid, float utilisation) {
+    if (pid <= 0) {
+        return;
+    }
+    ProcessCpuEntry *entry = find_or_insert(pid);
+    if (entry != NULL) {
+        int was_hot = entry->series.hot;
+        update_series(&entry->series, utilisation, config.process_enter, config.process_exit);
+        if (entry->series.hot != was_hot) notify_change(pid);
+    }
+}
+
+void cpu_monitor_set_live_sampling(int enabled) {
+    live_sampling = enabled;
+}
+
+// Close a sampling pass: forget processes that were not seen in it
+void cpu_monitor_end_pass() {
+    int stale = 0;
+    for (int i = 0; i < capacity; i++) {
+        if (table[i].pid != 0 && table[i].generation != generation) {
+            stale = 1;
+            break;
+        }
+    }
+    if (stale) {
+        rebuild_table(capacity, 1);
+    }
+    generation++;
+    passes++;
+}
+
+static float busy_percent(const CpuTimes *now, const CpuTimes *before) {
+    unsigned long long total = now->total - before->total;
+    if (now->total <= before->total) {
+        return -1.0f;
+    }
+    return (float)(100.0 * (double)(now->busy - before->busy) / (double)total);
+}
+
+// Sample /proc once; returns processes sampled or 0 without /proc
+int cpu_monitor_sample() {
+    if (!procfs_available()) {
+        return 0;
+    }
+    CpuTimes host;
+    CpuTimes cores[CPU_MONITOR_MAX_CPUS];
+    int cpus = procfs_read_cpu_times(&host, cores, CPU_MONITOR_MAX_CPUS);
+    if (cpus <= 0) {
+        return 0;
+    }
+    if (have_prev_times) {
+        float value = busy_percent(&host, &prev_host);
+        if (value >= 0.0f) cpu_monitor_record_core(-1, value);
+        for (int i = 0; i < cpus; i++) {
+            value = busy_percent(&cores[i], &prev_cores[i]);
+            if (value >= 0.0f) cpu_monitor_record_core(i, value);
+        }
+    }
+    prev_host = host;
+    memcpy(prev_cores, cores, sizeof(CpuTimes) * cpus);
+    have_prev_times = 1;
+
+    int pid_total = procfs_list_pids(pid_buffer, MAX_HOST_PIDS);
+    double now = monotonic_seconds();
+    double ticks_per_second = (double)procfs_clock_ticks();
+    int sampled = 0;
+    for (int i = 0; i < pid_total; i++) {
+        ProcPidStat stat;
+        if (!procfs_read_pid_stat(pid_buffer[i], &stat)) {
+            continue;
+        }
+        ProcessCpuEntry *entry = find_or_insert(stat.pid);
+        if (entry == NULL) {
+            continue;
+        }
+        unsigned long ticks = stat.utime + stat.stime;
+        if (entry->last_time > 0.0 && ticks >= entry->last_ticks && now > entry->last_time) {
+            float value = (float)(100.0 * (ticks - entry->last_ticks) / ticks_per_second
+                                  / (now - entry->last_time));
+            int was_hot = entry->series.hot;
+            update_series(&entry->series, value, config.process_enter, config.process_exit);
+            if (entry->series.hot != was_hot) notify_change(stat.pid);
+        }
+        entry->last_ticks = ticks;
+        entry->last_time = now;
+        sampled++;
+    }
+    if (table != NULL) {
+        cpu_monitor_end_pass();
+    }
+    return sampled;
+}
+
+// Sample, making sure at least one delta has been folded into the averages; with
+// live sampling off (trace replay) the recorded samples are used as they are
+int cpu_monitor_refresh() {
+    if (!live_sampling) {
+        return used;
+    }
+    int sampled = cpu_monitor_sample();
+    if (sampled > 0 && passes < 2) {
+        sleep_ms(config.interval_ms);
+        sampled = cpu_monitor_sample();
+    }
+    return sampled;
+}
+
+void cpu_monitor_report(CpuOverloadReport *report) {
+    memset(report, 0, sizeof(*report));
+    report->cpu_count = core_count;
+    report->host_ewma = host_series.ewma;
+    for (int i = 0; i < core_count; i++) {
+        if (core_series[i].hot) report->saturated_cores++;
+    }
+    for (int i = 0; i < capacity; i++) {
+        if (table[i].pid != 0 && table[i].series.hot) report->hot_processes++;
+    }
+    if (host_series.hot) {
+        report->state = CPU_STATE_HOST_OVERLOADED;
+    } else if (report->saturated_cores > 0) {
+        report->state = CPU_STATE_CORE_SATURATED;
+    } else {
+        report->state = CPU_STATE_NORMAL;
+    }
+}
+
+int cpu_monitor_lookup(int pid, ProcessCpuStats *stats) {
+    if (table == NULL || pid <= 0) {
+        return 0;
+    }
+    ProcessCpuEntry *entry = find_slot(table, capacity, pid);
+    if (entry->pid == 0 || !entry->series.seeded) {
+        return 0;
+    }
+    stats->pid = entry->pid;
+    stats->ewma = entry->series.ewma;
+    stats->hot = entry->series.hot;
+    return 1;
+}
+
+static int compare_ewma_desc(const void *a, const void *b) {
+    float ea = ((const ProcessCpuStats *)a)->ewma;
+    float eb = ((const ProcessCpuStats *)b)->ewma;
+    return (ea < eb) - (ea > eb);
+}
+
+// Collect hot processes, busiest first; returns the count
+int cpu_monitor_collect(ProcessCpuStats *out, int max_entries) {
+    int found = 0;
+    int coolest = 0;
+    for (int i = 0; i < capacity; i++) {
+        if (table[i].pid == 0 || !table[i].series.hot) continue;
+        ProcessCpuStats stats = {table[i].pid, table[i].series.ewma, 1};
+        if (found < max_entries) {
+            out[found++] = stats;
+        } else if (stats.ewma > out[coolest].ewma) {
+            out[coolest] = stats;
+        } else {
+            continue;
+        }
+        coolest = 0;
+        for (int j = 1; j < found; j++) {
+            if (out[j].ewma < out[coolest].ewma) coolest = j;
+        }
+    }
+    qsort(out, found, sizeof(ProcessCpuStats), compare_ewma_desc);
+    return found;
+}
+
+const char *cpu_monitor_state_name(CpuOverloadState state) {
+    switch (state) {
+        case CPU_STATE_CORE_SATURATED: return "SINGLE-CORE SATURATION";
+        case CPU_STATE_HOST_OVERLOADED: return "HOST OVERLOAD";
+        default: return "NORMAL";
+    }
+}
@@ -0,0 +1,58 @@
+/*
+ * cpu_monitor.h - Header for the EWMA-based CPU overload detector
+ */
+
+#ifndef CPU_MONITOR_H
+#define CPU_MONITOR_H
+
+#define CPU_MONITOR_MAX_CPUS 256
+
+typedef enum {
+    CPU_STATE_NORMAL = 0,
+    CPU_STATE_CORE_SATURATED = 1,   // one or more cores pinned, host has headroom
+    CPU_STATE_HOST_OVERLOADED = 2   // average utilisation across all cores is high
+} CpuOverloadState;
+
+// Smoothing and hysteresis settings for the detector
+typedef struct {
+    float alpha;                // EWMA weight of the newest sample (0..1]
+    float enter_threshold;      // % utilisation that raises an overload
+    float exit_threshold;       // % utilisation that clears it again
+    float process_enter;        // % of one core at which a process counts as hot
+    float process_exit;         // % of one core at which a hot process cools down
+    int interval_ms;            // sampling interval used when warming up
+} CpuOverloadConfig;
+
+typedef struct {
+    int pid;
+    float ewma;                 // smoothed % of one core
+    int hot;
+} ProcessCpuStats;
+
+typedef struct {
+    CpuOverloadState state;
+    int cpu_count;
+    float host_ewma;            // smoothed average utilisation of all cores
+    int saturated_cores;
+    int hot_processes;
+} CpuOverloadReport;
+
+void cpu_monitor_default_config(CpuOverloadConfig *config);
+void cpu_monitor_configure(const CpuOverloadConfig *config);
+void cpu_monitor_get_config(CpuOverloadConfig *config);
+void cpu_monitor_reset();
+
+void cpu_monitor_record_core(int cpu, float utilisation);
+void cpu_monitor_record_process(int pid, float utilisation);
+void cpu_monitor_end_pass();
+void cpu_monitor_set_live_sampling(int enabled);
+void cpu_monitor_set_change_hook(void (*hook)(int pid));
+int cpu_monitor_sample();
+int cpu_monitor_refresh();
+
+void cpu_monitor_report(CpuOverloadReport *report);
+int cpu_monitor_lookup(int pid, ProcessCpuStats *stats);
+int cpu_monitor_collect(ProcessCpuStats *out, int max_entries);
+const char *cpu_monitor_state_name(CpuOverloadState state);
+
+#endif // CPU_MONITOR_H
@@ -0,0 +1,56 @@
+/*
+ * deadlock_report.c - Shared reporting path for detected deadlock cycles
+ *
+ * Used by the simulator's cycle detection and by the lockdep preload
+ * library, so simulated and real cycles are reported the same way. The line
+ * is formatted into a local buffer and written with a single call, which
+ * keeps it readable when several threads report at once.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "deadlock_report.h"
+
+static FILE *report_output = NULL;
+static atomic_int report_count;
+
+void deadlock_report_set_output(FILE *out) {
+    report_output = out;
+}
+
+// Report a cycle; actual = 1 for a circular wait, 0 for a potential (lock order) one
+void report_deadlock_cycle(const char *source, int actual,
+                           const DeadlockStep *steps, int count) {
+    char line[1024];
+    int len = snprintf(line, sizeof(line), "%s [%s]: ",
+                       actual ? "DEADLOCK DETECTED" : "POTENTIAL DEADLOCK", source);
+    if (count > DEADLOCK_MAX_STEPS) {
+        count = DEADLOCK_MAX_STEPS;
+    }
+    for (int i = 0; i < count && len < (int)sizeof(line); i++) {
+        const DeadlockStep *step = &steps[i];
+        if (step->owner >= 0) {
+            len += snprintf(line + len, sizeof(line) - len, "%sP%ld (holds R%ld, wants R%ld)",
+                            i ? " -> " : "", step->owner, step->held, step->wanted);
+        } else {
+            len += snprintf(line + len, sizeof(line) - len, "%sR%ld -> R%ld",
+                            i ? ", " : "", step->held, step->wanted);
+        }
+    }
+    if (len < (int)sizeof(line)) {
+        snprintf(line + len, sizeof(line) - len, "%s\n",
+                 actual ? "" : " (lock order inversion)");
+    } else {
+        line[sizeof(line) - 2] = '\n';
+    }
+
+    FILE *out = report_output ? report_output : stdout;
+    fputs(line, out);
+    fflush(out);
+    atomic_fetch_add_explicit(&report_count, 1, memory_order_relaxed);
+}
+
+int deadlock_report_count() {
+    return atomic_load_explicit(&report_count, memory_order_relaxed);
+}
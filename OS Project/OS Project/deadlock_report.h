@@ -0,0 +1,24 @@
+/*
+ * deadlock_report.h - Header for the shared deadlock reporting path
+ */
+
+#ifndef DEADLOCK_REPORT_H
+#define DEADLOCK_REPORT_H
+
+#include <stdio.h>
+
+// One hop of a cycle: owner holds 'held' while requesting 'wanted'
+typedef struct {
+    long owner;                 // process/thread id, or -1 for a pure lock-order edge
+    long held;
+    long wanted;
+} DeadlockStep;
+
+#define DEADLOCK_MAX_STEPS 32
+
+void deadlock_report_set_output(FILE *out);
+void report_deadlock_cycle(const char *source, int actual,
+                           const DeadlockStep *steps, int count);
+int deadlock_report_count();
+
+#endif // DEADLOCK_REPORT_H
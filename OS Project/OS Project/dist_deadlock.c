@@ -0,0 +1,764 @@
+/*
+ * dist_deadlock.c - Multi-node resource sharing with Chandy-Misra-Haas detection
+ *
+ * The menu's deadlock check looks at one pcb_table. Here N nodes each own a
+ * slice of the processes and resources. A process acquires a few resources
+ * one at a time, some of them on other nodes, and every request, grant,
+ * release and cancel travels as a message through the destination node's
+ * inbox after a fixed link latency (hand-offs inside a node are free). No
+ * node ever sees the global wait-for graph.
+ *
+ * A process blocked for longer than the probe delay starts an edge-chasing
+ * probe (Chandy-Misra-Haas, AND model), and again after twice as long each
+ * time the chain turns out not to close. The probe goes to the node owning
+ * the resource it waits for, then to the home node of the holder, and on
+ * along the holder's own wait. It is dropped where the chain ends, and it
+ * declares a deadlock if it returns to its initiator while that process is
+ * still blocked in the same request. The detecting process aborts itself.
+ * In priority mode a process forwards only probes started by a higher
+ * process id and answers a lower one with a probe of its own, so each cycle
+ * is found once, by its highest member, without waiting for its timer.
+ *
+ * The simulator also keeps the global graph, which the nodes never read, to
+ * time each cycle from formation to detection and to count phantom
+ * detections: cycles already broken, or being broken, by another abort.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dist_deadlock.h"
+#include "deadlock_report.h"
+#include "arena.h"
+#include "timing.h"
+#include "workload_gen.h"
+
+#define SEEN_CLEAR_AT (1 << 22)     // forwarded-probe marks kept before the table is wiped
+
+static const char *message_names[DIST_MSG_KINDS] = {
+    "request", "grant", "release", "cancel", "probe"
+};
+
+typedef enum {
+    EVENT_REQUEST,                  // messages, delivered at the receiving node
+    EVENT_GRANT,
+    EVENT_RELEASE,
+    EVENT_CANCEL,
+    EVENT_PROBE_RESOURCE,           // probe arriving at a resource's node
+    EVENT_PROBE_PROCESS,            // probe arriving at a holder's home node
+    EVENT_THINK_DONE,               // local timers
+    EVENT_HOLD_DONE,
+    EVENT_PROBE_TIMER
+} DistEventType;
+
+typedef enum {
+    PROC_THINKING,
+    PROC_WAITING,
+    PROC_HOLDING
+} DistProcessState;
+
+typedef struct {
+    double time;
+    unsigned long long seq;         // ties keep send order, so every link is FIFO
+    int type;
+    int process;                    // requester, or a probe's initiator
+    int target;                     // resource, or the process a probe visits
+    int sender;                     // process a probe was forwarded by
+    unsigned int episode;
+    unsigned long long probe;
+} DistEvent;
+
+typedef struct {
+    Arena *arena;               // the run's arena; items grow inside it
+    DistEvent *items;
+    int count;
+    int capacity;
+} DistHeap;
+
+typedef struct {
+    // Home node's view
+    int state;
+    int wants[DIST_MAX_WANTS];
+    int want_count;
+    int next_want;
+    int held[DIST_MAX_WANTS];
+    int held_count;
+    int waiting;                    // resource requested and not granted yet, -1
+    unsigned int episode;           // bumped by every request and abort
+    double probe_interval;          // doubles after every probe that finds nothing
+    double last_probe;
+    // Resource nodes' view
+    int queued_on;                  // resource whose wait queue holds it, -1
+    unsigned int queued_episode;
+    int next_waiter;
+    // Simulator only
+    unsigned int stamp;
+    double cycle_formed;            // when the cycle it sits on closed, < 0 if none
+} DistProcess;
+
+typedef struct {
+    int holder;                     // -1 = free
+    int head;                       // FIFO of waiting processes
+    int tail;
+} DistResource;
+
+typedef struct {
+    const DistConfig *config;
+    DistResult *result;
+    Arena *arena;
+    unsigned long long rng;
+    DistHeap events;
+    DistProcess *processes;
+    DistResource *resources;
+    int process_total;
+    int resource_total;
+    double now;
+    unsigned long long seq;
+    unsigned long long next_probe;
+    unsigned int walk;
+    unsigned long long *seen;       // (process, probe) pairs already forwarded
+    int seen_capacity;
+    int seen_count;
+    double *latencies;
+    long long latency_count;
+    long long latency_capacity;
+    int report_cycles;
+    int failed;
+} DistRun;
+
+void dist_default_config(DistConfig *config) {
+    memset(config, 0, sizeof(*config));
+    config->nodes = 8;
+    config->processes_per_node = 64;
+    config->resources_per_node = 288;
+    config->wants_per_job = 3;
+    config->remote_fraction = 0.5;
+    config->think_mean_ms = 20.0;
+    config->hold_mean_ms = 5.0;
+    config->link_latency_ms = 0.5;
+    config->probe_delay_ms = 20.0;
+    config->priority_probes = 1;
+    config->duration_s = 10.0;
+    config->seed = 42;
+}
+
+const char *dist_message_name(DistMessageKind kind) {
+    return kind >= 0 && kind < DIST_MSG_KINDS ? message_names[kind] : "unknown";
+}
+
+static int event_before(const DistEvent *a, const DistEvent *b) {
+    return a->time < b->time || (a->time == b->time && a->seq < b->seq);
+}
+
+static int heap_push(DistHeap *heap, const DistEvent *event) {
+    if (heap->count == heap->capacity) {
+        int capacity = heap->capacity > 0 ? heap->capacity * 2 : 1024;
+        DistEvent *items = arena_grow(heap->arena, heap->items, sizeof(DistEvent) * (size_t)heap->capacity,
+                                      sizeof(DistEvent) * (size_t)capacity);
+        if (items == NULL) return 0;
+        heap->items = items;
+        heap->capacity = capacity;
+    }
+    int i = heap->count++;
+    while (i > 0 && event_before(event, &heap->items[(i - 1) / 2])) {
+        heap->items[i] = heap->items[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap->items[i] = *event;
+    return 1;
+}
+
+static DistEvent heap_pop(DistHeap *heap) {
+    DistEvent top = heap->items[0];
+    DistEvent last = heap->items[--heap->count];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= heap->count) break;
+        if (child + 1 < heap->count && event_before(&heap->items[child + 1], &heap->items[child])) child++;
+        if (!event_before(&heap->items[child], &last)) break;
+        heap->items[i] = heap->items[child];
+        i = child;
+    }
+    if (heap->count > 0) heap->items[i] = last;
+    return top;
+}
+
+static int process_node(const DistRun *run, int process) {
+    return process / run->config->processes_per_node;
+}
+
+static int resource_node(const DistRun *run, int resource) {
+    return resource / run->config->resources_per_node;
+}
+
+static void schedule(DistRun *run, double time, int type, int process, int target, int sender,
+                     unsigned int episode, unsigned long long probe) {
+    DistEvent event = {time, run->seq++, type, process, target, sender, episode, probe};
+    if (!heap_push(&run->events, &event)) run->failed = 1;
+}
+
+// Message from one node's inbox to another's; only inter-node hops are counted
+static void send(DistRun *run, int from, int to, DistMessageKind kind, int type, int process, int target,
+                 int sender, unsigned int episode, unsigned long long probe) {
+    double delay = 0.0;
+    if (from != to) {
+        delay = run->config->link_latency_ms;
+        run->result->messages[kind]++;
+        run->result->total_messages++;
+    }
+    schedule(run, run->now + delay, type, process, target, sender, episode, probe);
+}
+
+// ---- global wait-for graph (simulator only) ----
+
+static int waits_for(const DistRun *run, int process) {
+    int resource = run->processes[process].queued_on;
+    return resource >= 0 ? run->resources[resource].holder : -1;
+}
+
+static int on_cycle(DistRun *run, int process) {
+    unsigned int walk = ++run->walk;
+    for (int p = waits_for(run, process); p >= 0; p = waits_for(run, p)) {
+        if (p == process) return 1;
+        if (run->processes[p].stamp == walk) return 0;
+        run->processes[p].stamp = walk;
+    }
+    return 0;
+}
+
+// A new wait edge can only close a cycle through the process that added it
+static void note_wait(DistRun *run, int process) {
+    if (!on_cycle(run, process)) {
+        return;
+    }
+    run->result->cycles++;
+    int p = process;
+    do {
+        run->processes[p].cycle_formed = run->now;
+        p = waits_for(run, p);
+    } while (p != process);
+}
+
+static void report_cycle(DistRun *run, int initiator) {
+    DeadlockStep steps[DEADLOCK_MAX_STEPS];
+    int length = 0, p = initiator;
+    do {
+        int previous_wait = length > 0 ? (int)steps[length - 1].wanted : -1;
+        steps[length].owner = p;
+        steps[length].held = previous_wait;
+        steps[length].wanted = run->processes[p].queued_on;
+        length++;
+        p = waits_for(run, p);
+    } while (p != initiator && length < DEADLOCK_MAX_STEPS);
+    if (p == initiator) {
+        // The initiator holds what the last member is waiting for
+        steps[0].held = steps[length - 1].wanted;
+    }
+    char source[32];
+    snprintf(source, sizeof(source), "cmh node %d", process_node(run, initiator));
+    report_deadlock_cycle(source, 1, steps, length);
+}
+
+// ---- resource nodes ----
+
+static void grant(DistRun *run, int resource, int process, unsigned int episode) {
+    run->resources[resource].holder = process;
+    send(run, resource_node(run, resource), process_node(run, process), DIST_MSG_GRANT, EVENT_GRANT,
+         process, resource, -1, episode, 0);
+}
+
+static void hand_off(DistRun *run, int resource) {
+    DistResource *slot = &run->resources[resource];
+    int next = slot->head;
+    if (next < 0) {
+        slot->holder = -1;
+        return;
+    }
+    DistProcess *waiter = &run->processes[next];
+    slot->head = waiter->next_waiter;
+    if (slot->head < 0) slot->tail = -1;
+    waiter->queued_on = -1;
+    waiter->next_waiter = -1;
+    waiter->cycle_formed = -1.0;
+    grant(run, resource, next, waiter->queued_episode);
+}
+
+static void handle_request(DistRun *run, int process, int resource, unsigned int episode) {
+    DistResource *slot = &run->resources[resource];
+    if (slot->holder < 0) {
+        grant(run, resource, process, episode);
+        return;
+    }
+    DistProcess *waiter = &run->processes[process];
+    waiter->queued_on = resource;
+    waiter->queued_episode = episode;
+    waiter->next_waiter = -1;
+    if (slot->tail >= 0) run->processes[slot->tail].next_waiter = process;
+    else slot->head = process;
+    slot->tail = process;
+    run->result->blocked++;
+    note_wait(run, process);
+}
+
+static void handle_cancel(DistRun *run, int process, int resource) {
+    DistResource *slot = &run->resources[resource];
+    if (slot->holder == process) {
+        hand_off(run, resource);        // the grant crossed the abort
+        return;
+    }
+    int previous = -1;
+    for (int p = slot->head; p >= 0; previous = p, p = run->processes[p].next_waiter) {
+        if (p != process) continue;
+        if (previous >= 0) run->processes[previous].next_waiter = run->processes[p].next_waiter;
+        else slot->head = run->processes[p].next_waiter;
+        if (slot->tail == p) slot->tail = previous;
+        run->processes[p].queued_on = -1;
+        run->processes[p].next_waiter = -1;
+        run->processes[p].cycle_formed = -1.0;
+        return;
+    }
+}
+
+// ---- home nodes ----
+
+static void request_next(DistRun *run, int process) {
+    DistProcess *proc = &run->processes[process];
+    int resource = proc->wants[proc->next_want];
+    proc->state = PROC_WAITING;
+    proc->waiting = resource;
+    proc->episode++;
+    proc->probe_interval = run->config->probe_delay_ms;
+    run->result->requests++;
+    send(run, process_node(run, process), resource_node(run, resource), DIST_MSG_REQUEST, EVENT_REQUEST,
+         process, resource, -1, proc->episode, 0);
+    schedule(run, run->now + run->config->probe_delay_ms, EVENT_PROBE_TIMER, process, -1, -1, proc->episode, 0);
+}
+
+static int pick_resource(DistRun *run, int home) {
+    const DistConfig *config = run->config;
+    int node = home;
+    if (config->nodes > 1 && wg_uniform(&run->rng) <= config->remote_fraction) {
+        node = (home + 1 + (int)(wg_next(&run->rng) % (unsigned long long)(config->nodes - 1))) % config->nodes;
+    }
+    return node * config->resources_per_node + (int)(wg_next(&run->rng) % (unsigned long long)config->resources_per_node);
+}
+
+static void start_job(DistRun *run, int process) {
+    DistProcess *proc = &run->processes[process];
+    int home = process_node(run, process);
+    proc->want_count = 0;
+    while (proc->want_count < run->config->wants_per_job) {
+        int resource = pick_resource(run, home), duplicate = 0;
+        for (int w = 0; w < proc->want_count; w++) duplicate |= proc->wants[w] == resource;
+        if (!duplicate) proc->wants[proc->want_count++] = resource;
+    }
+    proc->next_want = 0;
+    proc->held_count = 0;
+    request_next(run, process);
+}
+
+static void release_all(DistRun *run, int process) {
+    DistProcess *proc = &run->processes[process];
+    int home = process_node(run, process);
+    for (int h = 0; h < proc->held_count; h++) {
+        send(run, home, resource_node(run, proc->held[h]), DIST_MSG_RELEASE, EVENT_RELEASE, process,
+             proc->held[h], -1, 0, 0);
+    }
+    proc->held_count = 0;
+}
+
+static void think(DistRun *run, int process) {
+    run->processes[process].state = PROC_THINKING;
+    schedule(run, run->now + wg_exponential(&run->rng, run->config->think_mean_ms), EVENT_THINK_DONE,
+             process, -1, -1, 0, 0);
+}
+
+static void handle_grant(DistRun *run, int process, int resource, unsigned int episode) {
+    DistProcess *proc = &run->processes[process];
+    if (proc->state != PROC_WAITING || proc->waiting != resource || proc->episode != episode) {
+        return;                         // aborted meanwhile; the cancel gave it back
+    }
+    proc->held[proc->held_count++] = resource;
+    proc->waiting = -1;
+    if (++proc->next_want < proc->want_count) {
+        request_next(run, process);
+        return;
+    }
+    proc->state = PROC_HOLDING;
+    schedule(run, run->now + wg_exponential(&run->rng, run->config->hold_mean_ms), EVENT_HOLD_DONE,
+             process, -1, -1, 0, 0);
+}
+
+static int mark_forwarded(DistRun *run, int process, unsigned long long probe) {
+    if (run->seen_count * 2 >= run->seen_capacity) {
+        int capacity = run->seen_capacity > 0 ? run->seen_capacity * 2 : 4096;
+        if (run->seen_count >= SEEN_CLEAR_AT) {
+            // Stale probes are long dead; at worst a circling one laps once more
+            capacity = run->seen_capacity;
+            memset(run->seen, 0, sizeof(unsigned long long) * (size_t)capacity);
+            run->seen_count = 0;
+        } else {
+            unsigned long long *grown = arena_calloc(run->arena, (size_t)capacity, sizeof(unsigned long long));
+            if (grown == NULL) {
+                run->failed = 1;
+                return 0;
+            }
+            for (int i = 0; i < run->seen_capacity; i++) {
+                unsigned long long key = run->seen[i];
+                if (key == 0) continue;
+                unsigned int slot = (unsigned int)(key * 0x9e3779b97f4a7c15ULL >> 32) & (unsigned int)(capacity - 1);
+                while (grown[slot] != 0) slot = (slot + 1) & (unsigned int)(capacity - 1);
+                grown[slot] = key;
+            }
+            run->seen = grown;
+            run->seen_capacity = capacity;
+        }
+    }
+    unsigned long long key = probe * (unsigned long long)run->process_total + (unsigned long long)process + 1;
+    unsigned int mask = (unsigned int)(run->seen_capacity - 1);
+    unsigned int slot = (unsigned int)(key * 0x9e3779b97f4a7c15ULL >> 32) & mask;
+    while (run->seen[slot] != 0) {
+        if (run->seen[slot] == key) return 0;
+        slot = (slot + 1) & mask;
+    }
+    run->seen[slot] = key;
+    run->seen_count++;
+    return 1;
+}
+
+static void record_latency(DistRun *run, double latency) {
+    if (run->latency_count == run->latency_capacity) {
+        long long capacity = run->latency_capacity > 0 ? run->latency_capacity * 2 : 1024;
+        double *grown = arena_grow(run->arena, run->latencies, sizeof(double) * (size_t)run->latency_capacity,
+                                   sizeof(double) * (size_t)capacity);
+        if (grown == NULL) {
+            run->failed = 1;
+            return;
+        }
+        run->latencies = grown;
+        run->latency_capacity = capacity;
+    }
+    run->latencies[run->latency_count++] = latency;
+}
+
+// Still deadlocked: on a cycle none of whose members has aborted yet
+static int cycle_intact(DistRun *run, int initiator) {
+    if (!on_cycle(run, initiator)) {
+        return 0;
+    }
+    int p = initiator;
+    do {
+        if (run->processes[p].state != PROC_WAITING) return 0;
+        p = waits_for(run, p);
+    } while (p != initiator);
+    return 1;
+}
+
+static void detect(DistRun *run, int initiator) {
+    DistResult *result = run->result;
+    DistProcess *proc = &run->processes[initiator];
+    result->detected++;
+    if (!cycle_intact(run, initiator)) {
+        result->phantoms++;
+    } else {
+        if (proc->cycle_formed >= 0.0) record_latency(run, run->now - proc->cycle_formed);
+        if (run->report_cycles > 0) {
+            run->report_cycles--;
+            report_cycle(run, initiator);
+        }
+    }
+    // Abort the initiator: give back what it holds and withdraw its request
+    int home = process_node(run, initiator);
+    release_all(run, initiator);
+    send(run, home, resource_node(run, proc->waiting), DIST_MSG_CANCEL, EVENT_CANCEL, initiator,
+         proc->waiting, -1, 0, 0);
+    proc->waiting = -1;
+    proc->episode++;
+    think(run, initiator);
+}
+
+static void start_probe(DistRun *run, int process) {
+    DistProcess *proc = &run->processes[process];
+    run->result->probes_started++;
+    proc->last_probe = run->now;
+    send(run, process_node(run, process), resource_node(run, proc->waiting), DIST_MSG_PROBE,
+         EVENT_PROBE_RESOURCE, process, proc->waiting, process, proc->episode, ++run->next_probe);
+}
+
+static void handle_probe_process(DistRun *run, const DistEvent *event) {
+    int process = event->target;
+    DistProcess *proc = &run->processes[process];
+    if (proc->state != PROC_WAITING) {
+        return;                         // the chain ends at a running process
+    }
+    if (process == event->process) {
+        if (proc->episode == event->episode) detect(run, process);
+        return;
+    }
+    if (run->config->priority_probes && event->process < process) {
+        // A lower process waits on this one: chase the chain with our own id instead
+        run->result->probes_suppressed++;
+        if (run->now - proc->last_probe >= run->config->probe_delay_ms) start_probe(run, process);
+        return;
+    }
+    if (!mark_forwarded(run, process, event->probe)) {
+        return;
+    }
+    send(run, process_node(run, process), resource_node(run, proc->waiting), DIST_MSG_PROBE,
+         EVENT_PROBE_RESOURCE, event->process, proc->waiting, process, event->episode, event->probe);
+}
+
+static void handle_probe_resource(DistRun *run, const DistEvent *event) {
+    // Forward only along a real edge: the sender must still be queued here
+    int resource = event->target;
+    int holder = run->resources[resource].holder;
+    if (holder < 0 || run->processes[event->sender].queued_on != resource) {
+        return;
+    }
+    send(run, resource_node(run, resource), process_node(run, holder), DIST_MSG_PROBE, EVENT_PROBE_PROCESS,
+         event->process, holder, resource, event->episode, event->probe);
+}
+
+static void handle_probe_timer(DistRun *run, int process, unsigned int episode) {
+    DistProcess *proc = &run->processes[process];
+    if (proc->state != PROC_WAITING || proc->episode != episode) {
+        return;
+    }
+    start_probe(run, process);
+    proc->probe_interval *= 2.0;
+    schedule(run, run->now + proc->probe_interval, EVENT_PROBE_TIMER, process, -1, -1, episode, 0);
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static long long count_open_cycles(DistRun *run) {
+    // Functional graph: each path either ends or runs into a cycle once
+    long long cycles = 0;
+    unsigned int base = run->walk + 1;
+    for (int start = 0; start < run->process_total; start++) {
+        if (run->processes[start].stamp >= base) continue;
+        unsigned int walk = ++run->walk;
+        int p = start;
+        while (p >= 0 && run->processes[p].stamp < base) {
+            run->processes[p].stamp = walk;
+            p = waits_for(run, p);
+        }
+        if (p >= 0 && run->processes[p].stamp == walk) cycles++;
+    }
+    return cycles;
+}
+
+int dist_simulate(const DistConfig *config, DistResult *result, int report_cycles) {
+    memset(result, 0, sizeof(*result));
+    if (config->nodes < 1 || config->nodes > DIST_MAX_NODES || config->processes_per_node < 1 ||
+        config->resources_per_node < 1 || config->wants_per_job < 1 || config->wants_per_job > DIST_MAX_WANTS ||
+        config->wants_per_job > config->nodes * config->resources_per_node || config->duration_s <= 0.0) {
+        return -1;
+    }
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    DistRun *run = arena_calloc(arena, 1, sizeof(DistRun));
+    if (run == NULL) return -1;
+    run->arena = run->events.arena = arena;
+    run->config = config;
+    run->result = result;
+    run->rng = config->seed != 0 ? config->seed : 0x9e3779b97f4a7c15ULL;
+    run->process_total = config->nodes * config->processes_per_node;
+    run->resource_total = config->nodes * config->resources_per_node;
+    run->report_cycles = report_cycles;
+
+    run->processes = arena_calloc(arena, (size_t)run->process_total, sizeof(DistProcess));
+    run->resources = arena_alloc(arena, sizeof(DistResource) * (size_t)run->resource_total);
+    if (run->processes == NULL || run->resources == NULL) {
+        arena_release(arena, mark);
+        return -1;
+    }
+    for (int r = 0; r < run->resource_total; r++) {
+        run->resources[r].holder = run->resources[r].head = run->resources[r].tail = -1;
+    }
+    for (int p = 0; p < run->process_total; p++) {
+        run->processes[p].waiting = run->processes[p].queued_on = run->processes[p].next_waiter = -1;
+        run->processes[p].cycle_formed = -1.0;
+        run->processes[p].last_probe = -config->probe_delay_ms;
+        think(run, p);
+    }
+
+    double start = monotonic_seconds();
+    double horizon = config->duration_s * 1000.0;
+    while (run->events.count > 0 && run->events.items[0].time <= horizon && !run->failed) {
+        DistEvent event = heap_pop(&run->events);
+        run->now = event.time;
+        result->events++;
+        switch (event.type) {
+        case EVENT_REQUEST: handle_request(run, event.process, event.target, event.episode); break;
+        case EVENT_GRANT: handle_grant(run, event.process, event.target, event.episode); break;
+        case EVENT_RELEASE:
+            if (run->resources[event.target].holder == event.process) hand_off(run, event.target);
+            break;
+        case EVENT_CANCEL: handle_cancel(run, event.process, event.target); break;
+        case EVENT_PROBE_RESOURCE: handle_probe_resource(run, &event); break;
+        case EVENT_PROBE_PROCESS: handle_probe_process(run, &event); break;
+        case EVENT_THINK_DONE: start_job(run, event.process); break;
+        case EVENT_HOLD_DONE:
+            release_all(run, event.process);
+            result->jobs++;
+            think(run, event.process);
+            break;
+        case EVENT_PROBE_TIMER: handle_probe_timer(run, event.process, event.episode); break;
+        }
+    }
+    result->wall_seconds = monotonic_seconds() - start;
+    result->open_cycles = count_open_cycles(run);
+
+    if (run->latency_count > 0) {
+        qsort(run->latencies, (size_t)run->latency_count, sizeof(double), compare_double);
+        double sum = 0.0;
+        for (long long i = 0; i < run->latency_count; i++) sum += run->latencies[i];
+        result->latency_mean_ms = sum / run->latency_count;
+        result->latency_p99_ms = run->latencies[(run->latency_count * 99) / 100];
+        result->latency_max_ms = run->latencies[run->latency_count - 1];
+    }
+    int failed = run->failed;
+    arena_release(arena, mark);
+    return failed ? -1 : 0;
+}
+
+static void print_header() {
+    printf("%-9s %6s %7s %8s %7s %8s %6s %5s %10s %9s %8s %8s %8s %8s %9s\n", "Mode", "Nodes", "Procs",
+           "Jobs", "Cycles", "Detected", "Phant", "Open", "Messages", "Probes", "Pr/cyc", "Lat ms", "p99 ms",
+           "Max ms", "Events");
+}
+
+void dist_print_result(const char *label, const DistConfig *config, const DistResult *result) {
+    long long found = result->detected - result->phantoms;
+    printf("%-9s %6d %7d %8lld %7lld %8lld %6lld %5lld %10lld %9lld %8.1f %8.2f %8.2f %8.2f %5.2f M/s\n", label,
+           config->nodes, config->nodes * config->processes_per_node, result->jobs, result->cycles,
+           result->detected, result->phantoms, result->open_cycles, result->total_messages,
+           result->messages[DIST_MSG_PROBE], found > 0 ? (double)result->messages[DIST_MSG_PROBE] / found : 0.0,
+           result->latency_mean_ms, result->latency_p99_ms, result->latency_max_ms,
+           result->wall_seconds > 0.0 ? result->events / result->wall_seconds / 1e6 : 0.0);
+}
+
+static int run_scale(DistConfig base, int priority_only) {
+    printf("=== DISTRIBUTED DEADLOCK SCALING: %.0f s per run, %.0f%% remote, %.1f ms links, %.0f ms probe delay ===\n",
+           base.duration_s, base.remote_fraction * 100.0, base.link_latency_ms, base.probe_delay_ms);
+    static const int node_counts[] = {2, 4, 8, 16, 32, 64, 128};
+    static const int sizes[] = {16, 64, 256, 1024};
+    int modes = priority_only ? 1 : 2;
+    for (int table = 0; table < 2; table++) {
+        printf(table == 0 ? "\nNode count (%d processes per node):\n" : "\nGraph size (%d nodes):\n",
+               table == 0 ? base.processes_per_node : 16);
+        print_header();
+        int rows = table == 0 ? (int)(sizeof(node_counts) / sizeof(node_counts[0])) : (int)(sizeof(sizes) / sizeof(sizes[0]));
+        for (int row = 0; row < rows; row++) {
+            for (int mode = 0; mode < modes; mode++) {
+                DistConfig config = base;
+                if (table == 0) {
+                    config.nodes = node_counts[row];
+                } else {
+                    config.nodes = 16;
+                    config.processes_per_node = sizes[row];
+                    config.resources_per_node = sizes[row] * base.resources_per_node / base.processes_per_node;
+                    if (config.resources_per_node < 1) config.resources_per_node = 1;
+                }
+                config.priority_probes = priority_only || mode == 1;
+                DistResult result;
+                if (dist_simulate(&config, &result, 0) != 0) {
+                    printf("%-9s not enough memory\n", config.priority_probes ? "priority" : "basic");
+                    continue;
+                }
+                dist_print_result(config.priority_probes ? "priority" : "basic", &config, &result);
+            }
+        }
+    }
+    return 0;
+}
+
+int dist_command(int argc, char *argv[]) {
+    DistConfig config;
+    dist_default_config(&config);
+    int positional = 0, usage = 0, scale = 0, modes = 3;    // bit 0 = basic, bit 1 = priority
+    for (int i = 0; i < argc && !usage; i++) {
+        if (strcmp(argv[i], "--remote") == 0 && i + 1 < argc) {
+            config.remote_fraction = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--latency") == 0 && i + 1 < argc) {
+            config.link_latency_ms = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--probe-delay") == 0 && i + 1 < argc) {
+            config.probe_delay_ms = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "scale") == 0 && i == 0) {
+            scale = 1;
+            config.duration_s = 2.0;
+        } else if (strcmp(argv[i], "basic") == 0 || strcmp(argv[i], "priority") == 0) {
+            modes = strcmp(argv[i], "basic") == 0 ? 1 : 2;
+        } else if (strcmp(argv[i], "both") == 0) {
+            modes = 3;
+        } else if (positional < 3 && argv[i][0] >= '0' && argv[i][0] <= '9') {
+            if (positional == 0) config.nodes = atoi(argv[i]);
+            else if (positional == 1) {
+                config.resources_per_node = atoi(argv[i]) * config.resources_per_node / config.processes_per_node;
+                config.processes_per_node = atoi(argv[i]);
+                if (config.resources_per_node < 1) config.resources_per_node = 1;
+            } else config.duration_s = atof(argv[i]);
+            positional++;
+        } else {
+            usage = 1;
+        }
+    }
+    if (usage || config.nodes < 1 || config.nodes > DIST_MAX_NODES || config.processes_per_node < 1 ||
+        config.duration_s <= 0.0 || config.remote_fraction < 0.0 || config.remote_fraction > 1.0 ||
+        config.link_latency_ms < 0.0 || config.probe_delay_ms <= 0.0 || (scale && positional > 0)) {
+        printf("Usage: distributed [nodes] [processes per node] [seconds] [basic|priority|both]\n"
+               "                   [--remote F] [--latency MS] [--probe-delay MS] [--seed N]\n"
+               "       distributed scale [basic|priority] [--remote F] [--latency MS] [--probe-delay MS]\n");
+        return 1;
+    }
+    run_arena_reset();
+    if (scale) {
+        int status = run_scale(config, modes == 2);
+        run_arena_reset();
+        return status;
+    }
+
+    printf("=== DISTRIBUTED DEADLOCK DETECTION (Chandy-Misra-Haas): %d nodes x %d processes, "
+           "%d resources per node, %.0f%% remote, %.0f s ===\n",
+           config.nodes, config.processes_per_node, config.resources_per_node, config.remote_fraction * 100.0,
+           config.duration_s);
+    DistResult results[2];
+    int ran[2] = {0, 0};
+    for (int mode = 0; mode < 2; mode++) {
+        if (!(modes & (1 << mode))) continue;
+        config.priority_probes = mode == 1;
+        printf("\n%s probes, first cycles found:\n", mode == 1 ? "Priority" : "Basic");
+        if (dist_simulate(&config, &results[mode], 3) != 0) {
+            printf("Not enough memory for %d processes.\n", config.nodes * config.processes_per_node);
+            continue;
+        }
+        if (results[mode].detected == results[mode].phantoms) printf("  none\n");
+        ran[mode] = 1;
+    }
+    printf("\n");
+    print_header();
+    for (int mode = 0; mode < 2; mode++) {
+        if (!ran[mode]) continue;
+        config.priority_probes = mode == 1;
+        dist_print_result(mode == 1 ? "priority" : "basic", &config, &results[mode]);
+    }
+    printf("\nInter-node messages by kind:\n%-9s", "Mode");
+    for (int k = 0; k < DIST_MSG_KINDS; k++) printf(" %10s", message_names[k]);
+    printf(" %10s %10s\n", "started", "suppressed");
+    for (int mode = 0; mode < 2; mode++) {
+        if (!ran[mode]) continue;
+        printf("%-9s", mode == 1 ? "priority" : "basic");
+        for (int k = 0; k < DIST_MSG_KINDS; k++) printf(" %10lld", results[mode].messages[k]);
+        printf(" %10lld %10lld\n", results[mode].probes_started, results[mode].probes_suppressed);
+    }
+    run_arena_print_stats("\nRun");
+    run_arena_reset();
+    return 0;
+}
@@ -0,0 +1,60 @@
+/*
+ * dist_deadlock.h - Header for multi-node resource sharing with distributed deadlock detection
+ */
+
+#ifndef DIST_DEADLOCK_H
+#define DIST_DEADLOCK_H
+
+#define DIST_MAX_NODES 4096
+#define DIST_MAX_WANTS 8            // resources one job acquires, one at a time
+
+typedef enum {
+    DIST_MSG_REQUEST,
+    DIST_MSG_GRANT,
+    DIST_MSG_RELEASE,
+    DIST_MSG_CANCEL,                // an aborted process withdraws its pending request
+    DIST_MSG_PROBE,
+    DIST_MSG_KINDS
+} DistMessageKind;
+
+typedef struct {
+    int nodes;
+    int processes_per_node;
+    int resources_per_node;
+    int wants_per_job;
+    double remote_fraction;         // share of requests for another node's resources
+    double think_mean_ms;
+    double hold_mean_ms;
+    double link_latency_ms;         // one-way delay between two nodes
+    double probe_delay_ms;          // blocked this long before a probe is started
+    int priority_probes;            // forward only probes from higher initiators
+    double duration_s;
+    unsigned long long seed;
+} DistConfig;
+
+typedef struct {
+    long long jobs;                 // completed acquire/hold/release rounds
+    long long requests;
+    long long blocked;              // requests that had to queue
+    long long cycles;               // circular waits formed (global wait-for graph)
+    long long detected;
+    long long phantoms;             // detections whose cycle another abort already broke
+    long long open_cycles;          // cycles still unresolved at the end
+    long long messages[DIST_MSG_KINDS];
+    long long total_messages;       // inter-node only; local hand-offs are free
+    long long probes_started;
+    long long probes_suppressed;
+    double latency_mean_ms;         // cycle formed -> detected
+    double latency_p99_ms;
+    double latency_max_ms;
+    long long events;
+    double wall_seconds;
+} DistResult;
+
+void dist_default_config(DistConfig *config);
+const char *dist_message_name(DistMessageKind kind);
+int dist_simulate(const DistConfig *config, DistResult *result, int report_cycles);
+void dist_print_result(const char *label, const DistConfig *config, const DistResult *result);
+int dist_command(int argc, char *argv[]);
+
+#endif // DIST_DEADLOCK_H
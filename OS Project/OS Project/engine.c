@@ -0,0 +1,366 @@
+/*
+ * engine.c - Simulation engine thread behind the live console
+ *
+ * The console never runs simulation code itself. It pushes commands into a
+ * single-producer/single-consumer ring and rings a doorbell pipe; the engine
+ * thread sleeps in poll() on that pipe until the next command, background
+ * fault arrival or due recovery. Injected faults stay visible in the process
+ * table for detect_delay_ms before their recovery runs. Engine state goes
+ * back through a sequence-locked EngineStatus, the process table through the
+ * existing PCB snapshots, and anything printed lands in the console's log.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#ifndef _WIN32
+#include <pthread.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "engine.h"
+#include "fault_injection.h"
+#include "recovery.h"
+#include "algorithms.h"
+#include "multicore.h"
+#include "io_scheduler.h"
+#include "visualization.h"
+#include "ui.h"
+#include "timing.h"
+#include "arena.h"
+#include "workload_gen.h"
+
+typedef struct {
+    const char *name;
+    void (*inject)();
+    void (*recover)();
+} EngineFault;
+
+static const EngineFault faults[ENGINE_FAULT_KINDS] = {
+    {"DEADLOCK", inject_deadlock, detect_and_fix_deadlock},
+    {"CPU OVERLOAD", inject_cpu_overload, detect_and_fix_cpu_overload},
+    {"MEMORY THRASHING", inject_thrashing, detect_and_fix_thrashing},
+    {"I/O STORM", inject_io_storm, detect_and_fix_io_storm},
+    {"PRIORITY INVERSION", inject_priority_inversion, detect_and_fix_priority_inversion},
+    {"STARVATION", inject_starvation, detect_and_fix_starvation},
+};
+
+// ---- command ring: the console produces, the engine consumes ----
+static int queue[ENGINE_QUEUE_SIZE];
+static atomic_uint queue_head;          // next slot the engine reads
+static atomic_uint queue_tail;          // next slot the console writes
+
+// ---- status seqlock: odd while the engine is writing ----
+static atomic_uint status_sequence;
+static EngineStatus shared_status;
+
+// ---- engine-thread state ----
+typedef struct {
+    int kind;
+    double due;
+} PendingRecovery;
+
+static EngineConfig config;
+static EngineStatus status;             // engine's working copy
+static PendingRecovery pending[ENGINE_MAX_PENDING];
+static int pending_count;
+static double started_at;
+static double paused_at;                // when the current pause began
+static double next_arrival;
+static unsigned long long rng_state;
+static atomic_int stop_requested;       // checked between actions, not queued behind them
+
+#ifndef _WIN32
+static pthread_t engine_thread;
+static int doorbell[2] = {-1, -1};
+#endif
+static int engine_running = 0;
+
+void engine_default_config(EngineConfig *out) {
+    out->auto_faults_per_min = 4.0;
+    out->auto_faults = 1;
+    out->detect_delay_ms = 1500;
+    out->seed = 0;
+}
+
+const char *engine_fault_name(int kind) {
+    if (kind < 1 || kind > ENGINE_FAULT_KINDS) return "?";
+    return faults[kind - 1].name;
+}
+
+// Console thread only; 0 when the ring is full
+int engine_submit(EngineCommand command) {
+    unsigned int tail = atomic_load_explicit(&queue_tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&queue_head, memory_order_acquire);
+    if (tail - head == ENGINE_QUEUE_SIZE) return 0;
+    queue[tail & (ENGINE_QUEUE_SIZE - 1)] = (int)command;
+    atomic_store_explicit(&queue_tail, tail + 1, memory_order_release);
+#ifndef _WIN32
+    // A full doorbell already guarantees a wake-up, so a failed write is fine
+    char byte = 1;
+    if (write(doorbell[1], &byte, 1) < 0) {
+        // EAGAIN: the engine has not drained earlier rings yet
+    }
+#endif
+    return 1;
+}
+
+int engine_queue_depth() {
+    unsigned int tail = atomic_load_explicit(&queue_tail, memory_order_acquire);
+    unsigned int head = atomic_load_explicit(&queue_head, memory_order_acquire);
+    return (int)(tail - head);
+}
+
+static int next_command() {
+    unsigned int head = atomic_load_explicit(&queue_head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&queue_tail, memory_order_acquire);
+    if (head == tail) return 0;
+    int command = queue[head & (ENGINE_QUEUE_SIZE - 1)];
+    atomic_store_explicit(&queue_head, head + 1, memory_order_release);
+    return command;
+}
+
+// Clock for recovery and arrival deadlines: stands still while paused
+static double engine_clock() {
+    return status.paused ? paused_at : monotonic_seconds();
+}
+
+static void publish_status() {
+    status.uptime_s = monotonic_seconds() - started_at;
+    status.pending = pending_count;
+    status.next_recovery_s = -1.0;
+    for (int i = 0; i < pending_count; i++) {
+        status.pending_kinds[i] = pending[i].kind;
+        double wait = pending[i].due - engine_clock();
+        if (wait < 0) wait = 0;
+        if (status.next_recovery_s < 0 || wait < status.next_recovery_s) status.next_recovery_s = wait;
+    }
+    unsigned int sequence = atomic_load_explicit(&status_sequence, memory_order_relaxed);
+    atomic_store_explicit(&status_sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&shared_status, &status, sizeof(status));
+    atomic_store_explicit(&status_sequence, sequence + 2, memory_order_release);
+}
+
+// A consistent copy of the latest published status
+void engine_read_status(EngineStatus *out) {
+    for (;;) {
+        unsigned int before = atomic_load_explicit(&status_sequence, memory_order_acquire);
+        if (before & 1) continue;
+        memcpy(out, &shared_status, sizeof(*out));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&status_sequence, memory_order_relaxed) == before) return;
+    }
+}
+
+static void set_activity(const char *activity) {
+    status.busy = activity[0] != '\0';
+    snprintf(status.activity, sizeof(status.activity), "%s", activity);
+    publish_status();
+}
+
+static void inject(int kind, int automatic) {
+    char activity[64];
+    snprintf(activity, sizeof(activity), "injecting %s", engine_fault_name(kind));
+    set_activity(activity);
+    run_arena_reset();
+    printf("\n[!] %s %s [!]\n", automatic ? "BACKGROUND FAULT:" : "INJECTING", engine_fault_name(kind));
+    faults[kind - 1].inject();
+    fflush(stdout);
+    status.faults_injected++;
+    if (automatic) status.auto_injected++;
+    if (pending_count < ENGINE_MAX_PENDING) {
+        pending[pending_count].kind = kind;
+        pending[pending_count].due = engine_clock() + config.detect_delay_ms / 1000.0;
+        pending_count++;
+    } else {
+        // Too many outstanding: recover this one straight away
+        faults[kind - 1].recover();
+        fflush(stdout);
+        status.recoveries++;
+    }
+    set_activity("");
+}
+
+static void recover_oldest() {
+    int kind = pending[0].kind;
+    memmove(pending, pending + 1, sizeof(PendingRecovery) * (pending_count - 1));
+    pending_count--;
+    char activity[64];
+    snprintf(activity, sizeof(activity), "recovering %s", engine_fault_name(kind));
+    set_activity(activity);
+    run_arena_reset();
+    double started = monotonic_seconds();
+    faults[kind - 1].recover();
+    fflush(stdout);
+    status.last_recovery_ms = (monotonic_seconds() - started) * 1000.0;
+    status.recoveries++;
+    set_activity("");
+}
+
+static void report(int command) {
+    static const char *names[] = {"algorithm comparisons", "system analysis", "performance dashboard"};
+    char activity[64];
+    snprintf(activity, sizeof(activity), "running %s", names[command - ENGINE_CMD_COMPARISONS]);
+    set_activity(activity);
+    run_arena_reset();
+    switch (command) {
+        case ENGINE_CMD_COMPARISONS:
+            printf("\n[@] Displaying Algorithm Comparisons...\n");
+            display_scheduling_comparison();
+            display_multicore_scheduling();
+            display_page_replacement_comparison();
+            display_io_scheduling_comparison();
+            break;
+        case ENGINE_CMD_ANALYSIS:
+            printf("\n[?] Running Complete System Analysis...\n");
+            bankers_algorithm();
+            detect_deadlock_cycle();
+            display_gantt_chart_enhanced();
+            display_memory_map_enhanced();
+            display_resource_graph();
+            break;
+        default:
+            printf("\n[#] Performance Dashboard\n");
+            display_gantt_chart_enhanced();
+            display_memory_map_enhanced();
+            display_status_panel();
+            break;
+    }
+    fflush(stdout);
+    set_activity("");
+}
+
+static void schedule_arrival() {
+    double mean_s = 60.0 / (config.auto_faults_per_min > 0 ? config.auto_faults_per_min : 1.0);
+    next_arrival = engine_clock() + wg_exponential(&rng_state, mean_s);
+}
+
+static void handle(int command) {
+    status.commands++;
+    if (command >= ENGINE_CMD_DEADLOCK && command <= ENGINE_CMD_STARVATION) {
+        inject(command, 0);
+    } else if (command >= ENGINE_CMD_COMPARISONS && command <= ENGINE_CMD_DASHBOARD) {
+        report(command);
+    } else if (command == ENGINE_CMD_TOGGLE_AUTO) {
+        status.auto_faults = !status.auto_faults;
+        if (status.auto_faults) schedule_arrival();
+    } else if (command == ENGINE_CMD_TOGGLE_PAUSE) {
+        if (!status.paused) {
+            paused_at = monotonic_seconds();
+            status.paused = 1;
+        } else {
+            // Held recoveries and the next arrival resume with their
+            // remaining delay intact: push them back by the time paused
+            double held = monotonic_seconds() - paused_at;
+            status.paused = 0;
+            for (int i = 0; i < pending_count; i++) pending[i].due += held;
+            next_arrival += held;
+        }
+    }
+}
+
+#ifndef _WIN32
+static void *engine_main(void *arg) {
+    (void)arg;
+    while (!atomic_load(&stop_requested)) {
+        double now = monotonic_seconds();
+        double wake = now + 1.0;        // uptime in the status line ticks once a second
+        if (!status.paused) {
+            if (pending_count > 0 && pending[0].due < wake) wake = pending[0].due;
+            if (status.auto_faults && next_arrival < wake) wake = next_arrival;
+        }
+        int timeout_ms = (int)((wake - now) * 1000.0 + 0.999);
+        struct pollfd fd = {doorbell[0], POLLIN, 0};
+        if (poll(&fd, 1, timeout_ms > 0 ? timeout_ms : 0) > 0) {
+            char drain[64];
+            while (read(doorbell[0], drain, sizeof(drain)) > 0) {
+            }
+        }
+
+        int command;
+        while (!atomic_load(&stop_requested) && (command = next_command()) != 0) {
+            handle(command);
+        }
+        if (atomic_load(&stop_requested)) break;
+
+        if (!status.paused) {
+            now = monotonic_seconds();
+            if (status.auto_faults && now >= next_arrival) {
+                inject(1 + (int)(wg_uniform(&rng_state) * ENGINE_FAULT_KINDS), 1);
+                schedule_arrival();
+            }
+            if (pending_count > 0 && monotonic_seconds() >= pending[0].due) {
+                recover_oldest();
+            }
+        }
+        publish_status();
+    }
+    status.running = 0;
+    publish_status();
+    run_arena_release();
+    return NULL;
+}
+#endif
+
+// Start the engine thread; 0 when threads are unavailable
+int engine_start(const EngineConfig *engine_config) {
+#ifdef _WIN32
+    (void)engine_config;
+    return 0;
+#else
+    if (engine_running) return 1;
+    config = *engine_config;
+    memset(&status, 0, sizeof(status));
+    pending_count = 0;
+    atomic_store(&stop_requested, 0);
+    atomic_store(&queue_head, 0);
+    atomic_store(&queue_tail, 0);
+    rng_state = config.seed != 0 ? config.seed : (unsigned long long)(monotonic_seconds() * 1e9);
+    started_at = monotonic_seconds();
+    status.running = 1;
+    status.auto_faults = config.auto_faults;
+    if (status.auto_faults) schedule_arrival();
+    publish_status();
+
+    if (pipe(doorbell) != 0) return 0;
+    for (int i = 0; i < 2; i++) {
+        fcntl(doorbell[i], F_SETFL, fcntl(doorbell[i], F_GETFL) | O_NONBLOCK);
+    }
+    if (pthread_create(&engine_thread, NULL, engine_main, NULL) != 0) {
+        close(doorbell[0]);
+        close(doorbell[1]);
+        return 0;
+    }
+    engine_running = 1;
+    return 1;
+#endif
+}
+
+// The engine stops after its current action; status.running drops to 0
+void engine_request_stop() {
+#ifndef _WIN32
+    if (!engine_running) return;
+    atomic_store(&stop_requested, 1);
+    char byte = 1;
+    if (write(doorbell[1], &byte, 1) < 0) {
+        // doorbell already full
+    }
+#endif
+}
+
+// Stop the engine and wait for it
+void engine_stop() {
+#ifndef _WIN32
+    if (!engine_running) return;
+    engine_request_stop();
+    pthread_join(engine_thread, NULL);
+    close(doorbell[0]);
+    close(doorbell[1]);
+    engine_running = 0;
+#endif
+}
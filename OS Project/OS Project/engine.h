@@ -0,0 +1,62 @@
+/*
+ * engine.h - Header for the simulation engine thread behind the live console
+ */
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#define ENGINE_QUEUE_SIZE 64            // commands in flight, power of two
+#define ENGINE_MAX_PENDING 16           // injected faults waiting for their recovery
+
+// Menu actions 1-9 keep their menu numbers
+typedef enum {
+    ENGINE_CMD_DEADLOCK = 1,
+    ENGINE_CMD_CPU_OVERLOAD,
+    ENGINE_CMD_THRASHING,
+    ENGINE_CMD_IO_STORM,
+    ENGINE_CMD_PRIORITY_INVERSION,
+    ENGINE_CMD_STARVATION,
+    ENGINE_CMD_COMPARISONS,
+    ENGINE_CMD_ANALYSIS,
+    ENGINE_CMD_DASHBOARD,
+    ENGINE_CMD_TOGGLE_AUTO,             // background fault arrivals on/off
+    ENGINE_CMD_TOGGLE_PAUSE             // hold arrivals and pending recoveries
+} EngineCommand;
+
+#define ENGINE_FAULT_KINDS 6
+
+typedef struct {
+    double auto_faults_per_min;         // Poisson arrival rate of background faults
+    int auto_faults;                    // start with background arrivals enabled
+    int detect_delay_ms;                // injected -> recovery starts
+    unsigned long long seed;
+} EngineConfig;
+
+// What the engine publishes back to the console; read as one consistent copy
+typedef struct {
+    double uptime_s;
+    long long commands;
+    long long faults_injected;
+    long long auto_injected;
+    long long recoveries;
+    double last_recovery_ms;            // wall time of the latest detect-and-fix
+    int running;
+    int paused;
+    int auto_faults;
+    int busy;                           // inside an injection, recovery or report
+    char activity[64];
+    int pending;
+    int pending_kinds[ENGINE_MAX_PENDING];
+    double next_recovery_s;             // until the oldest pending recovery starts
+} EngineStatus;
+
+void engine_default_config(EngineConfig *config);
+const char *engine_fault_name(int kind);
+int engine_start(const EngineConfig *config);
+int engine_submit(EngineCommand command);
+int engine_queue_depth();
+void engine_read_status(EngineStatus *status);
+void engine_request_stop();
+void engine_stop();
+
+#endif // ENGINE_H
@@ -5,6 +5,11 @@
 #include <stdio.h>
 #include "fault_injection.h"
 #include "process_manager.h"
+#include "algorithms.h"
+#include "rng.h"
+#include "timeline.h"
+#include "io_scheduler.h"
+#include "priority_sched.h"
 #include <stdlib.h>
 
 // Dummy implementation of deadlock fault injection
@@ -14,14 +19,21 @@ void inject_deadlock() {
         printf("Not enough processes to simulate deadlock.\n");
         return;
     }
-    int idx1 = rand() % process_count;
-    int idx2 = rand() % process_count;
+    int idx1 = rng_next() % process_count;
+    int idx2 = rng_next() % process_count;
     while(idx2 == idx1) {
-        idx2 = rand() % process_count;
+        idx2 = rng_next() % process_count;
     }
-    pcb_table[idx1].state = 2; // waiting
-    pcb_table[idx2].state = 2; // waiting
+    pcb_set_state(idx1, 2); // waiting
+    pcb_set_state(idx2, 2); // waiting
+
+    // Each process holds one resource and requests the other's
+    add_resource_allocation(pcb_table[idx1].pid, 1, 1, 0);
+    add_resource_allocation(pcb_table[idx2].pid, 2, 1, 0);
+    add_resource_allocation(pcb_table[idx1].pid, 2, 0, 1);
+    add_resource_allocation(pcb_table[idx2].pid, 1, 0, 1);
     printf("Processes %d and %d marked as waiting to simulate deadlock.\n", pcb_table[idx1].pid, pcb_table[idx2].pid);
+    timeline_instant(NULL, TIMELINE_PID_FAULTS, 0, "inject deadlock", "fault", timeline_now_us());
 }
 
 // Dummy implementation of CPU overload fault injection
@@ -31,9 +43,10 @@ void inject_cpu_overload() {
         printf("No processes available.\n");
         return;
     }
-    int idx = rand() % process_count;
-    pcb_table[idx].cpu_usage = 100.0;
+    int idx = rng_next() % process_count;
+    pcb_set_cpu_usage(idx, 100.0f);
     printf("Process %d CPU usage set to 100%% to simulate overload.\n", pcb_table[idx].pid);
+    timeline_instant(NULL, TIMELINE_PID_FAULTS, 0, "inject cpu overload", "fault", timeline_now_us());
 }
 
 // Dummy implementation of thrashing fault injection
@@ -43,9 +56,64 @@ void inject_thrashing() {
         printf("No processes available.\n");
         return;
     }
-    int idx = rand() % process_count;
+    int idx = rng_next() % process_count;
     // Reduce allocated memory drastically to simulate constant swapping
     int original_memory = pcb_table[idx].allocated_memory;
-    pcb_table[idx].allocated_memory = original_memory / 2;
-    printf("Process %d allocated memory reduced from %d to %d to simulate thrashing.\n", pcb_table[idx].pid, original_memory, pcb_table[idx].allocated_memory);
+    pcb_set_allocated_memory(idx, original_memory / 2);
+    printf("Process %d allocated memory reduced from %d KB to %d KB to simulate thrashing.\n", pcb_table[idx].pid, original_memory, pcb_table[idx].allocated_memory);
+    timeline_instant(NULL, TIMELINE_PID_FAULTS, 0, "inject thrashing", "fault", timeline_now_us());
+}
+
+void inject_io_storm() {
+    printf("\n[Fault Injection] Simulating I/O storm...\n");
+    if (process_count < 1) {
+        printf("No processes available.\n");
+        return;
+    }
+    int idx = rng_next() % process_count;
+    // One process floods the disk with small random writes
+    io_storm_start(pcb_table[idx].pid, IO_STORM_REQUESTS, IO_STORM_IOPS);
+    printf("Process %d is issuing %d random writes at %.0f IOPS.\n",
+           pcb_table[idx].pid, IO_STORM_REQUESTS, IO_STORM_IOPS);
+    timeline_instant(NULL, TIMELINE_PID_FAULTS, 0, "inject io storm", "fault", timeline_now_us());
+}
+
+void inject_priority_inversion() {
+    printf("\n[Fault Injection] Simulating priority inversion...\n");
+    if (process_count < 3) {
+        printf("Not enough processes to simulate priority inversion.\n");
+        return;
+    }
+    int low = rng_next() % process_count;
+    int medium = rng_next() % process_count;
+    while (medium == low) {
+        medium = rng_next() % process_count;
+    }
+    int high = rng_next() % process_count;
+    while (high == low || high == medium) {
+        high = rng_next() % process_count;
+    }
+    pcb_set_priority(low, 5);
+    pcb_set_priority(medium, 3);
+    pcb_set_priority(high, 1);
+
+    // Low holds a lock high needs; medium is ready to run for a long time
+    prio_inversion_start(pcb_table[low].pid, pcb_table[medium].pid, pcb_table[high].pid);
+    printf("Process %d (pri 5) holds a lock that Process %d (pri 1) needs; Process %d (pri 3) is CPU-bound.\n",
+           pcb_table[low].pid, pcb_table[high].pid, pcb_table[medium].pid);
+    timeline_instant(NULL, TIMELINE_PID_FAULTS, 0, "inject priority inversion", "fault", timeline_now_us());
+}
+
+void inject_starvation() {
+    printf("\n[Fault Injection] Simulating starvation...\n");
+    if (process_count < 1) {
+        printf("No processes available.\n");
+        return;
+    }
+    int idx = rng_next() % process_count;
+    pcb_set_priority(idx, 5);
+    prio_starvation_start(pcb_table[idx].pid);
+    printf("Process %d (pri 5) is competing with a flood of %d urgent tasks.\n",
+           pcb_table[idx].pid, PRIO_FLOOD_TASKS);
+    timeline_instant(NULL, TIMELINE_PID_FAULTS, 0, "inject starvation", "fault", timeline_now_us());
 }
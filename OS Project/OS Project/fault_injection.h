@@ -8,5 +8,8 @@
 void inject_deadlock();
 void inject_cpu_overload();
 void inject_thrashing();
+void inject_io_storm();
+void inject_priority_inversion();
+void inject_starvation();
 
 #endif // FAULT_INJECTION_H
@@ -0,0 +1,469 @@
+/*
+ * frame_scan.c - Vectorised page frame scans with runtime dispatch
+ *
+ * Page replacement spends its time in three loops over contiguous frame
+ * arrays: "is this page resident", "which frame has the oldest timestamp"
+ * and the CLOCK hand looking for a clear reference bit. Each has a scalar
+ * version and SSE4.1/AVX2 versions compiled with per-function target
+ * attributes, so the build needs no -m flags; the best level the CPU
+ * supports is picked on first use (frame_scan_select can force one, which
+ * the benchmarks use to compare them). Non-x86 builds use the scalar code.
+ * Batched lookups test eight pages against each loaded block of frames with
+ * a single branch; frame_scan_check compares every vector kernel with the
+ * scalar one.
+ */
+
+#include <limits.h>
+#include <string.h>
+#include "frame_scan.h"
+
+#define BATCH_PAGES 8   // pages a batched lookup tests against each loaded block
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FRAME_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+typedef int (*find_fn)(const int *frames, int count, int page);
+typedef int (*min_fn)(const int *values, int count);
+typedef int (*zero_fn)(const unsigned char *bytes, int count);
+typedef void (*batch_fn)(const int *frames, int count, const int *pages, int page_count, int *slots);
+
+// ---- scalar ----
+static int find_scalar(const int *frames, int count, int page) {
+    for (int i = 0; i < count; i++) {
+        if (frames[i] == page) return i;
+    }
+    return -1;
+}
+
+static int min_value_scalar(const int *values, int count) {
+    if (count <= 0) return INT_MAX;
+    int best = values[0];
+    for (int i = 1; i < count; i++) {
+        if (values[i] < best) best = values[i];
+    }
+    return best;
+}
+
+static int first_zero_scalar(const unsigned char *bytes, int count) {
+    for (int i = 0; i < count; i++) {
+        if (bytes[i] == 0) return i;
+    }
+    return -1;
+}
+
+static void find_batch_scalar(const int *frames, int count, const int *pages, int page_count, int *slots) {
+    for (int p = 0; p < page_count; p++) {
+        slots[p] = find_scalar(frames, count, pages[p]);
+    }
+}
+
+// Scalar tail of a page group: frames from i on, for the pages still pending
+static void finish_group(const int *frames, int i, int count, const int *pages, int *slots, unsigned int pending) {
+    for (; i < count && pending; i++) {
+        for (int k = 0; k < BATCH_PAGES; k++) {
+            if ((pending & (1u << k)) && frames[i] == pages[k]) {
+                slots[k] = i;
+                pending &= ~(1u << k);
+            }
+        }
+    }
+}
+
+// A group's page k was found at frame_index: record it and return the lowest
+// pending page, whose needle replaces k's so only pending pages can match
+static int resolve_page(int k, int frame_index, int *slots, unsigned int *pending) {
+    slots[k] = frame_index;
+    *pending &= ~(1u << k);
+    return *pending ? __builtin_ctz(*pending) : -1;
+}
+
+#ifdef FRAME_SCAN_X86
+// ---- SSE4.1: 4 frames / 16 reference bits per step ----
+__attribute__((target("sse4.1")))
+static int find_sse4(const int *frames, int count, int page) {
+    __m128i needle = _mm_set1_epi32(page);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i block = _mm_loadu_si128((const __m128i *)(frames + i));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(block, needle)));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    for (; i < count; i++) {
+        if (frames[i] == page) return i;
+    }
+    return -1;
+}
+
+// Test one block of 4 frames starting at base against a group's needles
+__attribute__((target("sse4.1")))
+static inline void test_block_sse4(__m128i block, __m128i *needles, int base, int *slots, unsigned int *pending) {
+    __m128i any = _mm_or_si128(
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi32(block, needles[0]), _mm_cmpeq_epi32(block, needles[1])),
+                     _mm_or_si128(_mm_cmpeq_epi32(block, needles[2]), _mm_cmpeq_epi32(block, needles[3]))),
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi32(block, needles[4]), _mm_cmpeq_epi32(block, needles[5])),
+                     _mm_or_si128(_mm_cmpeq_epi32(block, needles[6]), _mm_cmpeq_epi32(block, needles[7]))));
+    if (_mm_testz_si128(any, any)) return;
+    // Rare: a pending page is in this block
+    int fill = -1;
+    for (int k = 0; k < BATCH_PAGES; k++) {
+        if (!(*pending & (1u << k))) continue;
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(block, needles[k])));
+        if (mask) fill = resolve_page(k, base + __builtin_ctz(mask), slots, pending);
+    }
+    for (int k = 0; k < BATCH_PAGES && fill >= 0; k++) {
+        if (!(*pending & (1u << k))) needles[k] = needles[fill];
+    }
+}
+
+__attribute__((target("sse4.1")))
+static void find_batch_sse4(const int *frames, int count, const int *pages, int page_count, int *slots) {
+    int p = 0;
+    for (; p + BATCH_PAGES <= page_count; p += BATCH_PAGES) {
+        __m128i needles[BATCH_PAGES];
+        for (int k = 0; k < BATCH_PAGES; k++) {
+            needles[k] = _mm_set1_epi32(pages[p + k]);
+            slots[p + k] = -1;
+        }
+        unsigned int pending = (1u << BATCH_PAGES) - 1;
+        int i = 0;
+        for (; i + 4 <= count && pending; i += 4) {
+            test_block_sse4(_mm_loadu_si128((const __m128i *)(frames + i)), needles, i, slots + p, &pending);
+        }
+        // The tail as one block overlapping the last full one: pending pages
+        // are not in the overlap, so any match is a first match
+        if (pending && i < count && count >= 4) {
+            test_block_sse4(_mm_loadu_si128((const __m128i *)(frames + count - 4)), needles, count - 4,
+                            slots + p, &pending);
+            i = count;
+        }
+        finish_group(frames, i, count, pages + p, slots + p, pending);
+    }
+    for (; p < page_count; p++) {
+        slots[p] = find_sse4(frames, count, pages[p]);
+    }
+}
+
+__attribute__((target("sse4.1")))
+static int min_value_sse4(const int *values, int count) {
+    if (count <= 0) return INT_MAX;
+    int i = 0;
+    int best = values[0];
+    if (count >= 4) {
+        __m128i low = _mm_loadu_si128((const __m128i *)values);
+        for (i = 4; i + 4 <= count; i += 4) {
+            low = _mm_min_epi32(low, _mm_loadu_si128((const __m128i *)(values + i)));
+        }
+        low = _mm_min_epi32(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(1, 0, 3, 2)));
+        low = _mm_min_epi32(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(2, 3, 0, 1)));
+        best = _mm_cvtsi128_si32(low);
+    }
+    for (; i < count; i++) {
+        if (values[i] < best) best = values[i];
+    }
+    return best;
+}
+
+__attribute__((target("sse4.1")))
+static int first_zero_sse4(const unsigned char *bytes, int count) {
+    __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i *)(bytes + i));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, zero));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    for (; i < count; i++) {
+        if (bytes[i] == 0) return i;
+    }
+    return -1;
+}
+
+// ---- AVX2: 8 frames / 32 reference bits per step ----
+__attribute__((target("avx2")))
+static int find_avx2(const int *frames, int count, int page) {
+    __m256i needle = _mm256_set1_epi32(page);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        // Two vectors per iteration keep both load ports busy
+        __m256i a = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(frames + i)), needle);
+        __m256i b = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(frames + i + 8)), needle);
+        unsigned int mask = (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(a)) |
+                            ((unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(b)) << 8);
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    for (; i + 8 <= count; i += 8) {
+        __m256i a = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(frames + i)), needle);
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(a));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    for (; i < count; i++) {
+        if (frames[i] == page) return i;
+    }
+    return -1;
+}
+
+// Test one block of 8 frames starting at base against a group's needles
+__attribute__((target("avx2")))
+static inline void test_block_avx2(__m256i block, __m256i *needles, int base, int *slots, unsigned int *pending) {
+    __m256i any = _mm256_or_si256(
+        _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi32(block, needles[0]), _mm256_cmpeq_epi32(block, needles[1])),
+                     _mm256_or_si256(_mm256_cmpeq_epi32(block, needles[2]), _mm256_cmpeq_epi32(block, needles[3]))),
+        _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi32(block, needles[4]), _mm256_cmpeq_epi32(block, needles[5])),
+                     _mm256_or_si256(_mm256_cmpeq_epi32(block, needles[6]), _mm256_cmpeq_epi32(block, needles[7]))));
+    if (_mm256_testz_si256(any, any)) return;
+    // Rare: a pending page is in this block
+    int fill = -1;
+    for (int k = 0; k < BATCH_PAGES; k++) {
+        if (!(*pending & (1u << k))) continue;
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(block, needles[k])));
+        if (mask) fill = resolve_page(k, base + __builtin_ctz(mask), slots, pending);
+    }
+    for (int k = 0; k < BATCH_PAGES && fill >= 0; k++) {
+        if (!(*pending & (1u << k))) needles[k] = needles[fill];
+    }
+}
+
+__attribute__((target("avx2")))
+static void find_batch_avx2(const int *frames, int count, const int *pages, int page_count, int *slots) {
+    int p = 0;
+    for (; p + BATCH_PAGES <= page_count; p += BATCH_PAGES) {
+        __m256i needles[BATCH_PAGES];
+        for (int k = 0; k < BATCH_PAGES; k++) {
+            needles[k] = _mm256_set1_epi32(pages[p + k]);
+            slots[p + k] = -1;
+        }
+        unsigned int pending = (1u << BATCH_PAGES) - 1;
+        int i = 0;
+        for (; i + 8 <= count && pending; i += 8) {
+            test_block_avx2(_mm256_loadu_si256((const __m256i *)(frames + i)), needles, i, slots + p, &pending);
+        }
+        // The tail as one block overlapping the last full one: pending pages
+        // are not in the overlap, so any match is a first match
+        if (pending && i < count && count >= 8) {
+            test_block_avx2(_mm256_loadu_si256((const __m256i *)(frames + count - 8)), needles, count - 8,
+                            slots + p, &pending);
+            i = count;
+        }
+        finish_group(frames, i, count, pages + p, slots + p, pending);
+    }
+    for (; p < page_count; p++) {
+        slots[p] = find_avx2(frames, count, pages[p]);
+    }
+}
+
+__attribute__((target("avx2")))
+static int min_value_avx2(const int *values, int count) {
+    if (count <= 0) return INT_MAX;
+    int i = 0;
+    int best = values[0];
+    if (count >= 8) {
+        __m256i low = _mm256_loadu_si256((const __m256i *)values);
+        for (i = 8; i + 8 <= count; i += 8) {
+            low = _mm256_min_epi32(low, _mm256_loadu_si256((const __m256i *)(values + i)));
+        }
+        __m128i half = _mm_min_epi32(_mm256_castsi256_si128(low), _mm256_extracti128_si256(low, 1));
+        half = _mm_min_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+        half = _mm_min_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+        best = _mm_cvtsi128_si32(half);
+    }
+    for (; i < count; i++) {
+        if (values[i] < best) best = values[i];
+    }
+    return best;
+}
+
+__attribute__((target("avx2")))
+static int first_zero_avx2(const unsigned char *bytes, int count) {
+    __m256i zero = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(bytes + i));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, zero));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    for (; i < count; i++) {
+        if (bytes[i] == 0) return i;
+    }
+    return -1;
+}
+#endif
+
+static FrameScanLevel active_level = FRAME_SCAN_AUTO;
+static find_fn find_impl = find_scalar;
+static min_fn min_impl = min_value_scalar;
+static zero_fn zero_impl = first_zero_scalar;
+static batch_fn batch_impl = find_batch_scalar;
+
+static FrameScanLevel best_level() {
+    FrameScanLevel best = FRAME_SCAN_SCALAR;
+#ifdef FRAME_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        best = FRAME_SCAN_AVX2;
+    } else if (__builtin_cpu_supports("sse4.1")) {
+        best = FRAME_SCAN_SSE4;
+    }
+#endif
+    return best;
+}
+
+static void kernels_for(FrameScanLevel level, find_fn *find, min_fn *min, zero_fn *zero, batch_fn *batch) {
+    *find = find_scalar;
+    *min = min_value_scalar;
+    *zero = first_zero_scalar;
+    *batch = find_batch_scalar;
+#ifdef FRAME_SCAN_X86
+    if (level == FRAME_SCAN_AVX2) {
+        *find = find_avx2;
+        *min = min_value_avx2;
+        *zero = first_zero_avx2;
+        *batch = find_batch_avx2;
+    } else if (level == FRAME_SCAN_SSE4) {
+        *find = find_sse4;
+        *min = min_value_sse4;
+        *zero = first_zero_sse4;
+        *batch = find_batch_sse4;
+    }
+#else
+    (void)level;
+#endif
+}
+
+// Choose the kernels; FRAME_SCAN_AUTO (or an unsupported level) picks the best available
+FrameScanLevel frame_scan_select(FrameScanLevel level) {
+    FrameScanLevel best = best_level();
+    if (level == FRAME_SCAN_AUTO || level > best) {
+        level = best;
+    }
+    kernels_for(level, &find_impl, &min_impl, &zero_impl, &batch_impl);
+    active_level = level;
+    return level;
+}
+
+static void ensure_selected() {
+    if (active_level == FRAME_SCAN_AUTO) {
+        frame_scan_select(FRAME_SCAN_AUTO);
+    }
+}
+
+// Name of a level; FRAME_SCAN_AUTO names the level currently in use
+const char *frame_scan_level_name(FrameScanLevel level) {
+    if (level == FRAME_SCAN_AUTO) {
+        ensure_selected();
+        level = active_level;
+    }
+    switch (level) {
+        case FRAME_SCAN_AVX2: return "avx2";
+        case FRAME_SCAN_SSE4: return "sse4.1";
+        default: return "scalar";
+    }
+}
+
+// Frame holding page, or -1
+int frame_find(const int *frames, int count, int page) {
+    ensure_selected();
+    return find_impl(frames, count, page);
+}
+
+// Resolve many references at once: slots[i] = frame of pages[i] or -1
+void frame_find_batch(const int *frames, int count, const int *pages, int page_count, int *slots) {
+    ensure_selected();
+    batch_impl(frames, count, pages, page_count, slots);
+}
+
+// First index holding the smallest value (LRU victim by last-use time)
+int frame_find_min(const int *values, int count) {
+    if (count <= 0) {
+        return -1;
+    }
+    ensure_selected();
+    return find_impl(values, count, min_impl(values, count));
+}
+
+// CLOCK: advance from hand, clearing set reference bits, to the first clear
+// one; returns the victim frame. If every bit is set, all are cleared and the
+// hand itself is the victim, as after one full revolution.
+int frame_clock_sweep(unsigned char *referenced, int count, int hand) {
+    ensure_selected();
+    int offset = zero_impl(referenced + hand, count - hand);
+    if (offset >= 0) {
+        memset(referenced + hand, 0, (size_t)offset);
+        return hand + offset;
+    }
+    memset(referenced + hand, 0, (size_t)(count - hand));
+    offset = zero_impl(referenced, hand);
+    if (offset >= 0) {
+        memset(referenced, 0, (size_t)offset);
+        return offset;
+    }
+    memset(referenced, 0, (size_t)hand);
+    return hand;
+}
+
+// ---- scalar equivalence ----
+#define CHECK_MAX_COUNT 257
+#define CHECK_ROUNDS 64
+#define CHECK_BATCH 19
+
+static unsigned long long check_state;
+
+static unsigned int check_next() {
+    check_state ^= check_state << 13;
+    check_state ^= check_state >> 7;
+    check_state ^= check_state << 17;
+    return (unsigned int)(check_state >> 32);
+}
+
+// Compare level's kernels with the scalar ones over random arrays of the
+// edge lengths around each vector width; returns the number of differing
+// results, 0 when they agree, or -1 if the CPU lacks the level.
+int frame_scan_check(FrameScanLevel level) {
+    static const int lengths[] = {0, 1, 3, 4, 7, 8, 9, 15, 16, 17, 31, 32, 33, 64, 100, CHECK_MAX_COUNT};
+    if (level < FRAME_SCAN_SCALAR || level > best_level()) {
+        return -1;
+    }
+    find_fn find;
+    min_fn min;
+    zero_fn zero;
+    batch_fn batch;
+    kernels_for(level, &find, &min, &zero, &batch);
+
+    // One int past the start so the unaligned loads are exercised
+    static int frames[CHECK_MAX_COUNT + 1];
+    static unsigned char bytes[CHECK_MAX_COUNT + 1];
+    int pages[CHECK_BATCH], slots[CHECK_BATCH], expected[CHECK_BATCH];
+    int mismatches = 0;
+    check_state = 0x9e3779b97f4a7c15ULL;
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        int count = lengths[l];
+        int *values = frames + 1;
+        unsigned char *bits = bytes + 1;
+        for (int round = 0; round < CHECK_ROUNDS; round++) {
+            // A narrow value range makes duplicates, so "first match" is tested
+            int range = 2 * count + 2;
+            for (int i = 0; i < count; i++) {
+                values[i] = round % 4 == 0 ? (int)check_next() : (int)(check_next() % (unsigned int)range);
+                bits[i] = round % 8 == 0 ? 1 : (unsigned char)(check_next() % 8);
+            }
+            for (int i = 0; i < count; i++) {
+                mismatches += find(values, count, values[i]) != find_scalar(values, count, values[i]);
+            }
+            mismatches += find(values, count, -1) != find_scalar(values, count, -1);
+            mismatches += find(values, count, range) != find_scalar(values, count, range);
+            mismatches += min(values, count) != min_value_scalar(values, count);
+            mismatches += zero(bits, count) != first_zero_scalar(bits, count);
+
+            for (int p = 0; p < CHECK_BATCH; p++) {
+                pages[p] = count > 0 && p % 3 != 2 ? values[check_next() % (unsigned int)count] : -1 - p;
+            }
+            for (int page_count = 0; page_count <= CHECK_BATCH; page_count++) {
+                batch(values, count, pages, page_count, slots);
+                find_batch_scalar(values, count, pages, page_count, expected);
+                mismatches += memcmp(slots, expected, sizeof(int) * (size_t)page_count) != 0;
+            }
+        }
+    }
+    return mismatches;
+}
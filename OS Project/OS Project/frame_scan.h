@@ -0,0 +1,24 @@
+/*
+ * frame_scan.h - Header for vectorised page frame scans
+ */
+
+#ifndef FRAME_SCAN_H
+#define FRAME_SCAN_H
+
+typedef enum {
+    FRAME_SCAN_AUTO = -1,
+    FRAME_SCAN_SCALAR = 0,
+    FRAME_SCAN_SSE4 = 1,
+    FRAME_SCAN_AVX2 = 2
+} FrameScanLevel;
+
+int frame_find(const int *frames, int count, int page);
+void frame_find_batch(const int *frames, int count, const int *pages, int page_count, int *slots);
+int frame_find_min(const int *values, int count);
+int frame_clock_sweep(unsigned char *referenced, int count, int hand);
+
+FrameScanLevel frame_scan_select(FrameScanLevel level);
+const char *frame_scan_level_name(FrameScanLevel level);
+int frame_scan_check(FrameScanLevel level);
+
+#endif // FRAME_SCAN_H
@@ -0,0 +1,416 @@
+/*
+ * io_scheduler.c - Disk I/O scheduling simulation and I/O-storm workloads
+ *
+ * Requests arrive in time order and queue at a single device. Pending
+ * requests are bucketed per cylinder (FIFO within a cylinder) and counted in
+ * a Fenwick tree, so "nearest pending cylinder at or above / below the head"
+ * is two O(log C) queries. That keeps SSTF, SCAN, C-LOOK and deadline at
+ * O(log C) per dispatch, and a run with millions of queued requests costs
+ * about what FCFS does. The HDD model charges settle + distance-proportional
+ * seek, average rotational delay and transfer time; the SSD model a flat
+ * access latency plus transfer.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "io_scheduler.h"
+#include "process_manager.h"
+#include "arena.h"
+#include "workload_gen.h"
+
+static const char *scheduler_names[IO_SCHED_COUNT] = {"FCFS", "SSTF", "SCAN", "C-LOOK", "Deadline"};
+
+void io_default_device(IoDevice *device, IoDeviceKind kind) {
+    memset(device, 0, sizeof(*device));
+    device->kind = kind;
+    device->cylinders = 20000;
+    device->read_expire_us = 500000.0;
+    device->write_expire_us = 5000000.0;
+    if (kind == IO_DEVICE_HDD) {
+        // 7200 rpm class: ~16 ms full stroke, 4.2 ms half rotation, ~150 MB/s
+        device->seek_settle_us = 500.0;
+        device->seek_per_cylinder_us = 0.8;
+        device->rotation_us = 4167.0;
+        device->transfer_us_per_kb = 6.5;
+    } else {
+        device->access_us = 80.0;
+        device->transfer_us_per_kb = 0.5;
+    }
+}
+
+const char *io_scheduler_name(IoSchedulerKind kind) {
+    return kind >= 0 && kind < IO_SCHED_COUNT ? scheduler_names[kind] : "unknown";
+}
+
+// Arrivals at roughly iops per second (uniform jitter around the mean gap);
+// a sequential fraction continues from the previous request's cylinder
+void io_generate_workload(IoRequest *requests, int count, const IoDevice *device,
+                          double iops, float sequential, const int *pids, int pid_count,
+                          unsigned int seed) {
+    unsigned long long state = seed ? seed : 1;
+    double gap = iops > 0.0 ? 1e6 / iops : 0.0;
+    double t = 0.0;
+    int cylinder = 0;
+    for (int i = 0; i < count; i++) {
+        IoRequest *request = &requests[i];
+        t += gap * (wg_next(&state) % 2001) / 1000.0;
+        if ((wg_next(&state) % 1000) >= (unsigned int)(sequential * 1000)) {
+            cylinder = (int)(wg_next(&state) % (unsigned int)device->cylinders);
+        } else if (cylinder + 1 < device->cylinders) {
+            cylinder++;
+        }
+        request->arrival_us = t;
+        request->cylinder = cylinder;
+        request->size_kb = 4 << (wg_next(&state) % 4);     // 4..32 KB
+        request->pid = pid_count > 0 ? pids[wg_next(&state) % (unsigned int)pid_count] : 0;
+        request->is_write = wg_next(&state) % 3 == 0;
+    }
+}
+
+// ---- Fenwick tree of pending requests per cylinder ----
+typedef struct {
+    int *tree;      // 1-based
+    int size;
+    int top_bit;    // highest power of two <= size
+} PendingCounts;
+
+static void pending_add(PendingCounts *counts, int cylinder, int delta) {
+    for (int i = cylinder + 1; i <= counts->size; i += i & -i) {
+        counts->tree[i] += delta;
+    }
+}
+
+// Pending requests on cylinders [0, cylinder]
+static int pending_prefix(const PendingCounts *counts, int cylinder) {
+    int sum = 0;
+    for (int i = cylinder + 1; i > 0; i -= i & -i) {
+        sum += counts->tree[i];
+    }
+    return sum;
+}
+
+// Cylinder holding the k-th pending request (1-based k)
+static int pending_kth(const PendingCounts *counts, int k) {
+    int position = 0;
+    for (int step = counts->top_bit; step > 0; step >>= 1) {
+        if (position + step <= counts->size && counts->tree[position + step] < k) {
+            position += step;
+            k -= counts->tree[position];
+        }
+    }
+    return position;    // 0-based cylinder
+}
+
+// Nearest pending cylinder >= head, or -1
+static int pending_at_or_above(const PendingCounts *counts, int head, int pending) {
+    int below = head > 0 ? pending_prefix(counts, head - 1) : 0;
+    return below < pending ? pending_kth(counts, below + 1) : -1;
+}
+
+// Nearest pending cylinder <= head, or -1
+static int pending_at_or_below(const PendingCounts *counts, int head) {
+    int upto = pending_prefix(counts, head);
+    return upto > 0 ? pending_kth(counts, upto) : -1;
+}
+
+static double service_time(const IoDevice *device, int distance, int size_kb) {
+    double transfer = device->transfer_us_per_kb * size_kb;
+    if (device->kind == IO_DEVICE_SSD) {
+        return device->access_us + transfer;
+    }
+    double seek = distance > 0 ? device->seek_settle_us + device->seek_per_cylinder_us * distance : 0.0;
+    return seek + device->rotation_us + transfer;
+}
+
+// Serve requests (sorted by arrival) with one scheduler; returns 1 on success
+int io_simulate(const IoDevice *device, IoSchedulerKind scheduler, const IoRequest *requests,
+                int count, IoResult *result) {
+    memset(result, 0, sizeof(*result));
+    if (count < 1 || device->cylinders < 1 || scheduler < 0 || scheduler >= IO_SCHED_COUNT) {
+        return 0;
+    }
+    int cylinders = device->cylinders;
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    PendingCounts counts;
+    counts.size = cylinders;
+    counts.tree = arena_calloc(arena, (size_t)cylinders + 1, sizeof(int));
+    int *bucket_head = arena_alloc(arena, sizeof(int) * cylinders);
+    int *bucket_tail = arena_alloc(arena, sizeof(int) * cylinders);
+    int *next = arena_alloc(arena, sizeof(int) * count);
+    int *prev = arena_alloc(arena, sizeof(int) * count);
+    unsigned char *done = arena_calloc(arena, (size_t)count, 1);
+    double *latency = arena_alloc(arena, sizeof(double) * count);
+    if (counts.tree == NULL || bucket_head == NULL || bucket_tail == NULL || next == NULL ||
+        prev == NULL || done == NULL || latency == NULL) {
+        arena_release(arena, mark);
+        printf("Not enough memory to simulate %d I/O requests.\n", count);
+        return 0;
+    }
+    counts.top_bit = 1;
+    while (counts.top_bit * 2 <= cylinders) counts.top_bit *= 2;
+    for (int c = 0; c < cylinders; c++) {
+        bucket_head[c] = -1;
+        bucket_tail[c] = -1;
+    }
+
+    double t = 0.0, depth_sum = 0.0, latency_sum = 0.0;
+    int head = 0, direction = 1, admitted = 0, pending = 0, fifo = 0;
+    for (long long served = 0; served < count; served++) {
+        if (pending == 0 && requests[admitted].arrival_us > t) {
+            t = requests[admitted].arrival_us;   // idle until the next arrival
+        }
+        while (admitted < count && requests[admitted].arrival_us <= t) {
+            int c = requests[admitted].cylinder;
+            if (c < 0) c = 0;
+            if (c >= cylinders) c = cylinders - 1;
+            next[admitted] = -1;
+            prev[admitted] = bucket_tail[c];
+            if (bucket_tail[c] >= 0) next[bucket_tail[c]] = admitted; else bucket_head[c] = admitted;
+            bucket_tail[c] = admitted;
+            pending_add(&counts, c, 1);
+            pending++;
+            admitted++;
+        }
+        depth_sum += pending;
+        if (pending > result->max_queue_depth) result->max_queue_depth = pending;
+
+        int chosen = -1;
+        int target = -1;
+        while (done[fifo]) fifo++;      // oldest pending request
+        switch (scheduler) {
+            case IO_SCHED_FCFS:
+                chosen = fifo;
+                break;
+            case IO_SCHED_SSTF: {
+                int up = pending_at_or_above(&counts, head, pending);
+                int down = pending_at_or_below(&counts, head);
+                target = up < 0 || (down >= 0 && head - down < up - head) ? down : up;
+                break;
+            }
+            case IO_SCHED_SCAN:
+                // Sweep to the edge of the disk before reversing
+                target = direction > 0 ? pending_at_or_above(&counts, head, pending)
+                                       : pending_at_or_below(&counts, head);
+                if (target < 0) {
+                    int edge = direction > 0 ? cylinders - 1 : 0;
+                    int travel = edge > head ? edge - head : head - edge;
+                    result->seek_distance += travel;
+                    t += service_time(device, travel, 0) - service_time(device, 0, 0);
+                    head = edge;
+                    direction = -direction;
+                    target = direction > 0 ? pending_at_or_above(&counts, head, pending)
+                                           : pending_at_or_below(&counts, head);
+                }
+                break;
+            case IO_SCHED_DEADLINE: {
+                const IoRequest *oldest = &requests[fifo];
+                double expire = oldest->is_write ? device->write_expire_us : device->read_expire_us;
+                if (t - oldest->arrival_us > expire) {
+                    chosen = fifo;
+                    result->expired++;
+                    break;
+                }
+            }
+            // fall through - otherwise serve like C-LOOK
+            case IO_SCHED_CLOOK:
+            default:
+                target = pending_at_or_above(&counts, head, pending);
+                if (target < 0) target = pending_kth(&counts, 1);   // jump back to the lowest
+                break;
+        }
+        if (chosen < 0) {
+            chosen = bucket_head[target];
+        }
+
+        // Unlink from its cylinder bucket
+        int c = requests[chosen].cylinder;
+        if (c < 0) c = 0;
+        if (c >= cylinders) c = cylinders - 1;
+        if (prev[chosen] >= 0) next[prev[chosen]] = next[chosen]; else bucket_head[c] = next[chosen];
+        if (next[chosen] >= 0) prev[next[chosen]] = prev[chosen]; else bucket_tail[c] = prev[chosen];
+        pending_add(&counts, c, -1);
+        pending--;
+        done[chosen] = 1;
+
+        int distance = c > head ? c - head : head - c;
+        result->seek_distance += distance;
+        t += service_time(device, distance, requests[chosen].size_kb);
+        head = c;
+        latency[chosen] = t - requests[chosen].arrival_us;
+        latency_sum += latency[chosen];
+        if (latency[chosen] > result->max_latency_us) result->max_latency_us = latency[chosen];
+    }
+
+    result->completed = count;
+    result->avg_seek = (double)result->seek_distance / count;
+    result->mean_latency_us = latency_sum / count;
+    result->avg_queue_depth = depth_sum / count;
+    result->p99_latency_us = wg_select_kth(latency, count, (int)((count - 1) * 0.99));
+    result->makespan_us = t;
+    result->iops = t > 0.0 ? count / (t / 1e6) : 0.0;
+    arena_release(arena, mark);
+    return 1;
+}
+
+void io_print_result(const char *label, const IoResult *result) {
+    printf("%-9s seek %10lld (avg %7.1f) | depth avg %8.1f max %7d | latency mean %9.2f ms p99 %9.2f ms max %9.2f ms",
+           label, result->seek_distance, result->avg_seek, result->avg_queue_depth,
+           result->max_queue_depth, result->mean_latency_us / 1000.0,
+           result->p99_latency_us / 1000.0, result->max_latency_us / 1000.0);
+    if (result->expired > 0) printf(" | %lld expired", result->expired);
+    printf("\n");
+}
+
+// ---- I/O state of the simulated process table ----
+#define IO_BACKGROUND_REQUESTS 2000
+#define IO_BACKGROUND_IOPS 60.0
+
+static int storm_pid = -1;
+static int storm_requests = 0;
+static double storm_iops = 0.0;
+static int throttled_pid = -1;
+static double throttle_iops = 0.0;
+static IoSchedulerKind active_scheduler = IO_SCHED_CLOOK;
+
+void io_storm_start(int pid, int requests, double iops) {
+    storm_pid = pid;
+    storm_requests = requests;
+    storm_iops = iops;
+}
+
+int io_storm_pid() {
+    return storm_pid;
+}
+
+// Token-bucket style submit limit for one pid (iops <= 0 clears it)
+void io_set_throttle(int pid, double iops) {
+    throttled_pid = iops > 0.0 ? pid : -1;
+    throttle_iops = iops;
+}
+
+IoSchedulerKind io_active_scheduler() {
+    return active_scheduler;
+}
+
+void io_set_active_scheduler(IoSchedulerKind kind) {
+    if (kind >= 0 && kind < IO_SCHED_COUNT) active_scheduler = kind;
+}
+
+void io_reset_state() {
+    storm_pid = -1;
+    storm_requests = 0;
+    storm_iops = 0.0;
+    throttled_pid = -1;
+    throttle_iops = 0.0;
+    active_scheduler = IO_SCHED_CLOOK;
+}
+
+static int compare_arrival(const void *a, const void *b) {
+    double x = ((const IoRequest *)a)->arrival_us;
+    double y = ((const IoRequest *)b)->arrival_us;
+    return (x > y) - (x < y);
+}
+
+// Background I/O of the process table plus any storm, throttle applied and
+// sorted by arrival; returns the number of requests written
+int io_build_workload(IoRequest *requests, int capacity, const IoDevice *device) {
+    int pids[MAX_PROCESSES];
+    PcbReadGuard view = pcb_read_begin();
+    int pid_count = view.snapshot->count;
+    for (int i = 0; i < pid_count; i++) {
+        pids[i] = view.snapshot->rows[i].pid;
+    }
+    pcb_read_end(&view);
+
+    int count = capacity < IO_BACKGROUND_REQUESTS ? capacity : IO_BACKGROUND_REQUESTS;
+    io_generate_workload(requests, count, device, IO_BACKGROUND_IOPS, 0.3f, pids, pid_count, 7);
+    if (storm_pid >= 0 && count < capacity) {
+        int extra = storm_requests < capacity - count ? storm_requests : capacity - count;
+        // The storm starts a third of the way into the background window
+        double offset = requests[count / 3].arrival_us;
+        io_generate_workload(requests + count, extra, device, storm_iops, 0.0f, &storm_pid, 1, 99);
+        for (int i = 0; i < extra; i++) {
+            requests[count + i].arrival_us += offset;
+            requests[count + i].is_write = 1;
+        }
+        count += extra;
+    }
+    if (throttled_pid >= 0) {
+        // Delay each submission of the throttled pid to its allowed rate
+        double interval = 1e6 / throttle_iops, allowed = 0.0;
+        qsort(requests, (size_t)count, sizeof(IoRequest), compare_arrival);
+        for (int i = 0; i < count; i++) {
+            if (requests[i].pid != throttled_pid) continue;
+            if (requests[i].arrival_us < allowed) requests[i].arrival_us = allowed;
+            allowed = requests[i].arrival_us + interval;
+        }
+    }
+    qsort(requests, (size_t)count, sizeof(IoRequest), compare_arrival);
+    return count;
+}
+
+static void compare_schedulers(const IoDevice *device, const IoRequest *requests, int count) {
+    for (int s = 0; s < IO_SCHED_COUNT; s++) {
+        IoResult result;
+        if (io_simulate(device, (IoSchedulerKind)s, requests, count, &result)) {
+            io_print_result(io_scheduler_name((IoSchedulerKind)s), &result);
+        }
+    }
+}
+
+// Menu demo: the process table's background I/O on an HDD and an SSD
+void display_io_scheduling_comparison() {
+    printf("\n=== DISK I/O SCHEDULING ===\n");
+    int capacity = IO_BACKGROUND_REQUESTS + IO_STORM_REQUESTS;
+    IoRequest *requests = arena_alloc(run_arena(), sizeof(IoRequest) * capacity);
+    if (requests == NULL) {
+        printf("Not enough memory for the I/O workload.\n");
+        return;
+    }
+    IoDevice device;
+    io_default_device(&device, IO_DEVICE_HDD);
+    int count = io_build_workload(requests, capacity, &device);
+    printf("HDD, %d requests (%d cylinders):\n", count, device.cylinders);
+    compare_schedulers(&device, requests, count);
+    io_default_device(&device, IO_DEVICE_SSD);
+    printf("SSD, same requests:\n");
+    compare_schedulers(&device, requests, count);
+}
+
+// CLI: io [requests] [hdd|ssd] [iops]
+int io_command(int argc, char *argv[]) {
+    int count = 1000000;
+    IoDeviceKind kind = IO_DEVICE_HDD;
+    double iops = 0.0;
+    if (argc > 0) count = atoi(argv[0]);
+    if (argc > 1 && strcmp(argv[1], "ssd") == 0) kind = IO_DEVICE_SSD;
+    if (argc > 2) iops = atof(argv[2]);
+    if (count < 1) {
+        printf("Usage: io [requests] [hdd|ssd] [arrival iops]\n");
+        return 1;
+    }
+    IoDevice device;
+    io_default_device(&device, kind);
+    if (iops <= 0.0) {
+        // Slightly above what C-LOOK can sustain, so queues build up
+        iops = kind == IO_DEVICE_HDD ? 200.0 : 11000.0;
+    }
+
+    run_arena_reset();
+    IoRequest *requests = arena_alloc(run_arena(), sizeof(IoRequest) * (size_t)count);
+    if (requests == NULL) {
+        printf("Not enough memory for %d requests.\n", count);
+        run_arena_print_stats("Run");
+        return 1;
+    }
+    int pids[4] = {101, 102, 103, 104};
+    io_generate_workload(requests, count, &device, iops, 0.3f, pids, 4, 42);
+    printf("=== DISK I/O SCHEDULING: %d requests, %s, %.0f IOPS offered ===\n",
+           count, kind == IO_DEVICE_HDD ? "HDD" : "SSD", iops);
+    compare_schedulers(&device, requests, count);
+    run_arena_print_stats("\nRun");
+    run_arena_reset();
+    return 0;
+}
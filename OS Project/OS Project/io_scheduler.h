@@ -0,0 +1,83 @@
+/*
+ * io_scheduler.h - Header for the disk I/O scheduling simulation
+ */
+
+#ifndef IO_SCHEDULER_H
+#define IO_SCHEDULER_H
+
+#define IO_LATENCY_SLO_US 100000.0     // p99 above this counts as an I/O storm
+#define IO_QUEUE_DEPTH_LIMIT 64
+#define IO_STORM_REQUESTS 4000
+#define IO_STORM_IOPS 2000.0
+#define IO_THROTTLE_IOPS 40.0
+
+typedef enum {
+    IO_SCHED_FCFS,
+    IO_SCHED_SSTF,
+    IO_SCHED_SCAN,
+    IO_SCHED_CLOOK,
+    IO_SCHED_DEADLINE,
+    IO_SCHED_COUNT
+} IoSchedulerKind;
+
+typedef enum {
+    IO_DEVICE_HDD,
+    IO_DEVICE_SSD
+} IoDeviceKind;
+
+typedef struct {
+    IoDeviceKind kind;
+    int cylinders;
+    double seek_settle_us;      // HDD: fixed cost of any head movement
+    double seek_per_cylinder_us;
+    double rotation_us;         // HDD: average rotational delay per request
+    double access_us;           // SSD: flat per-request latency
+    double transfer_us_per_kb;
+    double read_expire_us;      // deadline scheduler: reads served by this age
+    double write_expire_us;
+} IoDevice;
+
+typedef struct {
+    double arrival_us;
+    int cylinder;
+    int size_kb;
+    int pid;
+    int is_write;
+} IoRequest;
+
+typedef struct {
+    long long completed;
+    long long seek_distance;
+    double avg_seek;
+    double mean_latency_us;
+    double p99_latency_us;
+    double max_latency_us;
+    double avg_queue_depth;
+    int max_queue_depth;
+    long long expired;          // deadline scheduler: dispatched from the FIFO
+    double makespan_us;
+    double iops;
+} IoResult;
+
+void io_default_device(IoDevice *device, IoDeviceKind kind);
+const char *io_scheduler_name(IoSchedulerKind kind);
+void io_generate_workload(IoRequest *requests, int count, const IoDevice *device,
+                          double iops, float sequential, const int *pids, int pid_count,
+                          unsigned int seed);
+int io_simulate(const IoDevice *device, IoSchedulerKind scheduler, const IoRequest *requests,
+                int count, IoResult *result);
+void io_print_result(const char *label, const IoResult *result);
+
+// Simulated I/O state of the process table (fault injection and recovery)
+void io_storm_start(int pid, int requests, double iops);
+int io_storm_pid();
+void io_set_throttle(int pid, double iops);
+IoSchedulerKind io_active_scheduler();
+void io_set_active_scheduler(IoSchedulerKind kind);
+void io_reset_state();
+int io_build_workload(IoRequest *requests, int capacity, const IoDevice *device);
+
+void display_io_scheduling_comparison();
+int io_command(int argc, char *argv[]);
+
+#endif // IO_SCHEDULER_H
@@ -0,0 +1,396 @@
+/*
+ * lockdep_preload.c - LD_PRELOAD lock-order validator for pthread mutexes
+ *
+ * Interposes pthread_mutex_lock/trylock/timedlock/unlock and builds a
+ * lock-order graph in the spirit of the kernel's lockdep: every thread keeps
+ * a stack of the mutexes it holds, and acquiring B while holding A records
+ * the dependency A -> B. The first time a dependency is seen, the graph is
+ * searched for a path B -> ... -> A, which would close a cycle (a potential
+ * deadlock even if the threads never actually collided). When an acquisition
+ * is contended, the chain "owner of the lock -> lock that owner waits for"
+ * is followed to catch actual circular waits as they form.
+ *
+ * Lock identities and dependency edges live in fixed-size open-addressed
+ * tables claimed with compare-and-swap, so the uncontended fast path is a
+ * hash probe, a trylock and a thread-local cache hit with no global lock.
+ * Cycles are reported through report_deadlock_cycle(), the same path the
+ * simulator's detect_and_fix_deadlock() uses.
+ *
+ * Build: gcc -std=c11 -O2 -fPIC -shared -pthread lockdep_preload.c deadlock_report.c -o liblockdep.so -ldl
+ * Use:   LD_PRELOAD=./liblockdep.so ./simulation real-faults deadlock
+ * Env:   LOCKDEP_LOG=<file> (default stderr), LOCKDEP_SUMMARY=1 prints totals at exit
+ *
+ * Locks are identified by address, so a mutex destroyed and re-created at
+ * the same address keeps its history.
+ */
+
+#define _GNU_SOURCE
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "deadlock_report.h"
+
+#define LOCKDEP_MAX_LOCKS 65536         // power of two
+#define LOCKDEP_MAX_EDGES 262144        // power of two
+#define LOCKDEP_MAX_THREADS 4096
+#define LOCKDEP_MAX_HELD 32
+#define LOCKDEP_EDGE_CACHE 64           // power of two
+#define LOCKDEP_MAX_SEARCH 8192
+
+#define TLS __thread __attribute__((tls_model("initial-exec")))
+
+typedef int (*mutex_fn)(pthread_mutex_t *);
+typedef int (*timedlock_fn)(pthread_mutex_t *, const struct timespec *);
+
+static mutex_fn real_lock;
+static mutex_fn real_trylock;
+static mutex_fn real_unlock;
+static timedlock_fn real_timedlock;
+
+// Lock classes: mutex address -> slot; ids reported to users are slot + 1
+static _Atomic uintptr_t lock_keys[LOCKDEP_MAX_LOCKS];
+static atomic_int lock_owner[LOCKDEP_MAX_LOCKS];        // thread slot + 1, 0 = free
+static atomic_int lock_edge_head[LOCKDEP_MAX_LOCKS];    // edge slot + 1, 0 = none
+
+// Dependency set keyed by (from id << 32 | to id); each edge is also linked
+// into its source lock's adjacency list for the cycle search
+static _Atomic uint64_t edge_keys[LOCKDEP_MAX_EDGES];
+static atomic_int edge_next[LOCKDEP_MAX_EDGES];
+
+static atomic_long thread_tid[LOCKDEP_MAX_THREADS];     // 0 = free slot
+static atomic_int thread_waiting[LOCKDEP_MAX_THREADS];  // lock slot + 1, 0 = none
+
+static atomic_int lock_total;
+static atomic_int edge_total;
+static atomic_int potential_total;
+static atomic_int actual_total;
+
+static pthread_key_t thread_key;
+static pthread_mutex_t search_lock = PTHREAD_MUTEX_INITIALIZER;
+static int search_queue[LOCKDEP_MAX_SEARCH];
+static int search_parent[LOCKDEP_MAX_SEARCH];
+static int search_seen[LOCKDEP_MAX_LOCKS];
+static int search_generation;
+
+static TLS int self_slot = -1;
+static TLS int held[LOCKDEP_MAX_HELD];
+static TLS int held_count;
+static TLS uint64_t edge_cache[LOCKDEP_EDGE_CACHE];
+static TLS int in_lockdep;
+
+static void resolve_real_functions() {
+    real_lock = (mutex_fn)dlsym(RTLD_NEXT, "pthread_mutex_lock");
+    real_trylock = (mutex_fn)dlsym(RTLD_NEXT, "pthread_mutex_trylock");
+    real_unlock = (mutex_fn)dlsym(RTLD_NEXT, "pthread_mutex_unlock");
+    real_timedlock = (timedlock_fn)dlsym(RTLD_NEXT, "pthread_mutex_timedlock");
+}
+
+static void release_thread_slot(void *value) {
+    int slot = (int)(intptr_t)value - 1;
+    if (slot >= 0) {
+        atomic_store(&thread_waiting[slot], 0);
+        atomic_store(&thread_tid[slot], 0);
+    }
+}
+
+__attribute__((constructor))
+static void lockdep_init() {
+    resolve_real_functions();
+    pthread_key_create(&thread_key, release_thread_slot);
+    const char *path = getenv("LOCKDEP_LOG");
+    if (path != NULL) {
+        FILE *log = fopen(path, "a");
+        if (log != NULL) {
+            setvbuf(log, NULL, _IOLBF, 0);
+            deadlock_report_set_output(log);
+        }
+    } else {
+        deadlock_report_set_output(stderr);
+    }
+}
+
+__attribute__((destructor))
+static void lockdep_summary() {
+    if (getenv("LOCKDEP_SUMMARY") != NULL) {
+        fprintf(stderr, "[lockdep] %d locks, %d dependencies, %d potential and %d actual cycles\n",
+                atomic_load(&lock_total), atomic_load(&edge_total),
+                atomic_load(&potential_total), atomic_load(&actual_total));
+    }
+}
+
+// Claim a registry slot for the calling thread; -1 if the registry is full
+static int current_thread_slot() {
+    if (self_slot >= 0) {
+        return self_slot;
+    }
+    long tid = (long)syscall(SYS_gettid);
+    for (int probe = 0; probe < LOCKDEP_MAX_THREADS; probe++) {
+        int slot = (int)((tid + probe) % LOCKDEP_MAX_THREADS);
+        long expected = 0;
+        if (atomic_compare_exchange_strong(&thread_tid[slot], &expected, tid)) {
+            self_slot = slot;
+            pthread_setspecific(thread_key, (void *)(intptr_t)(slot + 1));
+            return slot;
+        }
+    }
+    return -1;
+}
+
+static uint32_t hash_word(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    return (uint32_t)x;
+}
+
+// Find or insert the slot of a mutex; -1 if the table is full
+static int lock_slot(pthread_mutex_t *mutex, int insert) {
+    uintptr_t key = (uintptr_t)mutex;
+    uint32_t mask = LOCKDEP_MAX_LOCKS - 1;
+    uint32_t i = hash_word(key) & mask;
+    for (int probe = 0; probe < LOCKDEP_MAX_LOCKS; probe++) {
+        uintptr_t current = atomic_load_explicit(&lock_keys[i], memory_order_acquire);
+        if (current == key) {
+            return (int)i;
+        }
+        if (current == 0) {
+            if (!insert) return -1;
+            uintptr_t expected = 0;
+            if (atomic_compare_exchange_strong(&lock_keys[i], &expected, key)) {
+                atomic_fetch_add_explicit(&lock_total, 1, memory_order_relaxed);
+                return (int)i;
+            }
+            if (expected == key) {
+                return (int)i;
+            }
+        }
+        i = (i + 1) & mask;
+    }
+    return -1;
+}
+
+// Breadth-first search for a path start -> ... -> target; fills the cycle steps
+static int find_path(int start, int target, DeadlockStep *steps, int *length) {
+    int head = 0, tail = 0, found = -1;
+    search_generation++;
+    search_queue[tail] = start;
+    search_parent[tail++] = -1;
+    search_seen[start] = search_generation;
+    while (head < tail && found < 0) {
+        int node = search_queue[head];
+        int edge = atomic_load_explicit(&lock_edge_head[node], memory_order_acquire) - 1;
+        while (edge >= 0) {
+            uint64_t key = atomic_load_explicit(&edge_keys[edge], memory_order_relaxed);
+            int next = (int)(key & 0xffffffffu) - 1;
+            if (next == target) {
+                found = head;
+                break;
+            }
+            if (search_seen[next] != search_generation && tail < LOCKDEP_MAX_SEARCH) {
+                search_seen[next] = search_generation;
+                search_queue[tail] = next;
+                search_parent[tail++] = head;
+            }
+            edge = atomic_load_explicit(&edge_next[edge], memory_order_acquire) - 1;
+        }
+        head++;
+    }
+    if (found < 0) {
+        return 0;
+    }
+    // Walk back from the last hop to start, then append target -> start
+    int path[DEADLOCK_MAX_STEPS];
+    int count = 0;
+    for (int at = found; at >= 0 && count < DEADLOCK_MAX_STEPS - 1; at = search_parent[at]) {
+        path[count++] = search_queue[at];
+    }
+    *length = 0;
+    steps[(*length)].owner = -1;
+    steps[(*length)].held = target + 1;
+    steps[(*length)++].wanted = start + 1;
+    for (int k = count - 1; k >= 0; k--) {
+        steps[*length].owner = -1;
+        steps[*length].held = path[k] + 1;
+        steps[*length].wanted = (k > 0 ? path[k - 1] : target) + 1;
+        (*length)++;
+    }
+    return 1;
+}
+
+// Record "from held while acquiring to"; new dependencies are checked for cycles
+static void add_dependency(int from, int to) {
+    uint64_t key = ((uint64_t)(from + 1) << 32) | (uint32_t)(to + 1);
+    uint32_t cached = hash_word(key) & (LOCKDEP_EDGE_CACHE - 1);
+    if (edge_cache[cached] == key) {
+        return;
+    }
+    uint32_t mask = LOCKDEP_MAX_EDGES - 1;
+    uint32_t i = hash_word(key * 0x9e3779b97f4a7c15ULL) & mask;
+    for (int probe = 0; probe < LOCKDEP_MAX_EDGES; probe++) {
+        uint64_t current = atomic_load_explicit(&edge_keys[i], memory_order_acquire);
+        if (current == key) {
+            edge_cache[cached] = key;
+            return;
+        }
+        if (current == 0) {
+            uint64_t expected = 0;
+            if (atomic_compare_exchange_strong(&edge_keys[i], &expected, key)) {
+                break;
+            }
+            if (expected == key) {
+                edge_cache[cached] = key;
+                return;
+            }
+        }
+        i = (i + 1) & mask;
+        if (probe == LOCKDEP_MAX_EDGES - 1) return;   // edge table full
+    }
+    edge_cache[cached] = key;
+    atomic_fetch_add_explicit(&edge_total, 1, memory_order_relaxed);
+
+    // Publish the edge in the source lock's adjacency list
+    int head = atomic_load_explicit(&lock_edge_head[from], memory_order_relaxed);
+    do {
+        atomic_store_explicit(&edge_next[i], head, memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(&lock_edge_head[from], &head, (int)i + 1,
+                                                    memory_order_release, memory_order_relaxed));
+
+    DeadlockStep steps[DEADLOCK_MAX_STEPS];
+    int length = 0;
+    real_lock(&search_lock);
+    int cycle = find_path(to, from, steps, &length);
+    real_unlock(&search_lock);
+    if (cycle) {
+        atomic_fetch_add_explicit(&potential_total, 1, memory_order_relaxed);
+        report_deadlock_cycle("lockdep", 0, steps, length);
+    }
+}
+
+// Follow owner -> awaited lock -> owner from a contended acquisition
+static void check_wait_cycle(int self, int wanted) {
+    DeadlockStep steps[DEADLOCK_MAX_STEPS];
+    int thread = self;
+    int lock = wanted;
+    for (int n = 0; n < DEADLOCK_MAX_STEPS; n++) {
+        int owner = atomic_load_explicit(&lock_owner[lock], memory_order_acquire) - 1;
+        if (owner < 0) return;
+        steps[n].owner = atomic_load_explicit(&thread_tid[thread], memory_order_relaxed);
+        steps[n].wanted = lock + 1;
+        if (owner == self) {
+            int length = n + 1;
+            for (int k = 0; k < length; k++) {
+                steps[k].held = steps[(k + length - 1) % length].wanted;
+            }
+            atomic_fetch_add_explicit(&actual_total, 1, memory_order_relaxed);
+            report_deadlock_cycle("lockdep", 1, steps, length);
+            return;
+        }
+        int next = atomic_load_explicit(&thread_waiting[owner], memory_order_acquire) - 1;
+        if (next < 0) return;
+        thread = owner;
+        lock = next;
+    }
+}
+
+// Bookkeeping before a blocking acquisition; returns the lock slot or -1
+static int before_acquire(pthread_mutex_t *mutex, int *self) {
+    *self = current_thread_slot();
+    int slot = lock_slot(mutex, 1);
+    if (*self < 0 || slot < 0) {
+        return -1;
+    }
+    if (held_count > 0) {
+        int top = held_count < LOCKDEP_MAX_HELD ? held_count : LOCKDEP_MAX_HELD;
+        add_dependency(held[top - 1], slot);
+    }
+    return slot;
+}
+
+static void after_acquire(int slot, int self) {
+    atomic_store_explicit(&lock_owner[slot], self + 1, memory_order_release);
+    if (held_count < LOCKDEP_MAX_HELD) {
+        held[held_count] = slot;
+    }
+    held_count++;
+}
+
+static int tracked_lock(pthread_mutex_t *mutex, const struct timespec *deadline) {
+    int self;
+    in_lockdep = 1;
+    int slot = before_acquire(mutex, &self);
+    in_lockdep = 0;
+    if (slot < 0) {
+        return deadline ? real_timedlock(mutex, deadline) : real_lock(mutex);
+    }
+
+    int rc = real_trylock(mutex);
+    if (rc == EBUSY) {
+        // Contended: publish what we wait for and look for a circular wait
+        atomic_store_explicit(&thread_waiting[self], slot + 1, memory_order_release);
+        in_lockdep = 1;
+        check_wait_cycle(self, slot);
+        in_lockdep = 0;
+        rc = deadline ? real_timedlock(mutex, deadline) : real_lock(mutex);
+        atomic_store_explicit(&thread_waiting[self], 0, memory_order_release);
+    }
+    if (rc == 0) {
+        after_acquire(slot, self);
+    }
+    return rc;
+}
+
+int pthread_mutex_lock(pthread_mutex_t *mutex) {
+    if (real_lock == NULL) resolve_real_functions();
+    if (in_lockdep) return real_lock(mutex);
+    return tracked_lock(mutex, NULL);
+}
+
+int pthread_mutex_timedlock(pthread_mutex_t *mutex, const struct timespec *deadline) {
+    if (real_timedlock == NULL) resolve_real_functions();
+    if (in_lockdep) return real_timedlock(mutex, deadline);
+    return tracked_lock(mutex, deadline);
+}
+
+int pthread_mutex_trylock(pthread_mutex_t *mutex) {
+    if (real_trylock == NULL) resolve_real_functions();
+    int rc = real_trylock(mutex);
+    if (rc == 0 && !in_lockdep) {
+        // A trylock cannot block, so it adds no dependency, but it is held
+        int self = current_thread_slot();
+        int slot = lock_slot(mutex, 1);
+        if (self >= 0 && slot >= 0) {
+            after_acquire(slot, self);
+        }
+    }
+    return rc;
+}
+
+int pthread_mutex_unlock(pthread_mutex_t *mutex) {
+    if (real_unlock == NULL) resolve_real_functions();
+    if (!in_lockdep && held_count > 0) {
+        int slot = lock_slot(mutex, 0);
+        if (slot >= 0) {
+            // Usually the top of the stack; out-of-order unlocks are searched for
+            int top = held_count < LOCKDEP_MAX_HELD ? held_count : LOCKDEP_MAX_HELD;
+            int k = top - 1;
+            while (k >= 0 && held[k] != slot) k--;
+            if (k >= 0) {
+                memmove(&held[k], &held[k + 1], sizeof(int) * (top - 1 - k));
+                held_count--;
+            } else if (held_count > LOCKDEP_MAX_HELD) {
+                held_count--;   // was beyond the tracked depth
+            }
+            atomic_store_explicit(&lock_owner[slot], 0, memory_order_release);
+        }
+    }
+    return real_unlock(mutex);
+}
@@ -4,14 +4,110 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "process_manager.h"
 #include "fault_injection.h"
 #include "recovery.h"
 #include "visualization.h"
 #include "algorithms.h"
 #include "ui.h"
+#include "multicore.h"
+#include "real_faults.h"
+#include "checkpoint.h"
+#include "trace.h"
+#include "timeline.h"
+#include "arena.h"
+#include "io_scheduler.h"
+#include "sweep.h"
+#include "priority_sched.h"
+#include "chaos.h"
+#include "workload_gen.h"
+#include "cgroup_monitor.h"
+#include "dist_deadlock.h"
+#include "victim.h"
+#include "console.h"
+#include "memtrace.h"
+#include "swap_sim.h"
+
+static void run_menu();
+
+// Batch modes that run without the interactive menu
+static int run_command(int argc, char *argv[]) {
+    if (strcmp(argv[1], "multicore") == 0) {
+        return multicore_command(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "real-faults") == 0) {
+        return real_faults_command(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "checkpoint") == 0) {
+        return checkpoint_command(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "trace") == 0) {
+        return trace_command(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "io") == 0) {
+        return io_command(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "sweep") == 0) {
+        return sweep_command(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "priority") == 0) {
+        return priority_command(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "chaos") == 0) {
+        return chaos_command(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "workload") == 0) {
+        return workload_command(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "cgroups") == 0) {
+        return cgroup_command(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "distributed") == 0) {
+        return dist_command(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "victims") == 0) {
+        return victim_command(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "memtrace") == 0) {
+        return memtrace_command(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "swap") == 0) {
+        return swap_command(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "live") == 0) {
+        return console_command(argc - 2, argv + 2);
+    }
+    if (strcmp(argv[1], "restore") == 0 && argc > 2) {
+        // Resume a saved campaign straight into the menu, skipping the welcome screen
+        enable_console_colors();
+        if (!checkpoint_restore(argv[2])) {
+            return 1;
+        }
+        run_menu();
+        return 0;
+    }
+    printf("Unknown command: %s\n", argv[1]);
+    printf("Usage: %s [multicore ... | real-faults ... | checkpoint ... | restore <file> | trace ... | io ... | sweep ... | priority ... | chaos ... | workload ... | cgroups ... | distributed ... | victims ... | live ... | memtrace ... | swap ...]\n", argv[0]);
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    // SIM_TIMELINE=<file> streams the run's schedule and faults as a Chrome trace
+    const char *timeline_path = getenv("SIM_TIMELINE");
+    if (timeline_path != NULL && timeline_path[0] != '\0' && timeline_open(timeline_path)) {
+        atexit(timeline_close);
+    }
+    // SIM_MEMTRACE=<file> replays a libmemtrace.so recording in the page replacement comparison
+    const char *memtrace_path = getenv("SIM_MEMTRACE");
+    if (memtrace_path != NULL && memtrace_path[0] != '\0') {
+        memtrace_use_for_comparison(memtrace_path);
+    }
+
+    if (argc > 1) {
+        return run_command(argc, argv);
+    }
 
-int main() {
     // Initialize enhanced UI
     enable_console_colors();
     display_welcome_screen();
@@ -22,12 +118,29 @@ int main() {
     printf("\n✅ System initialized successfully!\n");
     pause_with_message("Press Enter to continue...");
 
+    run_menu();
+    return 0;
+}
+
+static void run_menu() {
+    // On a terminal the simulation runs on its own thread behind a live view;
+    // pipes and scripts keep the line-at-a-time menu below
+    if (console_available()) {
+        ConsoleConfig config;
+        console_default_config(&config);
+        console_run(&config);
+        return;
+    }
+
     int choice = 0;
     while(1) {
         // Display enhanced system monitor
         display_system_monitor();
         display_main_menu_enhanced();
         
+        // Every menu action is one run: its scratch memory is dropped in O(1)
+        run_arena_reset();
+
         if (scanf("%d", &choice) != 1) {
             printf("[X] Invalid input! Please enter a number.\n");
             while(getchar() != '\n'); // Clear input buffer
@@ -58,12 +171,35 @@ int main() {
                 break;
                 
             case 4:
+                display_fault_injection_animation("I/O STORM");
+                inject_io_storm();
+                display_recovery_animation("I/O THROTTLING");
+                detect_and_fix_io_storm();
+                break;
+                
+            case 5:
+                display_fault_injection_animation("PRIORITY INVERSION");
+                inject_priority_inversion();
+                display_recovery_animation("PRIORITY INHERITANCE");
+                detect_and_fix_priority_inversion();
+                break;
+                
+            case 6:
+                display_fault_injection_animation("STARVATION");
+                inject_starvation();
+                display_recovery_animation("PRIORITY AGING");
+                detect_and_fix_starvation();
+                break;
+                
+            case 7:
                 printf("\n[@] Displaying Algorithm Comparisons...\n");
                 display_scheduling_comparison();
+                display_multicore_scheduling();
                 display_page_replacement_comparison();
+                display_io_scheduling_comparison();
                 break;
                 
-            case 5:
+            case 8:
                 printf("\n[?] Running Complete System Analysis...\n");
                 bankers_algorithm();
                 detect_deadlock_cycle();
@@ -72,14 +208,14 @@ int main() {
                 display_resource_graph();
                 break;
                 
-            case 6:
+            case 9:
                 printf("\n[#] Performance Dashboard\n");
                 display_gantt_chart_enhanced();
                 display_memory_map_enhanced();
                 display_status_panel();
                 break;
                 
-            case 7:
+            case 10:
                 clear_screen_enhanced();
                 printf("==========================================\n");
                 printf("                                          \n");
@@ -93,12 +229,10 @@ int main() {
                 exit(0);
                 
             default:
-                printf("[X] Invalid choice! Please select 1-7.\n");
+                printf("[X] Invalid choice! Please select 1-10.\n");
         }
 
         // Pause before returning to menu
         pause_with_message("Press Enter to return to main menu...");
     }
-
-    return 0;
 }
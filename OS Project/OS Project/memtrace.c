@@ -0,0 +1,209 @@
+/*
+ * memtrace.c - Loading page traces recorded by libmemtrace.so
+ *
+ * Raw pages in a trace are arena page numbers; they are renumbered densely in
+ * first-seen order so the reference string plugs straight into the FIFO, LRU
+ * and CLOCK kernels, the sweep grid and the menu's comparison.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "memtrace.h"
+#include "algorithms.h"
+#include "timing.h"
+
+int memtrace_is_trace(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return 0;
+    char magic[4];
+    int match = fread(magic, 1, 4, file) == 4 && memcmp(magic, MEMTRACE_MAGIC, 4) == 0;
+    fclose(file);
+    return match;
+}
+
+// Raw page -> dense id, open addressed; keys stored + 1 so 0 marks a free slot
+typedef struct {
+    unsigned long long *keys;
+    int *ids;
+    unsigned int mask;
+    int used;
+} PageIds;
+
+static int page_ids_grow(PageIds *table) {
+    unsigned int capacity = table->mask == 0 ? 4096 : (table->mask + 1) * 2;
+    unsigned long long *keys = calloc(capacity, sizeof(*keys));
+    int *ids = malloc(sizeof(int) * capacity);
+    if (keys == NULL || ids == NULL) {
+        free(keys);
+        free(ids);
+        return 0;
+    }
+    for (unsigned int i = 0; table->mask != 0 && i <= table->mask; i++) {
+        if (table->keys[i] == 0) continue;
+        unsigned int slot = (unsigned int)(table->keys[i] * 0x9e3779b97f4a7c15ULL >> 32) & (capacity - 1);
+        while (keys[slot] != 0) slot = (slot + 1) & (capacity - 1);
+        keys[slot] = table->keys[i];
+        ids[slot] = table->ids[i];
+    }
+    free(table->keys);
+    free(table->ids);
+    table->keys = keys;
+    table->ids = ids;
+    table->mask = capacity - 1;
+    return 1;
+}
+
+static int page_id(PageIds *table, unsigned long long page) {
+    if ((unsigned int)table->used * 2 >= table->mask && !page_ids_grow(table)) return -1;
+    unsigned long long key = page + 1;
+    unsigned int slot = (unsigned int)(key * 0x9e3779b97f4a7c15ULL >> 32) & table->mask;
+    while (table->keys[slot] != 0) {
+        if (table->keys[slot] == key) return table->ids[slot];
+        slot = (slot + 1) & table->mask;
+    }
+    table->keys[slot] = key;
+    table->ids[slot] = table->used;
+    return table->used++;
+}
+
+// Parse a whole trace image; 1 on success
+int memtrace_decode(const unsigned char *data, size_t size, MemTrace *trace) {
+    memset(trace, 0, sizeof(*trace));
+    if (size < MEMTRACE_HEADER_BYTES || memcmp(data, MEMTRACE_MAGIC, 4) != 0 ||
+        (data[4] | data[5] << 8) != MEMTRACE_VERSION || data[6] > 30) {
+        return 0;
+    }
+    trace->page_size = 1 << data[6];
+    unsigned long interval_us = 0;
+    for (int i = 0; i < 4; i++) interval_us |= (unsigned long)data[8 + i] << (8 * i);
+    trace->interval_ms = interval_us / 1000.0;
+
+    PageIds table = {NULL, NULL, 0, 0};
+    int capacity = 0;
+    long long page = 0;
+    size_t at = MEMTRACE_HEADER_BYTES;
+    int ok = 1;
+    while (at < size && ok) {
+        unsigned long long value = 0;
+        int shift = 0;
+        for (;;) {
+            if (at >= size) {
+                value = 1;      // cut short (the program died mid-write): keep what came before
+                break;
+            }
+            if (shift > 63) {
+                ok = 0;
+                break;
+            }
+            unsigned char byte = data[at++];
+            value |= (unsigned long long)(byte & 0x7f) << shift;
+            shift += 7;
+            if (!(byte & 0x80)) break;
+        }
+        if (!ok) break;
+        if (value & 1) {
+            trace->intervals += (long long)(value >> 1);
+            continue;
+        }
+        unsigned long long zigzag = value >> 1;
+        page += (long long)(zigzag >> 1) ^ -(long long)(zigzag & 1);
+        if (trace->count == capacity) {
+            if (capacity >= (1 << 30)) {
+                ok = 0;
+                break;
+            }
+            capacity = capacity == 0 ? 65536 : capacity * 2;
+            int *grown = realloc(trace->pages, sizeof(int) * (size_t)capacity);
+            if (grown == NULL) {
+                ok = 0;
+                break;
+            }
+            trace->pages = grown;
+        }
+        int id = page_id(&table, (unsigned long long)page);
+        if (id < 0) {
+            ok = 0;
+            break;
+        }
+        trace->pages[trace->count++] = id;
+    }
+    trace->distinct = table.used;
+    free(table.keys);
+    free(table.ids);
+    if (!ok || trace->count == 0) {
+        memtrace_free(trace);
+        return 0;
+    }
+    return 1;
+}
+
+int memtrace_load(const char *path, MemTrace *trace) {
+    memset(trace, 0, sizeof(*trace));
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return 0;
+    size_t capacity = 1 << 20, size = 0;
+    unsigned char *data = malloc(capacity);
+    while (data != NULL) {
+        size += fread(data + size, 1, capacity - size, file);
+        if (size < capacity) break;
+        unsigned char *grown = realloc(data, capacity * 2);
+        if (grown == NULL) {
+            free(data);
+            data = NULL;
+            break;
+        }
+        data = grown;
+        capacity *= 2;
+    }
+    fclose(file);
+    int ok = data != NULL && memtrace_decode(data, size, trace);
+    free(data);
+    return ok;
+}
+
+void memtrace_free(MemTrace *trace) {
+    free(trace->pages);
+    trace->pages = NULL;
+    trace->count = 0;
+}
+
+static void print_summary(const char *path, const MemTrace *trace) {
+    printf("Trace %s: %d references to %d distinct pages (%.1f MB touched) over %lld intervals of %.1f ms\n",
+           path, trace->count, trace->distinct, (double)trace->distinct * trace->page_size / (1024.0 * 1024.0),
+           trace->intervals, trace->interval_ms);
+}
+
+// Make the menu's FIFO/LRU comparison replay this trace (SIM_MEMTRACE)
+int memtrace_use_for_comparison(const char *path) {
+    static MemTrace trace;
+    memtrace_free(&trace);
+    set_page_reference_trace(NULL, 0, 0, NULL);
+    if (!memtrace_load(path, &trace)) {
+        printf("Could not read memory trace %s\n", path);
+        return 0;
+    }
+    set_page_reference_trace(trace.pages, trace.count, trace.distinct, path);
+    return 1;
+}
+
+int memtrace_command(int argc, char *argv[]) {
+    if (argc < 1) {
+        printf("Usage: memtrace <trace.mtr>\n");
+        printf("Record one with: LD_PRELOAD=./libmemtrace.so MEMTRACE_INTERVAL_MS=10 ./program\n");
+        return 1;
+    }
+    MemTrace trace;
+    double started = monotonic_seconds();
+    if (!memtrace_load(argv[0], &trace)) {
+        printf("Could not read memory trace %s\n", argv[0]);
+        return 1;
+    }
+    double loaded = monotonic_seconds();
+    print_summary(argv[0], &trace);
+    printf("Decoded in %.1f ms\n\n", (loaded - started) * 1000.0);
+    display_page_replacement_table(trace.pages, trace.count, trace.distinct);
+    printf("\nReplayed in %.2f s\n", monotonic_seconds() - loaded);
+    memtrace_free(&trace);
+    return 0;
+}
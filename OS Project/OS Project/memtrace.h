@@ -0,0 +1,38 @@
+/*
+ * memtrace.h - Header for page-granular memory traces of real programs
+ *
+ * File format (written by libmemtrace.so, little endian):
+ *   16-byte header: "MTRC", u16 version, u16 log2(page size), u32 interval in
+ *   microseconds, u32 reserved
+ *   then a stream of LEB128 varints:
+ *     (zigzag(page - previous page) << 1)   one reference (first touch of a
+ *                                           page in the current interval)
+ *     (n << 1) | 1                          n sampling intervals ended
+ */
+
+#ifndef MEMTRACE_H
+#define MEMTRACE_H
+
+#include <stddef.h>
+
+#define MEMTRACE_MAGIC "MTRC"
+#define MEMTRACE_VERSION 1
+#define MEMTRACE_HEADER_BYTES 16
+
+typedef struct {
+    int *pages;                     // dense page ids in first-seen order, 0..distinct-1
+    int count;
+    int distinct;
+    long long intervals;
+    int page_size;
+    double interval_ms;
+} MemTrace;
+
+int memtrace_is_trace(const char *path);
+int memtrace_decode(const unsigned char *data, size_t size, MemTrace *trace);
+int memtrace_load(const char *path, MemTrace *trace);
+void memtrace_free(MemTrace *trace);
+int memtrace_use_for_comparison(const char *path);
+int memtrace_command(int argc, char *argv[]);
+
+#endif // MEMTRACE_H
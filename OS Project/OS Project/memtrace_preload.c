@@ -0,0 +1,870 @@
+/*
+ * memtrace_preload.c - LD_PRELOAD page-touch tracer for real programs
+ *
+ * Allocations of MEMTRACE_MIN_KB or more are served page-aligned from one
+ * reserved arena instead of the C library heap. At the start of every
+ * sampling interval the used part of the arena is made PROT_NONE with a
+ * single mprotect(); the first access to each page then raises SIGSEGV, the
+ * handler records the page and opens it again, and the program continues.
+ * Each interval therefore contributes the pages it touched in first-touch
+ * order, which is the reference string the page replacement code replays.
+ * A longer interval means fewer faults: overhead is set by the interval.
+ *
+ * The handler only claims a slot in a lock-free ring; a sampler thread
+ * re-arms the arena, drains the ring and writes the delta-encoded trace
+ * (format in memtrace.h). The kernel must never hit a protected page, so
+ * the calls that hand a data buffer to it - read/write, pread/pwrite,
+ * readv/writev, preadv/pwritev, recv/send, recvfrom/sendto, recvmsg/sendmsg
+ * and fread/fwrite with their _unlocked variants - copy arena buffers
+ * through a bounce buffer. Less common calls handed a large heap buffer
+ * directly (io_uring, splice of user memory, ...) can still see EFAULT.
+ *
+ * Build: gcc -std=c11 -O2 -fPIC -shared -pthread memtrace_preload.c -o libmemtrace.so -ldl
+ * Use:   LD_PRELOAD=./libmemtrace.so ./program ; ./simulation memtrace memtrace.<pid>.mtr
+ * Env:   MEMTRACE_FILE=<file> (%p = pid, default memtrace.%p.mtr),
+ *        MEMTRACE_INTERVAL_MS=10, MEMTRACE_MIN_KB=64, MEMTRACE_ARENA_MB=4096,
+ *        MEMTRACE_SUMMARY=1 prints totals at exit
+ *
+ * Pages are numbered within the arena, so two runs of the same program give
+ * comparable traces; small allocations (and the C library's own mmap'd
+ * chunks) are not traced.
+ */
+
+#define _GNU_SOURCE
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include "memtrace.h"
+
+#define MEMTRACE_PAGE_SHIFT 12
+#define MEMTRACE_PAGE ((size_t)1 << MEMTRACE_PAGE_SHIFT)
+#define MEMTRACE_RING 1048576           // touches waiting for the sampler, power of two
+#define MEMTRACE_MAX_FREE_RUNS 4096
+#define MEMTRACE_OUT_BYTES 65536
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+void __libc_free(void *pointer);
+
+typedef ssize_t (*read_fn)(int, void *, size_t);
+typedef ssize_t (*write_fn)(int, const void *, size_t);
+typedef ssize_t (*pread_fn)(int, void *, size_t, off_t);
+typedef ssize_t (*pwrite_fn)(int, const void *, size_t, off_t);
+typedef ssize_t (*recv_fn)(int, void *, size_t, int);
+typedef ssize_t (*send_fn)(int, const void *, size_t, int);
+typedef size_t (*fread_fn)(void *, size_t, size_t, FILE *);
+typedef size_t (*fwrite_fn)(const void *, size_t, size_t, FILE *);
+typedef ssize_t (*readv_fn)(int, const struct iovec *, int);
+typedef ssize_t (*preadv_fn)(int, const struct iovec *, int, off_t);
+typedef ssize_t (*recvfrom_fn)(int, void *, size_t, int, struct sockaddr *, socklen_t *);
+typedef ssize_t (*sendto_fn)(int, const void *, size_t, int, const struct sockaddr *, socklen_t);
+typedef ssize_t (*recvmsg_fn)(int, struct msghdr *, int);
+typedef ssize_t (*sendmsg_fn)(int, const struct msghdr *, int);
+typedef int (*sigaction_fn)(int, const struct sigaction *, struct sigaction *);
+typedef size_t (*usable_fn)(void *);
+
+static read_fn real_read;
+static write_fn real_write;
+static pread_fn real_pread;
+static pwrite_fn real_pwrite;
+static recv_fn real_recv;
+static send_fn real_send;
+static fread_fn real_fread;
+static fwrite_fn real_fwrite;
+static fread_fn real_fread_unlocked;
+static fwrite_fn real_fwrite_unlocked;
+static readv_fn real_readv;
+static readv_fn real_writev;
+static preadv_fn real_preadv;
+static preadv_fn real_pwritev;
+static recvfrom_fn real_recvfrom;
+static sendto_fn real_sendto;
+static recvmsg_fn real_recvmsg;
+static sendmsg_fn real_sendmsg;
+static sigaction_fn real_sigaction;
+static usable_fn real_usable_size;
+
+// ---- arena: page-granular blocks, bump allocated, freed runs reused first-fit ----
+static char *arena_base;                // NULL until the tracer is set up
+static size_t arena_pages;
+static atomic_size_t arena_used;        // pages below the bump pointer
+static uint32_t *block_pages;           // pages of the block starting at each page, 0 = none
+static struct {
+    uint32_t start;
+    uint32_t pages;
+} free_runs[MEMTRACE_MAX_FREE_RUNS];
+static int free_run_count;
+static pthread_mutex_t arena_lock = PTHREAD_MUTEX_INITIALIZER;
+static size_t min_bytes = 64 * 1024;
+static size_t peak_pages;
+static long long blocks_allocated;
+
+// ---- touch ring: handlers claim slots, the sampler drains them in order ----
+static _Atomic uint32_t ring[MEMTRACE_RING];    // page + 1, 0 = not written yet
+static atomic_ullong ring_head;
+static atomic_ullong ring_tail;
+static atomic_llong dropped;
+static atomic_int tracing;              // handlers record and the sampler re-arms
+static atomic_int map_limit_hit;
+
+// ---- sampler and output (sampler thread, then the destructor) ----
+static pthread_t sampler;
+static int sampler_started;
+static atomic_int stopping;
+static long interval_us = 10000;
+static int out_fd = -1;
+static unsigned char out_buffer[MEMTRACE_OUT_BYTES];
+static size_t out_used;
+static uint32_t last_page;
+static long long pending_intervals;
+static long long references;
+static long long intervals;
+static char out_path[512];
+
+static struct sigaction chained;        // the program's own SIGSEGV disposition
+static int handler_installed;
+
+static void resolve_real_functions() {
+    real_read = (read_fn)dlsym(RTLD_NEXT, "read");
+    real_write = (write_fn)dlsym(RTLD_NEXT, "write");
+    real_pread = (pread_fn)dlsym(RTLD_NEXT, "pread");
+    real_pwrite = (pwrite_fn)dlsym(RTLD_NEXT, "pwrite");
+    real_recv = (recv_fn)dlsym(RTLD_NEXT, "recv");
+    real_send = (send_fn)dlsym(RTLD_NEXT, "send");
+    real_fread = (fread_fn)dlsym(RTLD_NEXT, "fread");
+    real_fwrite = (fwrite_fn)dlsym(RTLD_NEXT, "fwrite");
+    real_fread_unlocked = (fread_fn)dlsym(RTLD_NEXT, "fread_unlocked");
+    real_fwrite_unlocked = (fwrite_fn)dlsym(RTLD_NEXT, "fwrite_unlocked");
+    real_readv = (readv_fn)dlsym(RTLD_NEXT, "readv");
+    real_writev = (readv_fn)dlsym(RTLD_NEXT, "writev");
+    real_preadv = (preadv_fn)dlsym(RTLD_NEXT, "preadv");
+    real_pwritev = (preadv_fn)dlsym(RTLD_NEXT, "pwritev");
+    real_recvfrom = (recvfrom_fn)dlsym(RTLD_NEXT, "recvfrom");
+    real_sendto = (sendto_fn)dlsym(RTLD_NEXT, "sendto");
+    real_recvmsg = (recvmsg_fn)dlsym(RTLD_NEXT, "recvmsg");
+    real_sendmsg = (sendmsg_fn)dlsym(RTLD_NEXT, "sendmsg");
+    real_sigaction = (sigaction_fn)dlsym(RTLD_NEXT, "sigaction");
+    real_usable_size = (usable_fn)dlsym(RTLD_NEXT, "malloc_usable_size");
+}
+
+static int in_arena(const void *pointer) {
+    return arena_base != NULL && (const char *)pointer >= arena_base &&
+           (const char *)pointer < arena_base + (arena_pages << MEMTRACE_PAGE_SHIFT);
+}
+
+static int overlaps_arena(const void *pointer, size_t length) {
+    return arena_base != NULL && (const char *)pointer < arena_base + (arena_pages << MEMTRACE_PAGE_SHIFT) &&
+           (const char *)pointer + length > arena_base;
+}
+
+// ---- fault path (async-signal-safe) ----
+static void record(uint32_t page) {
+    unsigned long long head = atomic_load_explicit(&ring_head, memory_order_relaxed);
+    do {
+        if (head - atomic_load_explicit(&ring_tail, memory_order_acquire) >= MEMTRACE_RING) {
+            atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+            return;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&ring_head, &head, head + 1,
+                                                    memory_order_acq_rel, memory_order_relaxed));
+    atomic_store_explicit(&ring[head & (MEMTRACE_RING - 1)], page + 1, memory_order_release);
+}
+
+static void on_fault(int signo, siginfo_t *info, void *context) {
+    char *address = info->si_addr;
+    size_t used = atomic_load_explicit(&arena_used, memory_order_acquire);
+    if (arena_base != NULL && address >= arena_base && address < arena_base + (used << MEMTRACE_PAGE_SHIFT)) {
+        uint32_t page = (uint32_t)((size_t)(address - arena_base) >> MEMTRACE_PAGE_SHIFT);
+        if (mprotect(arena_base + ((size_t)page << MEMTRACE_PAGE_SHIFT), MEMTRACE_PAGE,
+                     PROT_READ | PROT_WRITE) == 0) {
+            if (atomic_load_explicit(&tracing, memory_order_relaxed)) record(page);
+            return;
+        }
+        // Too many split mappings (vm.max_map_count): stop sampling for good
+        atomic_store(&tracing, 0);
+        atomic_store(&map_limit_hit, 1);
+        mprotect(arena_base, used << MEMTRACE_PAGE_SHIFT, PROT_READ | PROT_WRITE);
+        return;
+    }
+    // Not ours: behave as if the program's own disposition had run
+    if ((chained.sa_flags & SA_SIGINFO) && chained.sa_sigaction != NULL) {
+        chained.sa_sigaction(signo, info, context);
+    } else if (chained.sa_handler == SIG_IGN) {
+        return;
+    } else if (chained.sa_handler != SIG_DFL && chained.sa_handler != NULL) {
+        chained.sa_handler(signo);
+    } else {
+        struct sigaction fallback;
+        memset(&fallback, 0, sizeof(fallback));
+        fallback.sa_handler = SIG_DFL;
+        real_sigaction(SIGSEGV, &fallback, NULL);   // the access faults again and terminates
+    }
+}
+
+// ---- trace output ----
+static void flush_output() {
+    size_t done = 0;
+    while (out_fd >= 0 && done < out_used) {
+        ssize_t n = real_write(out_fd, out_buffer + done, out_used - done);
+        if (n <= 0) break;
+        done += (size_t)n;
+    }
+    out_used = 0;
+}
+
+static void put_varint(unsigned long long value) {
+    while (value >= 0x80) {
+        out_buffer[out_used++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out_buffer[out_used++] = (unsigned char)value;
+    if (out_used > MEMTRACE_OUT_BYTES - 32) flush_output();
+}
+
+static void emit_intervals() {
+    if (pending_intervals > 0) {
+        put_varint(((unsigned long long)pending_intervals << 1) | 1);
+        pending_intervals = 0;
+    }
+}
+
+static void emit_reference(uint32_t page) {
+    emit_intervals();
+    long long delta = (long long)page - (long long)last_page;
+    unsigned long long zigzag = ((unsigned long long)delta << 1) ^ (unsigned long long)(delta >> 63);
+    put_varint(zigzag << 1);
+    last_page = page;
+    references++;
+}
+
+// Move every touch claimed before until into the file
+static void drain(unsigned long long until) {
+    unsigned long long tail = atomic_load_explicit(&ring_tail, memory_order_relaxed);
+    for (; tail < until; tail++) {
+        _Atomic uint32_t *slot = &ring[tail & (MEMTRACE_RING - 1)];
+        uint32_t value;
+        while ((value = atomic_load_explicit(slot, memory_order_acquire)) == 0) {
+            sched_yield();      // claimed by a handler that has not stored yet
+        }
+        atomic_store_explicit(slot, 0, memory_order_relaxed);
+        emit_reference(value - 1);
+    }
+    atomic_store_explicit(&ring_tail, tail, memory_order_release);
+}
+
+// Close the current interval: touches so far belong to it, then re-arm
+static void end_interval() {
+    unsigned long long until = atomic_load_explicit(&ring_head, memory_order_acquire);
+    size_t used = atomic_load_explicit(&arena_used, memory_order_acquire);
+    if (used > 0 && atomic_load(&tracing)) {
+        mprotect(arena_base, used << MEMTRACE_PAGE_SHIFT, PROT_NONE);
+    }
+    drain(until);
+    pending_intervals++;
+    intervals++;
+    flush_output();
+}
+
+static void *sampler_main(void *arg) {
+    (void)arg;
+    struct timespec pause = {interval_us / 1000000, (interval_us % 1000000) * 1000};
+    while (!atomic_load(&stopping)) {
+        nanosleep(&pause, NULL);
+        if (atomic_load(&tracing)) end_interval();
+    }
+    return NULL;
+}
+
+// A forked child keeps the arena but not the sampler or the file
+static void after_fork_child() {
+    atomic_store(&tracing, 0);
+    sampler_started = 0;
+    out_fd = -1;
+    size_t used = atomic_load(&arena_used);
+    if (used > 0) mprotect(arena_base, used << MEMTRACE_PAGE_SHIFT, PROT_READ | PROT_WRITE);
+}
+
+static void format_path(const char *pattern) {
+    size_t used = 0;
+    for (const char *p = pattern; *p != '\0' && used < sizeof(out_path) - 24; p++) {
+        if (p[0] == '%' && p[1] == 'p') {
+            used += (size_t)snprintf(out_path + used, sizeof(out_path) - used, "%d", (int)getpid());
+            p++;
+        } else {
+            out_path[used++] = *p;
+        }
+    }
+    out_path[used] = '\0';
+}
+
+__attribute__((constructor))
+static void memtrace_init() {
+    resolve_real_functions();
+    const char *value;
+    if ((value = getenv("MEMTRACE_INTERVAL_MS")) != NULL && atof(value) > 0) {
+        interval_us = (long)(atof(value) * 1000.0);
+        if (interval_us < 100) interval_us = 100;
+    }
+    if ((value = getenv("MEMTRACE_MIN_KB")) != NULL && atol(value) > 0) {
+        min_bytes = (size_t)atol(value) * 1024;
+    }
+    size_t arena_mb = 4096;
+    if ((value = getenv("MEMTRACE_ARENA_MB")) != NULL && atol(value) > 0) {
+        arena_mb = (size_t)atol(value);
+    }
+    format_path((value = getenv("MEMTRACE_FILE")) != NULL ? value : "memtrace.%p.mtr");
+
+    size_t pages = arena_mb << (20 - MEMTRACE_PAGE_SHIFT);
+    if (pages > UINT32_MAX) pages = UINT32_MAX;
+    void *base = mmap(NULL, pages << MEMTRACE_PAGE_SHIFT, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    void *sizes = mmap(NULL, pages * sizeof(uint32_t), PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    out_fd = open(out_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (base == MAP_FAILED || sizes == MAP_FAILED || out_fd < 0) {
+        fprintf(stderr, "[memtrace] not tracing: cannot reserve %zu MB or open %s\n", arena_mb, out_path);
+        if (out_fd >= 0) close(out_fd);
+        out_fd = -1;
+        return;
+    }
+
+    unsigned char header[MEMTRACE_HEADER_BYTES] = {0};
+    memcpy(header, MEMTRACE_MAGIC, 4);
+    header[4] = MEMTRACE_VERSION & 0xff;
+    header[5] = MEMTRACE_VERSION >> 8;
+    header[6] = MEMTRACE_PAGE_SHIFT;
+    for (int i = 0; i < 4; i++) header[8 + i] = (unsigned char)((unsigned long)interval_us >> (8 * i));
+    memcpy(out_buffer, header, sizeof(header));
+    out_used = sizeof(header);
+    flush_output();
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = on_fault;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (real_sigaction(SIGSEGV, &action, &chained) != 0) {
+        close(out_fd);
+        out_fd = -1;
+        return;
+    }
+    handler_installed = 1;
+    block_pages = sizes;
+    arena_pages = pages;
+    arena_base = base;              // from here on large allocations are traced
+    pthread_atfork(NULL, NULL, after_fork_child);
+    atomic_store(&tracing, 1);
+    if (pthread_create(&sampler, NULL, sampler_main, NULL) == 0) {
+        sampler_started = 1;
+    }
+}
+
+__attribute__((destructor))
+static void memtrace_finish() {
+    if (out_fd < 0) return;
+    if (sampler_started) {
+        atomic_store(&stopping, 1);
+        pthread_join(sampler, NULL);
+        sampler_started = 0;
+    }
+    atomic_store(&tracing, 0);
+    size_t used = atomic_load(&arena_used);
+    if (used > 0) mprotect(arena_base, used << MEMTRACE_PAGE_SHIFT, PROT_READ | PROT_WRITE);
+    drain(atomic_load(&ring_head));
+    pending_intervals++;
+    intervals++;
+    emit_intervals();
+    flush_output();
+    close(out_fd);
+    out_fd = -1;
+    if (getenv("MEMTRACE_SUMMARY") != NULL) {
+        fprintf(stderr, "[memtrace] %lld references over %lld intervals of %.1f ms, %lld blocks, "
+                "peak %.1f MB traced, %lld dropped%s -> %s\n",
+                references, intervals, interval_us / 1000.0, blocks_allocated,
+                (double)(peak_pages << MEMTRACE_PAGE_SHIFT) / (1024.0 * 1024.0), (long long)atomic_load(&dropped),
+                atomic_load(&map_limit_hit) ? ", stopped early at vm.max_map_count" : "", out_path);
+    }
+}
+
+// ---- allocator ----
+static void *arena_allocate(size_t bytes) {
+    size_t pages = (bytes + MEMTRACE_PAGE - 1) >> MEMTRACE_PAGE_SHIFT;
+    size_t start = (size_t)-1;
+    pthread_mutex_lock(&arena_lock);
+    for (int i = 0; i < free_run_count; i++) {
+        if (free_runs[i].pages >= pages) {
+            start = free_runs[i].start;
+            free_runs[i].start += (uint32_t)pages;
+            free_runs[i].pages -= (uint32_t)pages;
+            if (free_runs[i].pages == 0) free_runs[i] = free_runs[--free_run_count];
+            break;
+        }
+    }
+    size_t used = atomic_load_explicit(&arena_used, memory_order_relaxed);
+    if (start == (size_t)-1 && used + pages <= arena_pages) {
+        start = used;
+        atomic_store_explicit(&arena_used, used + pages, memory_order_release);
+    }
+    if (start != (size_t)-1) {
+        block_pages[start] = (uint32_t)pages;
+        blocks_allocated++;
+        if (start + pages > peak_pages) peak_pages = start + pages;
+    }
+    pthread_mutex_unlock(&arena_lock);
+    // Fresh and recycled pages are PROT_NONE and zero: the first touch is traced
+    return start == (size_t)-1 ? NULL : arena_base + (start << MEMTRACE_PAGE_SHIFT);
+}
+
+static size_t arena_block_bytes(const void *pointer) {
+    size_t page = (size_t)((const char *)pointer - arena_base) >> MEMTRACE_PAGE_SHIFT;
+    return (size_t)block_pages[page] << MEMTRACE_PAGE_SHIFT;
+}
+
+static void arena_release(void *pointer) {
+    size_t page = (size_t)((char *)pointer - arena_base) >> MEMTRACE_PAGE_SHIFT;
+    uint32_t pages = block_pages[page];
+    if (pages == 0) return;     // not a block start
+    size_t bytes = (size_t)pages << MEMTRACE_PAGE_SHIFT;
+    mprotect(pointer, bytes, PROT_NONE);
+    madvise(pointer, bytes, MADV_DONTNEED);
+    pthread_mutex_lock(&arena_lock);
+    block_pages[page] = 0;
+    int merged = 0;
+    for (int i = 0; i < free_run_count && !merged; i++) {
+        if (free_runs[i].start + free_runs[i].pages == page) {
+            free_runs[i].pages += pages;
+            merged = 1;
+        } else if (page + pages == free_runs[i].start) {
+            free_runs[i].start = (uint32_t)page;
+            free_runs[i].pages += pages;
+            merged = 1;
+        }
+    }
+    if (!merged && free_run_count < MEMTRACE_MAX_FREE_RUNS) {
+        free_runs[free_run_count].start = (uint32_t)page;
+        free_runs[free_run_count].pages = pages;
+        free_run_count++;
+    }
+    pthread_mutex_unlock(&arena_lock);
+}
+
+void *malloc(size_t size) {
+    if (size >= min_bytes && arena_base != NULL) {
+        void *block = arena_allocate(size);
+        if (block != NULL) return block;
+    }
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    if (count * size >= min_bytes && arena_base != NULL) {
+        void *block = arena_allocate(count * size);
+        if (block != NULL) return block;
+    }
+    return __libc_calloc(count, size);
+}
+
+void free(void *pointer) {
+    if (pointer == NULL) return;
+    if (in_arena(pointer)) arena_release(pointer);
+    else __libc_free(pointer);
+}
+
+void *realloc(void *pointer, size_t size) {
+    if (pointer == NULL) return malloc(size);
+    if (size == 0) {
+        free(pointer);
+        return NULL;
+    }
+    size_t old_bytes;
+    if (in_arena(pointer)) {
+        old_bytes = arena_block_bytes(pointer);
+        if (size <= old_bytes) return pointer;
+    } else if (size >= min_bytes && arena_base != NULL && real_usable_size != NULL) {
+        old_bytes = real_usable_size(pointer);
+    } else {
+        return __libc_realloc(pointer, size);
+    }
+    void *moved = malloc(size);
+    if (moved == NULL) return NULL;
+    memcpy(moved, pointer, old_bytes < size ? old_bytes : size);
+    free(pointer);
+    return moved;
+}
+
+size_t malloc_usable_size(void *pointer) {
+    if (pointer == NULL) return 0;
+    if (in_arena(pointer)) return arena_block_bytes(pointer);
+    if (real_usable_size == NULL) resolve_real_functions();
+    return real_usable_size(pointer);
+}
+
+// ---- system calls on traced buffers go through an untraced copy ----
+#define ENSURE_REAL(fn) do { if ((fn) == NULL) resolve_real_functions(); } while (0)
+
+ssize_t read(int fd, void *buffer, size_t count) {
+    ENSURE_REAL(real_read);
+    if (!overlaps_arena(buffer, count)) return real_read(fd, buffer, count);
+    void *bounce = __libc_malloc(count);
+    if (bounce == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    ssize_t n = real_read(fd, bounce, count);
+    int saved = errno;
+    if (n > 0) memcpy(buffer, bounce, (size_t)n);
+    __libc_free(bounce);
+    errno = saved;
+    return n;
+}
+
+ssize_t pread(int fd, void *buffer, size_t count, off_t offset) {
+    ENSURE_REAL(real_pread);
+    if (!overlaps_arena(buffer, count)) return real_pread(fd, buffer, count, offset);
+    void *bounce = __libc_malloc(count);
+    if (bounce == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    ssize_t n = real_pread(fd, bounce, count, offset);
+    int saved = errno;
+    if (n > 0) memcpy(buffer, bounce, (size_t)n);
+    __libc_free(bounce);
+    errno = saved;
+    return n;
+}
+
+ssize_t recv(int fd, void *buffer, size_t count, int flags) {
+    ENSURE_REAL(real_recv);
+    if (!overlaps_arena(buffer, count)) return real_recv(fd, buffer, count, flags);
+    void *bounce = __libc_malloc(count);
+    if (bounce == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    ssize_t n = real_recv(fd, bounce, count, flags);
+    int saved = errno;
+    if (n > 0) memcpy(buffer, bounce, (size_t)n);
+    __libc_free(bounce);
+    errno = saved;
+    return n;
+}
+
+ssize_t write(int fd, const void *buffer, size_t count) {
+    ENSURE_REAL(real_write);
+    if (!overlaps_arena(buffer, count)) return real_write(fd, buffer, count);
+    void *bounce = __libc_malloc(count);
+    if (bounce == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    memcpy(bounce, buffer, count);
+    ssize_t n = real_write(fd, bounce, count);
+    int saved = errno;
+    __libc_free(bounce);
+    errno = saved;
+    return n;
+}
+
+ssize_t pwrite(int fd, const void *buffer, size_t count, off_t offset) {
+    ENSURE_REAL(real_pwrite);
+    if (!overlaps_arena(buffer, count)) return real_pwrite(fd, buffer, count, offset);
+    void *bounce = __libc_malloc(count);
+    if (bounce == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    memcpy(bounce, buffer, count);
+    ssize_t n = real_pwrite(fd, bounce, count, offset);
+    int saved = errno;
+    __libc_free(bounce);
+    errno = saved;
+    return n;
+}
+
+ssize_t send(int fd, const void *buffer, size_t count, int flags) {
+    ENSURE_REAL(real_send);
+    if (!overlaps_arena(buffer, count)) return real_send(fd, buffer, count, flags);
+    void *bounce = __libc_malloc(count);
+    if (bounce == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    memcpy(bounce, buffer, count);
+    ssize_t n = real_send(fd, bounce, count, flags);
+    int saved = errno;
+    __libc_free(bounce);
+    errno = saved;
+    return n;
+}
+
+// Large stdio transfers bypass the FILE buffer and hand the caller's buffer to the kernel
+static size_t bounced_fread(fread_fn real, void *buffer, size_t size, size_t count, FILE *stream) {
+    if (size == 0 || count > SIZE_MAX / size || !overlaps_arena(buffer, size * count)) {
+        return real(buffer, size, count, stream);
+    }
+    void *bounce = __libc_malloc(size * count);
+    if (bounce == NULL) {
+        errno = ENOMEM;
+        return 0;
+    }
+    size_t n = real(bounce, size, count, stream);
+    memcpy(buffer, bounce, n * size);
+    __libc_free(bounce);
+    return n;
+}
+
+static size_t bounced_fwrite(fwrite_fn real, const void *buffer, size_t size, size_t count, FILE *stream) {
+    if (size == 0 || count > SIZE_MAX / size || !overlaps_arena(buffer, size * count)) {
+        return real(buffer, size, count, stream);
+    }
+    void *bounce = __libc_malloc(size * count);
+    if (bounce == NULL) {
+        errno = ENOMEM;
+        return 0;
+    }
+    memcpy(bounce, buffer, size * count);
+    size_t n = real(bounce, size, count, stream);
+    __libc_free(bounce);
+    return n;
+}
+
+size_t fread(void *buffer, size_t size, size_t count, FILE *stream) {
+    ENSURE_REAL(real_fread);
+    return bounced_fread(real_fread, buffer, size, count, stream);
+}
+
+size_t fwrite(const void *buffer, size_t size, size_t count, FILE *stream) {
+    ENSURE_REAL(real_fwrite);
+    return bounced_fwrite(real_fwrite, buffer, size, count, stream);
+}
+
+// coreutils (sort, cat, ...) read and write through the _unlocked forms
+#undef fread_unlocked
+#undef fwrite_unlocked
+
+size_t fread_unlocked(void *buffer, size_t size, size_t count, FILE *stream) {
+    ENSURE_REAL(real_fread_unlocked);
+    return bounced_fread(real_fread_unlocked, buffer, size, count, stream);
+}
+
+size_t fwrite_unlocked(const void *buffer, size_t size, size_t count, FILE *stream) {
+    ENSURE_REAL(real_fwrite_unlocked);
+    return bounced_fwrite(real_fwrite_unlocked, buffer, size, count, stream);
+}
+
+ssize_t recvfrom(int fd, void *buffer, size_t count, int flags, struct sockaddr *address, socklen_t *length) {
+    ENSURE_REAL(real_recvfrom);
+    if (!overlaps_arena(buffer, count)) return real_recvfrom(fd, buffer, count, flags, address, length);
+    void *bounce = __libc_malloc(count);
+    if (bounce == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    ssize_t n = real_recvfrom(fd, bounce, count, flags, address, length);
+    int saved = errno;
+    if (n > 0) memcpy(buffer, bounce, (size_t)n);
+    __libc_free(bounce);
+    errno = saved;
+    return n;
+}
+
+ssize_t sendto(int fd, const void *buffer, size_t count, int flags, const struct sockaddr *address,
+               socklen_t length) {
+    ENSURE_REAL(real_sendto);
+    if (!overlaps_arena(buffer, count)) return real_sendto(fd, buffer, count, flags, address, length);
+    void *bounce = __libc_malloc(count);
+    if (bounce == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    memcpy(bounce, buffer, count);
+    ssize_t n = real_sendto(fd, bounce, count, flags, address, length);
+    int saved = errno;
+    __libc_free(bounce);
+    errno = saved;
+    return n;
+}
+
+// ---- vectored I/O: an iovec touching the arena sends the whole list through one bounce ----
+// Total length of the list, or (size_t)-1 when no entry overlaps the arena
+static size_t bounced_length(const struct iovec *iov, int count) {
+    size_t total = 0;
+    int traced = 0;
+    for (int i = 0; i < count; i++) {
+        total += iov[i].iov_len;
+        traced |= overlaps_arena(iov[i].iov_base, iov[i].iov_len);
+    }
+    return traced ? total : (size_t)-1;
+}
+
+static void gather(char *bounce, const struct iovec *iov, int count) {
+    for (int i = 0; i < count; i++) {
+        memcpy(bounce, iov[i].iov_base, iov[i].iov_len);
+        bounce += iov[i].iov_len;
+    }
+}
+
+static void scatter(const struct iovec *iov, int count, const char *bounce, size_t bytes) {
+    for (int i = 0; i < count && bytes > 0; i++) {
+        size_t part = iov[i].iov_len < bytes ? iov[i].iov_len : bytes;
+        memcpy(iov[i].iov_base, bounce, part);
+        bounce += part;
+        bytes -= part;
+    }
+}
+
+// One helper for readv/writev/preadv/pwritev; offset < 0 means the unpositioned call
+static ssize_t bounced_vector(int fd, const struct iovec *iov, int count, off_t offset, int writing) {
+    size_t total = bounced_length(iov, count);
+    if (total == (size_t)-1) {
+        if (offset < 0) return (writing ? real_writev : real_readv)(fd, iov, count);
+        return (writing ? real_pwritev : real_preadv)(fd, iov, count, offset);
+    }
+    char *bounce = __libc_malloc(total ? total : 1);
+    if (bounce == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    struct iovec single = {bounce, total};
+    if (writing) gather(bounce, iov, count);
+    ssize_t n;
+    if (offset < 0) n = (writing ? real_writev : real_readv)(fd, &single, 1);
+    else n = (writing ? real_pwritev : real_preadv)(fd, &single, 1, offset);
+    int saved = errno;
+    if (!writing && n > 0) scatter(iov, count, bounce, (size_t)n);
+    __libc_free(bounce);
+    errno = saved;
+    return n;
+}
+
+ssize_t readv(int fd, const struct iovec *iov, int count) {
+    ENSURE_REAL(real_readv);
+    return bounced_vector(fd, iov, count, -1, 0);
+}
+
+ssize_t writev(int fd, const struct iovec *iov, int count) {
+    ENSURE_REAL(real_writev);
+    return bounced_vector(fd, iov, count, -1, 1);
+}
+
+ssize_t preadv(int fd, const struct iovec *iov, int count, off_t offset) {
+    ENSURE_REAL(real_preadv);
+    if (offset < 0) return real_preadv(fd, iov, count, offset);     // let the kernel reject it
+    return bounced_vector(fd, iov, count, offset, 0);
+}
+
+ssize_t pwritev(int fd, const struct iovec *iov, int count, off_t offset) {
+    ENSURE_REAL(real_pwritev);
+    if (offset < 0) return real_pwritev(fd, iov, count, offset);
+    return bounced_vector(fd, iov, count, offset, 1);
+}
+
+// Data, address and ancillary buffers of a message may each sit in the arena
+ssize_t recvmsg(int fd, struct msghdr *message, int flags) {
+    ENSURE_REAL(real_recvmsg);
+    size_t total = bounced_length(message->msg_iov, (int)message->msg_iovlen);
+    int name_traced = overlaps_arena(message->msg_name, message->msg_namelen);
+    int control_traced = overlaps_arena(message->msg_control, message->msg_controllen);
+    if (total == (size_t)-1 && !name_traced && !control_traced) return real_recvmsg(fd, message, flags);
+    struct msghdr copy = *message;
+    size_t data = total == (size_t)-1 ? 0 : total;
+    char *bounce = __libc_malloc(data + message->msg_namelen + message->msg_controllen + 1);
+    if (bounce == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    struct iovec single = {bounce, data};
+    if (total != (size_t)-1) {
+        copy.msg_iov = &single;
+        copy.msg_iovlen = 1;
+    }
+    if (name_traced) copy.msg_name = bounce + data;
+    if (control_traced) copy.msg_control = bounce + data + message->msg_namelen;
+    ssize_t n = real_recvmsg(fd, &copy, flags);
+    int saved = errno;
+    if (n >= 0) {
+        if (copy.msg_iov == &single) scatter(message->msg_iov, (int)message->msg_iovlen, bounce, (size_t)n);
+        if (name_traced) memcpy(message->msg_name, copy.msg_name, copy.msg_namelen);
+        if (control_traced) memcpy(message->msg_control, copy.msg_control, copy.msg_controllen);
+        message->msg_namelen = copy.msg_namelen;
+        message->msg_controllen = copy.msg_controllen;
+        message->msg_flags = copy.msg_flags;
+    }
+    __libc_free(bounce);
+    errno = saved;
+    return n;
+}
+
+ssize_t sendmsg(int fd, const struct msghdr *message, int flags) {
+    ENSURE_REAL(real_sendmsg);
+    size_t total = bounced_length(message->msg_iov, (int)message->msg_iovlen);
+    int name_traced = overlaps_arena(message->msg_name, message->msg_namelen);
+    int control_traced = overlaps_arena(message->msg_control, message->msg_controllen);
+    if (total == (size_t)-1 && !name_traced && !control_traced) return real_sendmsg(fd, message, flags);
+    struct msghdr copy = *message;
+    size_t data = total == (size_t)-1 ? 0 : total;
+    char *bounce = __libc_malloc(data + message->msg_namelen + message->msg_controllen + 1);
+    if (bounce == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    struct iovec single = {bounce, data};
+    if (total != (size_t)-1) {
+        gather(bounce, message->msg_iov, (int)message->msg_iovlen);
+        copy.msg_iov = &single;
+        copy.msg_iovlen = 1;
+    }
+    if (name_traced) {
+        copy.msg_name = bounce + data;
+        memcpy(copy.msg_name, message->msg_name, message->msg_namelen);
+    }
+    if (control_traced) {
+        copy.msg_control = bounce + data + message->msg_namelen;
+        memcpy(copy.msg_control, message->msg_control, message->msg_controllen);
+    }
+    ssize_t n = real_sendmsg(fd, &copy, flags);
+    int saved = errno;
+    __libc_free(bounce);
+    errno = saved;
+    return n;
+}
+
+// ---- keep the tracer's SIGSEGV handler first; the program's runs behind it ----
+int sigaction(int signum, const struct sigaction *action, struct sigaction *old_action) {
+    ENSURE_REAL(real_sigaction);
+    if (signum != SIGSEGV || !handler_installed) return real_sigaction(signum, action, old_action);
+    if (old_action != NULL) *old_action = chained;
+    if (action != NULL) chained = *action;
+    return 0;
+}
+
+sighandler_t signal(int signum, sighandler_t handler) {
+    struct sigaction action, old_action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handler;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(signum, &action, &old_action) != 0) return SIG_ERR;
+    return old_action.sa_handler;
+}
@@ -0,0 +1,674 @@
+/*
+ * multicore.c - Multi-core scheduling simulation with per-CPU runqueues
+ *
+ * Every simulated CPU owns a round-robin runqueue and the arrivals that wake
+ * up on it. Simulated time advances in epochs of balance_interval ticks:
+ * within an epoch each core runs only its own queue and admits its own
+ * arrivals, and between epochs a single pass lets the cores that ran dry
+ * steal from the busiest queue (in CPU order) and moves tasks from the
+ * busiest to the idlest queue. Cores never touch each other's queues inside
+ * an epoch, so each core's epoch can run on a real thread and the result
+ * does not depend on the thread count. Without balancing the cores never
+ * interact, so the whole run is one epoch and threads never synchronise.
+ *
+ * When a timeline is open every slice, steal and balancing move is streamed
+ * through a per-CPU chunk, so tracing adds no shared lock to the epoch loop.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#ifndef _WIN32
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include "multicore.h"
+#include "process_manager.h"
+#include "timing.h"
+#include "timeline.h"
+#include "arena.h"
+#include "workload_gen.h"
+
+#define STEAL_SCAN_DEPTH 16
+#define NO_ARRIVAL 0x7fffffffffffffffLL
+#define BARRIER_SPINS 256           // polls before a waiting thread yields its CPU
+
+typedef struct {
+    atomic_flag lock;
+    int *slots;                 // ring buffer of task indices
+    int capacity;
+    int head;
+    int count;
+    atomic_llong load;          // remaining ticks of all queued tasks
+    long long busy;
+    long long steals;
+    int went_idle;              // ran dry during the last epoch
+    const int *arrivals;        // tasks waking up here, by arrival time
+    int arrival_count;
+    int next_arrival;
+} RunQueue;
+
+typedef struct {
+    const MulticoreConfig *config;
+    SimTask *tasks;
+    int task_count;
+    RunQueue queues[MULTICORE_MAX_CPUS];
+    Arena *arena;               // the caller's run arena; runqueues grow inside it
+    atomic_flag arena_lock;     // core threads take turns growing
+    long long epoch_start;
+    long long epoch_end;
+    long long balance_moves;
+    atomic_int finished;
+    int done;
+    int out_of_memory;
+    int timeline_pid;           // 0 when no timeline is being written
+    TimelineBuffer timeline[MULTICORE_MAX_CPUS];
+#ifndef _WIN32
+    atomic_int barrier_waiting;
+    atomic_int barrier_generation;
+    atomic_int thread_count;
+#endif
+} Simulation;
+
+void multicore_default_config(MulticoreConfig *config) {
+    config->cpu_count = 4;
+    config->time_quantum = 3;
+    config->balance_interval = 20;
+    config->periodic_balance = 1;
+    config->migration_cost = 2;
+    config->idle_steal = 1;
+    config->threads = 0;
+}
+
+static void queue_lock(RunQueue *q) {
+    while (atomic_flag_test_and_set_explicit(&q->lock, memory_order_acquire)) {
+        // spin; critical sections are a handful of instructions
+    }
+}
+
+static void queue_unlock(RunQueue *q) {
+    atomic_flag_clear_explicit(&q->lock, memory_order_release);
+}
+
+// Append a task index; caller holds the lock. Returns 0 on allocation failure
+static int queue_push(Simulation *sim, RunQueue *q, int task) {
+    if (q->count == q->capacity) {
+        // Nothing else allocates from the run arena while cores run, so this
+        // lock is all that is needed; the old ring goes back with the run
+        int new_capacity = q->capacity ? q->capacity * 2 : 64;
+        while (atomic_flag_test_and_set_explicit(&sim->arena_lock, memory_order_acquire)) {
+            // spin; held for one bump allocation
+        }
+        int *slots = arena_alloc(sim->arena, sizeof(int) * new_capacity);
+        atomic_flag_clear_explicit(&sim->arena_lock, memory_order_release);
+        if (slots == NULL) {
+            return 0;
+        }
+        for (int i = 0; i < q->count; i++) {
+            slots[i] = q->slots[(q->head + i) % q->capacity];
+        }
+        q->slots = slots;
+        q->capacity = new_capacity;
+        q->head = 0;
+    }
+    q->slots[(q->head + q->count) % q->capacity] = task;
+    q->count++;
+    return 1;
+}
+
+static int queue_pop_front(RunQueue *q) {
+    int task = q->slots[q->head];
+    q->head = (q->head + 1) % q->capacity;
+    q->count--;
+    return task;
+}
+
+// Take a task near the tail that may run on cpu (and is shorter than
+// max_remaining when given); returns -1 if none qualifies
+static int queue_take_for(RunQueue *q, const SimTask *tasks, int cpu, int max_remaining) {
+    int depth = q->count < STEAL_SCAN_DEPTH ? q->count : STEAL_SCAN_DEPTH;
+    for (int k = 0; k < depth; k++) {
+        int pos = (q->head + q->count - 1 - k) % q->capacity;
+        const SimTask *task = &tasks[q->slots[pos]];
+        if (task->affinity != 0 && !(task->affinity & (1ULL << cpu))) continue;
+        if (max_remaining > 0 && task->remaining >= max_remaining) continue;
+        int found = q->slots[pos];
+        int tail = (q->head + q->count - 1) % q->capacity;
+        q->slots[pos] = q->slots[tail];
+        q->count--;
+        return found;
+    }
+    return -1;
+}
+
+static int allowed_cpu(const SimTask *task, int cpu_count) {
+    if (task->affinity == 0 || (task->affinity & (1ULL << task->home_cpu))) {
+        return task->home_cpu;
+    }
+    for (int c = 0; c < cpu_count; c++) {
+        if (task->affinity & (1ULL << c)) return c;
+    }
+    return task->home_cpu;
+}
+
+// Simulated ticks are exported as milliseconds
+static double ticks_to_us(long long ticks) {
+    return (double)ticks * 1000.0;
+}
+
+static void migrate(Simulation *sim, int task, int to_cpu, long long when) {
+    SimTask *t = &sim->tasks[task];
+    if (sim->timeline_pid) {
+        // to_cpu's buffer belongs to the caller: the stealing core or the serial balancer
+        timeline_instant(&sim->timeline[to_cpu], sim->timeline_pid, to_cpu,
+                         "migrate", "balance", ticks_to_us(when));
+    }
+    t->remaining += sim->config->migration_cost;
+    t->migrations++;
+    RunQueue *q = &sim->queues[to_cpu];
+    queue_lock(q);
+    if (!queue_push(sim, q, task)) sim->out_of_memory = 1;
+    atomic_fetch_add_explicit(&q->load, t->remaining, memory_order_relaxed);
+    queue_unlock(q);
+}
+
+// Idle-time balancing at the barrier: pull one task from the most loaded
+// queue (the lowest-numbered one on ties)
+static int steal_into(Simulation *sim, int cpu, long long now) {
+    int cpu_count = sim->config->cpu_count;
+    int victim = -1;
+    long long best = 0;
+    for (int c = 0; c < cpu_count; c++) {
+        long long load = atomic_load_explicit(&sim->queues[c].load, memory_order_relaxed);
+        if (c != cpu && load > best) {
+            best = load;
+            victim = c;
+        }
+    }
+    if (victim < 0) {
+        return 0;
+    }
+    RunQueue *q = &sim->queues[victim];
+    queue_lock(q);
+    int task = q->count > 1 ? queue_take_for(q, sim->tasks, cpu, 0) : -1;
+    if (task >= 0) {
+        atomic_fetch_sub_explicit(&q->load, sim->tasks[task].remaining, memory_order_relaxed);
+    }
+    queue_unlock(q);
+    if (task < 0) {
+        return 0;
+    }
+    sim->queues[cpu].steals++;
+    migrate(sim, task, cpu, now);
+    return 1;
+}
+
+static long long next_arrival_time(const Simulation *sim, const RunQueue *q) {
+    return q->next_arrival < q->arrival_count ? sim->tasks[q->arrivals[q->next_arrival]].arrival_time : NO_ARRIVAL;
+}
+
+// Queue this core's tasks that have arrived by t
+static void admit_arrivals(Simulation *sim, RunQueue *q, long long t) {
+    while (q->next_arrival < q->arrival_count) {
+        int index = q->arrivals[q->next_arrival];
+        SimTask *task = &sim->tasks[index];
+        if (task->arrival_time > t) break;
+        queue_lock(q);
+        if (!queue_push(sim, q, index)) sim->out_of_memory = 1;
+        atomic_fetch_add_explicit(&q->load, task->remaining, memory_order_relaxed);
+        queue_unlock(q);
+        q->next_arrival++;
+    }
+}
+
+// Run one core's runqueue from epoch_start up to the next balancing point
+static void run_core_epoch(Simulation *sim, int cpu) {
+    RunQueue *q = &sim->queues[cpu];
+    long long t = sim->epoch_start;
+    long long epoch_end = sim->epoch_end;
+    int quantum = sim->config->time_quantum;
+
+    while (t < epoch_end) {
+        admit_arrivals(sim, q, t);
+        queue_lock(q);
+        if (q->count == 0) {
+            queue_unlock(q);
+            long long next = next_arrival_time(sim, q);
+            if (next < epoch_end) {
+                t = next;   // idle until the next local arrival
+                continue;
+            }
+            q->went_idle = 1;
+            break;  // idle for the rest of the epoch, steals at the barrier
+        }
+        int index = queue_pop_front(q);
+        SimTask *task = &sim->tasks[index];
+        atomic_fetch_sub_explicit(&q->load, task->remaining, memory_order_relaxed);
+        queue_unlock(q);
+
+        long long slice = task->remaining < quantum ? task->remaining : quantum;
+        if (slice > epoch_end - t) slice = epoch_end - t;
+        task->remaining -= (int)slice;
+        if (sim->timeline_pid) {
+            char name[24];
+            snprintf(name, sizeof(name), "T%d", task->id);
+            timeline_slice(&sim->timeline[cpu], sim->timeline_pid, cpu, name, "run",
+                           ticks_to_us(t), ticks_to_us(slice));
+        }
+        t += slice;
+        q->busy += slice;
+
+        if (task->remaining == 0) {
+            task->finish_time = (int)t;
+            atomic_fetch_add_explicit(&sim->finished, 1, memory_order_relaxed);
+        } else {
+            queue_lock(q);
+            if (!queue_push(sim, q, index)) sim->out_of_memory = 1;
+            atomic_fetch_add_explicit(&q->load, task->remaining, memory_order_relaxed);
+            queue_unlock(q);
+        }
+    }
+}
+
+// Periodic balancing: move tasks from the busiest to the idlest queue
+static void balance_queues(Simulation *sim) {
+    int cpu_count = sim->config->cpu_count;
+    int max_moves = 32 * cpu_count;
+    unsigned long long stuck = 0;   // queues with nothing movable this pass
+
+    for (int moves = 0; moves < max_moves; moves++) {
+        int busiest = -1, idlest = -1;
+        long long high = -1, low = -1;
+        for (int c = 0; c < cpu_count; c++) {
+            long long load = atomic_load_explicit(&sim->queues[c].load, memory_order_relaxed);
+            if (!(stuck & (1ULL << c)) && load > high) {
+                high = load;
+                busiest = c;
+            }
+            if (low < 0 || load < low) {
+                low = load;
+                idlest = c;
+            }
+        }
+        if (busiest < 0 || busiest == idlest || high - low <= sim->config->time_quantum) {
+            break;
+        }
+        RunQueue *q = &sim->queues[busiest];
+        // Only move a task if it actually narrows the gap
+        int task = queue_take_for(q, sim->tasks, idlest, (int)(high - low));
+        if (task < 0) {
+            stuck |= 1ULL << busiest;
+            continue;
+        }
+        atomic_fetch_sub_explicit(&q->load, sim->tasks[task].remaining, memory_order_relaxed);
+        migrate(sim, task, idlest, sim->epoch_start);
+        sim->balance_moves++;
+    }
+}
+
+// Serial step between epochs: balance, detect completion, set the next epoch
+static void between_epochs(Simulation *sim, int first) {
+    if (!first) {
+        sim->epoch_start = sim->epoch_end;
+    }
+    int cpu_count = sim->config->cpu_count;
+    long long queued = 0;
+    long long next_arrival = NO_ARRIVAL;
+    for (int c = 0; c < cpu_count; c++) {
+        queued += sim->queues[c].count;
+        long long next = next_arrival_time(sim, &sim->queues[c]);
+        if (next < next_arrival) next_arrival = next;
+    }
+    // Fast-forward over idle gaps to the epoch holding the next arrival
+    long long interval = sim->config->balance_interval;
+    if (queued == 0 && next_arrival != NO_ARRIVAL && next_arrival > sim->epoch_start) {
+        sim->epoch_start = next_arrival / interval * interval;
+    }
+    // Only balancing needs the cores to meet; without it one epoch runs everything
+    int balancing = cpu_count > 1 && (sim->config->periodic_balance || sim->config->idle_steal);
+    sim->epoch_end = balancing ? sim->epoch_start + interval : NO_ARRIVAL;
+    for (int c = 0; c < cpu_count; c++) {
+        if (sim->queues[c].went_idle && sim->queues[c].count == 0 && sim->config->idle_steal) {
+            steal_into(sim, c, sim->epoch_start);
+        }
+        sim->queues[c].went_idle = 0;
+    }
+    if (sim->config->periodic_balance && cpu_count > 1) {
+        balance_queues(sim);
+    }
+    if (sim->timeline_pid) {
+        for (int c = 0; c < cpu_count; c++) {
+            char name[24];
+            snprintf(name, sizeof(name), "CPU%d queue", c);
+            timeline_counter(&sim->timeline[c], sim->timeline_pid, name,
+                             ticks_to_us(sim->epoch_start), (double)sim->queues[c].count);
+        }
+    }
+    sim->done = sim->out_of_memory ||
+        atomic_load_explicit(&sim->finished, memory_order_relaxed) == sim->task_count;
+}
+
+#ifndef _WIN32
+// Epochs are short, so waiters poll rather than sleep on a condition
+// variable; they yield after a while in case the host has fewer CPUs
+static void barrier_wait(Simulation *sim) {
+    int generation = atomic_load_explicit(&sim->barrier_generation, memory_order_acquire);
+    if (atomic_fetch_add_explicit(&sim->barrier_waiting, 1, memory_order_acq_rel) + 1 ==
+        atomic_load_explicit(&sim->thread_count, memory_order_relaxed)) {
+        atomic_store_explicit(&sim->barrier_waiting, 0, memory_order_relaxed);
+        atomic_fetch_add_explicit(&sim->barrier_generation, 1, memory_order_release);
+        return;
+    }
+    for (int spins = 0; atomic_load_explicit(&sim->barrier_generation, memory_order_acquire) == generation; spins++) {
+        if (spins >= BARRIER_SPINS) sched_yield();
+    }
+}
+
+typedef struct {
+    Simulation *sim;
+    int thread_id;
+} CoreThread;
+
+static void *core_thread_main(void *arg) {
+    CoreThread *self = arg;
+    Simulation *sim = self->sim;
+    int first = 1;
+    for (;;) {
+        if (self->thread_id == 0) {
+            between_epochs(sim, first);
+        }
+        first = 0;
+        barrier_wait(sim);
+        if (sim->done) break;
+        int stride = atomic_load_explicit(&sim->thread_count, memory_order_relaxed);
+        for (int c = self->thread_id; c < sim->config->cpu_count; c += stride) {
+            run_core_epoch(sim, c);
+        }
+        barrier_wait(sim);
+    }
+    return NULL;
+}
+#endif
+
+// Sort keys are (cpu, arrival time, index) packed into one integer
+// Run the simulation; tasks are updated in place. Returns 1 on success
+int multicore_simulate(const MulticoreConfig *config, SimTask *tasks, int count,
+                       MulticoreResult *result) {
+    memset(result, 0, sizeof(*result));
+    if (config->cpu_count < 1 || config->cpu_count > MULTICORE_MAX_CPUS ||
+        config->time_quantum < 1 || config->balance_interval < 1 || count < 1 || count >= (1 << 27)) {
+        printf("Invalid multi-core configuration.\n");
+        return 0;
+    }
+
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    Simulation *sim = arena_calloc(arena, 1, sizeof(Simulation));
+    unsigned long long *keys = arena_alloc(arena, sizeof(unsigned long long) * count);
+    int *arrivals = arena_alloc(arena, sizeof(int) * count);
+    if (sim == NULL || keys == NULL || arrivals == NULL) {
+        arena_release(arena, mark);
+        printf("Not enough memory for %d tasks.\n", count);
+        return 0;
+    }
+    for (int i = 0; i < count; i++) {
+        tasks[i].remaining = tasks[i].burst_time > 0 ? tasks[i].burst_time : 1;
+        tasks[i].finish_time = -1;
+        tasks[i].migrations = 0;
+        if (tasks[i].home_cpu < 0 || tasks[i].home_cpu >= config->cpu_count) {
+            tasks[i].home_cpu = i % config->cpu_count;
+        }
+        // 6 bits of CPU, 31 of arrival time (negative counts as 0), 27 of index
+        unsigned long long arrival = tasks[i].arrival_time > 0 ? (unsigned int)tasks[i].arrival_time : 0;
+        keys[i] = ((unsigned long long)allowed_cpu(&tasks[i], config->cpu_count) << 58) | (arrival << 27) |
+                  (unsigned long long)i;
+    }
+    qsort(keys, count, sizeof(unsigned long long), wg_compare_packed);
+
+    sim->config = config;
+    sim->arena = arena;
+    atomic_flag_clear(&sim->arena_lock);
+    sim->tasks = tasks;
+    sim->task_count = count;
+    for (int i = 0; i < count; i++) {
+        arrivals[i] = (int)(keys[i] & ((1ULL << 27) - 1));
+    }
+    for (int c = 0, i = 0; c < config->cpu_count; c++) {
+        RunQueue *q = &sim->queues[c];
+        atomic_flag_clear(&q->lock);
+        atomic_init(&q->load, 0);
+        q->arrivals = arrivals + i;
+        while (i < count && (int)(keys[i] >> 58) == c) i++;
+        q->arrival_count = (int)(arrivals + i - q->arrivals);
+    }
+    atomic_init(&sim->finished, 0);
+    if (timeline_active()) {
+        // Each simulation gets its own trace process so runs never overlap
+        static int timeline_runs = 0;
+        char name[64];
+        sim->timeline_pid = TIMELINE_PID_MULTICORE + timeline_runs++;
+        snprintf(name, sizeof(name), "Multicore run %d (%d CPUs)", timeline_runs, config->cpu_count);
+        timeline_name(sim->timeline_pid, -1, name);
+        for (int c = 0; c < config->cpu_count; c++) {
+            snprintf(name, sizeof(name), "CPU%d", c);
+            timeline_name(sim->timeline_pid, c, name);
+            timeline_buffer_init(&sim->timeline[c]);
+        }
+    }
+
+    double start = monotonic_seconds();
+    int threads = config->threads;
+    if (threads > config->cpu_count) threads = config->cpu_count;
+#ifndef _WIN32
+    if (threads > 1) {
+        pthread_t handles[MULTICORE_MAX_CPUS];
+        CoreThread args[MULTICORE_MAX_CPUS];
+        atomic_init(&sim->barrier_waiting, 0);
+        atomic_init(&sim->barrier_generation, 0);
+        atomic_init(&sim->thread_count, threads);
+        // The calling thread drives core stripe 0 itself
+        int started = 1;
+        for (int i = 0; i < threads; i++) {
+            args[i].sim = sim;
+            args[i].thread_id = i;
+        }
+        for (int i = 1; i < threads; i++) {
+            if (pthread_create(&handles[i], NULL, core_thread_main, &args[i]) != 0) break;
+            started++;
+        }
+        if (started < threads) {
+            // Nobody can complete the barrier before this thread joins it
+            atomic_store(&sim->thread_count, started);
+        }
+        core_thread_main(&args[0]);
+        for (int i = 1; i < started; i++) {
+            pthread_join(handles[i], NULL);
+        }
+    }
+    if (threads <= 1)
+#endif
+    {
+        int first = 1;
+        for (;;) {
+            between_epochs(sim, first);
+            first = 0;
+            if (sim->done) break;
+            for (int c = 0; c < config->cpu_count; c++) {
+                run_core_epoch(sim, c);
+            }
+        }
+    }
+    result->wall_seconds = monotonic_seconds() - start;
+
+    result->cpu_count = config->cpu_count;
+    double turnaround = 0.0;
+    for (int i = 0; i < count; i++) {
+        if (tasks[i].finish_time > result->makespan) result->makespan = tasks[i].finish_time;
+        turnaround += tasks[i].finish_time - tasks[i].arrival_time;
+        result->migrations += tasks[i].migrations;
+    }
+    result->avg_turnaround = turnaround / count;
+    result->balance_moves = sim->balance_moves;
+    for (int c = 0; c < config->cpu_count; c++) {
+        result->busy_ticks[c] = sim->queues[c].busy;
+        result->steals += sim->queues[c].steals;
+        result->utilisation[c] = result->makespan > 0
+            ? (float)(100.0 * sim->queues[c].busy / result->makespan) : 0.0f;
+        if (sim->timeline_pid) {
+            timeline_buffer_free(&sim->timeline[c]);
+        }
+    }
+    int ok = !sim->out_of_memory;
+    if (!ok) {
+        printf("Simulation aborted: runqueue allocation failed.\n");
+    }
+    arena_release(arena, mark);
+    return ok;
+}
+
+// Generate a skewed workload: a fraction of tasks wake up on CPU 0
+void multicore_generate_workload(SimTask *tasks, int count, int cpu_count,
+                                 float skew, unsigned int seed) {
+    unsigned long long state = seed ? seed : 1;
+    int span = count / (cpu_count > 0 ? cpu_count : 1) * 4 + 1;
+    for (int i = 0; i < count; i++) {
+        SimTask *task = &tasks[i];
+        memset(task, 0, sizeof(*task));
+        task->id = i;
+        task->arrival_time = wg_next(&state) % span;
+        // Mostly short bursts with a tail of long CPU-bound tasks
+        task->burst_time = 1 + wg_next(&state) % 10;
+        if (wg_next(&state) % 10 == 0) {
+            task->burst_time += wg_next(&state) % 100;
+        }
+        int skewed = (wg_next(&state) % 1000) < (unsigned int)(skew * 1000);
+        task->home_cpu = skewed ? 0 : (int)(wg_next(&state) % cpu_count);
+        // One task in ten is pinned to its home CPU
+        if (wg_next(&state) % 10 == 0) {
+            task->affinity = 1ULL << task->home_cpu;
+        }
+    }
+}
+
+void multicore_print_result(const MulticoreResult *result) {
+    printf("Makespan: %lld ticks | Avg turnaround: %.1f | Migrations: %lld "
+           "(balanced %lld, stolen %lld) | Wall: %.3f s\n",
+           result->makespan, result->avg_turnaround, result->migrations,
+           result->balance_moves, result->steals, result->wall_seconds);
+    for (int c = 0; c < result->cpu_count; c++) {
+        printf("  CPU%-2d [", c);
+        int bars = (int)(result->utilisation[c] / 5.0f);
+        for (int i = 0; i < 20; i++) printf(i < bars ? "#" : ".");
+        printf("] %5.1f%%  busy %lld\n", result->utilisation[c], result->busy_ticks[c]);
+    }
+}
+
+// Threaded runs must reproduce the sequential schedule exactly
+static int same_schedule(const MulticoreResult *a, const SimTask *tasks_a,
+                         const MulticoreResult *b, const SimTask *tasks_b, int count) {
+    if (a->makespan != b->makespan || a->migrations != b->migrations || a->steals != b->steals ||
+        a->balance_moves != b->balance_moves) {
+        return 0;
+    }
+    for (int c = 0; c < a->cpu_count; c++) {
+        if (a->busy_ticks[c] != b->busy_ticks[c]) return 0;
+    }
+    for (int i = 0; i < count; i++) {
+        if (tasks_a[i].finish_time != tasks_b[i].finish_time) return 0;
+    }
+    return 1;
+}
+
+// Returns 0 if a threaded run diverged from the sequential one (reference
+// is scratch space for that comparison, NULL to skip it)
+static int run_policy(const char *label, MulticoreConfig config, int balance,
+                      const SimTask *workload, SimTask *scratch, SimTask *reference, int count) {
+    if (!balance) {
+        config.periodic_balance = 0;
+        config.idle_steal = 0;
+    }
+    memcpy(scratch, workload, sizeof(SimTask) * count);
+    MulticoreResult result;
+    printf("\n--- %s ---\n", label);
+    if (!multicore_simulate(&config, scratch, count, &result)) {
+        return 1;
+    }
+    multicore_print_result(&result);
+    if (reference == NULL || config.threads <= 1) {
+        return 1;
+    }
+    MulticoreConfig sequential = config;
+    sequential.threads = 0;
+    memcpy(reference, workload, sizeof(SimTask) * count);
+    MulticoreResult expected;
+    if (!multicore_simulate(&sequential, reference, count, &expected)) {
+        return 1;
+    }
+    if (!same_schedule(&result, scratch, &expected, reference, count)) {
+        printf("MISMATCH: %d threads diverged from the sequential run (makespan %lld vs %lld)\n",
+               config.threads, result.makespan, expected.makespan);
+        return 0;
+    }
+    printf("Matches the sequential run\n");
+    return 1;
+}
+
+// Menu demo: schedule the process table on 4 simulated cores
+void display_multicore_scheduling() {
+    printf("\n=== MULTI-CORE SCHEDULING (4 CPUs) ===\n");
+    if (process_count == 0) {
+        printf("No processes to schedule.\n");
+        return;
+    }
+    SimTask workload[MAX_PROCESSES];
+    SimTask scratch[MAX_PROCESSES];
+    for (int i = 0; i < process_count; i++) {
+        memset(&workload[i], 0, sizeof(SimTask));
+        workload[i].id = i;
+        workload[i].arrival_time = pcb_table[i].arrival_time;
+        workload[i].burst_time = pcb_table[i].burst_time;
+        workload[i].home_cpu = (i % 3 == 0) ? 0 : i % 4;   // CPU 0 is overloaded
+    }
+    MulticoreConfig config;
+    multicore_default_config(&config);
+    config.balance_interval = 4;
+    run_policy("No load balancing", config, 0, workload, scratch, NULL, process_count);
+    run_policy("Periodic balancing + work stealing", config, 1, workload, scratch, NULL, process_count);
+}
+
+// CLI: multicore [cpus] [tasks] [threads] [skew]
+int multicore_command(int argc, char *argv[]) {
+    MulticoreConfig config;
+    multicore_default_config(&config);
+    int count = 100000;
+    float skew = 0.5f;
+    if (argc > 0) config.cpu_count = atoi(argv[0]);
+    if (argc > 1) count = atoi(argv[1]);
+    if (argc > 2) config.threads = atoi(argv[2]);
+    if (argc > 3) skew = (float)atof(argv[3]);
+    if (config.cpu_count < 1 || config.cpu_count > MULTICORE_MAX_CPUS || count < 1) {
+        printf("Usage: multicore [cpus 1-%d] [tasks] [threads] [skew 0-1]\n", MULTICORE_MAX_CPUS);
+        return 1;
+    }
+
+    run_arena_reset();
+    SimTask *workload = arena_alloc(run_arena(), sizeof(SimTask) * count);
+    SimTask *scratch = arena_alloc(run_arena(), sizeof(SimTask) * count);
+    SimTask *reference = config.threads > 1 ? arena_alloc(run_arena(), sizeof(SimTask) * count) : NULL;
+    if (workload == NULL || scratch == NULL || (config.threads > 1 && reference == NULL)) {
+        printf("Not enough memory for %d tasks.\n", count);
+        run_arena_print_stats("Run");
+        return 1;
+    }
+    multicore_generate_workload(workload, count, config.cpu_count, skew, 42);
+    printf("=== MULTI-CORE SCHEDULING: %d CPUs, %d tasks, %d threads, skew %.2f ===\n",
+           config.cpu_count, count, config.threads, skew);
+    int match = run_policy("No load balancing", config, 0, workload, scratch, reference, count);
+    match &= run_policy("Periodic balancing + work stealing", config, 1, workload, scratch, reference, count);
+    run_arena_print_stats("\nRun");
+    run_arena_reset();
+    return match ? 0 : 1;
+}
@@ -0,0 +1,52 @@
+/*
+ * multicore.h - Header for the multi-core scheduling simulation
+ */
+
+#ifndef MULTICORE_H
+#define MULTICORE_H
+
+#define MULTICORE_MAX_CPUS 64
+
+typedef struct {
+    int cpu_count;              // simulated CPUs, each with its own runqueue
+    int time_quantum;           // per-core round-robin quantum (ticks)
+    int balance_interval;       // ticks between periodic load balancing passes
+    int periodic_balance;       // move tasks from busiest to idlest queue each interval
+    int migration_cost;         // ticks charged to a task each time it migrates
+    int idle_steal;             // idle cores steal work between balancing passes
+    int threads;                // real threads driving the cores (0 = sequential)
+} MulticoreConfig;
+
+typedef struct {
+    int id;
+    int arrival_time;
+    int burst_time;
+    int home_cpu;               // runqueue the task wakes up on
+    unsigned long long affinity; // allowed CPUs bitmask (0 = any CPU)
+    int remaining;
+    int finish_time;
+    int migrations;
+} SimTask;
+
+typedef struct {
+    int cpu_count;
+    long long busy_ticks[MULTICORE_MAX_CPUS];
+    float utilisation[MULTICORE_MAX_CPUS];
+    long long makespan;
+    long long migrations;
+    long long steals;
+    long long balance_moves;
+    double avg_turnaround;
+    double wall_seconds;
+} MulticoreResult;
+
+void multicore_default_config(MulticoreConfig *config);
+void multicore_generate_workload(SimTask *tasks, int count, int cpu_count,
+                                 float skew, unsigned int seed);
+int multicore_simulate(const MulticoreConfig *config, SimTask *tasks, int count,
+                       MulticoreResult *result);
+void multicore_print_result(const MulticoreResult *result);
+void display_multicore_scheduling();
+int multicore_command(int argc, char *argv[]);
+
+#endif // MULTICORE_H
@@ -0,0 +1,517 @@
+/*
+ * priority_sched.c - Preemptive priority scheduling with locks, aging and
+ * priority inheritance / ceiling
+ *
+ * One simulated CPU runs the most urgent ready task (lower priority value
+ * first). A task may take one lock part-way through its burst; a task that
+ * finds it held blocks on the lock's waiter queue. The ready queue and each
+ * waiter queue are indexed binary heaps over a shared key array, so
+ * re-keying a task (inheritance boosting a holder, a ceiling being applied)
+ * is one O(log n) sift instead of a re-sort.
+ *
+ * Aging is linear: a waiting task gains one level per aging interval. With
+ * key = priority * interval + ready_since the order of waiting tasks never
+ * changes as time passes, so aging needs no periodic pass over the queue.
+ * The running task keeps the key it was dispatched with: an urgent arrival
+ * preempts it only if it beats that aged key.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "priority_sched.h"
+#include "process_manager.h"
+#include "arena.h"
+#include "workload_gen.h"
+
+#define NO_AGING_SCALE (1LL << 40)  // keys without aging: priority, then FIFO sequence
+
+void prio_default_config(PrioSchedConfig *config) {
+    config->lock_protocol = PRIO_LOCK_PLAIN;
+    config->aging_interval = 0;
+}
+
+const char *prio_config_name(const PrioSchedConfig *config) {
+    static const char *names[3][2] = {
+        {"plain", "aging"},
+        {"inheritance", "inheritance+aging"},
+        {"ceiling", "ceiling+aging"}
+    };
+    int protocol = config->lock_protocol >= PRIO_LOCK_PLAIN && config->lock_protocol <= PRIO_LOCK_CEILING
+        ? config->lock_protocol : PRIO_LOCK_PLAIN;
+    return names[protocol][config->aging_interval > 0];
+}
+
+// Bursts of 1-20 ticks at the given CPU load, priorities 1-5, and a share of
+// tasks with a critical section on one of four locks
+void prio_generate_workload(PrioTask *tasks, int count, double load, float lock_share, unsigned int seed) {
+    unsigned long long state = seed ? seed : 1;
+    double gap = load > 0.0 ? 10.5 / load : 0.0;
+    double t = 0.0;
+    for (int i = 0; i < count; i++) {
+        PrioTask *task = &tasks[i];
+        t += gap * (wg_next(&state) % 2001) / 1000.0;
+        task->id = i + 1;
+        task->arrival = (int)t;
+        task->burst = 1 + wg_next(&state) % 20;
+        task->priority = 1 + wg_next(&state) % 5;
+        task->lock = -1;
+        task->lock_at = 0;
+        task->lock_hold = 0;
+        if ((wg_next(&state) % 1000) < (unsigned int)(lock_share * 1000)) {
+            task->lock = wg_next(&state) % 4;
+            task->lock_at = wg_next(&state) % task->burst;
+            task->lock_hold = 1 + wg_next(&state) % (task->burst - task->lock_at);
+        }
+    }
+}
+
+// ---- indexed heaps over a shared key array ----
+typedef struct {
+    int *items;
+    int size;
+} PrioHeap;
+
+typedef struct {
+    const PrioTask *tasks;
+    const PrioSchedConfig *config;
+    long long *key;
+    long long *stamp;           // ready_since with aging, FIFO sequence without
+    int *eff;                   // effective priority
+    int *position;              // slot in whichever heap holds the task
+    int *done;                  // CPU time received
+    unsigned char *phase;       // 0 before its lock, 1 holding it, 2 past it (or none)
+    PrioHeap ready;
+    PrioHeap waiters[PRIO_MAX_LOCKS];
+    int owner[PRIO_MAX_LOCKS];
+    int ceiling[PRIO_MAX_LOCKS];
+    long long inversion_start[PRIO_MAX_LOCKS];
+    long long now;
+    long long sequence;
+    long long scale;
+    PrioResult *result;
+} PrioSim;
+
+static void heap_place(PrioSim *sim, PrioHeap *heap, int slot, int task) {
+    heap->items[slot] = task;
+    sim->position[task] = slot;
+}
+
+static void heap_sift_up(PrioSim *sim, PrioHeap *heap, int slot) {
+    int task = heap->items[slot];
+    while (slot > 0) {
+        int parent = (slot - 1) / 2;
+        if (sim->key[heap->items[parent]] <= sim->key[task]) break;
+        heap_place(sim, heap, slot, heap->items[parent]);
+        slot = parent;
+    }
+    heap_place(sim, heap, slot, task);
+}
+
+static void heap_sift_down(PrioSim *sim, PrioHeap *heap, int slot) {
+    int task = heap->items[slot];
+    for (;;) {
+        int child = 2 * slot + 1;
+        if (child >= heap->size) break;
+        if (child + 1 < heap->size && sim->key[heap->items[child + 1]] < sim->key[heap->items[child]]) child++;
+        if (sim->key[heap->items[child]] >= sim->key[task]) break;
+        heap_place(sim, heap, slot, heap->items[child]);
+        slot = child;
+    }
+    heap_place(sim, heap, slot, task);
+}
+
+static void heap_push(PrioSim *sim, PrioHeap *heap, int task) {
+    heap->items[heap->size] = task;
+    sim->position[task] = heap->size++;
+    heap_sift_up(sim, heap, heap->size - 1);
+}
+
+static int heap_pop(PrioSim *sim, PrioHeap *heap) {
+    int top = heap->items[0];
+    if (--heap->size > 0) {
+        heap_place(sim, heap, 0, heap->items[heap->size]);
+        heap_sift_down(sim, heap, 0);
+    }
+    return top;
+}
+
+// Re-key a queued task after its effective priority changed: O(log n)
+static void heap_fix(PrioSim *sim, PrioHeap *heap, int task) {
+    heap_sift_up(sim, heap, sim->position[task]);
+    heap_sift_down(sim, heap, sim->position[task]);
+}
+
+static void set_key(PrioSim *sim, int task) {
+    sim->key[task] = sim->eff[task] * sim->scale + sim->stamp[task];
+}
+
+// Start waiting now (ready or blocked)
+static void start_waiting(PrioSim *sim, int task) {
+    sim->stamp[task] = sim->config->aging_interval > 0 ? sim->now : sim->sequence++;
+    set_key(sim, task);
+}
+
+// Does the best ready task take the CPU from the running one?
+static int should_preempt(const PrioSim *sim, int running) {
+    if (sim->ready.size == 0) return 0;
+    if (running < 0) return 1;
+    int top = sim->ready.items[0];
+    if (sim->config->aging_interval > 0) {
+        return sim->key[top] < sim->key[running];
+    }
+    return sim->eff[top] < sim->eff[running];
+}
+
+// Give task the lock (called when it reaches its critical section or is handed the lock)
+static void grant_lock(PrioSim *sim, int task, int lock) {
+    sim->owner[lock] = task;
+    sim->phase[task] = 1;
+    int eff = sim->tasks[task].priority;
+    if (sim->config->lock_protocol == PRIO_LOCK_CEILING && sim->ceiling[lock] < eff) {
+        eff = sim->ceiling[lock];
+        sim->result->priority_updates++;
+    } else if (sim->config->lock_protocol == PRIO_LOCK_INHERITANCE && sim->waiters[lock].size > 0) {
+        int best = sim->eff[sim->waiters[lock].items[0]];
+        if (best < eff) eff = best;
+    }
+    sim->eff[task] = eff;
+    set_key(sim, task);
+}
+
+// Running task reaches its lock; returns 0 if it blocked
+static int acquire_lock(PrioSim *sim, int task) {
+    int lock = sim->tasks[task].lock;
+    if (sim->owner[lock] < 0) {
+        grant_lock(sim, task, lock);
+        return 1;
+    }
+    start_waiting(sim, task);
+    heap_push(sim, &sim->waiters[lock], task);
+    int owner = sim->owner[lock];
+    if (sim->config->lock_protocol == PRIO_LOCK_INHERITANCE && sim->eff[task] < sim->eff[owner]) {
+        // The holder is ready or running, never blocked: it holds its only lock
+        sim->eff[owner] = sim->eff[task];
+        sim->result->priority_updates++;
+        set_key(sim, owner);
+        if (sim->position[owner] >= 0) heap_fix(sim, &sim->ready, owner);
+    }
+    return 0;
+}
+
+static void release_lock(PrioSim *sim, int task) {
+    int lock = sim->tasks[task].lock;
+    sim->phase[task] = 2;
+    sim->eff[task] = sim->tasks[task].priority;
+    set_key(sim, task);
+    sim->owner[lock] = -1;
+    if (sim->waiters[lock].size > 0) {
+        // Hand over to the best waiter; its wait keeps counting from when it blocked
+        int next = heap_pop(sim, &sim->waiters[lock]);
+        grant_lock(sim, next, lock);
+        heap_push(sim, &sim->ready, next);
+    }
+}
+
+// Blocked waiters held up by a less urgent task that is not the lock holder
+static void account_inversions(PrioSim *sim, int running, long long step) {
+    PrioResult *result = sim->result;
+    for (int lock = 0; lock < PRIO_MAX_LOCKS; lock++) {
+        int owner = sim->owner[lock];
+        int inverted = 0;
+        if (running >= 0 && owner >= 0 && owner != running && sim->waiters[lock].size > 0) {
+            int waiter = sim->waiters[lock].items[0];
+            inverted = sim->tasks[running].priority > sim->tasks[waiter].priority;
+            if (inverted) {
+                if (sim->inversion_start[lock] < 0) {
+                    sim->inversion_start[lock] = sim->now;
+                    result->inversions++;
+                }
+                long long length = sim->now + step - sim->inversion_start[lock];
+                if (length > result->longest_inversion) {
+                    result->longest_inversion = length;
+                    result->inversion_waiter = sim->tasks[waiter].id;
+                    result->inversion_owner = sim->tasks[owner].id;
+                    result->inversion_runner = sim->tasks[running].id;
+                }
+                result->inversion_time += step;
+            }
+        }
+        if (!inverted) sim->inversion_start[lock] = -1;
+    }
+}
+
+// Run the workload to completion; returns 1 on success
+int prio_simulate(const PrioSchedConfig *config, const PrioTask *tasks, int count, PrioResult *result) {
+    memset(result, 0, sizeof(*result));
+    if (count < 1) return 0;
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    PrioSim sim;
+    memset(&sim, 0, sizeof(sim));
+    sim.tasks = tasks;
+    sim.config = config;
+    sim.result = result;
+    sim.scale = config->aging_interval > 0 ? config->aging_interval : NO_AGING_SCALE;
+    sim.key = arena_alloc(arena, sizeof(long long) * count);
+    sim.stamp = arena_alloc(arena, sizeof(long long) * count);
+    sim.eff = arena_alloc(arena, sizeof(int) * count);
+    sim.position = arena_alloc(arena, sizeof(int) * count);
+    sim.done = arena_calloc(arena, (size_t)count, sizeof(int));
+    sim.phase = arena_alloc(arena, (size_t)count);
+    sim.ready.items = arena_alloc(arena, sizeof(int) * count);
+    int *order = arena_alloc(arena, sizeof(int) * count);
+    unsigned long long *keys = arena_alloc(arena, sizeof(unsigned long long) * count);
+    double *wait = arena_alloc(arena, sizeof(double) * count);
+    int ok = sim.key && sim.stamp && sim.eff && sim.position && sim.done && sim.phase &&
+             sim.ready.items && order && keys && wait;
+
+    int lock_used[PRIO_MAX_LOCKS] = {0};
+    for (int lock = 0; lock < PRIO_MAX_LOCKS; lock++) {
+        sim.owner[lock] = -1;
+        sim.ceiling[lock] = PRIO_LEVELS;
+        sim.inversion_start[lock] = -1;
+    }
+    for (int i = 0; ok && i < count; i++) {
+        order[i] = i;
+        sim.eff[i] = tasks[i].priority;
+        sim.position[i] = -1;
+        int lock = tasks[i].lock;
+        sim.phase[i] = lock >= 0 && lock < PRIO_MAX_LOCKS ? 0 : 2;
+        if (sim.phase[i] == 0) {
+            lock_used[lock] = 1;
+            if (tasks[i].priority < sim.ceiling[lock]) sim.ceiling[lock] = tasks[i].priority;
+        }
+    }
+    for (int lock = 0; ok && lock < PRIO_MAX_LOCKS; lock++) {
+        if (lock_used[lock]) {
+            sim.waiters[lock].items = arena_alloc(arena, sizeof(int) * count);
+            ok = sim.waiters[lock].items != NULL;
+        }
+    }
+    if (!ok) {
+        arena_release(arena, mark);
+        printf("Not enough memory to schedule %d tasks.\n", count);
+        return 0;
+    }
+    // Admission order: arrival time (sign bit flipped so it sorts unsigned), then index
+    for (int i = 0; i < count; i++) {
+        keys[i] = ((unsigned long long)((unsigned int)tasks[i].arrival ^ 0x80000000u) << 32) | (unsigned int)i;
+    }
+    qsort(keys, (size_t)count, sizeof(unsigned long long), wg_compare_packed);
+    for (int i = 0; i < count; i++) order[i] = (int)(keys[i] & 0xffffffffu);
+
+    int admitted = 0, running = -1, last_run = -1;
+    long long completed = 0, wait_sum = 0;
+    while (completed < count) {
+        while (admitted < count && tasks[order[admitted]].arrival <= sim.now) {
+            int task = order[admitted++];
+            start_waiting(&sim, task);
+            heap_push(&sim, &sim.ready, task);
+        }
+        if (should_preempt(&sim, running)) {
+            if (running >= 0) {
+                start_waiting(&sim, running);
+                heap_push(&sim, &sim.ready, running);
+            }
+            running = heap_pop(&sim, &sim.ready);
+            sim.position[running] = -1;
+            if (running != last_run && last_run >= 0) result->context_switches++;
+            last_run = running;
+        }
+        if (running < 0) {
+            if (admitted >= count) break;   // unreachable: a blocked task's holder is always runnable
+            sim.now = tasks[order[admitted]].arrival;  // idle until the next arrival
+            continue;
+        }
+
+        // Milestones at the current point of the running task's burst
+        const PrioTask *task = &tasks[running];
+        int lock_at = task->lock_at < task->burst ? task->lock_at : task->burst;
+        int hold_end = lock_at + task->lock_hold < task->burst ? lock_at + task->lock_hold : task->burst;
+        int *done = &sim.done[running];
+        if (sim.phase[running] == 0 && *done >= lock_at) {
+            if (!acquire_lock(&sim, running)) {
+                running = -1;
+                continue;
+            }
+        }
+        if (sim.phase[running] == 1 && *done >= hold_end) {
+            release_lock(&sim, running);
+            continue;       // a woken waiter may preempt
+        }
+        if (*done >= task->burst) {
+            long long waited = sim.now - task->arrival - task->burst;
+            wait[completed++] = (double)waited;
+            wait_sum += waited;
+            if (waited > result->max_wait) {
+                result->max_wait = waited;
+                result->max_wait_id = task->id;
+            }
+            int level = task->priority < 0 ? 0 : task->priority >= PRIO_LEVELS ? PRIO_LEVELS - 1 : task->priority;
+            if (waited > result->max_wait_by_level[level]) result->max_wait_by_level[level] = waited;
+            running = -1;
+            continue;
+        }
+
+        // Run until the next milestone or arrival
+        long long step = (sim.phase[running] == 0 ? lock_at : sim.phase[running] == 1 ? hold_end : task->burst) - *done;
+        if (admitted < count && tasks[order[admitted]].arrival - sim.now < step) {
+            step = tasks[order[admitted]].arrival - sim.now;
+        }
+        account_inversions(&sim, running, step);
+        sim.now += step;
+        *done += (int)step;
+    }
+
+    result->completed = completed;
+    result->makespan = sim.now;
+    result->avg_wait = (double)wait_sum / count;
+    result->p99_wait = (long long)wg_select_kth(wait, count, (int)((count - 1) * 0.99));
+    arena_release(arena, mark);
+    return 1;
+}
+
+void prio_print_result(const char *label, const PrioResult *result) {
+    printf("%-18s wait avg %8.1f p99 %7lld max %8lld (task %d) | inversion %7lld ticks in %5lld episodes, longest %6lld | %lld re-keys\n",
+           label, result->avg_wait, result->p99_wait, result->max_wait, result->max_wait_id,
+           result->inversion_time, result->inversions, result->longest_inversion, result->priority_updates);
+}
+
+// ---- faults on the simulated process table ----
+static int inversion_low = -1, inversion_medium = -1, inversion_high = -1;
+static int starvation_pid = -1;
+static PrioSchedConfig active_config = {PRIO_LOCK_PLAIN, 0};
+
+void prio_inversion_start(int low_pid, int medium_pid, int high_pid) {
+    inversion_low = low_pid;
+    inversion_medium = medium_pid;
+    inversion_high = high_pid;
+}
+
+void prio_starvation_start(int pid) {
+    starvation_pid = pid;
+}
+
+const PrioSchedConfig *prio_active_config() {
+    return &active_config;
+}
+
+void prio_set_active_config(const PrioSchedConfig *config) {
+    active_config = *config;
+}
+
+void prio_reset_state() {
+    inversion_low = inversion_medium = inversion_high = -1;
+    starvation_pid = -1;
+    prio_default_config(&active_config);
+}
+
+static PrioTask *add_task(PrioTask *tasks, int *count, int id, int arrival, int burst, int priority) {
+    PrioTask *task = &tasks[(*count)++];
+    task->id = id;
+    task->arrival = arrival;
+    task->burst = burst;
+    task->priority = priority;
+    task->lock = -1;
+    task->lock_at = 0;
+    task->lock_hold = 0;
+    return task;
+}
+
+static int table_priority(int pid, int fallback) {
+    int index = pcb_find_pid(pid);
+    return index >= 0 ? pcb_table[index].priority : fallback;
+}
+
+// Lock-free background load plus the process table and any injected
+// scenario; capacity must be at least PRIO_WORKLOAD_CAPACITY
+int prio_build_workload(PrioTask *tasks, int capacity) {
+    if (capacity < PRIO_WORKLOAD_CAPACITY) return 0;
+    int count = PRIO_BACKGROUND_TASKS;
+    prio_generate_workload(tasks, count, 0.5, 0.0f, 11);
+    for (int i = 0; i < count; i++) {
+        tasks[i].id = 100000 + i;
+        tasks[i].priority++;                // background runs at 2-6
+    }
+    int start = tasks[count / 2].arrival;   // scenarios play out mid-run
+
+    PcbReadGuard view = pcb_read_begin();
+    for (int i = 0; i < view.snapshot->count; i++) {
+        const PCB *pcb = &view.snapshot->rows[i];
+        add_task(tasks, &count, pcb->pid, pcb->arrival_time, 10 * (pcb->burst_time > 0 ? pcb->burst_time : 1),
+                 pcb->priority);
+    }
+    pcb_read_end(&view);
+
+    if (inversion_high >= 0) {
+        // Low takes the shared lock, high blocks on it, medium then runs for a long time
+        PrioTask *low = add_task(tasks, &count, inversion_low, start, 60, table_priority(inversion_low, 8));
+        low->lock = 0;
+        low->lock_at = 1;
+        low->lock_hold = 50;
+        PrioTask *high = add_task(tasks, &count, inversion_high, start + 5, 20, table_priority(inversion_high, 0));
+        high->lock = 0;
+        high->lock_hold = 10;
+        add_task(tasks, &count, inversion_medium, start + 8, 400, table_priority(inversion_medium, 4));
+    }
+    if (starvation_pid >= 0) {
+        // A long run of urgent work arriving faster than the CPU can serve it
+        add_task(tasks, &count, starvation_pid, start, 30, table_priority(starvation_pid, PRIO_LEVELS - 1));
+        PrioTask *flood = tasks + count;
+        prio_generate_workload(flood, PRIO_FLOOD_TASKS, 0.4, 0.0f, 12);
+        for (int i = 0; i < PRIO_FLOOD_TASKS; i++) {
+            flood[i].id = 200000 + i;
+            flood[i].arrival += start;
+            flood[i].priority = 1;
+        }
+        count += PRIO_FLOOD_TASKS;
+    }
+    return count;
+}
+
+// CLI: priority [tasks] [load] [lock share]
+int priority_command(int argc, char *argv[]) {
+    int count = 200000;
+    double load = 0.95;
+    float lock_share = 0.1f;
+    if (argc > 0) count = atoi(argv[0]);
+    if (argc > 1) load = atof(argv[1]);
+    if (argc > 2) lock_share = (float)atof(argv[2]);
+    if (count < 1 || load <= 0.0 || lock_share < 0.0f || lock_share > 1.0f) {
+        printf("Usage: priority [tasks] [load] [lock share 0-1]\n");
+        return 1;
+    }
+
+    run_arena_reset();
+    PrioTask *tasks = arena_alloc(run_arena(), sizeof(PrioTask) * (size_t)count);
+    if (tasks == NULL) {
+        printf("Not enough memory for %d tasks.\n", count);
+        run_arena_print_stats("Run");
+        return 1;
+    }
+    prio_generate_workload(tasks, count, load, lock_share, 42);
+    printf("=== PRIORITY SCHEDULING: %d tasks, load %.2f, %.0f%% with critical sections ===\n",
+           count, load, lock_share * 100.0f);
+    PrioSchedConfig configs[] = {
+        {PRIO_LOCK_PLAIN, 0},
+        {PRIO_LOCK_PLAIN, PRIO_AGING_INTERVAL},
+        {PRIO_LOCK_INHERITANCE, 0},
+        {PRIO_LOCK_CEILING, 0},
+        {PRIO_LOCK_INHERITANCE, PRIO_AGING_INTERVAL}
+    };
+    for (int c = 0; c < (int)(sizeof(configs) / sizeof(configs[0])); c++) {
+        PrioResult result;
+        if (prio_simulate(&configs[c], tasks, count, &result)) {
+            prio_print_result(prio_config_name(&configs[c]), &result);
+            printf("%-18s max wait by priority:", "");
+            for (int level = 1; level <= 5; level++) {
+                printf(" %d:%lld", level, result.max_wait_by_level[level]);
+            }
+            printf("\n");
+        }
+    }
+    run_arena_print_stats("\nRun");
+    run_arena_reset();
+    return 0;
+}
@@ -0,0 +1,72 @@
+/*
+ * priority_sched.h - Header for the preemptive priority scheduler with locks,
+ * aging and priority inheritance / ceiling
+ */
+
+#ifndef PRIORITY_SCHED_H
+#define PRIORITY_SCHED_H
+
+#define PRIO_LEVELS 10              // base priorities 0..9, lower runs first
+#define PRIO_MAX_LOCKS 8
+#define PRIO_AGING_INTERVAL 50      // ticks of waiting that earn one priority level
+#define PRIO_STARVATION_LIMIT 2000  // waits longer than this (ticks) count as starvation
+#define PRIO_BACKGROUND_TASKS 100000
+#define PRIO_FLOOD_TASKS 20000      // urgent burst that starves the victim of inject_starvation()
+#define PRIO_WORKLOAD_CAPACITY (PRIO_BACKGROUND_TASKS + PRIO_FLOOD_TASKS + 16)
+
+typedef enum {
+    PRIO_LOCK_PLAIN,                // holders keep their own priority
+    PRIO_LOCK_INHERITANCE,          // holder runs at its best waiter's priority
+    PRIO_LOCK_CEILING               // holder runs at the lock's ceiling while it holds it
+} PrioLockProtocol;
+
+typedef struct {
+    PrioLockProtocol lock_protocol;
+    int aging_interval;             // 0 = no aging
+} PrioSchedConfig;
+
+typedef struct {
+    int id;                         // pid, or a synthetic id for background work
+    int arrival;
+    int burst;
+    int priority;
+    int lock;                       // -1 = no critical section
+    int lock_at;                    // CPU time into the burst when the lock is taken
+    int lock_hold;                  // CPU time spent holding it
+} PrioTask;
+
+typedef struct {
+    long long completed;
+    long long context_switches;
+    long long priority_updates;     // heap re-keys from inheritance and ceilings
+    long long makespan;
+    double avg_wait;
+    long long p99_wait;
+    long long max_wait;
+    int max_wait_id;
+    long long max_wait_by_level[PRIO_LEVELS];
+    long long inversion_time;       // a waiter blocked while a less urgent, non-holding task ran
+    long long longest_inversion;
+    long long inversions;           // episodes
+    int inversion_waiter;           // ids in the longest episode
+    int inversion_owner;
+    int inversion_runner;
+} PrioResult;
+
+void prio_default_config(PrioSchedConfig *config);
+const char *prio_config_name(const PrioSchedConfig *config);
+void prio_generate_workload(PrioTask *tasks, int count, double load, float lock_share, unsigned int seed);
+int prio_simulate(const PrioSchedConfig *config, const PrioTask *tasks, int count, PrioResult *result);
+void prio_print_result(const char *label, const PrioResult *result);
+
+// Faults on the simulated process table (fault injection and recovery)
+void prio_inversion_start(int low_pid, int medium_pid, int high_pid);
+void prio_starvation_start(int pid);
+int prio_build_workload(PrioTask *tasks, int capacity);
+const PrioSchedConfig *prio_active_config();
+void prio_set_active_config(const PrioSchedConfig *config);
+void prio_reset_state();
+
+int priority_command(int argc, char *argv[]);
+
+#endif // PRIORITY_SCHED_H
@@ -2,24 +2,351 @@
  * process_manager.c - Implementation for process management module
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <ctype.h>
+#include <stdatomic.h>
 #include "process_manager.h"
+#include "procfs.h"
+#include "rng.h"
+#include "workload_gen.h"
 
 // For simplicity, we use a static array to hold process information
 #define MAX_PROCESSES 10
 PCB pcb_table[MAX_PROCESSES];
 int process_count = 0;
 
+static PcbWatch *watches[PCB_MAX_WATCHES];
+static int watch_count = 0;
+
+// ---- RCU-style snapshots ----
+// pcb_table is the writers' working copy. Every change publishes a fresh
+// immutable PcbSnapshot with one atomic pointer swap; readers pin the epoch
+// they started in and read the current snapshot without taking any lock.
+// A replaced snapshot is freed only once no reader pinned at or before the
+// epoch it was retired in is still active.
+typedef struct SnapshotNode {
+    PcbSnapshot snapshot;               // first, so a PcbSnapshot * is the node
+    unsigned long long retired_epoch;
+    struct SnapshotNode *next;
+} SnapshotNode;
+
+static _Atomic(PcbSnapshot *) current_snapshot = NULL;
+static const PcbSnapshot empty_snapshot = {0, 0, {{0}}};
+static atomic_ullong global_epoch = 1;
+static atomic_ullong reader_epochs[PCB_MAX_READERS];    // 0 = slot free
+static atomic_uint next_reader_slot;
+static atomic_flag write_lock = ATOMIC_FLAG_INIT;
+static SnapshotNode *retired = NULL;     // writer-owned, newest first
+static unsigned long long published_version = 0;
+
+static void lock_writers() {
+    while (atomic_flag_test_and_set_explicit(&write_lock, memory_order_acquire)) {
+        // writers are short: a row update and a table copy
+    }
+}
+
+static void unlock_writers() {
+    atomic_flag_clear_explicit(&write_lock, memory_order_release);
+}
+
+PcbReadGuard pcb_read_begin() {
+    PcbReadGuard guard;
+    unsigned long long epoch = atomic_load(&global_epoch);
+    unsigned int start = atomic_fetch_add_explicit(&next_reader_slot, 1, memory_order_relaxed);
+    for (unsigned int k = 0;; k++) {
+        int slot = (int)((start + k) % PCB_MAX_READERS);
+        unsigned long long expected = 0;
+        if (atomic_compare_exchange_weak(&reader_epochs[slot], &expected, epoch)) {
+            guard.slot = slot;
+            break;
+        }
+    }
+    const PcbSnapshot *snapshot = atomic_load(&current_snapshot);
+    guard.snapshot = snapshot != NULL ? snapshot : &empty_snapshot;
+    return guard;
+}
+
+void pcb_read_end(PcbReadGuard *guard) {
+    atomic_store(&reader_epochs[guard->slot], 0);
+    guard->snapshot = NULL;
+}
+
+// Free retired snapshots that no active reader can still hold
+static void reclaim_retired() {
+    unsigned long long oldest = ~0ULL;
+    for (int s = 0; s < PCB_MAX_READERS; s++) {
+        unsigned long long epoch = atomic_load(&reader_epochs[s]);
+        if (epoch != 0 && epoch < oldest) oldest = epoch;
+    }
+    SnapshotNode **link = &retired;
+    while (*link != NULL) {
+        SnapshotNode *node = *link;
+        if (node->retired_epoch < oldest) {
+            *link = node->next;
+            free(node);
+        } else {
+            link = &node->next;
+        }
+    }
+}
+
+// Copy the working table into a new snapshot and swap it in (writer lock held)
+static void publish_snapshot() {
+    SnapshotNode *next = malloc(sizeof(SnapshotNode));
+    if (next == NULL) {
+        return;     // readers keep the previous version
+    }
+    next->snapshot.version = ++published_version;
+    next->snapshot.count = process_count;
+    memcpy(next->snapshot.rows, pcb_table, sizeof(PCB) * process_count);
+    SnapshotNode *old = (SnapshotNode *)atomic_exchange(&current_snapshot, &next->snapshot);
+    if (old == NULL) {
+        return;
+    }
+    // Never wait for readers: a slow one only delays when old is freed
+    old->retired_epoch = atomic_fetch_add(&global_epoch, 1);
+    old->next = retired;
+    retired = old;
+    reclaim_retired();
+}
+
+// pid -> row, open addressed; rebuilt whenever a row changes hands
+#define PID_INDEX_SLOTS 32
+static int pid_index[PID_INDEX_SLOTS];  // row + 1, 0 = empty
+
+static void rebuild_pid_index() {
+    memset(pid_index, 0, sizeof(pid_index));
+    for (int i = 0; i < process_count; i++) {
+        unsigned int slot = ((unsigned int)pcb_table[i].pid * 2654435761u) & (PID_INDEX_SLOTS - 1);
+        while (pid_index[slot] != 0) {
+            slot = (slot + 1) & (PID_INDEX_SLOTS - 1);
+        }
+        pid_index[slot] = i + 1;
+    }
+}
+
+// Table row holding pid, or -1
+int pcb_find_pid(int pid) {
+    unsigned int slot = ((unsigned int)pid * 2654435761u) & (PID_INDEX_SLOTS - 1);
+    while (pid_index[slot] != 0) {
+        int row = pid_index[slot] - 1;
+        if (row < process_count && pcb_table[row].pid == pid) {
+            return row;
+        }
+        slot = (slot + 1) & (PID_INDEX_SLOTS - 1);
+    }
+    return -1;
+}
+
+static void queue_change(int index, unsigned int mask) {
+    if (index < 0 || index >= MAX_PROCESSES) {
+        return;
+    }
+    for (int w = 0; w < watch_count; w++) {
+        PcbWatch *watch = watches[w];
+        if ((watch->mask & mask) && !watch->queued[index]) {
+            watch->queued[index] = 1;
+            watch->dirty[watch->dirty_count++] = index;
+        }
+    }
+}
+
+// Publish a change to row index: interested watches queue it once, and
+// table edits (anything but a detector sample) become a new snapshot.
+// Code writing pcb_table directly must be single-threaded and call this after.
+void pcb_mark_changed(int index, unsigned int mask) {
+    lock_writers();
+    queue_change(index, mask);
+    if (mask & ~PCB_CHANGE_SAMPLE) publish_snapshot();
+    unlock_writers();
+}
+
+// Change published by pid (detector samples); pid 0 means every row
+void pcb_mark_pid_changed(int pid, unsigned int mask) {
+    lock_writers();
+    if (pid == 0) {
+        for (int i = 0; i < MAX_PROCESSES; i++) {
+            queue_change(i, mask);
+        }
+    } else {
+        queue_change(pcb_find_pid(pid), mask);
+    }
+    if (mask & ~PCB_CHANGE_SAMPLE) publish_snapshot();
+    unlock_writers();
+}
+
+// Bulk reload (init, restore): every row is re-evaluated on the next collect
+void pcb_mark_all_changed() {
+    rebuild_pid_index();
+    pcb_mark_pid_changed(0, PCB_CHANGE_ALL);
+}
+
+// Empty the table (trace replay rebuilds it from recorded frames); every
+// watch drops its rows on the next collect
+void pcb_clear_table() {
+    lock_writers();
+    process_count = 0;
+    rebuild_pid_index();
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        queue_change(i, PCB_CHANGE_ALL);
+    }
+    publish_snapshot();
+    unlock_writers();
+}
+
+// Setters may be called from several threads at once
+void pcb_set_state(int index, int state) {
+    lock_writers();
+    pcb_table[index].state = state;
+    queue_change(index, PCB_CHANGE_STATE);
+    publish_snapshot();
+    unlock_writers();
+}
+
+void pcb_set_cpu_usage(int index, float cpu_usage) {
+    lock_writers();
+    pcb_table[index].cpu_usage = cpu_usage;
+    queue_change(index, PCB_CHANGE_CPU);
+    publish_snapshot();
+    unlock_writers();
+}
+
+void pcb_set_allocated_memory(int index, int allocated_memory) {
+    lock_writers();
+    pcb_table[index].allocated_memory = allocated_memory;
+    queue_change(index, PCB_CHANGE_MEMORY);
+    publish_snapshot();
+    unlock_writers();
+}
+
+void pcb_set_mem_usage(int index, float mem_usage) {
+    lock_writers();
+    pcb_table[index].mem_usage = mem_usage;
+    queue_change(index, PCB_CHANGE_MEMORY);
+    publish_snapshot();
+    unlock_writers();
+}
+
+void pcb_set_priority(int index, int priority) {
+    lock_writers();
+    pcb_table[index].priority = priority;
+    queue_change(index, PCB_CHANGE_PRIORITY);
+    publish_snapshot();
+    unlock_writers();
+}
+
+// Subscribe a watch; the current table counts as changed for it
+void pcb_watch_register(PcbWatch *watch, unsigned int mask, int (*condition)(const PCB *pcb)) {
+    lock_writers();
+    if (watch->registered || watch_count >= PCB_MAX_WATCHES) {
+        unlock_writers();
+        return;
+    }
+    memset(watch, 0, sizeof(*watch));
+    watch->mask = mask;
+    watch->condition = condition;
+    watch->registered = 1;
+    watches[watch_count++] = watch;
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        watch->queued[i] = 1;
+        watch->dirty[watch->dirty_count++] = i;
+    }
+    unlock_writers();
+}
+
+static int compare_index(const void *a, const void *b) {
+    return *(const int *)a - *(const int *)b;
+}
+
+// Re-evaluate the changed rows, then list the rows matching the condition
+// in table order. Cost is O(changes log changes + matches), independent of
+// table size: new members are sorted and merged into the ordered list, and
+// members that stopped matching are dropped on the same pass.
+int pcb_watch_collect(PcbWatch *watch, int *indices) {
+    lock_writers();
+    int added = 0;
+    for (int k = 0; k < watch->dirty_count; k++) {
+        int i = watch->dirty[k];
+        watch->queued[i] = 0;
+        int holds = i < process_count && watch->condition(&pcb_table[i]);
+        if (holds && !watch->member[i]) {
+            watch->dirty[added++] = i;      // reuse the drained prefix
+        }
+        watch->member[i] = (unsigned char)holds;
+    }
+    watch->dirty_count = 0;
+    qsort(watch->dirty, (size_t)added, sizeof(int), compare_index);
+
+    // Merge from the back: old and new members are disjoint rows, so the
+    // list never outgrows the table
+    int old = watch->member_count - 1, fresh = added - 1, at = watch->member_count + added;
+    while (fresh >= 0) {
+        watch->members[--at] = old >= 0 && watch->members[old] > watch->dirty[fresh]
+            ? watch->members[old--] : watch->dirty[fresh--];
+    }
+
+    // Rows past a shrunken table stay members until they are reused
+    int kept = 0, count = 0;
+    for (int k = 0; k < watch->member_count + added; k++) {
+        int i = watch->members[k];
+        if (!watch->member[i]) continue;
+        watch->members[kept++] = i;
+        if (i < process_count) indices[count++] = i;
+    }
+    watch->member_count = kept;
+    unlock_writers();
+    return count;
+}
+
+// Fetch real process data from /proc (Linux); returns the number loaded
+static int init_procfs_processes() {
+    int pids[1024];
+    int pid_total = procfs_list_pids(pids, 1024);
+    long page_kb = procfs_page_size() / 1024;
+
+    for (int i = 0; i < pid_total && process_count < MAX_PROCESSES; i++) {
+        ProcPidStat stat;
+        // Kernel threads have no resident memory and are skipped
+        if (!procfs_read_pid_stat(pids[i], &stat) || stat.rss_pages <= 0) {
+            continue;
+        }
+        PCB *pcb = &pcb_table[process_count];
+        pcb->pid = stat.pid;
+        snprintf(pcb->name, sizeof(pcb->name), "%s", stat.name);
+        if (!procfs_read_pid_cgroup(stat.pid, pcb->cgroup, sizeof(pcb->cgroup))) {
+            snprintf(pcb->cgroup, sizeof(pcb->cgroup), "/");
+        }
+        pcb->allocated_memory = (int)(stat.rss_pages * page_kb);
+        pcb->mem_usage = pcb->allocated_memory / 1024.0;   // Convert to MB
+
+        // Assign random values for simulation parameters
+        pcb->cpu_usage = (rng_next() % 50) / 10.0 + 1.0;
+        pcb->arrival_time = rng_next() % 10;
+        pcb->burst_time = rng_next() % 10 + 1;
+        pcb->priority = rng_next() % 5 + 1;
+        pcb->state = 0; // Ready state
+        process_count++;
+    }
+    pcb_mark_all_changed();
+    return process_count;
+}
+
 // Function to fetch real process data from Windows
 void init_process_manager() {
     // Seed the random number generator
-    srand((unsigned int)time(NULL));
+    rng_seed((unsigned long long)time(NULL));
     
     process_count = 0;
+
+    if (procfs_available() && init_procfs_processes() > 0) {
+        printf("Loaded %d real processes from /proc.\n", process_count);
+        return;
+    }
     
     // Use Windows tasklist command to get real processes
     FILE *fp = popen("tasklist /fo csv", "r");
@@ -81,10 +408,10 @@ void init_process_manager() {
                         }
                         
                         // Assign random values for simulation parameters
-                        pcb_table[process_count].cpu_usage = (rand() % 50) / 10.0 + 1.0;
-                        pcb_table[process_count].arrival_time = rand() % 10;
-                        pcb_table[process_count].burst_time = rand() % 10 + 1;
-                        pcb_table[process_count].priority = rand() % 5 + 1;
+                        pcb_table[process_count].cpu_usage = (rng_next() % 50) / 10.0 + 1.0;
+                        pcb_table[process_count].arrival_time = rng_next() % 10;
+                        pcb_table[process_count].burst_time = rng_next() % 10 + 1;
+                        pcb_table[process_count].priority = rng_next() % 5 + 1;
                         pcb_table[process_count].state = 0; // Ready state
                         
                         process_count++;
@@ -95,6 +422,7 @@ void init_process_manager() {
     }
     
     pclose(fp);
+    pcb_mark_all_changed();
     
     if (process_count == 0) {
         printf("No processes found. Using dummy data.\n");
@@ -107,30 +435,94 @@ void init_process_manager() {
 // Fallback function for dummy processes
 void init_dummy_processes() {
     process_count = 5;
-    
+
+    // Poisson arrivals with exponential bursts capped at 10, seeded from the
+    // simulator's RNG so --seed and checkpoints still reproduce the table
+    WgProcessConfig config;
+    wg_default_process_config(&config);
+    config.arrival_rate = 0.5;
+    config.burst_mean = 5.0;
+    config.burst_max = 10;
+    config.seed = (unsigned long long)rng_next();
+    WgProcessStream stream;
+    WgProcess jobs[MAX_PROCESSES];
+    wg_process_init(&stream, &config);
+    wg_process_batch(&stream, jobs, process_count);
+
     for (int i = 0; i < process_count; i++) {
         pcb_table[i].pid = 100 + i;
         snprintf(pcb_table[i].name, sizeof(pcb_table[i].name), "Process_%c", 'A' + i);
-        pcb_table[i].cpu_usage = (rand() % 50) / 10.0 + 5.0;
-        pcb_table[i].mem_usage = (rand() % 50) / 10.0 + 5.0;
-        pcb_table[i].arrival_time = rand() % 10;
-        pcb_table[i].burst_time = rand() % 10 + 1;
-        pcb_table[i].priority = rand() % 5 + 1;
-        pcb_table[i].allocated_memory = rand() % 200 + 50;
+        snprintf(pcb_table[i].cgroup, sizeof(pcb_table[i].cgroup), "/");
+        pcb_table[i].cpu_usage = (rng_next() % 50) / 10.0 + 5.0;
+        pcb_table[i].mem_usage = (rng_next() % 50) / 10.0 + 5.0;
+        pcb_table[i].arrival_time = (int)jobs[i].arrival;
+        pcb_table[i].burst_time = jobs[i].burst;
+        pcb_table[i].priority = jobs[i].priority;
+        pcb_table[i].allocated_memory = (rng_next() % 200 + 50) * 1024;
         pcb_table[i].state = 0;
     }
+    pcb_mark_all_changed();
+}
+
+// Track an extra process (e.g. a stress worker); returns its table index.
+// A known pid is updated in place; when the table is full, slots are
+// recycled from the end so consecutive additions do not evict each other.
+// A NULL cgroup is read from /proc/<pid>/cgroup, so pass the recorded one
+// for pids that do not live on this host.
+int add_process(int pid, const char *name, const char *cgroup) {
+    static int evict_cursor = 0;
+    char path[sizeof(pcb_table[0].cgroup)];
+    if (cgroup) {
+        snprintf(path, sizeof(path), "%s", cgroup);
+    } else if (!procfs_read_pid_cgroup(pid, path, sizeof(path))) {
+        snprintf(path, sizeof(path), "/");
+    }
+    int burst_time = rng_next() % 10 + 1;
+    int priority = rng_next() % 5 + 1;
+
+    // Workers add themselves from their own threads: the row and the pid
+    // index change together under the writer lock
+    lock_writers();
+    int index = pcb_find_pid(pid);
+    int known = index >= 0;
+    if (index < 0 && process_count < MAX_PROCESSES) {
+        index = process_count++;
+    } else if (index < 0) {
+        index = MAX_PROCESSES - 1 - (evict_cursor++ % MAX_PROCESSES);
+    }
+    PCB *pcb = &pcb_table[index];
+    pcb->pid = pid;
+    snprintf(pcb->name, sizeof(pcb->name), "%s", name);
+    snprintf(pcb->cgroup, sizeof(pcb->cgroup), "%s", path);
+    pcb->cpu_usage = 1.0;
+    pcb->mem_usage = 1.0;
+    pcb->arrival_time = 0;
+    pcb->burst_time = burst_time;
+    pcb->priority = priority;
+    pcb->allocated_memory = 100 * 1024;
+    pcb->state = 0;
+    if (!known) {
+        rebuild_pid_index();
+    }
+    queue_change(index, PCB_CHANGE_ALL);
+    publish_snapshot();
+    unlock_writers();
+    return index;
 }
 
 // Function to display the process table
 void display_process_table() {
     printf("\n----- Process Table -----\n");
-    printf("PID\tName\t\tCPU%%\tMEM%%\tState\n");
-    for (int i = 0; i < process_count; i++) {
-        printf("%d\t%s\t\t%.1f\t%.1f\t%d\n",
-               pcb_table[i].pid,
-               pcb_table[i].name,
-               pcb_table[i].cpu_usage,
-               pcb_table[i].mem_usage,
-               pcb_table[i].state);
+    PcbReadGuard view = pcb_read_begin();
+    printf("PID\tName\t\tCPU%%\tMEM%%\tState\tCgroup\n");
+    for (int i = 0; i < view.snapshot->count; i++) {
+        printf("%d\t%s\t\t%.1f\t%.1f\t%d\t%s\n",
+               view.snapshot->rows[i].pid,
+               view.snapshot->rows[i].name,
+               view.snapshot->rows[i].cpu_usage,
+               view.snapshot->rows[i].mem_usage,
+               view.snapshot->rows[i].state,
+               view.snapshot->rows[i].cgroup[0] ? view.snapshot->rows[i].cgroup : "/");
     }
+    pcb_read_end(&view);
 }
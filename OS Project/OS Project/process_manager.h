@@ -8,6 +8,7 @@
 void init_process_manager();
 void init_dummy_processes();
 void display_process_table();
+int add_process(int pid, const char *name, const char *cgroup);
 
 // Define the Process Control Block structure
 typedef struct {
@@ -18,12 +19,66 @@ typedef struct {
     int arrival_time;   
     int burst_time;     
     int priority;       
-    int allocated_memory;
+    int allocated_memory;   // KB
     int state;          // 0 = ready, 1 = running, 2 = waiting
+    char cgroup[64];    // cgroup v2 path, "/" when unknown
 } PCB;
 
 #define MAX_PROCESSES 10
 extern PCB pcb_table[MAX_PROCESSES];
 extern int process_count;
 
+// Fields a change event can carry; watches subscribe to a mask of these
+#define PCB_CHANGE_STATE 0x1
+#define PCB_CHANGE_CPU 0x2
+#define PCB_CHANGE_MEMORY 0x4
+#define PCB_CHANGE_SAMPLE 0x8           // a detector's live verdict for the pid moved
+#define PCB_CHANGE_PRIORITY 0x10
+#define PCB_CHANGE_ALL 0x1f
+#define PCB_MAX_WATCHES 8
+
+// A detector's view of one condition: the rows where it currently holds,
+// kept up to date by re-evaluating only the rows changed since last collect
+typedef struct {
+    unsigned int mask;
+    int (*condition)(const PCB *pcb);
+    unsigned char member[MAX_PROCESSES];    // condition held at the last collect
+    int members[MAX_PROCESSES];             // those rows, in table order
+    int member_count;
+    unsigned char queued[MAX_PROCESSES];
+    int dirty[MAX_PROCESSES];
+    int dirty_count;
+    int registered;
+} PcbWatch;
+
+// Immutable published copy of the table; readers never see a half-applied write
+typedef struct {
+    unsigned long long version;
+    int count;
+    PCB rows[MAX_PROCESSES];
+} PcbSnapshot;
+
+typedef struct {
+    const PcbSnapshot *snapshot;
+    int slot;
+} PcbReadGuard;
+
+#define PCB_MAX_READERS 64
+
+PcbReadGuard pcb_read_begin();
+void pcb_read_end(PcbReadGuard *guard);
+
+void pcb_set_state(int index, int state);
+void pcb_set_cpu_usage(int index, float cpu_usage);
+void pcb_set_allocated_memory(int index, int allocated_memory);
+void pcb_set_mem_usage(int index, float mem_usage);
+void pcb_set_priority(int index, int priority);
+int pcb_find_pid(int pid);
+void pcb_mark_changed(int index, unsigned int mask);
+void pcb_mark_pid_changed(int pid, unsigned int mask);
+void pcb_mark_all_changed();
+void pcb_clear_table();
+void pcb_watch_register(PcbWatch *watch, unsigned int mask, int (*condition)(const PCB *pcb));
+int pcb_watch_collect(PcbWatch *watch, int *indices);
+
 #endif // PROCESS_MANAGER_H
@@ -0,0 +1,362 @@
+/*
+ * procfs.c - Implementation of Linux /proc sampling helpers
+ *
+ * The readers avoid stdio and use a single read() per file so that a full
+ * host scan stays cheap enough to run several times per second.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "procfs.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Read a small /proc file into buf; returns bytes read or -1
+static int read_small_file(const char *path, char *buf, int size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    int n = (int)read(fd, buf, size - 1);
+    close(fd);
+    if (n < 0) {
+        return -1;
+    }
+    buf[n] = '\0';
+    return n;
+}
+
+// Parse an unsigned decimal and advance past the trailing separator
+static unsigned long next_field(const char **cursor) {
+    const char *p = *cursor;
+    unsigned long value = 0;
+    int negative = 0;
+    if (*p == '-') {
+        negative = 1;
+        p++;
+    }
+    while (*p >= '0' && *p <= '9') {
+        value = value * 10 + (unsigned long)(*p - '0');
+        p++;
+    }
+    while (*p == ' ') p++;
+    *cursor = p;
+    return negative ? 0 : value;
+}
+
+static void skip_fields(const char **cursor, int count) {
+    const char *p = *cursor;
+    for (int i = 0; i < count && *p; i++) {
+        while (*p && *p != ' ') p++;
+        while (*p == ' ') p++;
+    }
+    *cursor = p;
+}
+#endif
+
+int procfs_available() {
+#ifdef __linux__
+    return access("/proc/self/stat", R_OK) == 0;
+#else
+    return 0;
+#endif
+}
+
+// Fill pids with the numeric entries of /proc; returns the count found
+int procfs_list_pids(int *pids, int max_pids) {
+#ifdef __linux__
+    DIR *dir = opendir("/proc");
+    if (dir == NULL) {
+        return -1;
+    }
+    int count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL && count < max_pids) {
+        const char *s = entry->d_name;
+        if (*s < '1' || *s > '9') {
+            continue;
+        }
+        int pid = 0;
+        while (*s >= '0' && *s <= '9') {
+            pid = pid * 10 + (*s - '0');
+            s++;
+        }
+        if (*s == '\0') {
+            pids[count++] = pid;
+        }
+    }
+    closedir(dir);
+    return count;
+#else
+    (void)pids;
+    (void)max_pids;
+    return -1;
+#endif
+}
+
+// Read /proc/[pid]/stat; returns 1 on success, 0 if the process is gone
+int procfs_read_pid_stat(int pid, ProcPidStat *stat) {
+#ifdef __linux__
+    char path[64];
+    char buf[512];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    if (read_small_file(path, buf, sizeof(buf)) <= 0) {
+        return 0;
+    }
+
+    // The command name may contain spaces and parentheses, so split on the last ')'
+    char *open_paren = strchr(buf, '(');
+    char *close_paren = strrchr(buf, ')');
+    if (open_paren == NULL || close_paren == NULL || close_paren < open_paren) {
+        return 0;
+    }
+    int name_len = (int)(close_paren - open_paren - 1);
+    if (name_len > (int)sizeof(stat->name) - 1) {
+        name_len = sizeof(stat->name) - 1;
+    }
+    memcpy(stat->name, open_paren + 1, name_len);
+    stat->name[name_len] = '\0';
+    stat->pid = pid;
+
+    const char *p = close_paren + 2;
+    stat->state = *p;
+    skip_fields(&p, 7);                 // state .. flags (fields 3-9)
+    stat->minflt = next_field(&p);      // field 10
+    skip_fields(&p, 1);
+    stat->majflt = next_field(&p);      // field 12
+    skip_fields(&p, 1);
+    stat->utime = next_field(&p);       // field 14
+    stat->stime = next_field(&p);       // field 15
+    skip_fields(&p, 8);                 // cutime .. vsize (fields 16-23)
+    stat->rss_pages = (long)next_field(&p); // field 24
+    return 1;
+#else
+    (void)pid;
+    (void)stat;
+    return 0;
+#endif
+}
+
+#ifdef __linux__
+// Pull the avg10 values out of a PSI file; returns 1 if a "some" line was found
+static int parse_pressure(const char *path, float *some_avg10, float *full_avg10) {
+    char buf[256];
+    if (read_small_file(path, buf, sizeof(buf)) <= 0) {
+        return 0;
+    }
+    char *some = strstr(buf, "some avg10=");
+    char *full = strstr(buf, "full avg10=");
+    if (some != NULL) *some_avg10 = strtof(some + 11, NULL);
+    if (full != NULL && full_avg10 != NULL) *full_avg10 = strtof(full + 11, NULL);
+    return some != NULL;
+}
+#endif
+
+// Read the avg10 values of /proc/pressure/memory; returns 1 if PSI is available
+int procfs_read_memory_pressure(float *some_avg10, float *full_avg10) {
+    *some_avg10 = 0.0f;
+    *full_avg10 = 0.0f;
+#ifdef __linux__
+    return parse_pressure("/proc/pressure/memory", some_avg10, full_avg10);
+#else
+    return 0;
+#endif
+}
+
+// Copy the unified (v2) hierarchy path from /proc/[pid]/cgroup; returns 1 if found
+int procfs_read_pid_cgroup(int pid, char *path, int size) {
+#ifdef __linux__
+    char file[64];
+    char buf[2048];
+    snprintf(file, sizeof(file), "/proc/%d/cgroup", pid);
+    if (read_small_file(file, buf, sizeof(buf)) <= 0) {
+        return 0;
+    }
+    // v1 controllers come first on hybrid hosts; the v2 entry is "0::/path"
+    const char *line = buf;
+    while (line != NULL && strncmp(line, "0::", 3) != 0) {
+        line = strchr(line, '\n');
+        if (line != NULL) line++;
+    }
+    if (line == NULL) {
+        return 0;
+    }
+    line += 3;
+    int length = 0;
+    while (line[length] != '\0' && line[length] != '\n' && length < size - 1) {
+        path[length] = line[length];
+        length++;
+    }
+    path[length] = '\0';
+    return length > 0;
+#else
+    (void)pid;
+    (void)path;
+    (void)size;
+    return 0;
+#endif
+}
+
+// Mount point of the cgroup2 file system (/sys/fs/cgroup, or .../unified on
+// hybrid hosts), found once from /proc/self/mountinfo; NULL without cgroup v2
+const char *procfs_cgroup_root() {
+#ifdef __linux__
+    static char root[256];
+    static int probed = 0;
+    if (!probed) {
+        static char buf[65536];
+        probed = 1;
+        if (read_small_file("/proc/self/mountinfo", buf, sizeof(buf)) > 0) {
+            for (const char *line = buf; line != NULL && root[0] == '\0';) {
+                const char *end = strchr(line, '\n');
+                const char *type = strstr(line, " - cgroup2 ");
+                if (type != NULL && (end == NULL || type < end)) {
+                    // Fields: id parent major:minor root mount-point ...
+                    const char *p = line;
+                    skip_fields(&p, 4);
+                    int length = 0;
+                    while (p[length] != ' ' && p[length] != '\0' && length < (int)sizeof(root) - 1) length++;
+                    memcpy(root, p, length);
+                    root[length] = '\0';
+                }
+                line = end != NULL ? end + 1 : NULL;
+            }
+        }
+    }
+    return root[0] != '\0' ? root : NULL;
+#else
+    return NULL;
+#endif
+}
+
+#ifdef __linux__
+static long long read_limit_bytes(const char *path) {
+    char buf[64];
+    if (read_small_file(path, buf, sizeof(buf)) <= 0 || buf[0] == 'm') {
+        return 0;   // absent or "max"
+    }
+    return strtoll(buf, NULL, 10);
+}
+#endif
+
+// Read the interface files of one group (path as in /proc/[pid]/cgroup);
+// returns 1 if the group exists. Files a controller does not provide read as 0.
+int procfs_read_cgroup_files(const char *group, CgroupFiles *files) {
+    memset(files, 0, sizeof(*files));
+#ifdef __linux__
+    const char *root = procfs_cgroup_root();
+    if (root == NULL) {
+        return 0;
+    }
+    char path[512];
+    char buf[512];
+    int base = snprintf(path, sizeof(path), "%s%s", root, strcmp(group, "/") == 0 ? "" : group);
+    if (base <= 0 || base > (int)sizeof(path) - 32) {
+        return 0;
+    }
+    snprintf(path + base, sizeof(path) - base, "/cgroup.procs");
+    if (access(path, R_OK) != 0) {
+        return 0;
+    }
+    snprintf(path + base, sizeof(path) - base, "/cpu.stat");
+    if (read_small_file(path, buf, sizeof(buf)) > 0) {
+        char *usage = strstr(buf, "usage_usec ");
+        if (usage != NULL) files->cpu_usage_usec = strtoull(usage + 11, NULL, 10);
+    }
+    snprintf(path + base, sizeof(path) - base, "/cpu.max");
+    if (read_small_file(path, buf, sizeof(buf)) > 0 && buf[0] != 'm') {
+        char *end;
+        double quota = strtod(buf, &end);
+        double period = strtod(end, NULL);
+        if (quota > 0.0 && period > 0.0) files->cpu_limit = quota / period;
+    }
+    snprintf(path + base, sizeof(path) - base, "/memory.current");
+    files->memory_current = read_limit_bytes(path);
+    snprintf(path + base, sizeof(path) - base, "/memory.max");
+    files->memory_max = read_limit_bytes(path);
+    snprintf(path + base, sizeof(path) - base, "/cpu.pressure");
+    parse_pressure(path, &files->cpu_some_avg10, NULL);
+    snprintf(path + base, sizeof(path) - base, "/memory.pressure");
+    parse_pressure(path, &files->memory_some_avg10, &files->memory_full_avg10);
+    return 1;
+#else
+    (void)group;
+    return 0;
+#endif
+}
+
+// Read host and per-CPU jiffies from /proc/stat; returns the CPU count
+int procfs_read_cpu_times(CpuTimes *host, CpuTimes *cpus, int max_cpus) {
+#ifdef __linux__
+    static char buf[65536];
+    if (read_small_file("/proc/stat", buf, sizeof(buf)) <= 0) {
+        return -1;
+    }
+    int cpu_count = 0;
+    const char *line = buf;
+    while (line[0] == 'c' && line[1] == 'p' && line[2] == 'u') {
+        const char *p = line + 3;
+        int index = -1;
+        if (*p >= '0' && *p <= '9') {
+            index = (int)next_field(&p);
+        } else {
+            while (*p == ' ') p++;
+        }
+        unsigned long long field[8];
+        for (int i = 0; i < 8; i++) {
+            field[i] = next_field(&p);
+        }
+        // user nice system idle iowait irq softirq steal
+        CpuTimes times;
+        times.busy = field[0] + field[1] + field[2] + field[5] + field[6] + field[7];
+        times.total = times.busy + field[3] + field[4];
+        if (index < 0) {
+            *host = times;
+        } else if (index < max_cpus) {
+            cpus[index] = times;
+            if (index + 1 > cpu_count) cpu_count = index + 1;
+        }
+        line = strchr(line, '\n');
+        if (line == NULL) break;
+        line++;
+    }
+    return cpu_count;
+#else
+    (void)host;
+    (void)cpus;
+    (void)max_cpus;
+    return -1;
+#endif
+}
+
+long procfs_clock_ticks() {
+#ifdef __linux__
+    static long ticks = 0;
+    if (ticks == 0) {
+        ticks = sysconf(_SC_CLK_TCK);
+        if (ticks <= 0) ticks = 100;
+    }
+    return ticks;
+#else
+    return 100;
+#endif
+}
+
+long procfs_page_size() {
+#ifdef __linux__
+    static long page_size = 0;
+    if (page_size == 0) {
+        page_size = sysconf(_SC_PAGESIZE);
+        if (page_size <= 0) page_size = 4096;
+    }
+    return page_size;
+#else
+    return 4096;
+#endif
+}
@@ -0,0 +1,48 @@
+/*
+ * procfs.h - Header for Linux /proc sampling helpers
+ */
+
+#ifndef PROCFS_H
+#define PROCFS_H
+
+// Fields of /proc/[pid]/stat used by the detectors
+typedef struct {
+    int pid;
+    char name[50];
+    char state;                 // R, S, D, Z, ...
+    unsigned long minflt;       // minor faults since process start
+    unsigned long majflt;       // major faults since process start
+    unsigned long utime;        // user time in clock ticks
+    unsigned long stime;        // system time in clock ticks
+    long rss_pages;             // resident set size in pages
+} ProcPidStat;
+
+// cgroup v2 interface files of one group; all readable without root
+typedef struct {
+    unsigned long long cpu_usage_usec;  // cpu.stat, includes descendants
+    double cpu_limit;           // cores allowed by cpu.max, 0 = unlimited
+    long long memory_current;   // bytes, memory.current
+    long long memory_max;       // bytes, memory.max, 0 = unlimited
+    float cpu_some_avg10;       // cpu.pressure
+    float memory_some_avg10;    // memory.pressure
+    float memory_full_avg10;
+} CgroupFiles;
+
+// Aggregate jiffies of one "cpu" line of /proc/stat
+typedef struct {
+    unsigned long long busy;    // user + nice + system + irq + softirq + steal
+    unsigned long long total;   // busy + idle + iowait
+} CpuTimes;
+
+int procfs_available();
+int procfs_list_pids(int *pids, int max_pids);
+int procfs_read_pid_stat(int pid, ProcPidStat *stat);
+int procfs_read_memory_pressure(float *some_avg10, float *full_avg10);
+int procfs_read_pid_cgroup(int pid, char *path, int size);
+const char *procfs_cgroup_root();
+int procfs_read_cgroup_files(const char *group, CgroupFiles *files);
+int procfs_read_cpu_times(CpuTimes *host, CpuTimes *cpus, int max_cpus);
+long procfs_clock_ticks();
+long procfs_page_size();
+
+#endif // PROCFS_H
@@ -0,0 +1,463 @@
+/*
+ * real_faults.c - Opt-in real-workload fault injection (Linux)
+ *
+ * Unlike fault_injection.c, which only flips fields in pcb_table, these
+ * routines create bounded faults on the local machine: spinning threads for
+ * CPU overload, a strided page-touching loop over an mmap'd buffer (pages
+ * are dropped with MADV_DONTNEED after every pass so each pass faults again)
+ * under an RLIMIT_AS cap for memory pressure, and two pthreads taking two
+ * mutexes in inverted order for deadlock. Every fault has a hard duration
+ * cap. The detectors recovery uses (the /proc samplers, the wait-for cycle
+ * search) are polled until they fire, then the matching detect_and_fix_*()
+ * routine in recovery.c is run against the real process before the fault
+ * is torn down; for deadlock, the worker recovery rolls back is preempted.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "real_faults.h"
+#include "process_manager.h"
+#include "recovery.h"
+#include "algorithms.h"
+#include "cpu_monitor.h"
+#include "thrashing_monitor.h"
+#include "timing.h"
+
+#ifdef __linux__
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+#define MAX_CPU_WORKERS 64
+#endif
+
+void real_faults_default_config(RealFaultConfig *config) {
+    config->duration_ms = 10000;
+    config->cpu_workers = 0;
+    config->memory_mb = 256;
+    config->stride_pages = 1;
+    config->poll_ms = 100;
+}
+
+#ifdef __linux__
+static atomic_int stop_workers;
+
+static void begin_result(RealFaultResult *result, const char *fault) {
+    memset(result, 0, sizeof(*result));
+    result->fault = fault;
+}
+
+static void count_detector_pass(RealFaultResult *result, double started) {
+    result->detector_avg_us += (monotonic_seconds() - started) * 1e6;
+    result->detector_passes++;
+}
+
+static void finish_result(RealFaultResult *result) {
+    if (result->detector_passes > 0) {
+        result->detector_avg_us /= result->detector_passes;
+    }
+}
+
+static void *cpu_spin_worker(void *arg) {
+    volatile unsigned long spins = 0;
+    (void)arg;
+    while (!atomic_load_explicit(&stop_workers, memory_order_relaxed)) {
+        spins++;
+    }
+    return NULL;
+}
+
+int run_real_cpu_fault(const RealFaultConfig *config, RealFaultResult *result) {
+    begin_result(result, "CPU overload");
+    int workers = config->cpu_workers > 0 ? config->cpu_workers : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (workers < 1) workers = 1;
+    if (workers > MAX_CPU_WORKERS) workers = MAX_CPU_WORKERS;
+
+    printf("\n[Real Fault] Starting %d spinning worker thread(s) for at most %d ms...\n",
+           workers, config->duration_ms);
+    add_process(getpid(), "stress-cpu", NULL);
+    cpu_monitor_sample();   // baseline for the first delta
+
+    pthread_t threads[MAX_CPU_WORKERS];
+    int started = 0;
+    atomic_store(&stop_workers, 0);
+    double start = monotonic_seconds();
+    for (int i = 0; i < workers; i++) {
+        if (pthread_create(&threads[i], NULL, cpu_spin_worker, NULL) != 0) break;
+        started++;
+    }
+
+    double deadline = start + config->duration_ms / 1000.0;
+    double detected_at = 0.0;
+    while (started > 0 && monotonic_seconds() < deadline) {
+        sleep_ms(config->poll_ms);
+        double t = monotonic_seconds();
+        cpu_monitor_sample();
+        count_detector_pass(result, t);
+        ProcessCpuStats stats;
+        if (cpu_monitor_lookup(getpid(), &stats) && stats.hot) {
+            detected_at = monotonic_seconds();
+            result->detected = 1;
+            result->detection_latency_ms = (detected_at - start) * 1000.0;
+            printf("[Real Fault] Detector fired after %.0f ms (process at %.1f%% of a core)\n",
+                   result->detection_latency_ms, stats.ewma);
+            break;
+        }
+    }
+
+    if (result->detected) {
+        detect_and_fix_cpu_overload();
+    } else {
+        printf("[Real Fault] CPU overload not detected within %d ms.\n", config->duration_ms);
+    }
+
+    // Recovery on the real machine: stop the spinning workers
+    atomic_store(&stop_workers, 1);
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    if (result->detected) {
+        result->recovery_ms = (monotonic_seconds() - detected_at) * 1000.0;
+    }
+    finish_result(result);
+    return result->detected;
+}
+
+typedef struct {
+    volatile char *buffer;
+    size_t length;
+    size_t stride;
+    atomic_long passes;
+} MemoryWorker;
+
+static void *memory_touch_worker(void *arg) {
+    MemoryWorker *worker = arg;
+    while (!atomic_load_explicit(&stop_workers, memory_order_relaxed)) {
+        for (size_t offset = 0; offset < worker->length; offset += worker->stride) {
+            worker->buffer[offset]++;
+        }
+        // Drop the pages so the next pass faults every one of them again
+        madvise((void *)worker->buffer, worker->length, MADV_DONTNEED);
+        atomic_fetch_add_explicit(&worker->passes, 1, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+static size_t current_address_space() {
+    FILE *fp = fopen("/proc/self/statm", "r");
+    unsigned long pages = 0;
+    if (fp != NULL) {
+        if (fscanf(fp, "%lu", &pages) != 1) pages = 0;
+        fclose(fp);
+    }
+    return (size_t)pages * (size_t)sysconf(_SC_PAGESIZE);
+}
+
+int run_real_memory_fault(const RealFaultConfig *config, RealFaultResult *result) {
+    begin_result(result, "Memory thrashing");
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    MemoryWorker worker;
+    worker.length = (size_t)config->memory_mb * 1024 * 1024;
+    worker.stride = page_size * (config->stride_pages > 0 ? config->stride_pages : 1);
+    atomic_init(&worker.passes, 0);
+
+    int self = add_process(getpid(), "stress-memory", NULL);
+    pcb_set_allocated_memory(self, config->memory_mb * 1024);   // KB, holds the buffer
+
+    // Cap address-space growth to the buffer plus headroom for thread stacks
+    struct rlimit old_limit;
+    getrlimit(RLIMIT_AS, &old_limit);
+    struct rlimit limit = old_limit;
+    rlim_t cap = current_address_space() + worker.length + (rlim_t)64 * 1024 * 1024;
+    if (old_limit.rlim_cur == RLIM_INFINITY || old_limit.rlim_cur > cap) {
+        limit.rlim_cur = cap;
+    }
+    setrlimit(RLIMIT_AS, &limit);
+
+    worker.buffer = mmap(NULL, worker.length, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (worker.buffer == MAP_FAILED) {
+        printf("[Real Fault] mmap of %d MB failed under the RLIMIT_AS cap.\n", config->memory_mb);
+        setrlimit(RLIMIT_AS, &old_limit);
+        return 0;
+    }
+
+    printf("\n[Real Fault] Touching %d MB every %zu bytes for at most %d ms (RLIMIT_AS %lu MB)...\n",
+           config->memory_mb, worker.stride, config->duration_ms,
+           (unsigned long)(limit.rlim_cur / (1024 * 1024)));
+    thrashing_monitor_sample();     // baseline window entry
+
+    pthread_t thread;
+    atomic_store(&stop_workers, 0);
+    double start = monotonic_seconds();
+    int started = pthread_create(&thread, NULL, memory_touch_worker, &worker) == 0;
+
+    double deadline = start + config->duration_ms / 1000.0;
+    double detected_at = 0.0;
+    while (started && monotonic_seconds() < deadline) {
+        sleep_ms(config->poll_ms);
+        double t = monotonic_seconds();
+        thrashing_monitor_sample();
+        count_detector_pass(result, t);
+        ProcessFaultStats stats;
+        if (thrashing_monitor_lookup(getpid(), &stats) && stats.thrashing) {
+            detected_at = monotonic_seconds();
+            result->detected = 1;
+            result->detection_latency_ms = (detected_at - start) * 1000.0;
+            printf("[Real Fault] Detector fired after %.0f ms (PFF %.0f faults/s)\n",
+                   result->detection_latency_ms, stats.pff);
+            break;
+        }
+    }
+
+    if (result->detected) {
+        detect_and_fix_thrashing();
+    } else {
+        printf("[Real Fault] Thrashing not detected within %d ms.\n", config->duration_ms);
+    }
+
+    atomic_store(&stop_workers, 1);
+    if (started) {
+        pthread_join(thread, NULL);
+    }
+    munmap((void *)worker.buffer, worker.length);
+    setrlimit(RLIMIT_AS, &old_limit);
+    if (result->detected) {
+        result->recovery_ms = (monotonic_seconds() - detected_at) * 1000.0;
+    }
+    printf("[Real Fault] Worker completed %ld passes over the buffer.\n",
+           atomic_load(&worker.passes));
+    finish_result(result);
+    return result->detected;
+}
+
+typedef struct {
+    pthread_mutex_t *first;
+    pthread_mutex_t *second;
+    int first_id;
+    int second_id;
+    atomic_int tid;
+    atomic_int holding;         // resource id currently held (0 = none)
+    atomic_int waiting;         // resource id being waited for (0 = none)
+    atomic_int abort_requested;
+    atomic_int completed;
+    atomic_int *ready;
+    double deadline;
+} DeadlockWorker;
+
+static void *deadlock_worker(void *arg) {
+    DeadlockWorker *worker = arg;
+    atomic_store(&worker->tid, (int)syscall(SYS_gettid));
+
+    pthread_mutex_lock(worker->first);
+    atomic_store(&worker->holding, worker->first_id);
+    // Wait until both workers hold their first lock so the inversion is certain
+    atomic_fetch_add(worker->ready, 1);
+    while (atomic_load(worker->ready) < 2 && monotonic_seconds() < worker->deadline) {
+        sleep_ms(1);
+    }
+
+    atomic_store(&worker->waiting, worker->second_id);
+    for (;;) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += 10 * 1000000L;
+        if (ts.tv_nsec >= 1000000000L) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        if (pthread_mutex_timedlock(worker->second, &ts) == 0) {
+            atomic_store(&worker->waiting, 0);
+            atomic_store(&worker->completed, 1);
+            pthread_mutex_unlock(worker->second);
+            break;
+        }
+        // Watchdog: back off when preempted or when the hard deadline passes
+        if (atomic_load(&worker->abort_requested) || monotonic_seconds() > worker->deadline) {
+            atomic_store(&worker->waiting, 0);
+            break;
+        }
+    }
+    atomic_store(&worker->holding, 0);
+    pthread_mutex_unlock(worker->first);
+    return NULL;
+}
+
+// Snapshot the workers' held and awaited mutexes as allocation records and
+// run the wait-for cycle detector recovery uses; returns 1 on a cycle
+static int find_lock_cycle(DeadlockWorker *workers, int count) {
+    ResourceAllocation records[4];
+    int record_count = 0;
+    for (int i = 0; i < count && i < 2; i++) {
+        int tid = atomic_load(&workers[i].tid);
+        int holding = atomic_load(&workers[i].holding);
+        int waiting = atomic_load(&workers[i].waiting);
+        if (holding) records[record_count++] = (ResourceAllocation){tid, holding, 1, 0};
+        if (waiting) records[record_count++] = (ResourceAllocation){tid, waiting, 0, 1};
+    }
+    return detect_wait_cycles(records, record_count, NULL, NULL) > 0;
+}
+
+int run_real_deadlock_fault(const RealFaultConfig *config, RealFaultResult *result) {
+    begin_result(result, "Deadlock");
+    pthread_mutex_t locks[2] = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER};
+    atomic_int ready;
+    atomic_init(&ready, 0);
+
+    double start = monotonic_seconds();
+    DeadlockWorker workers[2];
+    memset(workers, 0, sizeof(workers));
+    for (int i = 0; i < 2; i++) {
+        workers[i].first = &locks[i];
+        workers[i].second = &locks[1 - i];
+        workers[i].first_id = i + 1;
+        workers[i].second_id = 2 - i;
+        workers[i].ready = &ready;
+        workers[i].deadline = start + config->duration_ms / 1000.0;
+    }
+
+    printf("\n[Real Fault] Two threads taking mutexes R1/R2 in inverted order (watchdog %d ms)...\n",
+           config->duration_ms);
+    pthread_t threads[2];
+    int started = 0;
+    for (int i = 0; i < 2; i++) {
+        if (pthread_create(&threads[i], NULL, deadlock_worker, &workers[i]) != 0) break;
+        started++;
+    }
+
+    // Deadlock detection is cheap, so poll it faster than the /proc samplers
+    int poll_ms = config->poll_ms < 10 ? config->poll_ms : 10;
+    double detected_at = 0.0;
+    while (started == 2 && monotonic_seconds() < workers[0].deadline) {
+        double t = monotonic_seconds();
+        int cycle = find_lock_cycle(workers, 2);
+        count_detector_pass(result, t);
+        if (cycle) {
+            detected_at = monotonic_seconds();
+            result->detected = 1;
+            result->detection_latency_ms = (detected_at - start) * 1000.0;
+            printf("[Real Fault] Lock cycle found after %.1f ms\n", result->detection_latency_ms);
+            break;
+        }
+        sleep_ms(poll_ms);
+    }
+
+    int victim = -1;
+    if (result->detected) {
+        // Mirror the real lock graph into the simulator and run the usual recovery
+        for (int i = 0; i < 2; i++) {
+            int tid = atomic_load(&workers[i].tid);
+            int index = add_process(tid, i == 0 ? "lock-worker-A" : "lock-worker-B", NULL);
+            pcb_set_state(index, 2);
+            add_resource_allocation(tid, workers[i].first_id, 1, 0);
+            add_resource_allocation(tid, workers[i].second_id, 0, 1);
+        }
+        int victims[2];
+        int victim_count = detect_and_fix_deadlock_victims(victims, 2);
+        // Preempt the workers recovery rolled back: they release their first
+        // mutex and the others proceed
+        for (int k = 0; k < victim_count && k < 2; k++) {
+            for (int i = 0; i < 2; i++) {
+                if (atomic_load(&workers[i].tid) == victims[k]) {
+                    victim = i;
+                    atomic_store(&workers[i].abort_requested, 1);
+                }
+            }
+        }
+        if (victim < 0) {
+            printf("[Real Fault] Recovery rolled back no lock worker; watchdog will release the locks.\n");
+        }
+    } else {
+        printf("[Real Fault] Deadlock not detected; watchdog will release the locks.\n");
+    }
+
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    if (result->detected) {
+        result->recovery_ms = (monotonic_seconds() - detected_at) * 1000.0;
+        if (victim >= 0) {
+            int survivor = 1 - victim;
+            printf("[Real Fault] Worker %c %s after preemption of worker %c.\n", 'A' + survivor,
+                   atomic_load(&workers[survivor].completed) ? "completed" : "timed out", 'A' + victim);
+        }
+    }
+    finish_result(result);
+    return result->detected;
+}
+#else
+static int unsupported(RealFaultResult *result, const char *fault) {
+    memset(result, 0, sizeof(*result));
+    result->fault = fault;
+    printf("Real-workload faults require Linux (/proc, pthreads, mmap).\n");
+    return 0;
+}
+
+int run_real_cpu_fault(const RealFaultConfig *config, RealFaultResult *result) {
+    (void)config;
+    return unsupported(result, "CPU overload");
+}
+
+int run_real_memory_fault(const RealFaultConfig *config, RealFaultResult *result) {
+    (void)config;
+    return unsupported(result, "Memory thrashing");
+}
+
+int run_real_deadlock_fault(const RealFaultConfig *config, RealFaultResult *result) {
+    (void)config;
+    return unsupported(result, "Deadlock");
+}
+#endif
+
+static void print_results(const RealFaultResult *results, int count) {
+    printf("\n+------------------+----------+--------------+-------------+----------------+\n");
+    printf("| Fault            | Detected | Latency (ms) | Recover(ms) | Detector (us)  |\n");
+    printf("+------------------+----------+--------------+-------------+----------------+\n");
+    for (int i = 0; i < count; i++) {
+        printf("| %-16s | %-8s | %12.1f | %11.1f | %8.1f x%-5d|\n",
+               results[i].fault, results[i].detected ? "YES" : "NO",
+               results[i].detection_latency_ms, results[i].recovery_ms,
+               results[i].detector_avg_us, results[i].detector_passes);
+    }
+    printf("+------------------+----------+--------------+-------------+----------------+\n");
+}
+
+// CLI: real-faults [cpu|memory|deadlock|all] [duration_s] [memory_mb]
+int real_faults_command(int argc, char *argv[]) {
+    RealFaultConfig config;
+    real_faults_default_config(&config);
+    const char *which = argc > 0 ? argv[0] : "all";
+    if (argc > 1) config.duration_ms = atoi(argv[1]) * 1000;
+    if (argc > 2) config.memory_mb = atoi(argv[2]);
+    if (config.duration_ms < 1000 || config.duration_ms > 60000 ||
+        config.memory_mb < 1 || config.memory_mb > 4096) {
+        printf("Usage: real-faults [cpu|memory|deadlock|all] [duration 1-60 s] [memory 1-4096 MB]\n");
+        return 1;
+    }
+
+    printf("=== REAL-WORKLOAD FAULT INJECTION ===\n");
+    printf("Faults run on this machine, bounded to %d s and %d MB.\n",
+           config.duration_ms / 1000, config.memory_mb);
+    init_process_manager();
+
+    RealFaultResult results[3];
+    int count = 0;
+    int all = strcmp(which, "all") == 0;
+    if (all || strcmp(which, "cpu") == 0) run_real_cpu_fault(&config, &results[count++]);
+    if (all || strcmp(which, "memory") == 0) run_real_memory_fault(&config, &results[count++]);
+    if (all || strcmp(which, "deadlock") == 0) run_real_deadlock_fault(&config, &results[count++]);
+    if (count == 0) {
+        printf("Unknown fault type: %s\n", which);
+        return 1;
+    }
+    print_results(results, count);
+    return 0;
+}
@@ -0,0 +1,32 @@
+/*
+ * real_faults.h - Header for opt-in real-workload fault injection
+ */
+
+#ifndef REAL_FAULTS_H
+#define REAL_FAULTS_H
+
+// Bounds for the faults created on the local machine
+typedef struct {
+    int duration_ms;            // hard cap on how long any fault runs
+    int cpu_workers;            // spinning threads (0 = one per online CPU)
+    int memory_mb;              // size of the touched buffer (also caps RLIMIT_AS growth)
+    int stride_pages;           // distance between touched pages
+    int poll_ms;                // detector polling interval
+} RealFaultConfig;
+
+typedef struct {
+    const char *fault;
+    int detected;
+    double detection_latency_ms;    // fault start -> detector fired
+    double recovery_ms;             // detector fired -> fault gone
+    double detector_avg_us;         // cost of one detector pass
+    int detector_passes;
+} RealFaultResult;
+
+void real_faults_default_config(RealFaultConfig *config);
+int run_real_cpu_fault(const RealFaultConfig *config, RealFaultResult *result);
+int run_real_memory_fault(const RealFaultConfig *config, RealFaultResult *result);
+int run_real_deadlock_fault(const RealFaultConfig *config, RealFaultResult *result);
+int real_faults_command(int argc, char *argv[]);
+
+#endif // REAL_FAULTS_H
@@ -7,103 +7,563 @@
 #include "recovery.h"
 #include "process_manager.h"
 #include "algorithms.h"
+#include "thrashing_monitor.h"
+#include "cpu_monitor.h"
+#include "cgroup_monitor.h"
+#include "rng.h"
+#include "timeline.h"
+#include "io_scheduler.h"
+#include "priority_sched.h"
+#include "arena.h"
+#include "victim.h"
+#include "swap_sim.h"
+
+// Fault conditions, kept current from PCB change events (and the monitors'
+// per-pid verdict changes) so a check only re-evaluates the processes that
+// changed since the previous one instead of rescanning the table
+static PcbWatch waiting_watch;
+static PcbWatch overload_watch;
+static PcbWatch thrashing_watch;
+
+static int is_waiting(const PCB *pcb) {
+    return pcb->state == 2;
+}
+
+static int is_overloaded(const PCB *pcb) {
+    ProcessCpuStats stats;
+    return (cpu_monitor_lookup(pcb->pid, &stats) && stats.hot) || pcb->cpu_usage >= 99.0f;
+}
+
+#define THRASHING_LOW_ALLOCATION_KB (100 * 1024)
+
+// Host memory stalls (PSI full avg10) at or above the monitor's threshold
+static int memory_under_pressure() {
+    ThrashingConfig config;
+    float some_avg10, full_avg10;
+    thrashing_monitor_get_config(&config);
+    thrashing_monitor_pressure(&some_avg10, &full_avg10);
+    return full_avg10 >= config.psi_full_threshold;
+}
+
+// Frame scale for a thrashing process: > 0 from sampled PFF and working set,
+// -1 for the simulated low-allocation check, 0 when it is not thrashing
+static float thrashing_scale(const PCB *pcb, ProcessFaultStats *stats) {
+    if (thrashing_monitor_lookup(pcb->pid, stats)) {
+        // Thrashing needs a fault signal: PFF over the threshold, or host memory
+        // pressure while the frames (KB) cannot hold the working set
+        float ws_scale = pcb->allocated_memory > 0
+            ? (float)stats->working_set_kb / pcb->allocated_memory : 1.0f;
+        if (stats->thrashing || (ws_scale > 1.33f && memory_under_pressure())) {
+            return stats->frame_scale > ws_scale ? stats->frame_scale : ws_scale;
+        }
+        return 0.0f;
+    }
+    // If allocated_memory is less than threshold, assume thrashing
+    return pcb->allocated_memory < THRASHING_LOW_ALLOCATION_KB ? -1.0f : 0.0f;
+}
+
+static int is_thrashing(const PCB *pcb) {
+    ProcessFaultStats stats;
+    return thrashing_scale(pcb, &stats) != 0.0f;
+}
+
+static void on_sample_change(int pid) {
+    pcb_mark_pid_changed(pid, PCB_CHANGE_SAMPLE);
+}
+
+static void subscribe_watches() {
+    if (waiting_watch.registered) {
+        return;
+    }
+    pcb_watch_register(&waiting_watch, PCB_CHANGE_STATE, is_waiting);
+    pcb_watch_register(&overload_watch, PCB_CHANGE_CPU | PCB_CHANGE_SAMPLE, is_overloaded);
+    pcb_watch_register(&thrashing_watch, PCB_CHANGE_MEMORY | PCB_CHANGE_SAMPLE, is_thrashing);
+    cpu_monitor_set_change_hook(on_sample_change);
+    thrashing_monitor_set_change_hook(on_sample_change);
+}
+
+// The table has no executed-time field, so a process's burst stands in for
+// the work a rollback would throw away
+static void describe_process(int pid, VictimCandidate *candidate, void *context) {
+    (void)context;
+    int i = pcb_find_pid(pid);
+    if (i >= 0) {
+        candidate->progress = pcb_table[i].burst_time;
+        candidate->priority = pcb_table[i].priority;
+    }
+}
+
+// Roll back the cheapest set of processes whose loss breaks every cycle in
+// the allocation records; their pids go to victim_pids (up to capacity).
+// Returns how many were rolled back
+static int roll_back_victims(int *victim_pids, int capacity) {
+    ResourceAllocation records[MAX_RESOURCE_ALLOCATIONS];
+    int count = export_resource_allocations(records, MAX_RESOURCE_ALLOCATIONS);
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    WaitGraph graph;
+    VictimPlan plan;
+    if (count == 0 || victim_graph_from_records(records, count, describe_process, NULL, &graph) != 0 ||
+        victim_select(&graph, VICTIM_EXACT, &plan) <= 0) {
+        arena_release(arena, mark);
+        return 0;
+    }
+    for (int k = 0; k < plan.victim_count; k++) {
+        const VictimCandidate *victim = &graph.candidates[plan.victims[k]];
+        printf("Rolling back Process %d (loses %lld ticks: %lld progress + %lld restart, priority %d, "
+               "%d resource(s) held, cost %.1f)\n",
+               victim->pid, victim->progress + victim->restart, victim->progress, victim->restart,
+               victim->priority, victim->held, victim_cost(victim));
+        if (k < capacity) victim_pids[k] = victim->pid;
+        release_resource_allocations(victim->pid);
+        int i = pcb_find_pid(victim->pid);
+        if (i >= 0) pcb_set_state(i, 0);
+    }
+    printf("%d of %d deadlocked process(es) rolled back, %lld ticks of work lost incl. restarts (cost %.1f)\n",
+           plan.victim_count, plan.deadlocked, plan.work_lost, plan.cost);
+    int rolled_back = plan.victim_count;
+    arena_release(arena, mark);
+    return rolled_back;
+}
+
+// Does another process still hold a resource this one requests?
+static int still_blocked(int pid) {
+    ResourceAllocation records[MAX_RESOURCE_ALLOCATIONS];
+    int count = export_resource_allocations(records, MAX_RESOURCE_ALLOCATIONS);
+    for (int r = 0; r < count; r++) {
+        if (records[r].process_id != pid || !records[r].requested) continue;
+        for (int h = 0; h < count; h++) {
+            if (records[h].allocated && records[h].resource_id == records[r].resource_id &&
+                records[h].process_id != pid) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
 
 // Enhanced deadlock detection and recovery using algorithms
 void detect_and_fix_deadlock() {
+    detect_and_fix_deadlock_victims(NULL, 0);
+}
+
+// As detect_and_fix_deadlock; the rolled-back pids go to victim_pids (up to
+// capacity) so a caller driving real threads can preempt the same ones.
+// Returns how many processes were rolled back
+int detect_and_fix_deadlock_victims(int *victim_pids, int capacity) {
     printf("\n[Recovery] Starting deadlock detection and recovery...\n");
+    double started = timeline_wall_us();
+    subscribe_watches();
     
     // Use Banker's algorithm
     int safe_state = bankers_algorithm();
     
     // Use cycle detection
     int cycle_detected = detect_deadlock_cycle();
+    int victims = 0;
     
     if (cycle_detected || !safe_state) {
         printf("[Recovery] Applying deadlock recovery strategies...\n");
         
-        // Strategy 1: Reset waiting processes
-        for (int i = 0; i < process_count; i++) {
-            if (pcb_table[i].state == 2) { // waiting state indicates deadlock
-                printf("Preempting resources from Process %d\n", pcb_table[i].pid);
-                pcb_table[i].state = 0; // set to ready
+        // Strategy 1: Roll back the cheapest victims, then resume every waiting
+        // process nobody blocks any more (it acquires, runs and releases)
+        victims = roll_back_victims(victim_pids, capacity);
+        int resumed = 1;
+        while (resumed) {
+            resumed = 0;
+            int waiting[MAX_PROCESSES];
+            int waiting_count = pcb_watch_collect(&waiting_watch, waiting);
+            for (int k = 0; k < waiting_count; k++) {
+                int i = waiting[k];
+                if (pcb_table[i].state != 2 || still_blocked(pcb_table[i].pid)) continue;
+                printf("Process %d resumes with its requested resources\n", pcb_table[i].pid);
+                pcb_set_state(i, 0); // set to ready
+                release_resource_allocations(pcb_table[i].pid);
+                resumed = 1;
             }
         }
         
         // Strategy 2: Implement resource ordering to prevent future deadlocks
         printf("Implementing resource ordering protocol...\n");
         
-        printf("[Recovery] Deadlock resolved using preemption and resource ordering.\n");
+        printf("[Recovery] Deadlock resolved using cost-based rollback and resource ordering.\n");
     } else {
         printf("[Recovery] No deadlock detected. System is safe.\n");
     }
+    timeline_stopped_slice(NULL, TIMELINE_PID_FAULTS, 1, cycle_detected || !safe_state ? "recover deadlock" : "check deadlock",
+                           "recovery", started);
+    return victims;
 }
 
-// Enhanced CPU overload recovery with scheduling algorithms
+// Report the innermost cgroups in a fault with their suggested limits (dry run)
+static void report_group_faults(unsigned int flags) {
+    if (cgroup_monitor_refresh() <= 0) {
+        return;
+    }
+    CgroupStats groups[8];
+    int found = cgroup_monitor_collect(groups, 8, flags | CGROUP_COLLECT_INNERMOST);
+    if (found > 0) {
+        printf("[Recovery] %d cgroup(s) at fault; suggested limits:\n", found);
+    }
+    for (int g = 0; g < found; g++) {
+        CgroupRecovery plan;
+        cgroup_monitor_plan(&groups[g], &plan);
+        cgroup_monitor_print_plan(&groups[g], &plan);
+    }
+}
+
+// CPU overload recovery driven by smoothed /proc utilisation deltas
 void detect_and_fix_cpu_overload() {
     printf("\n[Recovery] Checking for CPU overload...\n");
+    double started = timeline_wall_us();
+    subscribe_watches();
     
-    int overloaded_processes = 0;
-    for (int i = 0; i < process_count; i++) {
-        if (pcb_table[i].cpu_usage >= 99.0) {
+    // Sample real utilisation; injected overloads on the PCB are still honoured
+    int sampled = cpu_monitor_refresh();
+    if (sampled > 0) {
+        CpuOverloadReport report;
+        cpu_monitor_report(&report);
+        printf("Host state: %s (avg %.1f%% over %d cores, %d saturated, %d hot processes)\n",
+               cpu_monitor_state_name(report.state), report.host_ewma,
+               report.cpu_count, report.saturated_cores, report.hot_processes);
+    }
+
+    int involved[MAX_PROCESSES];
+    int overloaded_processes = pcb_watch_collect(&overload_watch, involved);
+    for (int k = 0; k < overloaded_processes; k++) {
+        int i = involved[k];
+        ProcessCpuStats stats;
+        if (cpu_monitor_lookup(pcb_table[i].pid, &stats) && stats.hot) {
+            printf("CPU overload detected in Process %d (%.1f%% of a core, smoothed)\n",
+                   pcb_table[i].pid, stats.ewma);
+        } else {
             printf("CPU overload detected in Process %d (%.1f%% usage)\n", 
                    pcb_table[i].pid, pcb_table[i].cpu_usage);
-            overloaded_processes++;
         }
     }
     
     if (overloaded_processes > 0) {
         printf("[Recovery] Applying CPU scheduling optimizations...\n");
         
-        // Show scheduling comparison and apply best strategy
-        display_scheduling_comparison();
+        // Compare scheduling strategies on the tasks actually involved
+        display_scheduling_comparison_subset(involved, overloaded_processes);
         
         // Reset overloaded processes
-        for (int i = 0; i < process_count; i++) {
-            if (pcb_table[i].cpu_usage >= 99.0) {
-                pcb_table[i].cpu_usage = 15.0 + (rand() % 20); // Reset to reasonable level
-                printf("Process %d CPU usage normalized to %.1f%%\n", 
-                       pcb_table[i].pid, pcb_table[i].cpu_usage);
-            }
+        for (int k = 0; k < overloaded_processes; k++) {
+            int i = involved[k];
+            pcb_set_cpu_usage(i, 15.0f + (rng_next() % 20)); // Reset to reasonable level
+            printf("Process %d CPU usage normalized to %.1f%%\n", 
+                   pcb_table[i].pid, pcb_table[i].cpu_usage);
         }
         
         printf("[Recovery] CPU overload fixed using dynamic scheduling.\n");
     } else {
         printf("[Recovery] No CPU overload detected.\n");
     }
+    report_group_faults(CGROUP_COLLECT_OVERLOADED);
+    timeline_stopped_slice(NULL, TIMELINE_PID_FAULTS, 1, overloaded_processes > 0 ? "recover cpu overload" : "check cpu overload",
+                           "recovery", started);
+}
+
+// Replay the process table under memory overcommit with every memory-pressure
+// policy and keep the one with the best throughput. The replay is
+// deterministic per process count, so repeated checks reuse the last one.
+static void replay_memory_pressure() {
+    static SwapResult results[SWAP_RECOVER_COUNT];
+    static int replayed_processes = 0;
+    SwapConfig config;
+    swap_build_config(&config);
+    SwapRecovery before = swap_active_recovery(), best = before;
+    for (int r = 0; r < SWAP_RECOVER_COUNT && config.processes != replayed_processes; r++) {
+        if (swap_simulate(&config, (SwapRecovery)r, &results[r]) != 0) {
+            printf("Not enough memory to replay memory pressure.\n");
+            return;
+        }
+    }
+    replayed_processes = config.processes;
+    for (int r = 0; r < SWAP_RECOVER_COUNT; r++) {
+        if (results[r].throughput > results[best].throughput * 1.05) best = (SwapRecovery)r;
+    }
+    printf("Replaying %d processes with working sets %.1fx of %d MB on swap:\n", config.processes,
+           (double)config.processes * config.working_set_pages / config.memory_pages,
+           config.memory_pages * SWAP_PAGE_KB / 1024);
+    swap_print_result("Before", &results[before]);
+    if (best != before) {
+        printf("[Recovery] Switching memory-pressure policy %s -> %s...\n",
+               swap_recovery_name(before), swap_recovery_name(best));
+        swap_set_active_recovery(best);
+        swap_print_result("After", &results[best]);
+    } else {
+        printf("[Recovery] Keeping memory-pressure policy %s.\n", swap_recovery_name(before));
+    }
 }
 
-// Enhanced thrashing recovery with page replacement algorithms
+// The other half of PFF frame allocation: processes whose fault rate stays
+// under pff_lower give frames back, never below their working set or the
+// low-allocation mark the unsampled check uses. Returns the KB reclaimed
+static long reclaim_idle_frames() {
+    long reclaimed = 0;
+    for (int i = 0; i < process_count; i++) {
+        ProcessFaultStats stats;
+        if (!thrashing_monitor_lookup(pcb_table[i].pid, &stats) || !stats.reclaimable) continue;
+        int old_memory = pcb_table[i].allocated_memory;
+        long floor_kb = stats.working_set_kb > THRASHING_LOW_ALLOCATION_KB
+            ? stats.working_set_kb : THRASHING_LOW_ALLOCATION_KB;
+        long new_memory = (long)(old_memory * stats.frame_scale);
+        if (new_memory < floor_kb) new_memory = floor_kb;
+        if (new_memory >= old_memory) continue;
+        pcb_set_allocated_memory(i, (int)new_memory);
+        reclaimed += old_memory - new_memory;
+        printf("Process %d frames reclaimed from %d KB to %ld KB (PFF %.0f faults/s, working set %ld KB)\n",
+               pcb_table[i].pid, old_memory, new_memory, stats.pff, stats.working_set_kb);
+    }
+    return reclaimed;
+}
+
+// Thrashing recovery driven by page-fault frequency and working-set estimates
 void detect_and_fix_thrashing() {
     printf("\n[Recovery] Checking for thrashing...\n");
-    
+    double started = timeline_wall_us();
+    subscribe_watches();
+
+    // Sample real fault counters; processes without samples use the simulated check
+    int sampled = thrashing_monitor_refresh();
+    float frame_scale[MAX_PROCESSES];
+    int involved[MAX_PROCESSES];
     int thrashing_processes = 0;
-    for (int i = 0; i < process_count; i++) {
-        // If allocated_memory is less than threshold, assume thrashing
-        if (pcb_table[i].allocated_memory < 100) {
-            printf("Thrashing detected in Process %d (only %d MB allocated)\n", 
+
+    if (sampled > 0) {
+        float some_avg10, full_avg10;
+        thrashing_monitor_pressure(&some_avg10, &full_avg10);
+        printf("Sampled %d host processes (memory pressure: some %.1f%%, full %.1f%%)\n",
+               sampled, some_avg10, full_avg10);
+    }
+
+    thrashing_processes = pcb_watch_collect(&thrashing_watch, involved);
+    for (int k = 0; k < thrashing_processes; k++) {
+        int i = involved[k];
+        ProcessFaultStats stats;
+        frame_scale[i] = thrashing_scale(&pcb_table[i], &stats);
+        if (frame_scale[i] > 0.0f) {
+            printf("Thrashing detected in Process %d (PFF %.0f faults/s, working set %ld KB, %d KB allocated)\n",
+                   pcb_table[i].pid, stats.pff, stats.working_set_kb, pcb_table[i].allocated_memory);
+        } else {
+            printf("Thrashing detected in Process %d (only %d KB allocated)\n",
                    pcb_table[i].pid, pcb_table[i].allocated_memory);
-            thrashing_processes++;
         }
     }
     
+    // Frames come back from quiet processes before any thrashing ones grow
+    long reclaimed = reclaim_idle_frames();
+    if (reclaimed > 0) {
+        printf("Reclaimed %ld KB from processes below the PFF lower threshold\n", reclaimed);
+    }
+
     if (thrashing_processes > 0) {
         printf("[Recovery] Applying memory management optimizations...\n");
         
         // Show page replacement algorithm comparison
         display_page_replacement_comparison();
         
-        // Increase memory allocation for thrashing processes
-        for (int i = 0; i < process_count; i++) {
-            if (pcb_table[i].allocated_memory < 100) {
-                int old_memory = pcb_table[i].allocated_memory;
-                pcb_table[i].allocated_memory = 150 + (rand() % 100); // Increase allocation
-                printf("Process %d memory increased from %d MB to %d MB\n", 
+        // Resize frame allocation in proportion to the measured shortfall
+        for (int k = 0; k < thrashing_processes; k++) {
+            int i = involved[k];
+            int old_memory = pcb_table[i].allocated_memory;
+            if (frame_scale[i] > 0.0f) {
+                pcb_set_allocated_memory(i, (int)(old_memory * frame_scale[i]) + 1);
+                printf("Process %d frames resized x%.2f from %d KB to %d KB\n",
+                       pcb_table[i].pid, frame_scale[i], old_memory, pcb_table[i].allocated_memory);
+            } else {
+                pcb_set_allocated_memory(i, (150 + rng_next() % 100) * 1024); // Increase allocation
+                printf("Process %d memory increased from %d KB to %d KB\n",
                        pcb_table[i].pid, old_memory, pcb_table[i].allocated_memory);
             }
         }
         
-        printf("[Recovery] Thrashing resolved using LRU page replacement and increased allocation.\n");
+        replay_memory_pressure();
+        printf("[Recovery] Thrashing resolved using LRU page replacement, PFF-based frame allocation and %s load control.\n",
+               swap_recovery_name(swap_active_recovery()));
     } else {
         printf("[Recovery] No thrashing detected.\n");
     }
+    report_group_faults(CGROUP_COLLECT_THRASHING);
+    timeline_stopped_slice(NULL, TIMELINE_PID_FAULTS, 1, thrashing_processes > 0 ? "recover thrashing" : "check thrashing",
+                           "recovery", started);
+}
+
+// Pid with the most requests in an I/O workload
+static int top_io_submitter(const IoRequest *requests, int count, int *submitted) {
+    int pids[MAX_PROCESSES + 1], totals[MAX_PROCESSES + 1], distinct = 0, best = -1;
+    *submitted = 0;
+    for (int r = 0; r < count; r++) {
+        int k = 0;
+        while (k < distinct && pids[k] != requests[r].pid) k++;
+        if (k == distinct) {
+            if (distinct == MAX_PROCESSES + 1) continue;
+            pids[distinct] = requests[r].pid;
+            totals[distinct++] = 0;
+        }
+        if (++totals[k] > *submitted) {
+            *submitted = totals[k];
+            best = pids[k];
+        }
+    }
+    return best;
+}
+
+void detect_and_fix_io_storm() {
+    printf("\n[Recovery] Checking for I/O storms...\n");
+    double started = timeline_wall_us();
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    int capacity = IO_STORM_REQUESTS * 2;
+    IoRequest *requests = arena_alloc(arena, sizeof(IoRequest) * capacity);
+    int storm = 0;
+    if (requests == NULL) {
+        printf("Not enough memory to replay the I/O queue.\n");
+        goto done;
+    }
+    IoDevice device;
+    io_default_device(&device, IO_DEVICE_HDD);
+    int count = io_build_workload(requests, capacity, &device);
+    IoResult before;
+    if (io_simulate(&device, io_active_scheduler(), requests, count, &before)) {
+        storm = before.p99_latency_us > IO_LATENCY_SLO_US || before.max_queue_depth > IO_QUEUE_DEPTH_LIMIT;
+    }
+
+    if (storm) {
+        int submitted;
+        int pid = top_io_submitter(requests, count, &submitted);
+        printf("I/O storm detected: p99 latency %.1f ms (SLO %.0f ms), queue depth up to %d\n",
+               before.p99_latency_us / 1000.0, IO_LATENCY_SLO_US / 1000.0, before.max_queue_depth);
+        printf("Process %d submitted %d of %d queued requests\n", pid, submitted, count);
+        printf("[Recovery] Throttling Process %d to %.0f IOPS and switching %s -> %s scheduling...\n",
+               pid, IO_THROTTLE_IOPS, io_scheduler_name(io_active_scheduler()),
+               io_scheduler_name(IO_SCHED_DEADLINE));
+        io_set_throttle(pid, IO_THROTTLE_IOPS);
+        io_set_active_scheduler(IO_SCHED_DEADLINE);
+
+        // Judge the replay against the same limits that flagged the storm
+        IoResult after;
+        count = io_build_workload(requests, capacity, &device);
+        if (!io_simulate(&device, io_active_scheduler(), requests, count, &after)) {
+            printf("[Recovery] Could not replay the I/O queue; the storm is not confirmed contained.\n");
+            goto done;
+        }
+        io_print_result("Before", &before);
+        io_print_result("After", &after);
+        if (after.p99_latency_us <= IO_LATENCY_SLO_US && after.max_queue_depth <= IO_QUEUE_DEPTH_LIMIT) {
+            printf("[Recovery] I/O storm contained by submit throttling and deadline scheduling.\n");
+        } else {
+            printf("[Recovery] I/O storm persists after throttling: p99 latency %.1f ms (SLO %.0f ms), "
+                   "queue depth up to %d (limit %d).\n",
+                   after.p99_latency_us / 1000.0, IO_LATENCY_SLO_US / 1000.0, after.max_queue_depth,
+                   IO_QUEUE_DEPTH_LIMIT);
+        }
+    } else {
+        printf("[Recovery] No I/O storm detected (p99 %.1f ms, max queue depth %d).\n",
+               before.p99_latency_us / 1000.0, before.max_queue_depth);
+    }
+done:
+    arena_release(arena, mark);
+    timeline_stopped_slice(NULL, TIMELINE_PID_FAULTS, 1, storm ? "recover io storm" : "check io storm",
+                           "recovery", started);
+}
+
+// Schedule the process table's workload under the active protocol, then
+// under fixed if the check finds the fault; returns 1 if it was fixed,
+// -1 if fixed was already active, 0 if there was no fault
+static int replay_priority_workload(int (*found)(const PrioResult *), void (*report)(const PrioResult *),
+                                    const PrioSchedConfig *fixed) {
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    PrioTask *tasks = arena_alloc(arena, sizeof(PrioTask) * PRIO_WORKLOAD_CAPACITY);
+    if (tasks == NULL) {
+        printf("Not enough memory to replay the run queue.\n");
+        return 0;
+    }
+    int count = prio_build_workload(tasks, PRIO_WORKLOAD_CAPACITY);
+    PrioResult before, after;
+    int detected = 0;
+    if (prio_simulate(prio_active_config(), tasks, count, &before)) {
+        detected = found(&before);
+        report(&before);
+    }
+    const PrioSchedConfig *active = prio_active_config();
+    if (detected && active->lock_protocol == fixed->lock_protocol && active->aging_interval == fixed->aging_interval) {
+        printf("[Recovery] Scheduler already runs %s; the fault persists.\n", prio_config_name(fixed));
+        detected = -1;
+    } else if (detected) {
+        printf("[Recovery] Switching scheduler from %s to ", prio_config_name(active));
+        prio_set_active_config(fixed);
+        printf("%s...\n", prio_config_name(fixed));
+        if (prio_simulate(fixed, tasks, count, &after)) {
+            prio_print_result("Before", &before);
+            prio_print_result("After", &after);
+        }
+    }
+    arena_release(arena, mark);
+    return detected;
+}
+
+static int has_inversion(const PrioResult *result) {
+    return result->longest_inversion > 0;
+}
+
+static void report_inversion(const PrioResult *result) {
+    if (has_inversion(result)) {
+        printf("Priority inversion detected: Process %d blocked on a lock held by Process %d while less urgent task %d ran\n",
+               result->inversion_waiter, result->inversion_owner, result->inversion_runner);
+        printf("Inverted for %lld ticks in total, longest episode %lld ticks\n",
+               result->inversion_time, result->longest_inversion);
+    }
+}
+
+void detect_and_fix_priority_inversion() {
+    printf("\n[Recovery] Checking for priority inversion...\n");
+    double started = timeline_wall_us();
+    PrioSchedConfig fixed = *prio_active_config();
+    fixed.lock_protocol = PRIO_LOCK_INHERITANCE;
+    int detected = replay_priority_workload(has_inversion, report_inversion, &fixed);
+    if (detected > 0) {
+        printf("[Recovery] Priority inversion resolved: lock holders inherit their best waiter's priority.\n");
+    } else if (detected == 0) {
+        printf("[Recovery] No priority inversion detected.\n");
+    }
+    timeline_stopped_slice(NULL, TIMELINE_PID_FAULTS, 1, detected ? "recover priority inversion" : "check priority inversion",
+                           "recovery", started);
+}
+
+static int has_starvation(const PrioResult *result) {
+    return result->max_wait > PRIO_STARVATION_LIMIT;
+}
+
+static void report_starvation(const PrioResult *result) {
+    if (has_starvation(result)) {
+        printf("Starvation detected: task %d waited %lld ticks (limit %d)\n",
+               result->max_wait_id, result->max_wait, PRIO_STARVATION_LIMIT);
+        printf("Max wait by priority:");
+        for (int level = 0; level < PRIO_LEVELS; level++) {
+            if (result->max_wait_by_level[level] > 0) {
+                printf(" %d:%lld", level, result->max_wait_by_level[level]);
+            }
+        }
+        printf("\n");
+    }
+}
+
+void detect_and_fix_starvation() {
+    printf("\n[Recovery] Checking for starvation...\n");
+    double started = timeline_wall_us();
+    PrioSchedConfig fixed = *prio_active_config();
+    fixed.aging_interval = PRIO_AGING_INTERVAL;
+    int detected = replay_priority_workload(has_starvation, report_starvation, &fixed);
+    if (detected > 0) {
+        printf("[Recovery] Starvation resolved by aging: waiting tasks gain one priority level every %d ticks.\n",
+               PRIO_AGING_INTERVAL);
+    } else if (detected == 0) {
+        printf("[Recovery] No starvation detected.\n");
+    }
+    timeline_stopped_slice(NULL, TIMELINE_PID_FAULTS, 1, detected ? "recover starvation" : "check starvation",
+                           "recovery", started);
 }
@@ -6,7 +6,11 @@
 #define RECOVERY_H
 
 void detect_and_fix_deadlock();
+int detect_and_fix_deadlock_victims(int *victim_pids, int capacity);
 void detect_and_fix_cpu_overload();
 void detect_and_fix_thrashing();
+void detect_and_fix_io_storm();
+void detect_and_fix_priority_inversion();
+void detect_and_fix_starvation();
 
 #endif // RECOVERY_H
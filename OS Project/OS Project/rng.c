@@ -0,0 +1,36 @@
+/*
+ * rng.c - Seedable random number generator with exportable state
+ *
+ * xorshift64* replaces rand() so the generator state can be saved in a
+ * checkpoint and a restored run draws exactly the same numbers.
+ */
+
+#include "rng.h"
+
+static unsigned long long rng_state = 0x9e3779b97f4a7c15ULL;
+
+void rng_seed(unsigned long long seed) {
+    // splitmix64 step so nearby seeds give unrelated streams; state must be non-zero
+    unsigned long long z = seed + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    rng_state = z ? z : 0x9e3779b97f4a7c15ULL;
+}
+
+int rng_next() {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (int)((rng_state * 0x2545f4914f6cdd1dULL) >> 33);
+}
+
+unsigned long long rng_get_state() {
+    return rng_state;
+}
+
+void rng_set_state(unsigned long long state) {
+    if (state != 0) {
+        rng_state = state;
+    }
+}
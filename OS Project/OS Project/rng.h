@@ -0,0 +1,13 @@
+/*
+ * rng.h - Header for the simulator's seedable random number generator
+ */
+
+#ifndef RNG_H
+#define RNG_H
+
+void rng_seed(unsigned long long seed);
+int rng_next();     // 0 .. 2^31-1, drop-in for rand()
+unsigned long long rng_get_state();
+void rng_set_state(unsigned long long state);
+
+#endif // RNG_H
@@ -0,0 +1,688 @@
+/*
+ * swap_sim.c - Memory-pressure simulation: a swap device, kswapd background
+ * reclaim, direct reclaim stalls and thrashing recovery policies
+ *
+ * One CPU runs processes from a fair queue. Each process alternates CPU
+ * bursts of memory references with non-memory I/O waits, so throughput first
+ * rises with the number of processes. References mostly fall inside a per-process working
+ * set that slides through a larger footprint; a reference to a non-resident
+ * page is a minor fault on first touch or a major fault that blocks until the
+ * swap device reads the page back. Frames are reclaimed with a clock hand:
+ * kswapd wakes below the low watermark and reclaims at a fixed rate up to the
+ * high one (backing off while the device is congested), and an allocation
+ * that finds free frames at the min watermark reclaims a batch itself and
+ * waits for its writeback - a direct reclaim stall charged to that process.
+ * Once the working sets no longer fit, faults queue at the device and
+ * throughput collapses; the recovery policies trade concurrency for memory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "swap_sim.h"
+#include "process_manager.h"
+#include "workload_gen.h"
+#include "arena.h"
+#include "timing.h"
+
+#define PAGE_TOUCHED 1
+#define PAGE_DIRTY 2
+#define PAGE_IN_SWAP 4          // the swap copy is current
+
+static const char *recovery_names[SWAP_RECOVER_COUNT] = {"none", "admission", "suspend"};
+
+void swap_default_config(SwapConfig *config, IoDeviceKind device) {
+    memset(config, 0, sizeof(*config));
+    config->processes = 32;
+    config->memory_pages = 16384;       // 64 MB
+    config->working_set_pages = 1024;
+    config->footprint_scale = 2;
+    config->locality = 0.995;
+    config->write_fraction = 0.3;
+    config->drift_refs = 400;
+    config->ws_window_refs = 20000;
+    config->ref_cost_us = 1.0;
+    config->cpu_burst_ms = 2.0;
+    config->io_wait_ms = 8.0;
+    config->quantum_ms = 10.0;
+    config->minor_fault_us = 2.0;
+    config->scan_cost_us = 0.2;
+    if (device == IO_DEVICE_HDD) {
+        config->swap_latency_us = 8000.0;
+        config->swap_bandwidth_mb_s = 150.0;
+        config->swap_channels = 1;
+    } else {
+        config->swap_latency_us = 80.0;
+        config->swap_bandwidth_mb_s = 500.0;
+        config->swap_channels = 4;
+    }
+    config->watermark_min = 0.005;
+    config->watermark_low = 0.02;
+    config->watermark_high = 0.04;
+    config->kswapd_pages_per_ms = 64.0;
+    config->epoch_ms = 50.0;
+    config->duration_s = 10.0;
+    config->seed = 42;
+}
+
+const char *swap_recovery_name(SwapRecovery recovery) {
+    return recovery >= 0 && recovery < SWAP_RECOVER_COUNT ? recovery_names[recovery] : "unknown";
+}
+
+typedef struct {
+    int base;                   // first page of the footprint
+    int footprint;
+    int ws;                     // working set size
+    int ws_start;               // offset of the working set in the footprint
+    int drift_left;
+    double burst_left_us;
+    double vruntime;            // CPU time used, the fair queue's key
+    long long refs;
+    int window_id;              // working-set estimate over windows of virtual time
+    int window_refs;
+    int window_distinct;
+    int ws_estimate;
+    int held;
+    int parked;                 // became runnable while held
+    int held_epoch;
+    long long epoch_faults;
+} SwapProc;
+
+typedef struct {
+    double key;
+    int proc;
+} HeapEntry;
+
+typedef struct {
+    HeapEntry *entries;
+    int count;
+} Heap;
+
+typedef struct {
+    const SwapConfig *config;
+    SwapResult *result;
+    unsigned long long rng;
+    double now;
+    SwapProc *procs;
+    int nprocs;
+    // Pages and frames
+    int *page_frame;
+    int *page_stamp;
+    unsigned char *page_flags;
+    int *frame_page;
+    int *frame_owner;
+    unsigned char *frame_ref;
+    int frames;
+    int *free_frames;
+    int free_count;
+    int hand;
+    int min_free, low_free, high_free;
+    // Swap device
+    double channel_free[SWAP_MAX_CHANNELS];
+    int channel_writing[SWAP_MAX_CHANNELS];
+    double bus_free;
+    double transfer_us;
+    double swap_wait_us;
+    long long swap_requests;
+    // kswapd
+    int kswapd_awake;
+    double kswapd_credit;
+    double kswapd_last;
+    // Scheduling: ready processes by virtual runtime, blocked ones by wake time
+    Heap ready;
+    Heap wakes;
+    double min_vruntime;
+    double stall_us;            // memory stall time this epoch, all processes
+    int epoch;
+    int admit_next;
+} SwapState;
+
+static void heap_push(Heap *heap, double key, int proc) {
+    int i = heap->count++;
+    while (i > 0 && heap->entries[(i - 1) / 2].key > key) {
+        heap->entries[i] = heap->entries[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap->entries[i] = (HeapEntry){key, proc};
+}
+
+static HeapEntry heap_pop(Heap *heap) {
+    HeapEntry top = heap->entries[0];
+    HeapEntry last = heap->entries[--heap->count];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= heap->count) break;
+        if (child + 1 < heap->count && heap->entries[child + 1].key < heap->entries[child].key) child++;
+        if (heap->entries[child].key >= last.key) break;
+        heap->entries[i] = heap->entries[child];
+        i = child;
+    }
+    if (heap->count > 0) heap->entries[i] = last;
+    return top;
+}
+
+// Fair queueing as in CFS: a process that slept long gets at most one
+// quantum of credit over the least-served runnable process
+static void ready_push(SwapState *s, int p) {
+    SwapProc *proc = &s->procs[p];
+    double floor = s->min_vruntime - s->config->quantum_ms * 1000.0;
+    if (proc->vruntime < floor) proc->vruntime = floor;
+    heap_push(&s->ready, proc->vruntime, p);
+}
+
+// Requests queued or in service at the device
+static int swap_queue_depth(const SwapState *s) {
+    double service = s->config->swap_latency_us + s->transfer_us;
+    int depth = 0;
+    for (int c = 0; c < s->config->swap_channels; c++) {
+        double backlog = s->channel_free[c] - s->now;
+        if (backlog > 0.0) depth += (int)(backlog / service) + 1;
+    }
+    return depth;
+}
+
+// One page read or write submitted at time at; returns its completion time.
+// Channels overlap their latency, transfers share the device bandwidth.
+// Swap slots are handed out in clusters, so a write that follows a write on
+// the same channel is sequential and skips the positioning latency.
+static double swap_submit(SwapState *s, double at, int is_write) {
+    int depth = swap_queue_depth(s);
+    if (depth > s->result->swap_max_queue) s->result->swap_max_queue = depth;
+    int best = 0;
+    for (int c = 1; c < s->config->swap_channels; c++) {
+        if (s->channel_free[c] < s->channel_free[best]) best = c;
+    }
+    double start = s->channel_free[best] > at ? s->channel_free[best] : at;
+    int sequential = is_write && s->channel_writing[best] && s->channel_free[best] >= at;
+    double transfer = start + (sequential ? 0.0 : s->config->swap_latency_us);
+    if (s->bus_free > transfer) transfer = s->bus_free;
+    double done = transfer + s->transfer_us;
+    s->bus_free = done;
+    s->channel_free[best] = done;
+    s->channel_writing[best] = is_write;
+    s->swap_wait_us += done - at;
+    s->swap_requests++;
+    return done;
+}
+
+// Clock eviction of one frame; pages of held processes go first regardless
+// of their reference bit. Returns the writeback completion time (or at).
+static double evict_one(SwapState *s, double at, int *scanned) {
+    for (int pass = 0; pass < 3 * s->frames; pass++) {
+        int f = s->hand;
+        s->hand = (s->hand + 1) % s->frames;
+        (*scanned)++;
+        int page = s->frame_page[f];
+        if (page < 0) continue;
+        if (s->frame_ref[f] && !s->procs[s->frame_owner[f]].held) {
+            s->frame_ref[f] = 0;
+            continue;
+        }
+        double done = at;
+        if ((s->page_flags[page] & PAGE_DIRTY) || !(s->page_flags[page] & PAGE_IN_SWAP)) {
+            done = swap_submit(s, at, 1);
+            s->result->swap_outs++;
+            s->page_flags[page] = (unsigned char)((s->page_flags[page] & ~PAGE_DIRTY) | PAGE_IN_SWAP);
+        }
+        s->page_frame[page] = -1;
+        s->frame_page[f] = -1;
+        s->free_frames[s->free_count++] = f;
+        return done;
+    }
+    return at;
+}
+
+// Background reclaim between the low and high watermarks
+static void kswapd_run(SwapState *s) {
+    if (!s->kswapd_awake) {
+        if (s->free_count >= s->low_free) return;
+        s->kswapd_awake = 1;
+        s->kswapd_last = s->now;
+        s->kswapd_credit = 0.0;
+    }
+    s->kswapd_credit += (s->now - s->kswapd_last) / 1000.0 * s->config->kswapd_pages_per_ms;
+    s->kswapd_last = s->now;
+    if (s->kswapd_credit > s->high_free) s->kswapd_credit = s->high_free;
+    while (s->kswapd_credit >= 1.0 && s->free_count < s->high_free) {
+        if (swap_queue_depth(s) >= SWAP_WRITEBACK_LIMIT) {
+            s->kswapd_credit = 0.0;     // congested: wait for writeback to drain
+            return;
+        }
+        int scanned = 0;
+        evict_one(s, s->now, &scanned);
+        s->kswapd_credit -= 1.0;
+        s->result->kswapd_reclaimed++;
+    }
+    if (s->free_count >= s->high_free) s->kswapd_awake = 0;
+}
+
+// A free frame; below the min watermark the allocation reclaims
+// a batch itself and *ready is when the last of that writeback completes
+static int take_frame(SwapState *s, double *ready) {
+    *ready = s->now;
+    kswapd_run(s);
+    if (s->free_count <= s->min_free) {
+        int scanned = 0;
+        double written = s->now;
+        for (int k = 0; k < SWAP_RECLAIM_BATCH; k++) {
+            double done = evict_one(s, s->now, &scanned);
+            if (done > written) written = done;
+        }
+        s->now += scanned * s->config->scan_cost_us;
+        s->result->direct_reclaimed += SWAP_RECLAIM_BATCH;
+        s->result->direct_stalls++;
+        if (written > s->now) {
+            double stall_ms = (written - s->now) / 1000.0;
+            s->result->direct_stall_ms += stall_ms;
+            if (stall_ms > s->result->direct_stall_max_ms) s->result->direct_stall_max_ms = stall_ms;
+            *ready = written;
+        } else {
+            *ready = s->now;
+        }
+    }
+    if (s->free_count == 0) {
+        int scanned = 0;
+        evict_one(s, s->now, &scanned);
+    }
+    if (s->free_count < s->result->min_free) s->result->min_free = s->free_count;
+    return s->free_frames[--s->free_count];
+}
+
+static int pick_page(SwapState *s, SwapProc *proc) {
+    if (--proc->drift_left <= 0) {
+        proc->ws_start = (proc->ws_start + 1) % proc->footprint;
+        proc->drift_left = s->config->drift_refs;
+    }
+    int offset;
+    if (wg_uniform(&s->rng) < s->config->locality) {
+        offset = (proc->ws_start + (int)(wg_next(&s->rng) % (unsigned long long)proc->ws)) % proc->footprint;
+    } else {
+        offset = (int)(wg_next(&s->rng) % (unsigned long long)proc->footprint);
+    }
+    return proc->base + offset;
+}
+
+// Run process p for up to a quantum; returns 1 if it blocked
+static int run_slice(SwapState *s, int p) {
+    const SwapConfig *config = s->config;
+    SwapProc *proc = &s->procs[p];
+    double slice_end = s->now + config->quantum_ms * 1000.0;
+    while (s->now < slice_end) {
+        if (proc->burst_left_us <= 0.0) {
+            // Burst done: wait on non-memory I/O
+            proc->burst_left_us = wg_exponential(&s->rng, config->cpu_burst_ms * 1000.0);
+            heap_push(&s->wakes, s->now + wg_exponential(&s->rng, config->io_wait_ms * 1000.0), p);
+            return 1;
+        }
+        int page = pick_page(s, proc);
+        int write = wg_uniform(&s->rng) < config->write_fraction;
+        proc->refs++;
+        proc->vruntime += config->ref_cost_us;
+        proc->burst_left_us -= config->ref_cost_us;
+        s->now += config->ref_cost_us;
+        if (s->page_stamp[page] != proc->window_id) {
+            s->page_stamp[page] = proc->window_id;
+            proc->window_distinct++;
+        }
+        if (++proc->window_refs >= config->ws_window_refs) {
+            proc->ws_estimate = proc->window_distinct;
+            proc->window_id++;
+            proc->window_refs = 0;
+            proc->window_distinct = 0;
+        }
+
+        int frame = s->page_frame[page];
+        if (frame >= 0) {
+            s->frame_ref[frame] = 1;
+            if (write) s->page_flags[page] |= PAGE_DIRTY;
+            continue;
+        }
+        double ready;
+        frame = take_frame(s, &ready);
+        s->page_frame[page] = frame;
+        s->frame_page[frame] = page;
+        s->frame_owner[frame] = p;
+        s->frame_ref[frame] = 1;
+        if (!(s->page_flags[page] & PAGE_TOUCHED)) {
+            s->result->minor_faults++;
+            s->page_flags[page] = PAGE_TOUCHED | PAGE_DIRTY;
+            s->now += config->minor_fault_us;
+        } else {
+            s->result->major_faults++;
+            s->result->swap_ins++;
+            proc->epoch_faults++;
+            ready = swap_submit(s, ready > s->now ? ready : s->now, 0);
+            if (write) s->page_flags[page] |= PAGE_DIRTY;
+        }
+        if (ready > s->now) {
+            s->stall_us += ready - s->now;
+            heap_push(&s->wakes, ready, p);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void hold(SwapState *s, int p) {
+    if (s->procs[p].held) return;
+    s->procs[p].held = 1;
+    s->procs[p].held_epoch = s->epoch;
+    s->result->holds++;
+}
+
+static void release(SwapState *s, int p) {
+    if (!s->procs[p].held) return;
+    s->procs[p].held = 0;
+    if (s->procs[p].parked) {
+        s->procs[p].parked = 0;
+        ready_push(s, p);
+    }
+}
+
+// Admit processes round-robin from admit_next while their working-set
+// estimates fit; the rest wait for the next rotation
+static void admit_rotation(SwapState *s) {
+    double budget = SWAP_ADMIT_FRACTION * s->frames, used = 0.0;
+    int admitted = 0, next = s->admit_next, stopped = 0;
+    for (int k = 0; k < s->nprocs; k++) {
+        int p = (s->admit_next + k) % s->nprocs;
+        if (!stopped && (admitted == 0 || used + s->procs[p].ws_estimate <= budget)) {
+            used += s->procs[p].ws_estimate;
+            admitted++;
+            next = (p + 1) % s->nprocs;
+            release(s, p);
+        } else {
+            stopped = 1;
+            hold(s, p);
+        }
+    }
+    s->admit_next = next;
+}
+
+static void epoch_policy(SwapState *s, SwapRecovery recovery) {
+    int active = 0, held = 0;
+    for (int p = 0; p < s->nprocs; p++) {
+        if (s->procs[p].held) held++;
+        else active++;
+    }
+    s->result->held_avg += held;
+    double pressure = active > 0 ? s->stall_us / (s->config->epoch_ms * 1000.0 * active) : 0.0;
+    if (recovery == SWAP_RECOVER_ADMISSION && s->epoch % SWAP_ADMIT_ROTATE_EPOCHS == 0) {
+        admit_rotation(s);
+    } else if (recovery == SWAP_RECOVER_SUSPEND) {
+        if (pressure > SWAP_SUSPEND_PRESSURE && active > 1) {
+            // The worst faulters, an eighth of the active set per epoch
+            for (int k = active / 8 > 0 ? active / 8 : 1; k > 0; k--) {
+                int worst = -1;
+                for (int p = 0; p < s->nprocs; p++) {
+                    if (!s->procs[p].held && (worst < 0 || s->procs[p].epoch_faults > s->procs[worst].epoch_faults)) {
+                        worst = p;
+                    }
+                }
+                hold(s, worst);
+            }
+        } else if (pressure < SWAP_RESUME_PRESSURE && held > 0 && s->free_count >= s->low_free) {
+            int longest = -1;
+            for (int p = 0; p < s->nprocs; p++) {
+                if (s->procs[p].held && (longest < 0 || s->procs[p].held_epoch < s->procs[longest].held_epoch)) {
+                    longest = p;
+                }
+            }
+            release(s, longest);
+        }
+    }
+    for (int p = 0; p < s->nprocs; p++) {
+        s->procs[p].epoch_faults = 0;
+    }
+    s->stall_us = 0.0;
+    s->epoch++;
+}
+
+int swap_simulate(const SwapConfig *config, SwapRecovery recovery, SwapResult *result) {
+    memset(result, 0, sizeof(*result));
+    if (config->processes < 1 || config->processes > SWAP_MAX_PROCESSES || config->memory_pages < 64 ||
+        config->working_set_pages < 2 || config->footprint_scale < 1 || config->swap_channels < 1 ||
+        config->swap_channels > SWAP_MAX_CHANNELS || config->swap_bandwidth_mb_s <= 0.0 ||
+        config->duration_s <= 0.0 || config->epoch_ms <= 0.0 || config->ref_cost_us <= 0.0) {
+        return -1;
+    }
+    double started = monotonic_seconds();
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    SwapState s;
+    memset(&s, 0, sizeof(s));
+    s.config = config;
+    s.result = result;
+    s.rng = config->seed ? config->seed : 1;
+    s.nprocs = config->processes;
+    s.frames = config->memory_pages;
+    s.procs = arena_calloc(arena, (size_t)s.nprocs, sizeof(SwapProc));
+    s.ready.entries = arena_alloc(arena, sizeof(HeapEntry) * (size_t)s.nprocs);
+    s.wakes.entries = arena_alloc(arena, sizeof(HeapEntry) * (size_t)s.nprocs);
+    s.frame_page = arena_alloc(arena, sizeof(int) * (size_t)s.frames);
+    s.frame_owner = arena_alloc(arena, sizeof(int) * (size_t)s.frames);
+    s.frame_ref = arena_calloc(arena, (size_t)s.frames, 1);
+    s.free_frames = arena_alloc(arena, sizeof(int) * (size_t)s.frames);
+    if (s.procs == NULL || s.ready.entries == NULL || s.wakes.entries == NULL || s.frame_page == NULL ||
+        s.frame_owner == NULL || s.frame_ref == NULL || s.free_frames == NULL) {
+        arena_release(arena, mark);
+        return -1;
+    }
+
+    // Working sets spread 0.5x to 1.5x around the mean
+    long long pages = 0;
+    for (int p = 0; p < s.nprocs; p++) {
+        SwapProc *proc = &s.procs[p];
+        proc->ws = config->working_set_pages / 2 + (int)(wg_next(&s.rng) % (unsigned long long)config->working_set_pages) + 1;
+        proc->footprint = proc->ws * config->footprint_scale;
+        proc->base = (int)pages;
+        proc->ws_start = (int)(wg_next(&s.rng) % (unsigned long long)proc->footprint);
+        proc->drift_left = config->drift_refs;
+        proc->burst_left_us = wg_exponential(&s.rng, config->cpu_burst_ms * 1000.0);
+        proc->window_id = 1;
+        proc->ws_estimate = config->working_set_pages;     // until measured
+        pages += proc->footprint;
+    }
+    if (pages > 1 << 28) {
+        arena_release(arena, mark);
+        return -1;
+    }
+    s.page_frame = arena_alloc(arena, sizeof(int) * (size_t)pages);
+    s.page_stamp = arena_calloc(arena, (size_t)pages, sizeof(int));
+    s.page_flags = arena_calloc(arena, (size_t)pages, 1);
+    if (s.page_frame == NULL || s.page_stamp == NULL || s.page_flags == NULL) {
+        arena_release(arena, mark);
+        return -1;
+    }
+    memset(s.page_frame, 0xff, sizeof(int) * (size_t)pages);
+    memset(s.frame_page, 0xff, sizeof(int) * (size_t)s.frames);
+    for (int f = 0; f < s.frames; f++) s.free_frames[f] = s.frames - 1 - f;
+    s.free_count = s.frames;
+    s.min_free = (int)(config->watermark_min * s.frames) + 1;
+    s.low_free = (int)(config->watermark_low * s.frames) + 1;
+    s.high_free = (int)(config->watermark_high * s.frames) + 1;
+    if (s.low_free <= s.min_free) s.low_free = s.min_free + 1;
+    if (s.high_free <= s.low_free) s.high_free = s.low_free + 1;
+    result->min_free = s.frames;
+    s.transfer_us = SWAP_PAGE_KB * 1024.0 / (config->swap_bandwidth_mb_s * 1048576.0 / 1e6);
+    for (int p = 0; p < s.nprocs; p++) ready_push(&s, p);
+
+    double end = config->duration_s * 1e6, epoch_us = config->epoch_ms * 1000.0, next_epoch = 0.0;
+    while (s.now < end) {
+        while (s.wakes.count > 0 && s.wakes.entries[0].key <= s.now) {
+            ready_push(&s, heap_pop(&s.wakes).proc);
+        }
+        if (s.now >= next_epoch) {
+            epoch_policy(&s, recovery);
+            next_epoch += epoch_us;
+        }
+        kswapd_run(&s);
+        int p = -1;
+        while (s.ready.count > 0 && p < 0) {
+            p = heap_pop(&s.ready).proc;
+            if (s.procs[p].held) {
+                s.procs[p].parked = 1;
+                p = -1;
+            }
+        }
+        if (p < 0) {
+            // Idle until the next wakeup or policy epoch
+            double next = next_epoch < end ? next_epoch : end;
+            if (s.wakes.count > 0 && s.wakes.entries[0].key < next) next = s.wakes.entries[0].key;
+            s.now = next > s.now ? next : s.now;
+            continue;
+        }
+        if (s.procs[p].vruntime > s.min_vruntime) s.min_vruntime = s.procs[p].vruntime;
+        if (!run_slice(&s, p)) ready_push(&s, p);
+    }
+
+    long long low = -1;
+    for (int p = 0; p < s.nprocs; p++) {
+        result->references += s.procs[p].refs;
+        if (low < 0 || s.procs[p].refs < low) low = s.procs[p].refs;
+    }
+    result->throughput = result->references / config->duration_s;
+    result->cpu_useful = result->references * config->ref_cost_us / (s.now > 0.0 ? s.now : 1.0);
+    result->swap_latency_ms = s.swap_requests > 0 ? s.swap_wait_us / s.swap_requests / 1000.0 : 0.0;
+    result->held_avg = s.epoch > 0 ? result->held_avg / s.epoch : 0.0;
+    result->slowest_share = result->references > 0 ? (double)low * s.nprocs / result->references : 0.0;
+    result->wall_seconds = monotonic_seconds() - started;
+    arena_release(arena, mark);
+    return 0;
+}
+
+void swap_print_result(const char *label, const SwapResult *result) {
+    printf("%-9s %9.0f refs/s | CPU useful %5.1f%% | major faults %8lld, minor %7lld | swap in %8lld out %8lld, latency %8.2f ms, queue max %4d\n",
+           label, result->throughput, result->cpu_useful * 100.0, result->major_faults, result->minor_faults,
+           result->swap_ins, result->swap_outs, result->swap_latency_ms, result->swap_max_queue);
+    printf("%-9s reclaim kswapd %8lld, direct %8lld in %6lld stalls (%9.1f ms, max %7.2f ms) | free min %5d | held avg %6.1f, %5lld holds | slowest %.2f of mean\n",
+           "", result->kswapd_reclaimed, result->direct_reclaimed, result->direct_stalls, result->direct_stall_ms,
+           result->direct_stall_max_ms, result->min_free, result->held_avg, result->holds, result->slowest_share);
+}
+
+// ---- memory-pressure policy of the simulated process table ----
+static SwapRecovery active_recovery = SWAP_RECOVER_NONE;
+
+SwapRecovery swap_active_recovery() {
+    return active_recovery;
+}
+
+void swap_set_active_recovery(SwapRecovery recovery) {
+    if (recovery >= 0 && recovery < SWAP_RECOVER_COUNT) active_recovery = recovery;
+}
+
+// The process table overcommitted by SWAP_REPLAY_OVERCOMMIT on a replay-sized
+// memory, swapping to a disk like the I/O-storm replay
+void swap_build_config(SwapConfig *config) {
+    PcbReadGuard view = pcb_read_begin();
+    int count = view.snapshot->count;
+    pcb_read_end(&view);
+    if (count < 1) count = 1;
+    if (count > SWAP_MAX_PROCESSES) count = SWAP_MAX_PROCESSES;
+    swap_default_config(config, IO_DEVICE_HDD);
+    config->processes = count;
+    config->memory_pages = SWAP_REPLAY_MEMORY_PAGES;
+    config->working_set_pages = (int)(SWAP_REPLAY_MEMORY_PAGES * SWAP_REPLAY_OVERCOMMIT / count);
+    config->duration_s = 5.0;
+}
+
+static int parse_recovery(const char *name) {
+    if (strcmp(name, "all") == 0) return SWAP_RECOVER_COUNT;
+    for (int r = 0; r < SWAP_RECOVER_COUNT; r++) {
+        if (strcmp(name, recovery_names[r]) == 0) return r;
+    }
+    return -1;
+}
+
+// Throughput of every policy as the process count grows past what memory holds
+static void print_curve(SwapConfig *config) {
+    static const int counts[] = {1, 2, 4, 8, 12, 16, 20, 24, 32, 48, 64};
+    printf("%9s %8s", "Processes", "WS/mem");
+    for (int r = 0; r < SWAP_RECOVER_COUNT; r++) printf(" | %9s refs/s  major/s", recovery_names[r]);
+    printf("\n");
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        config->processes = counts[i];
+        printf("%9d %8.2f", counts[i], (double)counts[i] * config->working_set_pages / config->memory_pages);
+        for (int r = 0; r < SWAP_RECOVER_COUNT; r++) {
+            SwapResult result;
+            if (swap_simulate(config, (SwapRecovery)r, &result) != 0) {
+                printf(" | %25s", "-");
+                continue;
+            }
+            printf(" | %16.0f %8.0f", result.throughput, result.major_faults / config->duration_s);
+        }
+        printf("\n");
+    }
+}
+
+// CLI: swap [curve] [processes] [memory MB] [seconds] [hdd|ssd] [--policy P] [--seed N]
+int swap_command(int argc, char *argv[]) {
+    SwapConfig config;
+    IoDeviceKind kind = IO_DEVICE_SSD;
+    int curve = 0, usage = 0, positional = 0, processes = 32, memory_mb = 64, policy = SWAP_RECOVER_COUNT;
+    double seconds = 10.0;
+    unsigned long long seed = 42;
+    for (int i = 0; i < argc && !usage; i++) {
+        if (strcmp(argv[i], "curve") == 0 && i == 0) {
+            curve = 1;
+        } else if (strcmp(argv[i], "hdd") == 0) {
+            kind = IO_DEVICE_HDD;
+        } else if (strcmp(argv[i], "ssd") == 0) {
+            kind = IO_DEVICE_SSD;
+        } else if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+            policy = parse_recovery(argv[++i]);
+            usage = policy < 0;
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (argv[i][0] >= '0' && argv[i][0] <= '9') {
+            // curve takes no process count
+            int slot = positional++ + curve;
+            if (slot == 0) processes = atoi(argv[i]);
+            else if (slot == 1) memory_mb = atoi(argv[i]);
+            else if (slot == 2) seconds = atof(argv[i]);
+            else usage = 1;
+        } else {
+            usage = 1;
+        }
+    }
+    if (usage || processes < 1 || processes > SWAP_MAX_PROCESSES || memory_mb < 1 || memory_mb > 65536 ||
+        seconds <= 0.0 || seconds > 3600.0) {
+        printf("Usage: swap [processes] [memory MB] [seconds] [hdd|ssd] [--policy none|admission|suspend|all] [--seed N]\n");
+        printf("       swap curve [memory MB] [seconds] [hdd|ssd] [--seed N]\n");
+        printf("  Working sets average 4 MB per process; past memory / 4 MB processes the system thrashes.\n");
+        return 1;
+    }
+    swap_default_config(&config, kind);
+    config.processes = processes;
+    config.memory_pages = memory_mb * 1024 / SWAP_PAGE_KB;
+    config.duration_s = seconds;
+    config.seed = seed;
+    run_arena_reset();
+    printf("=== SWAP AND RECLAIM: %d MB memory, %s swap (%.0f us, %.0f MB/s, %d channels), %.1f s simulated ===\n",
+           memory_mb, kind == IO_DEVICE_HDD ? "HDD" : "SSD", config.swap_latency_us,
+           config.swap_bandwidth_mb_s, config.swap_channels, seconds);
+    printf("Watermarks min/low/high %d/%d/%d free pages, kswapd %.0f pages/ms\n",
+           (int)(config.watermark_min * config.memory_pages) + 1, (int)(config.watermark_low * config.memory_pages) + 1,
+           (int)(config.watermark_high * config.memory_pages) + 1, config.kswapd_pages_per_ms);
+    if (curve) {
+        print_curve(&config);
+        run_arena_reset();
+        return 0;
+    }
+    printf("%d processes, working sets %.2fx memory\n", processes,
+           (double)processes * config.working_set_pages / config.memory_pages);
+    for (int r = 0; r < SWAP_RECOVER_COUNT; r++) {
+        if (policy != SWAP_RECOVER_COUNT && policy != r) continue;
+        SwapResult result;
+        if (swap_simulate(&config, (SwapRecovery)r, &result) != 0) {
+            printf("Not enough memory to simulate %d processes.\n", processes);
+            run_arena_reset();
+            return 1;
+        }
+        swap_print_result(recovery_names[r], &result);
+        printf("%-9s simulated in %.2f s\n", "", result.wall_seconds);
+    }
+    run_arena_reset();
+    return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * swap_sim.h - Header for the memory-pressure model: swap device, kswapd
+ * background reclaim and direct reclaim
+ */
+
+#ifndef SWAP_SIM_H
+#define SWAP_SIM_H
+
+#include "io_scheduler.h"
+
+#define SWAP_PAGE_KB 4
+#define SWAP_MAX_PROCESSES 1024
+#define SWAP_MAX_CHANNELS 64
+#define SWAP_RECLAIM_BATCH 32           // frames one direct reclaim pass frees
+#define SWAP_WRITEBACK_LIMIT 64         // kswapd backs off while this many swap requests are queued
+#define SWAP_SUSPEND_PRESSURE 0.4       // stalled share of an epoch that suspends a process
+#define SWAP_RESUME_PRESSURE 0.1
+#define SWAP_ADMIT_FRACTION 0.9         // share of memory admission control fills with working sets
+#define SWAP_ADMIT_ROTATE_EPOCHS 40     // the admitted set rotates so held processes make progress
+#define SWAP_REPLAY_MEMORY_PAGES 16384  // 64 MB for the thrashing recovery replay
+#define SWAP_REPLAY_OVERCOMMIT 1.5      // working sets vs memory when thrashing is detected
+
+typedef enum {
+    SWAP_RECOVER_NONE,                  // every process keeps running
+    SWAP_RECOVER_ADMISSION,             // run only processes whose working sets fit, rotating
+    SWAP_RECOVER_SUSPEND,               // suspend the worst faulter while memory stalls dominate
+    SWAP_RECOVER_COUNT
+} SwapRecovery;
+
+typedef struct {
+    int processes;
+    int memory_pages;                   // physical frames
+    int working_set_pages;              // mean per process; each gets 0.5x to 1.5x
+    int footprint_scale;                // address space = working set x this
+    double locality;                    // share of references inside the working set
+    double write_fraction;              // references that dirty their page
+    int drift_refs;                     // the working set slides one page every this many references
+    int ws_window_refs;                 // virtual-time window of the working-set estimate
+    double ref_cost_us;                 // CPU time of one memory reference
+    double cpu_burst_ms;                // mean CPU burst between non-memory I/O waits
+    double io_wait_ms;                  // mean non-memory I/O wait
+    double quantum_ms;
+    double minor_fault_us;              // zero-fill of a first touch
+    double scan_cost_us;                // CPU cost of examining one frame during direct reclaim
+    double swap_latency_us;             // per request, before transfer
+    double swap_bandwidth_mb_s;
+    int swap_channels;                  // requests the device serves in parallel
+    double watermark_min;               // free-frame watermarks as fractions of memory
+    double watermark_low;
+    double watermark_high;
+    double kswapd_pages_per_ms;         // background reclaim rate
+    double epoch_ms;                    // recovery policy period
+    double duration_s;
+    unsigned long long seed;
+} SwapConfig;
+
+typedef struct {
+    long long references;               // useful work done
+    double throughput;                  // references per simulated second
+    double cpu_useful;                  // share of CPU time spent on references
+    long long minor_faults;
+    long long major_faults;
+    long long swap_ins;
+    long long swap_outs;
+    long long kswapd_reclaimed;
+    long long direct_reclaimed;
+    long long direct_stalls;            // allocations that had to reclaim themselves
+    double direct_stall_ms;             // charged to the faulting processes
+    double direct_stall_max_ms;
+    double swap_latency_ms;             // mean queue wait + service
+    int swap_max_queue;
+    int min_free;
+    double held_avg;                    // processes suspended or not admitted, time average
+    long long holds;                    // suspensions or de-admissions
+    double slowest_share;               // slowest process's references / the mean
+    double wall_seconds;
+} SwapResult;
+
+void swap_default_config(SwapConfig *config, IoDeviceKind device);
+const char *swap_recovery_name(SwapRecovery recovery);
+int swap_simulate(const SwapConfig *config, SwapRecovery recovery, SwapResult *result);
+void swap_print_result(const char *label, const SwapResult *result);
+
+// Memory-pressure policy of the simulated process table (thrashing recovery)
+SwapRecovery swap_active_recovery();
+void swap_set_active_recovery(SwapRecovery recovery);
+void swap_build_config(SwapConfig *config);
+
+int swap_command(int argc, char *argv[]);
+
+#endif // SWAP_SIM_H
@@ -0,0 +1,450 @@
+/*
+ * sweep.c - Parallel parameter sweeps of the scheduling and paging kernels
+ *
+ * The demos fix one time quantum and one frame count. A sweep evaluates the
+ * whole grid instead (quantum x policy x workload, frames x policy x trace).
+ * Workloads and traces are generated or parsed once and shared read-only;
+ * worker threads claim grid points from an atomic counter, so the small
+ * quanta and large frame counts that cost the most never leave a core idle.
+ * Each worker's temporaries come from its own per-thread run arena.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#endif
+#include "sweep.h"
+#include "algorithms.h"
+#include "arena.h"
+#include "timing.h"
+#include "frame_scan.h"
+#include "memtrace.h"
+#include "workload_gen.h"
+
+static const int sweep_quanta[] = {1, 2, 3, 4, 5, 6, 8, 10, 12, 16, 20, 24, 32, 48, 64, 128};
+static const int sweep_frames[] = {3, 4, 5, 6, 8, 10, 12, 16, 20, 24, 32, 48, 64, 96, 128, 256};
+#define SWEEP_QUANTA (int)(sizeof(sweep_quanta) / sizeof(sweep_quanta[0]))
+#define SWEEP_FRAMES (int)(sizeof(sweep_frames) / sizeof(sweep_frames[0]))
+
+static const char *sched_policy_names[SWEEP_SCHED_POLICIES] = {"rr", "priority_rr"};
+static const char *page_policy_names[SWEEP_PAGE_POLICIES] = {"fifo", "lru", "clock"};
+
+const char *sweep_sched_policy_name(int policy) {
+    return policy >= 0 && policy < SWEEP_SCHED_POLICIES ? sched_policy_names[policy] : "unknown";
+}
+
+const char *sweep_page_policy_name(int policy) {
+    return policy >= 0 && policy < SWEEP_PAGE_POLICIES ? page_policy_names[policy] : "unknown";
+}
+
+// Round robin with every task arriving at t = 0, like the demo. With a
+// priority array the levels run one after another, best (lowest) first.
+void sweep_rr_metrics(const int *burst_time, const int *priority, int count, int time_quantum,
+                      double *avg_waiting, double *avg_turnaround, long long *context_switches) {
+    *avg_waiting = *avg_turnaround = 0.0;
+    *context_switches = 0;
+    if (count < 1 || time_quantum < 1) return;
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    int *order = arena_alloc(arena, sizeof(int) * count);
+    int *remaining = arena_alloc(arena, sizeof(int) * count);
+    int *active = arena_alloc(arena, sizeof(int) * count);
+    if (order == NULL || remaining == NULL || active == NULL) {
+        arena_release(arena, mark);
+        *context_switches = -1;
+        return;
+    }
+    if (priority != NULL) {
+        priority_kernel(priority, burst_time, count, order);    // stable, so arrival order within a level
+    } else {
+        for (int i = 0; i < count; i++) order[i] = i;
+    }
+
+    long long now = 0, waiting = 0, turnaround = 0, switches = 0;
+    int last = -1;
+    for (int start = 0; start < count; ) {
+        int end = priority != NULL ? start + 1 : count;
+        while (end < count && priority[order[end]] == priority[order[start]]) end++;
+        int active_count = 0;
+        for (int k = start; k < end; k++) {
+            int i = order[k];
+            remaining[i] = burst_time[i];
+            if (remaining[i] > 0) active[active_count++] = i;
+        }
+        while (active_count > 0) {
+            int kept = 0;
+            for (int k = 0; k < active_count; k++) {
+                int i = active[k];
+                int run = remaining[i] > time_quantum ? time_quantum : remaining[i];
+                if (last >= 0 && last != i) switches++;
+                last = i;
+                now += run;
+                remaining[i] -= run;
+                if (remaining[i] > 0) {
+                    active[kept++] = i;
+                } else {
+                    turnaround += now;
+                    waiting += now - burst_time[i];
+                }
+            }
+            active_count = kept;
+        }
+        start = end;
+    }
+    *avg_waiting = (double)waiting / count;
+    *avg_turnaround = (double)turnaround / count;
+    *context_switches = switches;
+    arena_release(arena, mark);
+}
+
+static void evaluate_point(const SweepGrid *grid, SweepPoint *point) {
+    if (point->kind == SWEEP_SCHEDULING) {
+        const SweepSchedWorkload *workload = &grid->workloads[point->workload];
+        sweep_rr_metrics(workload->burst_time,
+                         point->policy == SWEEP_SCHED_PRIORITY_RR ? workload->priority : NULL,
+                         workload->count, point->parameter, &point->avg_waiting,
+                         &point->avg_turnaround, &point->context_switches);
+        return;
+    }
+    const SweepPageTrace *trace = &grid->traces[point->workload];
+    int faults;
+    switch (point->policy) {
+        case SWEEP_PAGE_FIFO: faults = fifo_page_faults(trace->pages, trace->count, point->parameter); break;
+        case SWEEP_PAGE_LRU: faults = lru_page_faults(trace->pages, trace->count, point->parameter); break;
+        default: faults = clock_page_faults(trace->pages, trace->count, point->parameter); break;
+    }
+    point->faults = faults;
+    point->fault_rate = trace->count > 0 ? (double)faults / trace->count : 0.0;
+}
+
+#ifndef _WIN32
+typedef struct {
+    SweepGrid *grid;
+    atomic_int next;
+} SweepQueue;
+
+static void *sweep_worker(void *arg) {
+    SweepQueue *queue = arg;
+    for (;;) {
+        int i = atomic_fetch_add_explicit(&queue->next, 1, memory_order_relaxed);
+        if (i >= queue->grid->point_count) break;
+        evaluate_point(queue->grid, &queue->grid->points[i]);
+    }
+    return NULL;
+}
+
+static void *sweep_thread_main(void *arg) {
+    sweep_worker(arg);
+    run_arena_release();
+    return NULL;
+}
+#endif
+
+// Evaluate every grid point; returns the number of threads that took part
+int sweep_run(SweepGrid *grid, int threads) {
+#ifndef _WIN32
+    if (threads < 1) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads > SWEEP_MAX_THREADS) threads = SWEEP_MAX_THREADS;
+    if (threads > grid->point_count) threads = grid->point_count;
+    if (threads > 1) {
+        // Resolve the frame-scan dispatch once, before the workers read it
+        frame_scan_level_name(FRAME_SCAN_AUTO);
+        SweepQueue queue;
+        queue.grid = grid;
+        atomic_init(&queue.next, 0);
+        pthread_t handles[SWEEP_MAX_THREADS];
+        int started = 1;
+        for (int i = 1; i < threads; i++) {
+            if (pthread_create(&handles[started], NULL, sweep_thread_main, &queue) != 0) break;
+            started++;
+        }
+        sweep_worker(&queue);   // the calling thread works too
+        for (int i = 1; i < started; i++) {
+            pthread_join(handles[i], NULL);
+        }
+        return started;
+    }
+#else
+    (void)threads;
+#endif
+    for (int i = 0; i < grid->point_count; i++) {
+        evaluate_point(grid, &grid->points[i]);
+    }
+    return 1;
+}
+
+// ---- workloads ----
+static int make_sched_workloads(SweepSchedWorkload *workloads, int count) {
+    static const char *names[] = {"uniform", "bimodal", "heavy_tail"};
+    Arena *arena = run_arena();
+    unsigned long long state = 40;    // own stream: sweeps stay independent of rng.c
+    for (int w = 0; w < 3; w++) {
+        int *burst = arena_alloc(arena, sizeof(int) * count);
+        int *priority = arena_alloc(arena, sizeof(int) * count);
+        if (burst == NULL || priority == NULL) return 0;
+        for (int i = 0; i < count; i++) {
+            unsigned int r = (unsigned int)(wg_next(&state) >> 32);
+            if (w == 0) {
+                burst[i] = 1 + r % 20;
+            } else if (w == 1) {
+                // Mostly interactive bursts with a fifth of long CPU-bound ones
+                burst[i] = r % 5 == 0 ? 40 + r / 5 % 61 : 1 + r / 5 % 4;
+            } else {
+                double u = (r % 10000) / 10000.0;
+                burst[i] = 1 + (int)(u * u * u * u * 400);
+            }
+            priority[i] = 1 + wg_next(&state) % 5;
+        }
+        workloads[w].name = names[w];
+        workloads[w].count = count;
+        workloads[w].burst_time = burst;
+        workloads[w].priority = priority;
+    }
+    return 3;
+}
+
+static int make_page_traces(SweepPageTrace *traces, int count) {
+    static const char *names[] = {"uniform", "looping", "locality"};
+    Arena *arena = run_arena();
+    unsigned long long state = 41;
+    for (int t = 0; t < 3; t++) {
+        int *pages = arena_alloc(arena, sizeof(int) * count);
+        if (pages == NULL) return 0;
+        int base = 0;
+        for (int i = 0; i < count; i++) {
+            unsigned int r = (unsigned int)(wg_next(&state) >> 32);
+            if (t == 0) {
+                pages[i] = r % 256;
+            } else if (t == 1) {
+                pages[i] = i % 80;      // cyclic scan: FIFO and LRU fault on every reference below 80 frames
+            } else {
+                // Working set of 24 pages that moves every 5000 references
+                if (i % 5000 == 0) base = wg_next(&state) % 488;
+                pages[i] = r % 10 == 0 ? (int)(r / 10 % 512) : base + (int)(r / 10 % 24);
+            }
+        }
+        traces[t].name = names[t];
+        traces[t].count = count;
+        traces[t].pages = pages;
+    }
+    return 3;
+}
+
+// Whitespace-separated page numbers or a libmemtrace.so recording; returns an
+// array in the arena, or NULL
+static int *load_page_trace(Arena *arena, const char *path, int *count) {
+    if (memtrace_is_trace(path)) {
+        MemTrace trace;
+        if (!memtrace_load(path, &trace)) return NULL;
+        int *pages = arena_alloc(arena, sizeof(int) * (size_t)trace.count);
+        if (pages != NULL) memcpy(pages, trace.pages, sizeof(int) * (size_t)trace.count);
+        *count = trace.count;
+        memtrace_free(&trace);
+        return pages;
+    }
+    FILE *file = fopen(path, "r");
+    if (file == NULL) return NULL;
+    int capacity = 4096, used = 0, page;
+    int *pages = arena_alloc(arena, sizeof(int) * capacity);
+    while (pages != NULL && fscanf(file, "%d", &page) == 1) {
+        if (used == capacity) {
+            pages = arena_grow(arena, pages, sizeof(int) * (size_t)capacity, sizeof(int) * (size_t)capacity * 2);
+            if (pages == NULL) break;
+            capacity *= 2;
+        }
+        pages[used++] = page;
+    }
+    fclose(file);
+    *count = used;
+    return used > 0 ? pages : NULL;
+}
+
+// ---- output ----
+static void print_sched_tables(const SweepGrid *grid) {
+    for (int w = 0; w < grid->workload_count; w++) {
+        printf("\nScheduling, %s workload (%d tasks): avg waiting / avg turnaround / context switches\n",
+               grid->workloads[w].name, grid->workloads[w].count);
+        printf("%8s", "quantum");
+        for (int p = 0; p < SWEEP_SCHED_POLICIES; p++) printf(" | %-40s", sweep_sched_policy_name(p));
+        printf("\n");
+        int best = -1;
+        for (int i = 0; i < grid->point_count; i++) {
+            const SweepPoint *point = &grid->points[i];
+            if (point->kind != SWEEP_SCHEDULING || point->workload != w) continue;
+            if (point->policy == 0) printf("%8d", point->parameter);
+            printf(" | %12.1f %12.1f %13lld", point->avg_waiting, point->avg_turnaround, point->context_switches);
+            if (point->policy == SWEEP_SCHED_POLICIES - 1) printf("\n");
+            if (best < 0 || point->avg_turnaround < grid->points[best].avg_turnaround) best = i;
+        }
+        if (best >= 0) {
+            printf("Lowest turnaround: %s with quantum %d\n",
+                   sweep_sched_policy_name(grid->points[best].policy), grid->points[best].parameter);
+        }
+    }
+}
+
+static void print_page_tables(const SweepGrid *grid) {
+    for (int t = 0; t < grid->trace_count; t++) {
+        printf("\nPaging, %s trace (%d references): fault rate %%\n",
+               grid->traces[t].name, grid->traces[t].count);
+        printf("%8s", "frames");
+        for (int p = 0; p < SWEEP_PAGE_POLICIES; p++) printf(" | %8s", sweep_page_policy_name(p));
+        printf("\n");
+        for (int i = 0; i < grid->point_count; i++) {
+            const SweepPoint *point = &grid->points[i];
+            if (point->kind != SWEEP_PAGING || point->workload != t) continue;
+            if (point->policy == 0) printf("%8d", point->parameter);
+            printf(" | %8.2f", point->fault_rate * 100.0);
+            if (point->policy == SWEEP_PAGE_POLICIES - 1) printf("\n");
+        }
+    }
+}
+
+// Flat lists of points, one object per configuration (read by app.py)
+static void write_json(FILE *out, const SweepGrid *grid, int threads, double seconds) {
+    fprintf(out, "{\n  \"threads\": %d,\n  \"seconds\": %.3f,\n  \"configurations\": %d,\n",
+            threads, seconds, grid->point_count);
+    const char *separator = "";
+    fprintf(out, "  \"scheduling\": [");
+    for (int i = 0; i < grid->point_count; i++) {
+        const SweepPoint *point = &grid->points[i];
+        if (point->kind != SWEEP_SCHEDULING) continue;
+        fprintf(out, "%s\n    {\"workload\": \"%s\", \"policy\": \"%s\", \"quantum\": %d, "
+                "\"avg_waiting\": %.3f, \"avg_turnaround\": %.3f, \"context_switches\": %lld}",
+                separator, grid->workloads[point->workload].name, sweep_sched_policy_name(point->policy),
+                point->parameter, point->avg_waiting, point->avg_turnaround, point->context_switches);
+        separator = ",";
+    }
+    fprintf(out, "\n  ],\n  \"paging\": [");
+    separator = "";
+    for (int i = 0; i < grid->point_count; i++) {
+        const SweepPoint *point = &grid->points[i];
+        if (point->kind != SWEEP_PAGING) continue;
+        fprintf(out, "%s\n    {\"trace\": \"%s\", \"policy\": \"%s\", \"frames\": %d, "
+                "\"faults\": %lld, \"fault_rate\": %.5f}",
+                separator, grid->traces[point->workload].name, sweep_page_policy_name(point->policy),
+                point->parameter, point->faults, point->fault_rate);
+        separator = ",";
+    }
+    fprintf(out, "\n  ]\n}\n");
+}
+
+// CLI: sweep [sched|paging|all] [threads] [--tasks N] [--refs N] [--trace FILE] [--json FILE|-]
+int sweep_command(int argc, char *argv[]) {
+    int do_sched = 1, do_paging = 1, threads = 0;
+    int tasks = 20000, refs = 200000;
+    const char *trace_path = NULL, *json_path = NULL;
+    int positional = 0;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--tasks") == 0 && i + 1 < argc) {
+            tasks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--refs") == 0 && i + 1 < argc) {
+            refs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (positional == 0 && (strcmp(argv[i], "sched") == 0 || strcmp(argv[i], "paging") == 0 ||
+                                       strcmp(argv[i], "all") == 0)) {
+            do_sched = strcmp(argv[i], "paging") != 0;
+            do_paging = strcmp(argv[i], "sched") != 0;
+            positional++;
+        } else if (positional <= 1 && argv[i][0] >= '0' && argv[i][0] <= '9') {
+            threads = atoi(argv[i]);
+            positional = 2;
+        } else {
+            positional = -1;
+            break;
+        }
+    }
+    if (positional < 0 || tasks < 1 || refs < 1) {
+        printf("Usage: sweep [sched|paging|all] [threads] [--tasks N] [--refs N] [--trace FILE] [--json FILE|-]\n");
+        return 1;
+    }
+    int quiet = json_path != NULL && strcmp(json_path, "-") == 0;
+
+    run_arena_reset();
+    Arena *arena = run_arena();
+    SweepSchedWorkload workloads[SWEEP_MAX_WORKLOADS];
+    SweepPageTrace traces[SWEEP_MAX_WORKLOADS];
+    SweepGrid grid;
+    memset(&grid, 0, sizeof(grid));
+    grid.workloads = workloads;
+    grid.traces = traces;
+    if (do_sched) grid.workload_count = make_sched_workloads(workloads, tasks);
+    if (do_paging) {
+        grid.trace_count = make_page_traces(traces, refs);
+        if (trace_path != NULL) {
+            int count = 0;
+            int *file_pages = load_page_trace(arena, trace_path, &count);
+            if (file_pages == NULL) {
+                printf("Cannot read page trace %s\n", trace_path);
+                return 1;
+            }
+            printf("Loaded %d references from %s\n", count, trace_path);
+            traces[grid.trace_count].name = "file";
+            traces[grid.trace_count].count = count;
+            traces[grid.trace_count].pages = file_pages;
+            grid.trace_count++;
+        }
+    }
+    int capacity = grid.workload_count * SWEEP_SCHED_POLICIES * SWEEP_QUANTA +
+                   grid.trace_count * SWEEP_PAGE_POLICIES * SWEEP_FRAMES;
+    grid.points = arena_calloc(arena, (size_t)(capacity > 0 ? capacity : 1), sizeof(SweepPoint));
+    if ((do_sched && grid.workload_count == 0) || (do_paging && grid.trace_count == 0) || grid.points == NULL) {
+        printf("Not enough memory for the sweep inputs.\n");
+        run_arena_reset();
+        return 1;
+    }
+    for (int w = 0; w < grid.workload_count; w++) {
+        for (int q = 0; q < SWEEP_QUANTA; q++) {
+            for (int p = 0; p < SWEEP_SCHED_POLICIES; p++) {
+                SweepPoint *point = &grid.points[grid.point_count++];
+                point->kind = SWEEP_SCHEDULING;
+                point->workload = w;
+                point->policy = p;
+                point->parameter = sweep_quanta[q];
+            }
+        }
+    }
+    for (int t = 0; t < grid.trace_count; t++) {
+        for (int f = 0; f < SWEEP_FRAMES; f++) {
+            for (int p = 0; p < SWEEP_PAGE_POLICIES; p++) {
+                SweepPoint *point = &grid.points[grid.point_count++];
+                point->kind = SWEEP_PAGING;
+                point->workload = t;
+                point->policy = p;
+                point->parameter = sweep_frames[f];
+            }
+        }
+    }
+
+    double start = monotonic_seconds();
+    int used = sweep_run(&grid, threads);
+    double seconds = monotonic_seconds() - start;
+
+    if (!quiet) {
+        printf("=== PARAMETER SWEEP: %d configurations on %d thread(s) in %.2f s (%s frame scans) ===\n",
+               grid.point_count, used, seconds, frame_scan_level_name(FRAME_SCAN_AUTO));
+        print_sched_tables(&grid);
+        print_page_tables(&grid);
+    }
+    if (json_path != NULL) {
+        FILE *out = quiet ? stdout : fopen(json_path, "w");
+        if (out == NULL) {
+            printf("Cannot write %s\n", json_path);
+        } else {
+            write_json(out, &grid, used, seconds);
+            if (!quiet) {
+                fclose(out);
+                printf("\nSweep results written to %s\n", json_path);
+            }
+        }
+    }
+    run_arena_reset();
+    return 0;
+}
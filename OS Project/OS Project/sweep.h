@@ -0,0 +1,72 @@
+/*
+ * sweep.h - Header for parallel parameter sweeps of the scheduling and paging kernels
+ */
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#define SWEEP_MAX_WORKLOADS 4
+#define SWEEP_MAX_THREADS 64
+
+typedef enum {
+    SWEEP_SCHEDULING,
+    SWEEP_PAGING
+} SweepKind;
+
+typedef enum {
+    SWEEP_SCHED_RR,             // one round-robin queue in arrival order
+    SWEEP_SCHED_PRIORITY_RR,    // round robin within each priority level, best level first
+    SWEEP_SCHED_POLICIES
+} SweepSchedPolicy;
+
+typedef enum {
+    SWEEP_PAGE_FIFO,
+    SWEEP_PAGE_LRU,
+    SWEEP_PAGE_CLOCK,
+    SWEEP_PAGE_POLICIES
+} SweepPagePolicy;
+
+// Inputs shared read-only by every worker
+typedef struct {
+    const char *name;
+    int count;
+    const int *burst_time;
+    const int *priority;        // lower value runs first
+} SweepSchedWorkload;
+
+typedef struct {
+    const char *name;
+    int count;
+    const int *pages;
+} SweepPageTrace;
+
+// One grid point; the worker that claims it fills in the metrics
+typedef struct {
+    SweepKind kind;
+    int workload;               // index into the workload or trace list
+    int policy;
+    int parameter;              // time quantum or frame count
+    double avg_waiting;         // scheduling
+    double avg_turnaround;
+    long long context_switches;
+    long long faults;           // paging
+    double fault_rate;
+} SweepPoint;
+
+typedef struct {
+    const SweepSchedWorkload *workloads;
+    int workload_count;
+    const SweepPageTrace *traces;
+    int trace_count;
+    SweepPoint *points;
+    int point_count;
+} SweepGrid;
+
+const char *sweep_sched_policy_name(int policy);
+const char *sweep_page_policy_name(int policy);
+void sweep_rr_metrics(const int *burst_time, const int *priority, int count, int time_quantum,
+                      double *avg_waiting, double *avg_turnaround, long long *context_switches);
+int sweep_run(SweepGrid *grid, int threads);
+int sweep_command(int argc, char *argv[]);
+
+#endif // SWEEP_H
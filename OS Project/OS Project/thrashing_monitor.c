@@ -0,0 +1,340 @@
+/*
+ * thrashing_monitor.c - Page-fault-frequency thrashing detector
+ *
+ * Samples minflt/majflt/rss of every host process from /proc/[pid]/stat and
+ * host memory pressure from /proc/pressure/memory. Each process keeps a
+ * sliding window of samples in an open-addressed table keyed by PID, from
+ * which the weighted fault frequency (PFF) and a working-set estimate (peak
+ * RSS over the window) are derived. A full scan costs one open/read/close per
+ * process, which keeps 10 Hz sampling of all host processes cheap.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "thrashing_monitor.h"
+#include "procfs.h"
+#include "timing.h"
+
+#define MAX_HOST_PIDS 32768
+#define INITIAL_CAPACITY 256
+
+typedef struct {
+    double timestamp;
+    unsigned long minflt;
+    unsigned long majflt;
+    long rss_kb;
+} FaultSample;
+
+typedef struct {
+    int pid;                    // 0 marks an empty slot
+    unsigned int generation;    // last sampling pass that recorded this pid
+    int head;                   // index of the newest sample
+    int count;
+    FaultSample samples[PFF_MAX_WINDOW];
+} FaultHistory;
+
+static ThrashingConfig config = {2000.0f, 200.0f, 50.0f, 10.0f, 10, 100};
+static FaultHistory *table = NULL;
+static int capacity = 0;
+static int used = 0;
+static unsigned int generation = 1;
+static int passes = 0;
+static float pressure_some = 0.0f;
+static float pressure_full = 0.0f;
+static int live_sampling = 1;
+static int pid_buffer[MAX_HOST_PIDS];
+static void (*change_hook)(int pid) = NULL;
+
+// Called with a pid whose statistics changed, or 0 when all may have
+void thrashing_monitor_set_change_hook(void (*hook)(int pid)) {
+    change_hook = hook;
+}
+
+static void notify_change(int pid) {
+    if (change_hook != NULL) change_hook(pid);
+}
+
+void thrashing_monitor_default_config(ThrashingConfig *out) {
+    out->pff_upper = 2000.0f;
+    out->pff_lower = 200.0f;
+    out->major_fault_weight = 50.0f;
+    out->psi_full_threshold = 10.0f;
+    out->window_samples = 10;
+    out->interval_ms = 100;
+}
+
+void thrashing_monitor_configure(const ThrashingConfig *new_config) {
+    config = *new_config;
+    if (config.window_samples < 2) config.window_samples = 2;
+    if (config.window_samples > PFF_MAX_WINDOW) config.window_samples = PFF_MAX_WINDOW;
+    if (config.interval_ms < 1) config.interval_ms = 1;
+    notify_change(0);
+}
+
+void thrashing_monitor_get_config(ThrashingConfig *out) {
+    *out = config;
+}
+
+void thrashing_monitor_reset() {
+    free(table);
+    table = NULL;
+    capacity = 0;
+    used = 0;
+    generation = 1;
+    passes = 0;
+    pressure_some = 0.0f;
+    pressure_full = 0.0f;
+    notify_change(0);
+}
+
+static unsigned int hash_pid(int pid) {
+    return (unsigned int)pid * 2654435761u;
+}
+
+static FaultHistory *find_slot(FaultHistory *slots, int slot_capacity, int pid) {
+    unsigned int mask = (unsigned int)slot_capacity - 1;
+    unsigned int i = hash_pid(pid) & mask;
+    while (slots[i].pid != 0 && slots[i].pid != pid) {
+        i = (i + 1) & mask;
+    }
+    return &slots[i];
+}
+
+// Rehash into a table of new_capacity, optionally dropping stale entries
+static void rebuild_table(int new_capacity, int drop_stale) {
+    FaultHistory *slots = calloc(new_capacity, sizeof(FaultHistory));
+    if (slots == NULL) {
+        return;
+    }
+    int kept = 0;
+    for (int i = 0; i < capacity; i++) {
+        if (table[i].pid == 0) continue;
+        if (drop_stale && table[i].generation != generation) {
+            notify_change(table[i].pid);
+            continue;
+        }
+        *find_slot(slots, new_capacity, table[i].pid) = table[i];
+        kept++;
+    }
+    free(table);
+    table = slots;
+    capacity = new_capacity;
+    used = kept;
+}
+
+// Feed one counter sample for pid (used by the /proc sampler and by replay)
+void thrashing_monitor_record(int pid, double timestamp, unsigned long minflt,
+                              unsigned long majflt, long rss_kb) {
+    if (pid <= 0) {
+        return;
+    }
+    if (table == NULL) {
+        capacity = INITIAL_CAPACITY;
+        table = calloc(capacity, sizeof(FaultHistory));
+        if (table == NULL) {
+            capacity = 0;
+            return;
+        }
+    } else if ((used + 1) * 2 > capacity) {
+        rebuild_table(capacity * 2, 0);
+    }
+
+    FaultHistory *entry = find_slot(table, capacity, pid);
+    if (entry->pid == 0) {
+        entry->pid = pid;
+        entry->count = 0;
+        entry->head = -1;
+        used++;
+    } else if (entry->count > 0) {
+        // Counters going backwards means the PID was reused by a new process
+        FaultSample *last = &entry->samples[entry->head];
+        if (minflt < last->minflt || majflt < last->majflt) {
+            entry->count = 0;
+            entry->head = -1;
+        }
+    }
+
+    entry->generation = generation;
+    entry->head = (entry->head + 1) % PFF_MAX_WINDOW;
+    entry->samples[entry->head].timestamp = timestamp;
+    entry->samples[entry->head].minflt = minflt;
+    entry->samples[entry->head].majflt = majflt;
+    entry->samples[entry->head].rss_kb = rss_kb;
+    if (entry->count < config.window_samples) {
+        entry->count++;
+    }
+    notify_change(pid);
+}
+
+void thrashing_monitor_set_live_sampling(int enabled) {
+    live_sampling = enabled;
+}
+
+void thrashing_monitor_set_pressure(float some_avg10, float full_avg10) {
+    // Crossing the PSI threshold moves every process's PFF limit
+    int was_high = pressure_full >= config.psi_full_threshold;
+    pressure_some = some_avg10;
+    pressure_full = full_avg10;
+    if ((pressure_full >= config.psi_full_threshold) != was_high) notify_change(0);
+}
+
+// Drop processes not recorded since the previous pass and start a new pass
+void thrashing_monitor_end_pass() {
+    if (table == NULL) {
+        return;
+    }
+    int stale = 0;
+    for (int i = 0; i < capacity; i++) {
+        if (table[i].pid != 0 && table[i].generation != generation) {
+            stale = 1;
+            break;
+        }
+    }
+    if (stale) {
+        rebuild_table(capacity, 1);
+    }
+    generation++;
+    passes++;
+}
+
+// Sample every host process once; returns processes sampled or 0 without /proc
+int thrashing_monitor_sample() {
+    if (!procfs_available()) {
+        return 0;
+    }
+    int pid_total = procfs_list_pids(pid_buffer, MAX_HOST_PIDS);
+    if (pid_total <= 0) {
+        return 0;
+    }
+
+    long page_kb = procfs_page_size() / 1024;
+    double now = monotonic_seconds();
+    int sampled = 0;
+    for (int i = 0; i < pid_total; i++) {
+        ProcPidStat stat;
+        if (procfs_read_pid_stat(pid_buffer[i], &stat)) {
+            thrashing_monitor_record(stat.pid, now, stat.minflt, stat.majflt,
+                                     stat.rss_pages * page_kb);
+            sampled++;
+        }
+    }
+
+    float some_avg10, full_avg10;
+    procfs_read_memory_pressure(&some_avg10, &full_avg10);
+    thrashing_monitor_set_pressure(some_avg10, full_avg10);
+
+    thrashing_monitor_end_pass();
+    return sampled;
+}
+
+// Sample, making sure the window holds at least two points to diff; with live
+// sampling off (trace replay) the recorded samples are used as they are
+int thrashing_monitor_refresh() {
+    if (!live_sampling) {
+        return used;
+    }
+    int sampled = thrashing_monitor_sample();
+    if (sampled > 0 && passes < 2) {
+        sleep_ms(config.interval_ms);
+        sampled = thrashing_monitor_sample();
+    }
+    return sampled;
+}
+
+static float effective_upper() {
+    if (pressure_full >= config.psi_full_threshold) {
+        return config.pff_upper * 0.5f;
+    }
+    return config.pff_upper;
+}
+
+static void compute_stats(const FaultHistory *entry, ProcessFaultStats *stats) {
+    int count = entry->count < config.window_samples ? entry->count : config.window_samples;
+    const FaultSample *newest = &entry->samples[entry->head];
+    const FaultSample *oldest =
+        &entry->samples[(entry->head - count + 1 + PFF_MAX_WINDOW) % PFF_MAX_WINDOW];
+
+    stats->pid = entry->pid;
+    stats->samples = count;
+    stats->window_minflt = newest->minflt - oldest->minflt;
+    stats->window_majflt = newest->majflt - oldest->majflt;
+
+    long peak = 0;
+    for (int i = 0; i < count; i++) {
+        const FaultSample *s = &entry->samples[(entry->head - i + PFF_MAX_WINDOW) % PFF_MAX_WINDOW];
+        if (s->rss_kb > peak) peak = s->rss_kb;
+    }
+    stats->working_set_kb = peak;
+
+    double elapsed = newest->timestamp - oldest->timestamp;
+    double weighted = stats->window_minflt + config.major_fault_weight * stats->window_majflt;
+    stats->pff = elapsed > 0 ? (float)(weighted / elapsed) : 0.0f;
+
+    float upper = effective_upper();
+    stats->thrashing = count >= 2 && stats->pff >= upper;
+    stats->reclaimable = count >= 2 && !stats->thrashing && stats->pff < config.pff_lower;
+    stats->frame_scale = 1.0f;
+    if (stats->thrashing) {
+        // Grow the allocation in proportion to how far PFF overshoots the threshold
+        stats->frame_scale = stats->pff / upper;
+        if (stats->frame_scale < 1.25f) stats->frame_scale = 1.25f;
+        if (stats->frame_scale > 4.0f) stats->frame_scale = 4.0f;
+    } else if (stats->reclaimable) {
+        // Faulting rarely: take back a fifth of the frames per recovery pass
+        stats->frame_scale = 0.8f;
+    }
+}
+
+// Look up the window statistics of one PID; returns 1 if it has been sampled
+int thrashing_monitor_lookup(int pid, ProcessFaultStats *stats) {
+    if (table == NULL || pid <= 0) {
+        return 0;
+    }
+    FaultHistory *entry = find_slot(table, capacity, pid);
+    if (entry->pid == 0 || entry->count == 0) {
+        return 0;
+    }
+    compute_stats(entry, stats);
+    return 1;
+}
+
+static int compare_pff_desc(const void *a, const void *b) {
+    float pa = ((const ProcessFaultStats *)a)->pff;
+    float pb = ((const ProcessFaultStats *)b)->pff;
+    return (pa < pb) - (pa > pb);
+}
+
+// Collect thrashing host processes, highest PFF first; returns the count
+int thrashing_monitor_collect(ProcessFaultStats *out, int max_entries) {
+    if (table == NULL) {
+        return 0;
+    }
+    int found = 0;
+    int weakest = 0;
+    for (int i = 0; i < capacity; i++) {
+        if (table[i].pid == 0 || table[i].count == 0) continue;
+        ProcessFaultStats stats;
+        compute_stats(&table[i], &stats);
+        if (!stats.thrashing) continue;
+        if (found < max_entries) {
+            out[found++] = stats;
+        } else if (stats.pff > out[weakest].pff) {
+            out[weakest] = stats;
+        } else {
+            continue;
+        }
+        // Track the weakest kept entry so a full buffer keeps the top offenders
+        weakest = 0;
+        for (int j = 1; j < found; j++) {
+            if (out[j].pff < out[weakest].pff) weakest = j;
+        }
+    }
+    qsort(out, found, sizeof(ProcessFaultStats), compare_pff_desc);
+    return found;
+}
+
+void thrashing_monitor_pressure(float *some_avg10, float *full_avg10) {
+    *some_avg10 = pressure_some;
+    *full_avg10 = pressure_full;
+}
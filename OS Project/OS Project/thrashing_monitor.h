@@ -0,0 +1,51 @@
+/*
+ * thrashing_monitor.h - Header for the page-fault-frequency thrashing detector
+ */
+
+#ifndef THRASHING_MONITOR_H
+#define THRASHING_MONITOR_H
+
+#define PFF_MAX_WINDOW 16
+
+// Tunable thresholds for the page-fault-frequency (PFF) detector
+typedef struct {
+    float pff_upper;            // weighted faults/sec at which a process is thrashing
+    float pff_lower;            // weighted faults/sec below which frames can be reclaimed
+    float major_fault_weight;   // cost of a major fault relative to a minor one
+    float psi_full_threshold;   // host "full avg10" % that halves pff_upper
+    int window_samples;         // sliding window length (samples, <= PFF_MAX_WINDOW)
+    int interval_ms;            // sampling interval used when warming up the window
+} ThrashingConfig;
+
+// Per-process view over the current sliding window
+typedef struct {
+    int pid;
+    float pff;                  // weighted page faults per second
+    unsigned long window_minflt;
+    unsigned long window_majflt;
+    long working_set_kb;        // peak resident set over the window
+    int samples;
+    int thrashing;              // pff crossed the (pressure adjusted) upper threshold
+    int reclaimable;            // pff stayed under pff_lower: frames can be given back
+    float frame_scale;          // proportional resize factor suggested for recovery (< 1 shrinks)
+} ProcessFaultStats;
+
+void thrashing_monitor_default_config(ThrashingConfig *config);
+void thrashing_monitor_configure(const ThrashingConfig *config);
+void thrashing_monitor_get_config(ThrashingConfig *config);
+void thrashing_monitor_reset();
+
+void thrashing_monitor_record(int pid, double timestamp, unsigned long minflt,
+                              unsigned long majflt, long rss_kb);
+void thrashing_monitor_set_pressure(float some_avg10, float full_avg10);
+void thrashing_monitor_end_pass();
+void thrashing_monitor_set_live_sampling(int enabled);
+void thrashing_monitor_set_change_hook(void (*hook)(int pid));
+int thrashing_monitor_sample();
+int thrashing_monitor_refresh();
+
+int thrashing_monitor_lookup(int pid, ProcessFaultStats *stats);
+int thrashing_monitor_collect(ProcessFaultStats *out, int max_entries);
+void thrashing_monitor_pressure(float *some_avg10, float *full_avg10);
+
+#endif // THRASHING_MONITOR_H
@@ -0,0 +1,206 @@
+/*
+ * timeline.c - Streaming Chrome trace (JSON) exporter
+ *
+ * Events are formatted straight into a writer-owned 64 KB chunk and the chunk
+ * is appended to the file when it fills, so a run with millions of context
+ * switches never holds its timeline in memory. Each simulated CPU has its own
+ * chunk, which lets the threaded multicore simulation emit events without
+ * contending on a lock per event; only whole-chunk writes are serialised.
+ * The output loads in chrome://tracing and ui.perfetto.dev.
+ *
+ * Enable with SIM_TIMELINE=<file>; one simulated tick is exported as 1 ms.
+ * Every "ts" is simulated time. The process table's scheduler, fault
+ * injection and recovery share one simulated clock: recovery runs while
+ * the table is stopped, so its slice has its measured wall-clock length and
+ * the clock moves past it. Each multicore run is its own simulation on its
+ * own track, starting at 0.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include "timeline.h"
+#include "timing.h"
+
+static FILE *timeline_file = NULL;
+static atomic_flag file_lock = ATOMIC_FLAG_INIT;
+static atomic_flag shared_lock = ATOMIC_FLAG_INIT;
+static TimelineBuffer shared_buffer;
+static double opened_at = 0.0;
+static atomic_llong sim_clock_us;
+static long long bytes_written = 0;
+static atomic_llong event_count;
+static int first_event = 1;
+
+static void spin_lock(atomic_flag *lock) {
+    while (atomic_flag_test_and_set_explicit(lock, memory_order_acquire)) {
+        // spin; chunk writes are short
+    }
+}
+
+static void spin_unlock(atomic_flag *lock) {
+    atomic_flag_clear_explicit(lock, memory_order_release);
+}
+
+int timeline_open(const char *path) {
+    if (timeline_file != NULL) {
+        timeline_close();
+    }
+    timeline_file = fopen(path, "w");
+    if (timeline_file == NULL) {
+        printf("Error: Cannot create timeline %s\n", path);
+        return 0;
+    }
+    // The chunks are the buffering; stdio would only copy them again
+    setvbuf(timeline_file, NULL, _IONBF, 0);
+    fputs("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n", timeline_file);
+    bytes_written = 0;
+    first_event = 1;
+    atomic_init(&event_count, 0);
+    atomic_init(&sim_clock_us, 0);
+    opened_at = monotonic_seconds();
+    timeline_buffer_init(&shared_buffer);
+    timeline_name(TIMELINE_PID_SCHEDULER, -1, "Round Robin (process table)");
+    timeline_name(TIMELINE_PID_FAULTS, -1, "Faults & recovery");
+    timeline_name(TIMELINE_PID_FAULTS, 0, "injection");
+    timeline_name(TIMELINE_PID_FAULTS, 1, "recovery");
+    return 1;
+}
+
+void timeline_close() {
+    if (timeline_file == NULL) {
+        return;
+    }
+    timeline_buffer_free(&shared_buffer);
+    fputs("\n]}\n", timeline_file);
+    fclose(timeline_file);
+    timeline_file = NULL;
+    printf("Timeline: %lld events, %lld bytes written.\n",
+           (long long)atomic_load(&event_count), bytes_written);
+}
+
+int timeline_active() {
+    return timeline_file != NULL;
+}
+
+// Simulated clock of the process table, in microseconds
+double timeline_now_us() {
+    return (double)atomic_load(&sim_clock_us);
+}
+
+// Move the simulated clock on by duration_us; returns where it stood
+double timeline_advance_us(double duration_us) {
+    return (double)atomic_fetch_add(&sim_clock_us, (long long)(duration_us + 0.5));
+}
+
+// Wall-clock microseconds since the timeline was opened, for timing
+// work done while the simulation is stopped
+double timeline_wall_us() {
+    return (monotonic_seconds() - opened_at) * 1e6;
+}
+
+void timeline_buffer_init(TimelineBuffer *buffer) {
+    buffer->data = timeline_file != NULL ? malloc(TIMELINE_CHUNK_BYTES) : NULL;
+    buffer->size = 0;
+}
+
+void timeline_buffer_flush(TimelineBuffer *buffer) {
+    if (buffer->data == NULL || buffer->size == 0 || timeline_file == NULL) {
+        return;
+    }
+    spin_lock(&file_lock);
+    // Events are written as ",\n{...}"; the very first one drops its comma
+    const char *start = buffer->data;
+    size_t size = buffer->size;
+    if (first_event) {
+        start += 2;
+        size -= 2;
+        first_event = 0;
+    }
+    fwrite(start, 1, size, timeline_file);
+    bytes_written += (long long)size;
+    spin_unlock(&file_lock);
+    buffer->size = 0;
+}
+
+void timeline_buffer_free(TimelineBuffer *buffer) {
+    timeline_buffer_flush(buffer);
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->size = 0;
+}
+
+// Append one formatted event, flushing first if the chunk cannot hold it
+static void append_event(TimelineBuffer *buffer, const char *format, ...) {
+    if (timeline_file == NULL) {
+        return;
+    }
+    int shared = buffer == NULL;
+    if (shared) {
+        spin_lock(&shared_lock);
+        buffer = &shared_buffer;
+    }
+    if (buffer->data != NULL) {
+        char event[512];
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(event, sizeof(event), format, args);
+        va_end(args);
+        if (length >= (int)sizeof(event)) length = (int)sizeof(event) - 1;
+        if (length > 0) {
+            if (buffer->size + (size_t)length + 2 > TIMELINE_CHUNK_BYTES) {
+                timeline_buffer_flush(buffer);
+            }
+            buffer->data[buffer->size++] = ',';
+            buffer->data[buffer->size++] = '\n';
+            memcpy(buffer->data + buffer->size, event, (size_t)length);
+            buffer->size += (size_t)length;
+            atomic_fetch_add_explicit(&event_count, 1, memory_order_relaxed);
+        }
+    }
+    if (shared) {
+        spin_unlock(&shared_lock);
+    }
+}
+
+// Names are emitted by the simulator itself and never need JSON escaping
+void timeline_slice(TimelineBuffer *buffer, int pid, int tid, const char *name,
+                    const char *category, double start_us, double duration_us) {
+    append_event(buffer, "{\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"name\":\"%s\",\"cat\":\"%s\",\"ts\":%.0f,\"dur\":%.0f}",
+                 pid, tid, name, category, start_us, duration_us);
+}
+
+void timeline_instant(TimelineBuffer *buffer, int pid, int tid, const char *name,
+                      const char *category, double ts_us) {
+    append_event(buffer, "{\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"name\":\"%s\",\"cat\":\"%s\",\"ts\":%.0f}",
+                 pid, tid, name, category, ts_us);
+}
+
+void timeline_counter(TimelineBuffer *buffer, int pid, const char *name, double ts_us, double value) {
+    append_event(buffer, "{\"ph\":\"C\",\"pid\":%d,\"name\":\"%s\",\"ts\":%.0f,\"args\":{\"value\":%.2f}}",
+                 pid, name, ts_us, value);
+}
+
+// Work that stops the simulation (recovery): a slice of its wall-clock
+// length since wall_started_us, placed at the simulated clock, which skips it
+void timeline_stopped_slice(TimelineBuffer *buffer, int pid, int tid, const char *name,
+                            const char *category, double wall_started_us) {
+    double duration_us = timeline_wall_us() - wall_started_us;
+    if (duration_us < 1.0) duration_us = 1.0;
+    timeline_slice(buffer, pid, tid, name, category, timeline_advance_us(duration_us), duration_us);
+}
+
+// Label a trace process (tid < 0) or thread
+void timeline_name(int pid, int tid, const char *name) {
+    if (tid < 0) {
+        append_event(NULL, "{\"ph\":\"M\",\"pid\":%d,\"name\":\"process_name\",\"args\":{\"name\":\"%s\"}}",
+                     pid, name);
+    } else {
+        append_event(NULL, "{\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":\"%s\"}}",
+                     pid, tid, name);
+    }
+}
@@ -0,0 +1,45 @@
+/*
+ * timeline.h - Header for the streaming Chrome trace (JSON) exporter
+ */
+
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <stddef.h>
+
+#define TIMELINE_CHUNK_BYTES (64 * 1024)
+
+// Trace "processes" the simulator writes to (threads are CPUs or PIDs);
+// multicore run N is written as TIMELINE_PID_MULTICORE + N
+#define TIMELINE_PID_SCHEDULER 1
+#define TIMELINE_PID_FAULTS 2
+#define TIMELINE_PID_MULTICORE 10
+
+// A writer's private chunk; appended to the file in one piece when full
+typedef struct {
+    char *data;
+    size_t size;
+} TimelineBuffer;
+
+int timeline_open(const char *path);
+void timeline_close();
+int timeline_active();
+double timeline_now_us();
+double timeline_advance_us(double duration_us);
+double timeline_wall_us();
+
+void timeline_buffer_init(TimelineBuffer *buffer);
+void timeline_buffer_flush(TimelineBuffer *buffer);
+void timeline_buffer_free(TimelineBuffer *buffer);
+
+// buffer may be NULL to use the shared (locked) buffer
+void timeline_slice(TimelineBuffer *buffer, int pid, int tid, const char *name,
+                    const char *category, double start_us, double duration_us);
+void timeline_instant(TimelineBuffer *buffer, int pid, int tid, const char *name,
+                      const char *category, double ts_us);
+void timeline_stopped_slice(TimelineBuffer *buffer, int pid, int tid, const char *name,
+                            const char *category, double wall_started_us);
+void timeline_counter(TimelineBuffer *buffer, int pid, const char *name, double ts_us, double value);
+void timeline_name(int pid, int tid, const char *name);
+
+#endif // TIMELINE_H
@@ -0,0 +1,39 @@
+/*
+ * timing.c - Implementation of portable timing helpers
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include "timing.h"
+
+// Monotonic wall clock in seconds, used for sampling intervals and latencies
+double monotonic_seconds() {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+void sleep_ms(int milliseconds) {
+#ifdef _WIN32
+    Sleep(milliseconds);
+#else
+    struct timespec ts;
+    ts.tv_sec = milliseconds / 1000;
+    ts.tv_nsec = (long)(milliseconds % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+#endif
+}
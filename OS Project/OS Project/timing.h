@@ -0,0 +1,11 @@
+/*
+ * timing.h - Header for portable timing helpers
+ */
+
+#ifndef TIMING_H
+#define TIMING_H
+
+double monotonic_seconds();
+void sleep_ms(int milliseconds);
+
+#endif // TIMING_H
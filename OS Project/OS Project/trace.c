@@ -0,0 +1,620 @@
+/*
+ * trace.c - Record host process traces and replay them through the detectors
+ *
+ * A trace is a small header followed by one length-prefixed frame per
+ * sampling pass. Inside a frame the processes are sorted by pid and stored
+ * column by column (pids, minor faults, major faults, CPU ticks, RSS, state),
+ * each counter as a zigzag varint delta against the same pid in the previous
+ * frame. Long-running processes therefore cost a few bytes per sample, and
+ * names and cgroups are only written when a pid first appears.
+ *
+ * Replay streams the file one frame at a time, so memory is bounded by the
+ * number of live processes rather than by the length of the capture. Frames
+ * feed the thrashing and CPU detectors in place of live /proc sampling, and
+ * whenever a detector raises an incident the processes involved are mirrored
+ * into the process table and recovery.c runs against them. The replay is open
+ * loop: recovery changes the simulated table, not the recorded workload.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "trace.h"
+#include "procfs.h"
+#include "timing.h"
+#include "process_manager.h"
+#include "algorithms.h"
+#include "recovery.h"
+#include "thrashing_monitor.h"
+#include "cpu_monitor.h"
+#include "cgroup_monitor.h"
+
+#define TRACE_MAGIC "OSFSTRCE"
+#define TRACE_MAX_PIDS 65536
+#define TRACE_MAX_FRAME_BYTES (64u * 1024u * 1024u)
+
+typedef struct {
+    char magic[8];
+    unsigned int version;
+    unsigned int interval_ms;
+    unsigned int clock_ticks;       // of the recording host
+    unsigned int page_size;
+    long long started;              // seconds since the epoch
+} TraceHeader;
+
+typedef struct {
+    unsigned char *data;
+    size_t size;
+    size_t capacity;
+} ByteBuffer;
+
+typedef struct {
+    const unsigned char *data;
+    size_t size;
+    size_t pos;
+    int error;
+} ByteCursor;
+
+// The previous and current frame plus, per current process, its index in
+// the previous frame (-1 if new); shared by the encoder and the decoder
+typedef struct {
+    TraceProcess *prev;
+    TraceProcess *cur;
+    int *match;
+    int prev_count;
+    int capacity;
+    long long prev_ms;
+    unsigned int version;           // of the trace being decoded
+} FramePair;
+
+static int buffer_reserve(ByteBuffer *buffer, size_t extra) {
+    if (buffer->size + extra <= buffer->capacity) {
+        return 1;
+    }
+    size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+    while (capacity < buffer->size + extra) capacity *= 2;
+    unsigned char *data = realloc(buffer->data, capacity);
+    if (data == NULL) {
+        return 0;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return 1;
+}
+
+static void put_varint(ByteBuffer *buffer, unsigned long long value) {
+    if (!buffer_reserve(buffer, 10)) return;
+    while (value >= 0x80) {
+        buffer->data[buffer->size++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    buffer->data[buffer->size++] = (unsigned char)value;
+}
+
+static unsigned long long get_varint(ByteCursor *cursor) {
+    unsigned long long value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (cursor->pos >= cursor->size) break;
+        unsigned char byte = cursor->data[cursor->pos++];
+        value |= (unsigned long long)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    cursor->error = 1;
+    return 0;
+}
+
+static unsigned long long zigzag(long long value) {
+    return ((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63);
+}
+
+static long long unzigzag(unsigned long long value) {
+    return (long long)(value >> 1) ^ -(long long)(value & 1);
+}
+
+static int pair_reserve(FramePair *pair, int count) {
+    if (count <= pair->capacity) {
+        return 1;
+    }
+    int capacity = pair->capacity ? pair->capacity : 256;
+    while (capacity < count) capacity *= 2;
+    TraceProcess *prev = realloc(pair->prev, sizeof(TraceProcess) * capacity);
+    if (prev != NULL) pair->prev = prev;
+    TraceProcess *cur = realloc(pair->cur, sizeof(TraceProcess) * capacity);
+    if (cur != NULL) pair->cur = cur;
+    int *match = realloc(pair->match, sizeof(int) * capacity);
+    if (match != NULL) pair->match = match;
+    if (prev == NULL || cur == NULL || match == NULL) {
+        return 0;
+    }
+    pair->capacity = capacity;
+    return 1;
+}
+
+// Merge the sorted pid column of the current frame against the previous one
+static void match_previous(FramePair *pair, int count) {
+    int j = 0;
+    for (int i = 0; i < count; i++) {
+        while (j < pair->prev_count && pair->prev[j].pid < pair->cur[i].pid) j++;
+        pair->match[i] = (j < pair->prev_count && pair->prev[j].pid == pair->cur[i].pid) ? j : -1;
+    }
+}
+
+static void advance_pair(FramePair *pair, int count) {
+    TraceProcess *swap = pair->prev;
+    pair->prev = pair->cur;
+    pair->cur = swap;
+    pair->prev_count = count;
+}
+
+static void free_pair(FramePair *pair) {
+    free(pair->prev);
+    free(pair->cur);
+    free(pair->match);
+    memset(pair, 0, sizeof(*pair));
+}
+
+static int compare_pid(const void *a, const void *b) {
+    return ((const TraceProcess *)a)->pid - ((const TraceProcess *)b)->pid;
+}
+
+static int put_string(ByteBuffer *out, const char *text) {
+    size_t length = strlen(text);
+    put_varint(out, length);
+    if (!buffer_reserve(out, length)) return 0;
+    memcpy(out->data + out->size, text, length);
+    out->size += length;
+    return 1;
+}
+
+// Length-prefixed string, truncated to size - 1; 0 on a short payload
+static int get_string(ByteCursor *in, char *text, size_t size) {
+    unsigned long long length = get_varint(in);
+    if (in->error || length > in->size - in->pos) {
+        return 0;
+    }
+    size_t kept = length < size ? (size_t)length : size - 1;
+    memcpy(text, in->data + in->pos, kept);
+    text[kept] = '\0';
+    in->pos += (size_t)length;
+    return 1;
+}
+
+// Encode pair->cur (count processes, sorted) as one frame payload
+static void encode_frame(ByteBuffer *out, FramePair *pair, const TraceFrame *frame) {
+    long long now_ms = (long long)(frame->timestamp * 1000.0 + 0.5);
+    int count = frame->count;
+    match_previous(pair, count);
+
+    out->size = 0;
+    put_varint(out, (unsigned long long)(now_ms - pair->prev_ms));
+    put_varint(out, frame->host_busy);
+    put_varint(out, frame->host_total);
+    put_varint(out, (unsigned long long)(frame->psi_some * 100.0f + 0.5f));
+    put_varint(out, (unsigned long long)(frame->psi_full * 100.0f + 0.5f));
+    put_varint(out, (unsigned long long)count);
+
+    int last_pid = 0;
+    for (int i = 0; i < count; i++) {
+        put_varint(out, (unsigned long long)(pair->cur[i].pid - last_pid));
+        last_pid = pair->cur[i].pid;
+    }
+    #define PUT_DELTA_COLUMN(field) \
+        for (int i = 0; i < count; i++) { \
+            long long base = pair->match[i] >= 0 ? (long long)pair->prev[pair->match[i]].field : 0; \
+            put_varint(out, zigzag((long long)pair->cur[i].field - base)); \
+        }
+    PUT_DELTA_COLUMN(minflt)
+    PUT_DELTA_COLUMN(majflt)
+    PUT_DELTA_COLUMN(cpu_ticks)
+    PUT_DELTA_COLUMN(rss_pages)
+    #undef PUT_DELTA_COLUMN
+    if (!buffer_reserve(out, (size_t)count)) return;
+    for (int i = 0; i < count; i++) {
+        out->data[out->size++] = (unsigned char)pair->cur[i].state;
+    }
+    for (int i = 0; i < count; i++) {
+        if (pair->match[i] >= 0) continue;
+        if (!put_string(out, pair->cur[i].name) || !put_string(out, pair->cur[i].cgroup)) return;
+    }
+    pair->prev_ms = now_ms;
+}
+
+// Decode one frame payload into pair->cur; returns the process count or -1
+static int decode_frame(ByteCursor *in, FramePair *pair, TraceFrame *frame) {
+    pair->prev_ms += (long long)get_varint(in);
+    frame->timestamp = pair->prev_ms / 1000.0;
+    frame->host_busy = get_varint(in);
+    frame->host_total = get_varint(in);
+    frame->psi_some = get_varint(in) / 100.0f;
+    frame->psi_full = get_varint(in) / 100.0f;
+    unsigned long long count = get_varint(in);
+    if (in->error || count > in->size || !pair_reserve(pair, (int)count)) {
+        return -1;
+    }
+
+    int n = (int)count;
+    int last_pid = 0;
+    for (int i = 0; i < n; i++) {
+        last_pid += (int)get_varint(in);
+        pair->cur[i].pid = last_pid;
+    }
+    match_previous(pair, n);
+    #define GET_DELTA_COLUMN(field, type) \
+        for (int i = 0; i < n; i++) { \
+            long long base = pair->match[i] >= 0 ? (long long)pair->prev[pair->match[i]].field : 0; \
+            pair->cur[i].field = (type)(base + unzigzag(get_varint(in))); \
+        }
+    GET_DELTA_COLUMN(minflt, unsigned long)
+    GET_DELTA_COLUMN(majflt, unsigned long)
+    GET_DELTA_COLUMN(cpu_ticks, unsigned long)
+    GET_DELTA_COLUMN(rss_pages, long)
+    #undef GET_DELTA_COLUMN
+    if (in->error || in->size - in->pos < (size_t)n) {
+        return -1;
+    }
+    for (int i = 0; i < n; i++) {
+        pair->cur[i].state = (char)in->data[in->pos++];
+    }
+    for (int i = 0; i < n; i++) {
+        if (pair->match[i] >= 0) {
+            memcpy(pair->cur[i].name, pair->prev[pair->match[i]].name, sizeof(pair->cur[i].name));
+            memcpy(pair->cur[i].cgroup, pair->prev[pair->match[i]].cgroup, sizeof(pair->cur[i].cgroup));
+            continue;
+        }
+        if (!get_string(in, pair->cur[i].name, sizeof(pair->cur[i].name))) {
+            return -1;
+        }
+        if (pair->version < 2) {
+            snprintf(pair->cur[i].cgroup, sizeof(pair->cur[i].cgroup), "/");
+        } else if (!get_string(in, pair->cur[i].cgroup, sizeof(pair->cur[i].cgroup))) {
+            return -1;
+        }
+    }
+    frame->count = n;
+    frame->processes = pair->cur;
+    return n;
+}
+
+static int write_frame(FILE *file, const ByteBuffer *payload) {
+    unsigned char prefix[10];
+    int length = 0;
+    size_t value = payload->size;
+    while (value >= 0x80) {
+        prefix[length++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    prefix[length++] = (unsigned char)value;
+    return fwrite(prefix, 1, (size_t)length, file) == (size_t)length &&
+           fwrite(payload->data, 1, payload->size, file) == payload->size;
+}
+
+// Read the next length-prefixed payload; 1 on success, 0 at end of file, -1 if corrupt
+static int read_frame(FILE *file, ByteBuffer *payload) {
+    size_t length = 0;
+    int byte = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        byte = getc(file);
+        if (byte == EOF) {
+            return shift == 0 ? 0 : -1;
+        }
+        length |= (size_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) break;
+    }
+    if ((byte & 0x80) || length > TRACE_MAX_FRAME_BYTES) {
+        return -1;
+    }
+    payload->size = 0;
+    if (!buffer_reserve(payload, length) || fread(payload->data, 1, length, file) != length) {
+        return -1;
+    }
+    payload->size = length;
+    return 1;
+}
+
+int trace_record(const char *path, int seconds, int interval_ms) {
+    if (!procfs_available()) {
+        printf("Error: Trace recording needs Linux /proc.\n");
+        return 0;
+    }
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        printf("Error: Cannot create trace %s.\n", path);
+        return 0;
+    }
+    TraceHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    header.interval_ms = (unsigned int)interval_ms;
+    header.clock_ticks = (unsigned int)procfs_clock_ticks();
+    header.page_size = (unsigned int)procfs_page_size();
+    header.started = (long long)time(NULL);
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+    int *pids = malloc(sizeof(int) * TRACE_MAX_PIDS);
+    FramePair pair;
+    memset(&pair, 0, sizeof(pair));
+    pair.version = TRACE_VERSION;
+    ByteBuffer payload = {NULL, 0, 0};
+    CpuTimes prev_host = {0, 0};
+    procfs_read_cpu_times(&prev_host, NULL, 0);
+
+    printf("Recording /proc every %d ms for %d s to %s...\n", interval_ms, seconds, path);
+    double start = monotonic_seconds();
+    long frames = 0, samples = 0;
+    while (ok && pids != NULL && monotonic_seconds() - start < seconds) {
+        int pid_total = procfs_list_pids(pids, TRACE_MAX_PIDS);
+        if (!pair_reserve(&pair, pid_total)) {
+            ok = 0;
+            break;
+        }
+        TraceFrame frame;
+        memset(&frame, 0, sizeof(frame));
+        frame.timestamp = monotonic_seconds() - start;
+        for (int i = 0; i < pid_total; i++) {
+            ProcPidStat stat;
+            if (!procfs_read_pid_stat(pids[i], &stat)) continue;
+            TraceProcess *process = &pair.cur[frame.count++];
+            process->pid = stat.pid;
+            memcpy(process->name, stat.name, sizeof(process->name));
+            process->state = stat.state;
+            process->minflt = stat.minflt;
+            process->majflt = stat.majflt;
+            process->cpu_ticks = stat.utime + stat.stime;
+            process->rss_pages = stat.rss_pages;
+        }
+        qsort(pair.cur, (size_t)frame.count, sizeof(TraceProcess), compare_pid);
+        // Only pids new since the previous pass need their cgroup read
+        match_previous(&pair, frame.count);
+        for (int i = 0; i < frame.count; i++) {
+            TraceProcess *process = &pair.cur[i];
+            if (pair.match[i] >= 0) {
+                memcpy(process->cgroup, pair.prev[pair.match[i]].cgroup, sizeof(process->cgroup));
+            } else if (!procfs_read_pid_cgroup(process->pid, process->cgroup, sizeof(process->cgroup))) {
+                snprintf(process->cgroup, sizeof(process->cgroup), "/");
+            }
+        }
+
+        CpuTimes host = prev_host;
+        procfs_read_cpu_times(&host, NULL, 0);
+        frame.host_busy = host.busy - prev_host.busy;
+        frame.host_total = host.total - prev_host.total;
+        prev_host = host;
+        procfs_read_memory_pressure(&frame.psi_some, &frame.psi_full);
+
+        encode_frame(&payload, &pair, &frame);
+        ok = write_frame(file, &payload);
+        advance_pair(&pair, frame.count);
+        frames++;
+        samples += frame.count;
+
+        // Fixed-rate schedule so sampling cost does not stretch the interval
+        double next = start + (double)frames * interval_ms / 1000.0;
+        double wait = next - monotonic_seconds();
+        if (wait > 0) sleep_ms((int)(wait * 1000.0));
+    }
+    long total_bytes = ftell(file);
+    if (fclose(file) != 0) ok = 0;
+    free(pids);
+    free(payload.data);
+    free_pair(&pair);
+    if (!ok) {
+        printf("Error: Failed while writing trace %s.\n", path);
+        return 0;
+    }
+    printf("Recorded %ld frames, %ld process samples, %ld bytes (%.1f bytes/sample).\n",
+           frames, samples, total_bytes, samples > 0 ? (double)total_bytes / samples : 0.0);
+    return 1;
+}
+
+static const TraceProcess *find_process(const TraceFrame *frame, int pid) {
+    TraceProcess key;
+    key.pid = pid;
+    return bsearch(&key, frame->processes, (size_t)frame->count, sizeof(TraceProcess), compare_pid);
+}
+
+// Copy the involved processes into the simulated process table
+static void mirror_process(const TraceFrame *frame, int pid, float cpu_usage, long page_kb) {
+    const TraceProcess *process = find_process(frame, pid);
+    if (process == NULL) {
+        return;
+    }
+    int index = add_process(pid, process->name, process->cgroup);
+    int rss_kb = (int)(process->rss_pages * page_kb);
+    pcb_set_cpu_usage(index, cpu_usage);
+    pcb_set_allocated_memory(index, rss_kb);
+    pcb_set_mem_usage(index, rss_kb / 1024.0f);
+}
+
+typedef struct {
+    const char *name;
+    int active;
+    double started;
+    int count;
+    double total_seconds;
+    double longest_seconds;
+} IncidentTracker;
+
+// Track detector state changes; returns 1 when an incident has just started
+static int update_incident(IncidentTracker *tracker, int active, double now, const char *detail) {
+    if (active && !tracker->active) {
+        tracker->active = 1;
+        tracker->started = now;
+        tracker->count++;
+        printf("\n[Replay t=%.1fs] %s raised: %s\n", now, tracker->name, detail);
+        return 1;
+    }
+    if (!active && tracker->active) {
+        double duration = now - tracker->started;
+        tracker->active = 0;
+        tracker->total_seconds += duration;
+        if (duration > tracker->longest_seconds) tracker->longest_seconds = duration;
+        printf("[Replay t=%.1fs] %s cleared after %.1f s\n", now, tracker->name, duration);
+    }
+    return 0;
+}
+
+int trace_replay(const char *path, double speed) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        printf("Error: Cannot open trace %s.\n", path);
+        return 0;
+    }
+    TraceHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version > TRACE_VERSION || header.clock_ticks == 0) {
+        printf("Error: %s is not a readable trace.\n", path);
+        fclose(file);
+        return 0;
+    }
+
+    // Detectors take their samples from the trace instead of this host
+    thrashing_monitor_reset();
+    cpu_monitor_reset();
+    thrashing_monitor_set_live_sampling(0);
+    cpu_monitor_set_live_sampling(0);
+    cgroup_monitor_set_live_sampling(0);
+    pcb_clear_table();
+    clear_resource_allocations();
+
+    long page_kb = header.page_size / 1024;
+    FramePair pair;
+    memset(&pair, 0, sizeof(pair));
+    pair.version = header.version;
+    ByteBuffer payload = {NULL, 0, 0};
+    IncidentTracker cpu_incident = {"CPU overload", 0, 0.0, 0, 0.0, 0.0};
+    IncidentTracker memory_incident = {"Thrashing", 0, 0.0, 0, 0.0, 0.0};
+    ProcessCpuStats hot[MAX_PROCESSES];
+    ProcessFaultStats faulting[MAX_PROCESSES];
+    long frames = 0, samples = 0;
+    double last_time = 0.0;
+    int status;
+
+    printf("Replaying %s at %.0fx real time...\n", path, speed);
+    double wall_start = monotonic_seconds();
+    while ((status = read_frame(file, &payload)) > 0) {
+        ByteCursor cursor = {payload.data, payload.size, 0, 0};
+        TraceFrame frame;
+        if (decode_frame(&cursor, &pair, &frame) < 0) {
+            status = -1;
+            break;
+        }
+        double dt = frame.timestamp - last_time;
+
+        for (int i = 0; i < frame.count; i++) {
+            const TraceProcess *process = &frame.processes[i];
+            thrashing_monitor_record(process->pid, frame.timestamp, process->minflt,
+                                     process->majflt, process->rss_pages * page_kb);
+            if (pair.match[i] >= 0 && dt > 0.0) {
+                const TraceProcess *before = &pair.prev[pair.match[i]];
+                if (process->cpu_ticks >= before->cpu_ticks) {
+                    cpu_monitor_record_process(process->pid,
+                        (float)(100.0 * (process->cpu_ticks - before->cpu_ticks) / header.clock_ticks / dt));
+                }
+            }
+        }
+        thrashing_monitor_set_pressure(frame.psi_some, frame.psi_full);
+        thrashing_monitor_end_pass();
+        if (frame.host_total > 0) {
+            cpu_monitor_record_core(-1, (float)(100.0 * frame.host_busy / frame.host_total));
+        }
+        cpu_monitor_end_pass();
+
+        // CPU incidents: host overload or any process pinned above the threshold
+        CpuOverloadReport report;
+        cpu_monitor_report(&report);
+        int tracked = cpu_monitor_collect(hot, MAX_PROCESSES);
+        int hot_count = 0;
+        for (int i = 0; i < tracked; i++) {
+            if (hot[i].hot) hot[hot_count++] = hot[i];
+        }
+        char detail[160];
+        snprintf(detail, sizeof(detail), "host %.1f%% (%s), %d hot processes",
+                 report.host_ewma, cpu_monitor_state_name(report.state), report.hot_processes);
+        if (update_incident(&cpu_incident, report.state != CPU_STATE_NORMAL || hot_count > 0,
+                            frame.timestamp, detail)) {
+            for (int i = 0; i < hot_count; i++) {
+                mirror_process(&frame, hot[i].pid, hot[i].ewma, page_kb);
+            }
+            detect_and_fix_cpu_overload();
+        }
+
+        // Thrashing incidents: any process above the (pressure adjusted) PFF threshold
+        int fault_count = thrashing_monitor_collect(faulting, MAX_PROCESSES);
+        int thrashing = 0;
+        for (int i = 0; i < fault_count; i++) {
+            if (faulting[i].thrashing) faulting[thrashing++] = faulting[i];
+        }
+        snprintf(detail, sizeof(detail), "%d processes above the PFF threshold (PSI full %.1f%%)",
+                 thrashing, frame.psi_full);
+        if (update_incident(&memory_incident, thrashing > 0, frame.timestamp, detail)) {
+            for (int i = 0; i < thrashing; i++) {
+                ProcessCpuStats cpu;
+                mirror_process(&frame, faulting[i].pid,
+                               cpu_monitor_lookup(faulting[i].pid, &cpu) ? cpu.ewma : 0.0f, page_kb);
+            }
+            detect_and_fix_thrashing();
+        }
+
+        advance_pair(&pair, frame.count);
+        last_time = frame.timestamp;
+        frames++;
+        samples += frame.count;
+
+        // Pace against the trace clock; speed <= 0 replays as fast as possible
+        if (speed > 0.0) {
+            double ahead = last_time / speed - (monotonic_seconds() - wall_start);
+            if (ahead > 0.001) sleep_ms((int)(ahead * 1000.0));
+        }
+    }
+    double wall = monotonic_seconds() - wall_start;
+    update_incident(&cpu_incident, 0, last_time, "");
+    update_incident(&memory_incident, 0, last_time, "");
+    fclose(file);
+    free(payload.data);
+    free_pair(&pair);
+    thrashing_monitor_set_live_sampling(1);
+    cpu_monitor_set_live_sampling(1);
+    cgroup_monitor_set_live_sampling(1);
+
+    if (status < 0) {
+        printf("Warning: trace is truncated or corrupt after frame %ld.\n", frames);
+    }
+    printf("\n=== TRACE REPLAY SUMMARY ===\n");
+    printf("Frames: %ld, process samples: %ld, trace time %.1f s, replayed in %.2f s (%.0fx)\n",
+           frames, samples, last_time, wall, wall > 0.0 ? last_time / wall : 0.0);
+    printf("+--------------+-----------+-------------+-------------+\n");
+    printf("| Detector     | Incidents | Total (s)   | Longest (s) |\n");
+    printf("+--------------+-----------+-------------+-------------+\n");
+    const IncidentTracker *trackers[2] = {&cpu_incident, &memory_incident};
+    for (int i = 0; i < 2; i++) {
+        printf("| %-12s | %9d | %11.1f | %11.1f |\n", trackers[i]->name, trackers[i]->count,
+               trackers[i]->total_seconds, trackers[i]->longest_seconds);
+    }
+    printf("+--------------+-----------+-------------+-------------+\n");
+    return status >= 0;
+}
+
+// trace record <file> [seconds] [interval ms] | trace replay <file> [speed]
+int trace_command(int argc, char *argv[]) {
+    if (argc >= 2 && strcmp(argv[0], "record") == 0) {
+        int seconds = argc > 2 ? atoi(argv[2]) : 60;
+        int interval_ms = argc > 3 ? atoi(argv[3]) : 1000;
+        if (seconds < 1 || interval_ms < 10) {
+            printf("Usage: trace record <file> [seconds >= 1] [interval >= 10 ms]\n");
+            return 1;
+        }
+        return trace_record(argv[1], seconds, interval_ms) ? 0 : 1;
+    }
+    if (argc >= 2 && strcmp(argv[0], "replay") == 0) {
+        double speed = argc > 2 ? atof(argv[2]) : 1000.0;
+        return trace_replay(argv[1], speed) ? 0 : 1;
+    }
+    printf("Usage: trace record <file> [seconds] [interval ms]\n");
+    printf("       trace replay <file> [speed, 0 = unthrottled]\n");
+    return 1;
+}
@@ -0,0 +1,37 @@
+/*
+ * trace.h - Header for recording and replaying host process traces
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#define TRACE_VERSION 2         // 2 adds the cgroup of each new pid
+
+// One process as sampled from /proc/[pid]/stat
+typedef struct {
+    int pid;
+    char name[50];
+    char cgroup[64];                // cgroup v2 path, "/" in version 1 traces
+    char state;
+    unsigned long minflt;
+    unsigned long majflt;
+    unsigned long cpu_ticks;        // utime + stime
+    long rss_pages;
+} TraceProcess;
+
+// One sampling pass over the host
+typedef struct {
+    double timestamp;               // seconds since the recording started
+    unsigned long long host_busy;   // busy jiffies since the previous frame
+    unsigned long long host_total;  // all jiffies since the previous frame
+    float psi_some;                 // memory pressure avg10 %
+    float psi_full;
+    int count;
+    TraceProcess *processes;        // sorted by pid
+} TraceFrame;
+
+int trace_record(const char *path, int seconds, int interval_ms);
+int trace_replay(const char *path, double speed);
+int trace_command(int argc, char *argv[]);
+
+#endif // TRACE_H
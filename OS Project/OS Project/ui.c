@@ -2,6 +2,8 @@
  * ui.c - Enhanced UI implementation with colors and animations
  */
 
+#define _DEFAULT_SOURCE     // usleep is hidden by -std=c11
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -88,16 +90,19 @@ void display_loading_animation(const char* text) {
 }
 
 void display_status_panel() {
+    PcbReadGuard guard = pcb_read_begin();
+    const PCB *rows = guard.snapshot->rows;
+    int count = guard.snapshot->count;
     printf("+-------------- SYSTEM STATUS --------------+\n");
     printf("| [*] System:     ONLINE                    |\n");
-    printf("| [*] Processes:  %2d active                |\n", process_count);
+    printf("| [*] Processes:  %2d active                |\n", count);
     
     // Calculate average CPU usage
     float avg_cpu = 0;
-    for(int i = 0; i < process_count; i++) {
-        avg_cpu += pcb_table[i].cpu_usage;
+    for(int i = 0; i < count; i++) {
+        avg_cpu += rows[i].cpu_usage;
     }
-    avg_cpu /= process_count;
+    avg_cpu /= count;
     
     printf("| [*] CPU Usage:  %.1f%%                    |\n", avg_cpu);
     
@@ -106,9 +111,13 @@ void display_status_panel() {
     time_str[strlen(time_str)-1] = '\0'; // Remove newline
     printf("| [*] Time:       %s |\n", time_str + 11); // Just show time part
     printf("+-------------------------------------------+\n");
+    pcb_read_end(&guard);
 }
 
 void display_process_table_enhanced() {
+    PcbReadGuard guard = pcb_read_begin();
+    const PCB *rows = guard.snapshot->rows;
+    int count = guard.snapshot->count;
     printf("\n");
     printf("+======================================================+\n");
     printf("|                 PROCESS TABLE                        |\n");
@@ -116,14 +125,14 @@ void display_process_table_enhanced() {
     printf("| PID  | Process Name      | CPU%%  | MEM%%  | State   |\n");
     printf("+------+-------------------+-------+-------+---------+\n");
     
-    for (int i = 0; i < process_count && i < 8; i++) {
+    for (int i = 0; i < count && i < 8; i++) {
         printf("| %4d | %-17s | %5.1f | %5.1f | ", 
-               pcb_table[i].pid, 
-               pcb_table[i].name, 
-               pcb_table[i].cpu_usage, 
-               pcb_table[i].mem_usage);
+               rows[i].pid, 
+               rows[i].name, 
+               rows[i].cpu_usage, 
+               rows[i].mem_usage);
         
-        switch(pcb_table[i].state) {
+        switch(rows[i].state) {
             case 0: printf("READY   "); break;
             case 1: printf("RUNNING "); break;
             case 2: printf("WAITING "); break;
@@ -132,11 +141,12 @@ void display_process_table_enhanced() {
         printf("|\n");
     }
     
-    if(process_count > 8) {
-        printf("| ... and %d more processes ...                      |\n", process_count - 8);
+    if(count > 8) {
+        printf("| ... and %d more processes ...                      |\n", count - 8);
     }
     
     printf("+======================================================+\n");
+    pcb_read_end(&guard);
 }
 
 void display_fault_injection_animation(const char* fault_type) {
@@ -214,12 +224,15 @@ void display_main_menu_enhanced() {
     printf("|  1. [!] Inject Deadlock                                 |\n");
     printf("|  2. [!] Inject CPU Overload                             |\n");
     printf("|  3. [!] Inject Memory Thrashing                         |\n");
-    printf("|  4. [@] Show Algorithm Comparisons                      |\n");
-    printf("|  5. [?] Run System Analysis                             |\n");
-    printf("|  6. [#] Performance Dashboard                           |\n");
-    printf("|  7. [X] Exit Simulation                                 |\n");
+    printf("|  4. [!] Inject I/O Storm                                |\n");
+    printf("|  5. [!] Inject Priority Inversion                       |\n");
+    printf("|  6. [!] Inject Starvation                               |\n");
+    printf("|  7. [@] Show Algorithm Comparisons                      |\n");
+    printf("|  8. [?] Run System Analysis                             |\n");
+    printf("|  9. [#] Performance Dashboard                           |\n");
+    printf("| 10. [X] Exit Simulation                                 |\n");
     printf("+==========================================================+\n");
-    printf("Enter your choice (1-7): ");
+    printf("Enter your choice (1-10): ");
 }
 
 void pause_with_message(const char* message) {
@@ -234,6 +247,9 @@ void display_system_monitor() {
 }
 
 void display_gantt_chart_enhanced() {
+    PcbReadGuard guard = pcb_read_begin();
+    const PCB *rows = guard.snapshot->rows;
+    int count = guard.snapshot->count;
     printf(BLUE BOLD "\n╔═══════════════ GANTT CHART ═══════════════╗\n" RESET);
     printf(BLUE "║ " RESET "Time:  ");
     
@@ -245,30 +261,34 @@ void display_gantt_chart_enhanced() {
     printf(BLUE " ║\n");
     
     printf("║ " RESET "CPU:   ");
-    for (int i = 0; i < process_count && i < 4; i++) {
+    for (int i = 0; i < count && i < 4; i++) {
         // Color code based on process priority
-        if (pcb_table[i].priority <= 2) printf(RED);
-        else if (pcb_table[i].priority <= 3) printf(YELLOW);
+        if (rows[i].priority <= 2) printf(RED);
+        else if (rows[i].priority <= 3) printf(YELLOW);
         else printf(GREEN);
         
-        printf("P%d", pcb_table[i].pid % 100);
-        for (int j = 0; j < pcb_table[i].burst_time && j < 4; j++) {
+        printf("P%d", rows[i].pid % 100);
+        for (int j = 0; j < rows[i].burst_time && j < 4; j++) {
             printf("█");
         }
         printf(RESET " ");
     }
     printf(BLUE "║\n");
     printf("╚═══════════════════════════════════════════╝\n" RESET);
+    pcb_read_end(&guard);
 }
 
 void display_memory_map_enhanced() {
+    PcbReadGuard guard = pcb_read_begin();
+    const PCB *rows = guard.snapshot->rows;
+    int count = guard.snapshot->count;
     printf(GREEN BOLD "\n╔════════════ MEMORY ALLOCATION MAP ════════════╗\n" RESET);
     
     int total_memory = 1000;
     int used_memory = 0;
     
-    for (int i = 0; i < process_count && i < 10; i++) {
-        used_memory += (int)pcb_table[i].mem_usage;
+    for (int i = 0; i < count && i < 10; i++) {
+        used_memory += (int)rows[i].mem_usage;
     }
     
     printf(GREEN "║ " RESET "Total Memory: %d MB | Used: %d MB | Free: %d MB" GREEN " ║\n" RESET, 
@@ -292,11 +312,11 @@ void display_memory_map_enhanced() {
     for(int i = 0; i < 22; i++) printf(" ");
     printf("║\n");
     
-    for (int i = 0; i < process_count && i < 3; i++) {
+    for (int i = 0; i < count && i < 3; i++) {
         printf(GREEN "║ " RESET "  %-12s: %4.1f MB ", 
-               pcb_table[i].name, pcb_table[i].mem_usage);
+               rows[i].name, rows[i].mem_usage);
         
-        int bars = (int)(pcb_table[i].mem_usage / 5.0);
+        int bars = (int)(rows[i].mem_usage / 5.0);
         for (int j = 0; j < bars && j < 8; j++) {
             if (j < 3) printf(GREEN "▓");
             else if (j < 6) printf(YELLOW "▓");
@@ -308,4 +328,5 @@ void display_memory_map_enhanced() {
     }
     
     printf(GREEN "╚═══════════════════════════════════════════════╝\n" RESET);
+    pcb_read_end(&guard);
 }
@@ -0,0 +1,616 @@
+/*
+ * victim.c - Choosing which deadlocked processes to roll back
+ *
+ * Recovery has to break every cycle in the wait-for graph, and each process
+ * it rolls back costs the work it has done, its restart and the resources it
+ * has to re-acquire, weighted by priority. The cheapest such set is a
+ * minimum-weight feedback vertex set, so the default is a greedy cover:
+ * processes that cannot be on a cycle are peeled off, the one with the lowest
+ * cost per cycle it can sit on goes next, and peeling resumes. Exact mode
+ * also searches small deadlocked groups exhaustively.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "victim.h"
+#include "arena.h"
+#include "timing.h"
+#include "workload_gen.h"
+
+// Rollback cost: lost work and restart weighted by urgency, plus re-acquisition
+double victim_cost(const VictimCandidate *candidate) {
+    int priority = candidate->priority < 1 ? 1 : candidate->priority > 6 ? 6 : candidate->priority;
+    double weight = 1.0 + (6 - priority) * 0.5;
+    return (candidate->progress + candidate->restart) * weight + candidate->held * VICTIM_HELD_COST;
+}
+
+static int compare_key(const void *a, const void *b) {
+    unsigned long long x = *(const unsigned long long *)a, y = *(const unsigned long long *)b;
+    return (x > y) - (x < y);
+}
+
+// First entry whose upper 32 bits are >= key
+static int lower_bound(const unsigned long long *keys, int count, unsigned int key) {
+    int lo = 0, hi = count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if ((unsigned int)(keys[mid] >> 32) < key) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+// Build the wait-for graph of allocation records in the run arena: every
+// process waits on every other holder of each resource it requests. held comes
+// from the records; describe fills in progress, priority and restart cost.
+// Returns 0, or -1 if memory runs out.
+int victim_graph_from_records(const ResourceAllocation *records, int count,
+                              void (*describe)(int pid, VictimCandidate *candidate, void *context),
+                              void *context, WaitGraph *graph) {
+    Arena *arena = run_arena();
+    memset(graph, 0, sizeof(*graph));
+    unsigned long long *holders = arena_alloc(arena, sizeof(unsigned long long) * (count + 1));
+    unsigned long long *pids = arena_alloc(arena, sizeof(unsigned long long) * (count + 1));
+    if (holders == NULL || pids == NULL) return -1;
+
+    int holder_count = 0, pid_count = 0;
+    for (int i = 0; i < count; i++) {
+        pids[pid_count++] = (unsigned long long)(unsigned int)records[i].process_id << 32;
+        if (records[i].allocated) {
+            holders[holder_count++] = ((unsigned long long)(unsigned int)records[i].resource_id << 32) | (unsigned int)i;
+        }
+    }
+    qsort(holders, (size_t)holder_count, sizeof(unsigned long long), compare_key);
+    qsort(pids, (size_t)pid_count, sizeof(unsigned long long), compare_key);
+    int nodes = 0;
+    for (int i = 0; i < pid_count; i++) {
+        if (nodes == 0 || (pids[i] >> 32) != (pids[nodes - 1] >> 32)) pids[nodes++] = pids[i];
+    }
+
+    VictimCandidate *candidates = arena_calloc(arena, (size_t)nodes + 1, sizeof(VictimCandidate));
+    int *edge_start = arena_calloc(arena, (size_t)nodes + 2, sizeof(int));
+    if (candidates == NULL || edge_start == NULL) return -1;
+    for (int v = 0; v < nodes; v++) {
+        candidates[v].pid = (int)(pids[v] >> 32);
+        candidates[v].priority = 3;
+        candidates[v].restart = VICTIM_RESTART_TICKS;
+        if (describe) describe(candidates[v].pid, &candidates[v], context);
+        candidates[v].held = 0;
+    }
+
+    // Count, then place, one edge per (request, other holder)
+    for (int pass = 0; pass < 2; pass++) {
+        int *cursor = pass == 0 ? NULL : arena_alloc(arena, sizeof(int) * (nodes + 1));
+        if (pass == 1) {
+            for (int v = 0; v < nodes; v++) edge_start[v + 1] += edge_start[v];
+            graph->edge_to = arena_alloc(arena, sizeof(int) * (edge_start[nodes] + 1));
+            if (cursor == NULL || graph->edge_to == NULL) return -1;
+            memcpy(cursor, edge_start, sizeof(int) * nodes);
+        }
+        for (int i = 0; i < count; i++) {
+            unsigned int pid = (unsigned int)records[i].process_id;
+            int node = lower_bound(pids, nodes, pid);
+            if (pass == 0 && records[i].allocated) candidates[node].held++;
+            if (!records[i].requested) continue;
+            unsigned int resource = (unsigned int)records[i].resource_id;
+            for (int at = lower_bound(holders, holder_count, resource);
+                 at < holder_count && (holders[at] >> 32) == resource; at++) {
+                unsigned int holder = (unsigned int)records[holders[at] & 0xffffffffu].process_id;
+                if (holder == pid) continue;
+                if (pass == 0) edge_start[node + 1]++;
+                else graph->edge_to[cursor[node]++] = lower_bound(pids, nodes, holder);
+            }
+        }
+    }
+    graph->nodes = nodes;
+    graph->edge_count = edge_start[nodes];
+    graph->candidates = candidates;
+    graph->edge_start = edge_start;
+    return 0;
+}
+
+// Strongly connected components (iterative Tarjan); returns how many
+static int find_components(const WaitGraph *graph, int *comp, int *index, int *low,
+                           int *stack, int *call, int *cursor) {
+    int next_index = 0, top = 0, comps = 0;
+    for (int v = 0; v < graph->nodes; v++) {
+        index[v] = -1;
+        comp[v] = -1;
+    }
+    for (int root = 0; root < graph->nodes; root++) {
+        if (index[root] >= 0) continue;
+        int depth = 0;
+        call[depth++] = root;
+        index[root] = low[root] = next_index++;
+        stack[top++] = root;
+        cursor[root] = graph->edge_start[root];
+        while (depth > 0) {
+            int v = call[depth - 1];
+            if (cursor[v] < graph->edge_start[v + 1]) {
+                int w = graph->edge_to[cursor[v]++];
+                if (index[w] < 0) {
+                    index[w] = low[w] = next_index++;
+                    stack[top++] = w;
+                    cursor[w] = graph->edge_start[w];
+                    call[depth++] = w;
+                } else if (comp[w] < 0 && index[w] < low[v]) {
+                    low[v] = index[w];      // w is still on the stack
+                }
+                continue;
+            }
+            if (low[v] == index[v]) {
+                int w;
+                do {
+                    w = stack[--top];
+                    comp[w] = comps;
+                } while (w != v);
+                comps++;
+            }
+            if (--depth > 0 && low[v] < low[call[depth - 1]]) low[call[depth - 1]] = low[v];
+        }
+    }
+    return comps;
+}
+
+typedef struct {
+    double score;
+    int node;
+    int version;
+} CoverEntry;
+
+// Greedy cover state; only edges inside one deadlocked group are counted
+typedef struct {
+    const WaitGraph *graph;
+    const int *comp;
+    const int *rev_start;
+    const int *rev_from;
+    const double *cost;
+    int *in_degree;
+    int *out_degree;
+    int *version;
+    unsigned char *alive;               // 0 removed, 1 alive, 2 alive and queued for peeling
+    int *queue;
+    int queue_head, queue_tail;
+    CoverEntry *heap;
+    int heap_count;
+} Cover;
+
+static int entry_before(const CoverEntry *a, const CoverEntry *b) {
+    return a->score < b->score || (a->score == b->score && a->node < b->node);
+}
+
+static void heap_push(Cover *cover, int node) {
+    CoverEntry entry = {cover->cost[node] / ((double)cover->in_degree[node] * cover->out_degree[node]),
+                        node, ++cover->version[node]};
+    int at = cover->heap_count++;
+    while (at > 0 && entry_before(&entry, &cover->heap[(at - 1) / 2])) {
+        cover->heap[at] = cover->heap[(at - 1) / 2];
+        at = (at - 1) / 2;
+    }
+    cover->heap[at] = entry;
+}
+
+static CoverEntry heap_pop(Cover *cover) {
+    CoverEntry top = cover->heap[0];
+    CoverEntry last = cover->heap[--cover->heap_count];
+    int at = 0;
+    for (;;) {
+        int child = 2 * at + 1;
+        if (child >= cover->heap_count) break;
+        if (child + 1 < cover->heap_count && entry_before(&cover->heap[child + 1], &cover->heap[child])) child++;
+        if (!entry_before(&cover->heap[child], &last)) break;
+        cover->heap[at] = cover->heap[child];
+        at = child;
+    }
+    cover->heap[at] = last;
+    return top;
+}
+
+// A node's degrees changed: a node with no way in or out of a cycle is peeled
+static void cover_touch(Cover *cover, int node) {
+    if (cover->alive[node] != 1) return;
+    if (cover->in_degree[node] == 0 || cover->out_degree[node] == 0) {
+        cover->alive[node] = 2;
+        cover->queue[cover->queue_tail++] = node;
+    } else {
+        heap_push(cover, node);
+    }
+}
+
+static void cover_remove(Cover *cover, int v) {
+    const WaitGraph *graph = cover->graph;
+    cover->alive[v] = 0;
+    for (int e = graph->edge_start[v]; e < graph->edge_start[v + 1]; e++) {
+        int w = graph->edge_to[e];
+        if (cover->alive[w] && cover->comp[w] == cover->comp[v]) {
+            cover->in_degree[w]--;
+            cover_touch(cover, w);
+        }
+    }
+    for (int e = cover->rev_start[v]; e < cover->rev_start[v + 1]; e++) {
+        int u = cover->rev_from[e];
+        if (cover->alive[u] && cover->comp[u] == cover->comp[v]) {
+            cover->out_degree[u]--;
+            cover_touch(cover, u);
+        }
+    }
+}
+
+// Is v on a cycle through the alive nodes of its group? (iterative DFS)
+static int on_cycle(const WaitGraph *graph, const int *comp, const unsigned char *alive,
+                    int v, int *seen, int stamp, int *stack) {
+    int top = 0;
+    stack[top++] = v;
+    while (top > 0) {
+        int u = stack[--top];
+        for (int e = graph->edge_start[u]; e < graph->edge_start[u + 1]; e++) {
+            int w = graph->edge_to[e];
+            if (w == v) return 1;
+            if (alive[w] && comp[w] == comp[v] && seen[w] != stamp) {
+                seen[w] = stamp;
+                stack[top++] = w;
+            }
+        }
+    }
+    return 0;
+}
+
+// Does the group stay acyclic with only the nodes in kept? (peel sinks)
+static int mask_acyclic(const unsigned int *out_mask, unsigned int kept) {
+    while (kept) {
+        unsigned int sinks = 0;
+        for (unsigned int rest = kept; rest; rest &= rest - 1) {
+            int i = __builtin_ctz(rest);
+            if (!(out_mask[i] & kept)) sinks |= 1u << i;
+        }
+        if (!sinks) return 0;
+        kept &= ~sinks;
+    }
+    return 1;
+}
+
+// Exhaustive search of one small group, seeded with the greedy choice;
+// returns 1 if it found a cheaper set
+static int exact_group(const WaitGraph *graph, const int *comp, const int *members, int size,
+                       const double *cost, unsigned char *victim, int *local, double *subset_cost) {
+    unsigned int out_mask[VICTIM_EXACT_LIMIT] = {0};
+    double member_cost[VICTIM_EXACT_LIMIT];
+    unsigned int best = 0;
+    double best_cost = 0.0;
+    for (int i = 0; i < size; i++) local[members[i]] = i;
+    for (int i = 0; i < size; i++) {
+        int v = members[i];
+        member_cost[i] = cost[v];
+        if (victim[v]) {
+            best |= 1u << i;
+            best_cost += cost[v];
+        }
+        for (int e = graph->edge_start[v]; e < graph->edge_start[v + 1]; e++) {
+            int w = graph->edge_to[e];
+            if (comp[w] == comp[v]) out_mask[i] |= 1u << local[w];
+        }
+    }
+    unsigned int full = (1u << size) - 1;
+    unsigned int greedy = best;
+    subset_cost[0] = 0.0;
+    for (unsigned int mask = 1; mask <= full; mask++) {
+        subset_cost[mask] = subset_cost[mask & (mask - 1)] + member_cost[__builtin_ctz(mask)];
+        if (subset_cost[mask] < best_cost - 1e-9 && mask_acyclic(out_mask, full & ~mask)) {
+            best = mask;
+            best_cost = subset_cost[mask];
+        }
+    }
+    for (int i = 0; i < size; i++) victim[members[i]] = (best >> i) & 1u;
+    return best != greedy;
+}
+
+// Choose processes to roll back so no cycle remains. plan->victims lives in
+// the run arena. Returns the number of victims, or -1 if memory runs out.
+int victim_select(const WaitGraph *graph, VictimMode mode, VictimPlan *plan) {
+    Arena *arena = run_arena();
+    int n = graph->nodes, edges = graph->edge_count;
+    memset(plan, 0, sizeof(*plan));
+    plan->victims = arena_alloc(arena, sizeof(int) * (n + 1));
+    if (plan->victims == NULL) return -1;
+    ArenaMark mark = arena_mark(arena);
+    int result = -1;
+
+    int *comp = arena_alloc(arena, sizeof(int) * (n + 1));
+    int *scratch_a = arena_alloc(arena, sizeof(int) * (n + 1));
+    int *scratch_b = arena_alloc(arena, sizeof(int) * (n + 1));
+    int *scratch_c = arena_alloc(arena, sizeof(int) * (n + 1));
+    int *scratch_d = arena_alloc(arena, sizeof(int) * (n + 1));
+    int *scratch_e = arena_alloc(arena, sizeof(int) * (n + 1));
+    if (comp == NULL || scratch_a == NULL || scratch_b == NULL || scratch_c == NULL ||
+        scratch_d == NULL || scratch_e == NULL) {
+        goto done;
+    }
+    int comps = find_components(graph, comp, scratch_a, scratch_b, scratch_c, scratch_d, scratch_e);
+
+    // Groups with a cycle, their members listed contiguously
+    int *group_start = arena_calloc(arena, (size_t)comps + 2, sizeof(int));
+    int *members = arena_alloc(arena, sizeof(int) * (n + 1));
+    unsigned char *cyclic = arena_calloc(arena, (size_t)comps + 1, 1);
+    double *cost = arena_alloc(arena, sizeof(double) * (n + 1));
+    int *rev_start = arena_calloc(arena, (size_t)n + 2, sizeof(int));
+    int *rev_from = arena_alloc(arena, sizeof(int) * (edges + 1));
+    unsigned char *alive = arena_calloc(arena, (size_t)n + 1, 1);
+    unsigned char *victim = arena_calloc(arena, (size_t)n + 1, 1);
+    CoverEntry *heap = arena_alloc(arena, sizeof(CoverEntry) * ((size_t)n + 2 * (size_t)edges + 1));
+    if (group_start == NULL || members == NULL || cyclic == NULL || cost == NULL || rev_start == NULL ||
+        rev_from == NULL || alive == NULL || victim == NULL || heap == NULL) {
+        goto done;
+    }
+    for (int v = 0; v < n; v++) {
+        group_start[comp[v] + 1]++;
+        cost[v] = victim_cost(&graph->candidates[v]);
+        for (int e = graph->edge_start[v]; e < graph->edge_start[v + 1]; e++) {
+            rev_start[graph->edge_to[e] + 1]++;
+            if (comp[graph->edge_to[e]] == comp[v]) cyclic[comp[v]] = 1;
+        }
+    }
+    for (int c = 0; c < comps; c++) group_start[c + 1] += group_start[c];
+    for (int v = 0; v < n; v++) rev_start[v + 1] += rev_start[v];
+    memcpy(scratch_a, group_start, sizeof(int) * comps);
+    memcpy(scratch_b, rev_start, sizeof(int) * n);
+    for (int v = 0; v < n; v++) {
+        members[scratch_a[comp[v]]++] = v;
+        for (int e = graph->edge_start[v]; e < graph->edge_start[v + 1]; e++) {
+            rev_from[scratch_b[graph->edge_to[e]]++] = v;
+        }
+    }
+
+    // Greedy cover over the deadlocked groups
+    Cover cover = {graph, comp, rev_start, rev_from, cost, scratch_a, scratch_b, scratch_c,
+                   alive, scratch_d, 0, 0, heap, 0};
+    for (int v = 0; v < n; v++) {
+        cover.in_degree[v] = cover.out_degree[v] = cover.version[v] = 0;
+        alive[v] = cyclic[comp[v]];
+    }
+    for (int v = 0; v < n; v++) {
+        if (!alive[v]) continue;
+        for (int e = graph->edge_start[v]; e < graph->edge_start[v + 1]; e++) {
+            int w = graph->edge_to[e];
+            if (comp[w] == comp[v]) {
+                cover.out_degree[v]++;
+                cover.in_degree[w]++;
+            }
+        }
+    }
+    for (int v = 0; v < n; v++) {
+        cover_touch(&cover, v);
+    }
+    for (;;) {
+        while (cover.queue_head < cover.queue_tail) {
+            int v = cover.queue[cover.queue_head++];
+            if (alive[v]) cover_remove(&cover, v);
+        }
+        int chosen = -1;
+        while (cover.heap_count > 0 && chosen < 0) {
+            CoverEntry entry = heap_pop(&cover);
+            if (alive[entry.node] == 1 && entry.version == cover.version[entry.node]) chosen = entry.node;
+        }
+        if (chosen < 0) break;
+        victim[chosen] = 1;
+        cover_remove(&cover, chosen);
+    }
+
+    // Drop victims whose cycles the others already break, dearest first
+    for (int v = 0; v < n; v++) {
+        alive[v] = cyclic[comp[v]] && !victim[v];
+        scratch_a[v] = -1;
+    }
+    int stamp = 0;
+    for (int c = 0; c < comps; c++) {
+        int size = group_start[c + 1] - group_start[c];
+        if (!cyclic[c]) continue;
+        plan->groups++;
+        plan->deadlocked += size;
+        if (size > VICTIM_PRUNE_LIMIT) continue;
+        int chosen = 0;
+        int *order = scratch_b;
+        for (int k = group_start[c]; k < group_start[c + 1]; k++) {
+            int v = members[k];
+            if (!victim[v]) continue;
+            int at = chosen++;
+            while (at > 0 && cost[order[at - 1]] < cost[v]) {
+                order[at] = order[at - 1];
+                at--;
+            }
+            order[at] = v;
+        }
+        for (int k = 0; k < chosen; k++) {
+            int v = order[k];
+            alive[v] = 1;
+            if (on_cycle(graph, comp, alive, v, scratch_a, ++stamp, scratch_c)) {
+                alive[v] = 0;
+            } else {
+                victim[v] = 0;
+            }
+        }
+    }
+
+    // Exact mode: exhaustive search of the small groups
+    if (mode == VICTIM_EXACT) {
+        double *subset_cost = NULL;
+        for (int c = 0; c < comps; c++) {
+            int size = group_start[c + 1] - group_start[c];
+            if (!cyclic[c] || size > VICTIM_EXACT_LIMIT) continue;
+            if (subset_cost == NULL) {
+                subset_cost = arena_alloc(arena, sizeof(double) << VICTIM_EXACT_LIMIT);
+                if (subset_cost == NULL) goto done;
+            }
+            plan->exact_groups++;
+            plan->exact_improved += exact_group(graph, comp, &members[group_start[c]], size,
+                                                cost, victim, scratch_b, subset_cost);
+        }
+    }
+
+    for (int v = 0; v < n; v++) {
+        if (!victim[v]) continue;
+        plan->victims[plan->victim_count++] = v;
+        plan->cost += cost[v];
+        plan->work_lost += graph->candidates[v].progress + graph->candidates[v].restart;
+    }
+    result = plan->victim_count;
+
+done:
+    arena_release(arena, mark);
+    return result;
+}
+
+// 1 if the graph has no cycle once the victims are gone (Kahn's algorithm)
+int victim_breaks_all_cycles(const WaitGraph *graph, const int *victims, int count) {
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    int n = graph->nodes;
+    int *in_degree = arena_calloc(arena, (size_t)n + 1, sizeof(int));
+    int *queue = arena_alloc(arena, sizeof(int) * (n + 1));
+    unsigned char *removed = arena_calloc(arena, (size_t)n + 1, 1);
+    int acyclic = 0;
+    if (in_degree != NULL && queue != NULL && removed != NULL) {
+        for (int k = 0; k < count; k++) removed[victims[k]] = 1;
+        for (int v = 0; v < n; v++) {
+            if (removed[v]) continue;
+            for (int e = graph->edge_start[v]; e < graph->edge_start[v + 1]; e++) {
+                if (!removed[graph->edge_to[e]]) in_degree[graph->edge_to[e]]++;
+            }
+        }
+        int head = 0, tail = 0, remaining = 0;
+        for (int v = 0; v < n; v++) {
+            if (removed[v]) continue;
+            remaining++;
+            if (in_degree[v] == 0) queue[tail++] = v;
+        }
+        while (head < tail) {
+            int v = queue[head++];
+            remaining--;
+            for (int e = graph->edge_start[v]; e < graph->edge_start[v + 1]; e++) {
+                int w = graph->edge_to[e];
+                if (!removed[w] && --in_degree[w] == 0) queue[tail++] = w;
+            }
+        }
+        acyclic = remaining == 0;
+    }
+    arena_release(arena, mark);
+    return acyclic;
+}
+
+// ---- victims command: a synthetic process table with local resource sharing ----
+
+typedef struct {
+    unsigned long long seed;
+} SyntheticCosts;
+
+static void describe_synthetic(int pid, VictimCandidate *candidate, void *context) {
+    const SyntheticCosts *costs = context;
+    unsigned long long state = costs->seed ^ ((unsigned long long)pid * 0x9e3779b97f4a7c15ULL);
+    candidate->progress = (long long)(wg_next(&state) % 500);
+    candidate->priority = (int)(wg_next(&state) % 5) + 1;
+    candidate->restart = VICTIM_RESTART_TICKS + (long long)(wg_next(&state) % 20);
+}
+
+static void print_plan_row(const char *label, int victims, double cost, long long work_lost,
+                           const VictimPlan *plan, double ms, int verified) {
+    printf("%-16s %9d %14.1f %12lld", label, victims, cost, work_lost);
+    if (plan != NULL) {
+        printf(" %8d/%-6d %9.1f %s\n", plan->exact_improved, plan->exact_groups, ms, verified ? "yes" : "NO");
+    } else {
+        printf(" %15s %9s %s\n", "-", "-", "yes");
+    }
+}
+
+int victim_command(int argc, char *argv[]) {
+    int processes = 100000, degree = 2, window = 32, usage = 0, positional = 0;
+    double waiting = 0.6;
+    unsigned long long seed = 42;
+    for (int i = 0; i < argc && !usage; i++) {
+        if (strcmp(argv[i], "--degree") == 0 && i + 1 < argc) {
+            degree = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--waiting") == 0 && i + 1 < argc) {
+            waiting = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+            window = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (positional == 0 && argv[i][0] >= '0' && argv[i][0] <= '9') {
+            processes = atoi(argv[i]);
+            positional++;
+        } else {
+            usage = 1;
+        }
+    }
+    if (usage || processes < 2 || processes > 10000000 || degree < 1 || degree > 16 ||
+        waiting < 0.0 || waiting > 1.0 || window < 1) {
+        printf("Usage: victims [processes] [--degree D] [--waiting F] [--window W] [--seed N]\n");
+        printf("  Each process holds one resource; a fraction F also waits for up to D resources\n");
+        printf("  held by neighbours within W places, forming overlapping cycles.\n");
+        return 1;
+    }
+
+    run_arena_reset();
+    Arena *arena = run_arena();
+    ResourceAllocation *records = arena_alloc(arena, sizeof(ResourceAllocation) * (size_t)processes * (degree + 1));
+    if (records == NULL) {
+        printf("Not enough memory for %d processes.\n", processes);
+        return 1;
+    }
+    unsigned long long state = seed;
+    int count = 0;
+    for (int p = 0; p < processes; p++) {
+        records[count++] = (ResourceAllocation){p + 1, p + 1, 1, 0};
+        if (wg_uniform(&state) >= waiting) continue;
+        int wants = 1 + (int)(wg_next(&state) % (unsigned long long)degree);
+        for (int k = 0; k < wants; k++) {
+            int offset = 1 + (int)(wg_next(&state) % (unsigned long long)window);
+            int other = (wg_next(&state) & 1) ? p + offset : p - offset;
+            other = ((other % processes) + processes) % processes;
+            records[count++] = (ResourceAllocation){p + 1, other + 1, 0, 1};
+        }
+    }
+
+    SyntheticCosts costs = {seed};
+    WaitGraph graph;
+    double started = monotonic_seconds();
+    if (victim_graph_from_records(records, count, describe_synthetic, &costs, &graph) != 0) {
+        printf("Not enough memory for the wait-for graph.\n");
+        run_arena_reset();
+        return 1;
+    }
+    printf("=== DEADLOCK VICTIM SELECTION: %d processes, %d allocation records ===\n", processes, count);
+    printf("Wait-for graph: %d edges, built in %.1f ms\n", graph.edge_count, (monotonic_seconds() - started) * 1000.0);
+
+    // Baseline: the old recovery reset every waiting process
+    int waiting_count = 0;
+    double waiting_cost = 0.0;
+    long long waiting_work = 0;
+    for (int v = 0; v < graph.nodes; v++) {
+        if (graph.edge_start[v + 1] == graph.edge_start[v]) continue;
+        waiting_count++;
+        waiting_cost += victim_cost(&graph.candidates[v]);
+        waiting_work += graph.candidates[v].progress + graph.candidates[v].restart;
+    }
+
+    VictimPlan plans[2];
+    double ms[2];
+    int verified[2];
+    for (int mode = 0; mode < 2; mode++) {
+        started = monotonic_seconds();
+        if (victim_select(&graph, mode == 0 ? VICTIM_GREEDY : VICTIM_EXACT, &plans[mode]) < 0) {
+            printf("Not enough memory for victim selection.\n");
+            run_arena_reset();
+            return 1;
+        }
+        ms[mode] = (monotonic_seconds() - started) * 1000.0;
+        verified[mode] = victim_breaks_all_cycles(&graph, plans[mode].victims, plans[mode].victim_count);
+    }
+    printf("Deadlocked: %d groups, %d processes\n\n", plans[0].groups, plans[0].deadlocked);
+    printf("%-16s %9s %14s %12s %15s %9s %s\n", "Strategy", "Victims", "Cost", "Work lost", "Exact improved",
+           "Time ms", "Acyclic");
+    print_plan_row("reset waiting", waiting_count, waiting_cost, waiting_work, NULL, 0.0, 1);
+    print_plan_row("greedy", plans[0].victim_count, plans[0].cost, plans[0].work_lost, &plans[0], ms[0], verified[0]);
+    print_plan_row("greedy + exact", plans[1].victim_count, plans[1].cost, plans[1].work_lost, &plans[1], ms[1],
+                   verified[1]);
+    run_arena_reset();
+    return verified[0] && verified[1] ? 0 : 1;
+}
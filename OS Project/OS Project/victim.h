@@ -0,0 +1,57 @@
+/*
+ * victim.h - Header for cost-minimising deadlock victim selection
+ */
+
+#ifndef VICTIM_H
+#define VICTIM_H
+
+#include "algorithms.h"
+
+#define VICTIM_EXACT_LIMIT 16           // largest deadlocked group searched exhaustively
+#define VICTIM_PRUNE_LIMIT 4096         // larger groups skip the redundant-victim pass
+#define VICTIM_RESTART_TICKS 2          // fixed cost of restarting a rolled-back process
+#define VICTIM_HELD_COST 1.0            // per resource a victim has to re-acquire
+
+typedef enum {
+    VICTIM_GREEDY,                      // peel + greedy cycle cover, O((n + e) log n)
+    VICTIM_EXACT                        // greedy, then exhaustive search on small groups
+} VictimMode;
+
+// What rolling a process back costs
+typedef struct {
+    int pid;
+    long long progress;                 // work done that a rollback throws away (ticks)
+    long long restart;                  // fixed restart cost (ticks)
+    int priority;                       // 1 = most urgent
+    int held;                           // resources held
+} VictimCandidate;
+
+// Wait-for graph in CSR form; edges run from a waiter to a holder
+typedef struct {
+    int nodes;
+    int edge_count;
+    VictimCandidate *candidates;
+    int *edge_start;                    // nodes + 1 offsets into edge_to
+    int *edge_to;
+} WaitGraph;
+
+typedef struct {
+    int *victims;                       // node indices, ascending
+    int victim_count;
+    int groups;                         // deadlocked groups (strongly connected, with a cycle)
+    int deadlocked;                     // processes in those groups
+    int exact_groups;                   // groups searched exhaustively
+    int exact_improved;                 // of those, groups where the search beat greedy
+    double cost;
+    long long work_lost;                // progress + restart over all victims
+} VictimPlan;
+
+double victim_cost(const VictimCandidate *candidate);
+int victim_graph_from_records(const ResourceAllocation *records, int count,
+                              void (*describe)(int pid, VictimCandidate *candidate, void *context),
+                              void *context, WaitGraph *graph);
+int victim_select(const WaitGraph *graph, VictimMode mode, VictimPlan *plan);
+int victim_breaks_all_cycles(const WaitGraph *graph, const int *victims, int count);
+int victim_command(int argc, char *argv[]);
+
+#endif // VICTIM_H
@@ -39,15 +39,18 @@ void display_visualization() {
 
 // Display Gantt chart for CPU scheduling
 void display_gantt_chart() {
+    PcbReadGuard guard = pcb_read_begin();
+    const PCB *rows = guard.snapshot->rows;
+    int count = guard.snapshot->count;
     printf("--- CPU SCHEDULING GANTT CHART ---\n");
     printf("Time: ");
     for (int i = 0; i < 40; i++) printf("-");
     printf("\n");
     
     printf("      |");
-    for (int i = 0; i < process_count && i < 8; i++) {
-        printf("P%d|", pcb_table[i].pid % 100);
-        for (int j = 0; j < pcb_table[i].burst_time - 1 && j < 4; j++) {
+    for (int i = 0; i < count && i < 8; i++) {
+        printf("P%d|", rows[i].pid % 100);
+        for (int j = 0; j < rows[i].burst_time - 1 && j < 4; j++) {
             printf("  |");
         }
     }
@@ -55,26 +58,30 @@ void display_gantt_chart() {
     
     printf("Time: ");
     int time = 0;
-    for (int i = 0; i < process_count && i < 8; i++) {
+    for (int i = 0; i < count && i < 8; i++) {
         printf("%2d", time);
-        time += pcb_table[i].burst_time;
-        for (int j = 0; j < pcb_table[i].burst_time - 1 && j < 4; j++) {
+        time += rows[i].burst_time;
+        for (int j = 0; j < rows[i].burst_time - 1 && j < 4; j++) {
             printf("   ");
         }
     }
     printf("\n");
+    pcb_read_end(&guard);
 }
 
 // Display memory allocation map
 void display_memory_map() {
+    PcbReadGuard guard = pcb_read_begin();
+    const PCB *rows = guard.snapshot->rows;
+    int count = guard.snapshot->count;
     printf("--- MEMORY ALLOCATION MAP ---\n");
     printf("Memory: [");
     
     int total_memory = 1000; // Simulated total memory in MB
     int used_memory = 0;
     
-    for (int i = 0; i < process_count && i < 10; i++) {
-        used_memory += (int)pcb_table[i].mem_usage;
+    for (int i = 0; i < count && i < 10; i++) {
+        used_memory += (int)rows[i].mem_usage;
     }
     
     // Display memory blocks
@@ -90,30 +97,34 @@ void display_memory_map() {
     
     // Show individual process memory usage
     printf("Process Memory Usage:\n");
-    for (int i = 0; i < process_count && i < 5; i++) {
-        printf("  %-12s: %4.1f MB ", pcb_table[i].name, pcb_table[i].mem_usage);
-        int bars = (int)(pcb_table[i].mem_usage / 10.0);
+    for (int i = 0; i < count && i < 5; i++) {
+        printf("  %-12s: %4.1f MB ", rows[i].name, rows[i].mem_usage);
+        int bars = (int)(rows[i].mem_usage / 10.0);
         for (int j = 0; j < bars && j < 10; j++) printf("▓");
         printf("\n");
     }
+    pcb_read_end(&guard);
 }
 
 // Display resource allocation graph for deadlock detection
 void display_resource_graph() {
+    PcbReadGuard guard = pcb_read_begin();
+    const PCB *rows = guard.snapshot->rows;
+    int count = guard.snapshot->count;
     printf("--- RESOURCE ALLOCATION GRAPH ---\n");
     printf("Processes and Resources:\n");
     
     // Simulate resource allocation
     char resources[4] = {'1', '2', '3', '4'};
     
-    for (int i = 0; i < process_count && i < 4; i++) {
-        printf("Process P%d ", pcb_table[i].pid % 100);
+    for (int i = 0; i < count && i < 4; i++) {
+        printf("Process P%d ", rows[i].pid % 100);
         
         // Show resource allocation based on process state
-        if (pcb_table[i].state == 2) { // Waiting state indicates potential deadlock
+        if (rows[i].state == 2) { // Waiting state indicates potential deadlock
             printf("---> R%d (WAITING) ", (i + 1) % 4 + 1);
             printf("❌ DEADLOCK DETECTED");
-        } else if (pcb_table[i].state == 1) { // Running state
+        } else if (rows[i].state == 1) { // Running state
             printf("---> R%d (ALLOCATED) ", (i % 4) + 1);
             printf("✓ RUNNING");
         } else {
@@ -128,9 +139,9 @@ void display_resource_graph() {
     for (int i = 0; i < 4; i++) {
         printf("R%d: ", i + 1);
         int allocated = 0;
-        for (int j = 0; j < process_count && j < 4; j++) {
-            if ((j % 4) == i && pcb_table[j].state != 0) {
-                printf("Allocated to P%d ", pcb_table[j].pid % 100);
+        for (int j = 0; j < count && j < 4; j++) {
+            if ((j % 4) == i && rows[j].state != 0) {
+                printf("Allocated to P%d ", rows[j].pid % 100);
                 allocated = 1;
                 break;
             }
@@ -138,4 +149,5 @@ void display_resource_graph() {
         if (!allocated) printf("Available");
         printf("\n");
     }
+    pcb_read_end(&guard);
 }
@@ -0,0 +1,654 @@
+/*
+ * workload_gen.c - Streaming process-arrival and page-reference generators
+ *
+ * The demos run on five dummy processes and one ten-reference string. These
+ * generators produce inputs of any length instead, a batch at a time and
+ * reproducibly from a seed: process arrivals (Poisson or following a daily
+ * load curve) with exponential or Pareto bursts, and page references that
+ * are uniform, Zipf-distributed, looping, phase-changing or follow a slowly
+ * drifting working set. Nothing is stored beyond one batch, so the workload
+ * command can push billions of jobs or references through the scheduling
+ * and paging kernels in constant memory.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "workload_gen.h"
+#include "algorithms.h"
+#include "timing.h"
+
+#define WORKLOAD_BATCH 65536
+#define BURST_LIMIT 1000000000.0
+#define LRU_REBASE_AT (1 << 30)
+
+// Relative load by hour of day: quiet nights, a morning ramp, a lunch dip
+static const double day_profile[WG_DAY_PROFILE_HOURS] = {
+    0.30, 0.22, 0.18, 0.16, 0.18, 0.28, 0.50, 0.85, 1.30, 1.65, 1.80, 1.75,
+    1.45, 1.55, 1.75, 1.70, 1.55, 1.35, 1.15, 1.00, 0.85, 0.70, 0.55, 0.40
+};
+
+static const char *ref_pattern_names[WG_REF_PATTERNS] = {
+    "uniform", "zipf", "loop", "phased", "working_set"
+};
+
+unsigned long long wg_next(unsigned long long *state) {
+    // xorshift64*, small and fast enough to sit inside every batch loop
+    unsigned long long x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 2685821657736338717ULL;
+}
+
+double wg_uniform(unsigned long long *state) {
+    // (0, 1], so the logarithm below is always finite
+    return (double)((wg_next(state) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+static int below(unsigned long long *state, int n) {
+    // Multiply-shift range reduction of the top 32 bits
+    return (int)(((wg_next(state) >> 32) * (unsigned long long)n) >> 32);
+}
+
+double wg_exponential(unsigned long long *state, double mean) {
+    return -mean * log(wg_uniform(state));
+}
+
+// k-th smallest value (0-based), partially reordering values
+double wg_select_kth(double *values, int count, int k) {
+    int lo = 0, hi = count - 1;
+    while (lo < hi) {
+        double pivot = values[lo + (hi - lo) / 2];
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (values[i] < pivot) i++;
+            while (values[j] > pivot) j--;
+            if (i <= j) {
+                double swap = values[i];
+                values[i++] = values[j];
+                values[j--] = swap;
+            }
+        }
+        if (k <= j) hi = j;
+        else if (k >= i) lo = i;
+        else break;
+    }
+    return values[k];
+}
+
+// qsort order for keys packed into one unsigned 64-bit word, most
+// significant field first, so sorting needs no context
+int wg_compare_packed(const void *a, const void *b) {
+    unsigned long long x = *(const unsigned long long *)a;
+    unsigned long long y = *(const unsigned long long *)b;
+    return (x > y) - (x < y);
+}
+
+static unsigned long long seed_state(unsigned long long seed) {
+    // Spread small seeds so neighbouring values start far apart; never zero
+    unsigned long long state = (seed + 1) * 0x9e3779b97f4a7c15ULL;
+    return state != 0 ? state : 1;
+}
+
+// ---- process arrivals ----
+
+void wg_default_process_config(WgProcessConfig *config) {
+    memset(config, 0, sizeof(*config));
+    config->arrivals = WG_ARRIVAL_POISSON;
+    config->arrival_rate = 0.09;        // load 0.9 at the default mean burst
+    config->day_ticks = 100000;
+    config->bursts = WG_BURST_EXPONENTIAL;
+    config->burst_mean = 10.0;
+    config->pareto_alpha = 1.5;
+    config->burst_max = 0;
+    config->priority_levels = 5;
+    config->seed = 1;
+}
+
+void wg_process_init(WgProcessStream *stream, const WgProcessConfig *config) {
+    memset(stream, 0, sizeof(*stream));
+    stream->config = *config;
+    stream->state = seed_state(config->seed);
+    double peak = 0.0, total = 0.0;
+    for (int h = 0; h < WG_DAY_PROFILE_HOURS; h++) {
+        total += day_profile[h];
+        if (day_profile[h] > peak) peak = day_profile[h];
+    }
+    // Diurnal candidates arrive at the peak hour's rate and are thinned to
+    // each hour's share, which keeps the daily average at arrival_rate
+    for (int h = 0; h < WG_DAY_PROFILE_HOURS; h++) stream->profile[h] = day_profile[h] / peak;
+    if (stream->config.arrival_rate <= 0.0) stream->config.arrival_rate = 0.09;
+    if (config->arrivals == WG_ARRIVAL_DIURNAL) {
+        stream->config.arrival_rate *= peak * WG_DAY_PROFILE_HOURS / total;
+    }
+    if (stream->config.day_ticks < WG_DAY_PROFILE_HOURS) stream->config.day_ticks = WG_DAY_PROFILE_HOURS;
+    if (stream->config.priority_levels < 1) stream->config.priority_levels = 1;
+    if (stream->config.pareto_alpha <= 1.0) stream->config.pareto_alpha = 1.5;
+    if (stream->config.burst_mean < 1.0) stream->config.burst_mean = 1.0;
+}
+
+static int next_burst(WgProcessStream *stream) {
+    const WgProcessConfig *config = &stream->config;
+    double burst;
+    if (config->bursts == WG_BURST_PARETO) {
+        double alpha = config->pareto_alpha;
+        double minimum = config->burst_mean * (alpha - 1.0) / alpha;
+        burst = minimum * pow(wg_uniform(&stream->state), -1.0 / alpha);
+    } else {
+        burst = wg_exponential(&stream->state, config->burst_mean);
+    }
+    if (burst > BURST_LIMIT) burst = BURST_LIMIT;
+    int value = (int)(burst + 0.5);
+    if (value < 1) value = 1;
+    if (config->burst_max > 0 && value > config->burst_max) value = config->burst_max;
+    return value;
+}
+
+void wg_process_batch(WgProcessStream *stream, WgProcess *out, int count) {
+    const WgProcessConfig *config = &stream->config;
+    double mean_gap = 1.0 / config->arrival_rate;
+    double hours_per_tick = (double)WG_DAY_PROFILE_HOURS / config->day_ticks;
+    for (int i = 0; i < count; i++) {
+        for (;;) {
+            stream->clock += wg_exponential(&stream->state, mean_gap);
+            if (config->arrivals != WG_ARRIVAL_DIURNAL) break;
+            int hour = (int)((long long)(stream->clock * hours_per_tick) % WG_DAY_PROFILE_HOURS);
+            if (wg_uniform(&stream->state) <= stream->profile[hour]) break;
+        }
+        out[i].arrival = (long long)stream->clock;
+        out[i].burst = next_burst(stream);
+        out[i].priority = 1 + below(&stream->state, config->priority_levels);
+    }
+    stream->produced += count;
+}
+
+// ---- page references ----
+
+const char *wg_ref_pattern_name(WgRefPattern pattern) {
+    return pattern >= 0 && pattern < WG_REF_PATTERNS ? ref_pattern_names[pattern] : "unknown";
+}
+
+int wg_ref_pattern_from_name(const char *name) {
+    for (int p = 0; p < WG_REF_PATTERNS; p++) {
+        if (strcmp(name, ref_pattern_names[p]) == 0) return p;
+    }
+    return -1;
+}
+
+void wg_default_ref_config(WgRefConfig *config, WgRefPattern pattern) {
+    memset(config, 0, sizeof(*config));
+    config->pattern = pattern;
+    config->pages = 4096;
+    config->zipf_exponent = 1.0;
+    config->loop_length = 96;
+    config->working_set = 48;
+    config->phase_length = 100000;
+    config->shift_every = 1000;
+    config->noise = pattern == WG_REF_PHASED || pattern == WG_REF_WORKING_SET ? 0.02 : 0.0;
+    config->seed = 1;
+}
+
+int wg_ref_init(WgRefStream *stream, const WgRefConfig *config, Arena *arena) {
+    memset(stream, 0, sizeof(*stream));
+    stream->config = *config;
+    stream->state = seed_state(config->seed);
+    WgRefConfig *c = &stream->config;
+    if (c->pages < 1) c->pages = 1;
+    if (c->loop_length < 1) c->loop_length = 1;
+    if (c->working_set < 1) c->working_set = 1;
+    if (c->working_set > c->pages) c->working_set = c->pages;
+    if (c->phase_length < 1) c->phase_length = 1;
+    if (c->shift_every < 1) c->shift_every = 1;
+
+    if (c->pattern == WG_REF_ZIPF || c->pattern == WG_REF_PHASED) {
+        int n = c->pattern == WG_REF_ZIPF ? c->pages : c->working_set;
+        double *cdf = arena_alloc(arena, sizeof(double) * (size_t)n);
+        int *guide = arena_alloc(arena, sizeof(int) * (size_t)n);
+        if (cdf == NULL || guide == NULL) return 0;
+        double total = 0.0;
+        for (int k = 0; k < n; k++) {
+            total += pow(k + 1.0, -c->zipf_exponent);
+            cdf[k] = total;
+        }
+        for (int k = 0; k < n; k++) cdf[k] /= total;
+        cdf[n - 1] = 1.0;
+        for (int g = 0, k = 0; g < n; g++) {
+            while (cdf[k] < (double)g / n) k++;
+            guide[g] = k;
+        }
+        stream->zipf_cdf = cdf;
+        stream->zipf_guide = guide;
+        stream->zipf_size = n;
+    }
+    if (c->pattern == WG_REF_WORKING_SET) {
+        int *set = arena_alloc(arena, sizeof(int) * (size_t)c->working_set);
+        if (set == NULL) return 0;
+        int start = below(&stream->state, c->pages);
+        for (int i = 0; i < c->working_set; i++) set[i] = (start + i) % c->pages;
+        stream->set = set;
+    }
+    return 1;
+}
+
+static int zipf_rank(WgRefStream *stream) {
+    // Guide table jump, then a short walk: O(1) expected
+    double u = wg_uniform(&stream->state);
+    int g = (int)(u * stream->zipf_size);
+    if (g >= stream->zipf_size) g = stream->zipf_size - 1;
+    int k = stream->zipf_guide[g];
+    while (stream->zipf_cdf[k] < u) k++;
+    return k;
+}
+
+void wg_ref_batch(WgRefStream *stream, int *out, int count) {
+    const WgRefConfig *c = &stream->config;
+    for (int i = 0; i < count; i++) {
+        long long n = stream->produced + i;
+        if (c->noise > 0.0 && wg_uniform(&stream->state) < c->noise) {
+            out[i] = below(&stream->state, c->pages);
+            continue;
+        }
+        switch (c->pattern) {
+            case WG_REF_ZIPF:
+                out[i] = zipf_rank(stream);
+                break;
+            case WG_REF_LOOP:
+                out[i] = stream->loop_position;
+                if (++stream->loop_position == c->loop_length) stream->loop_position = 0;
+                break;
+            case WG_REF_PHASED:
+                if (n % c->phase_length == 0) stream->base = below(&stream->state, c->pages - c->working_set + 1);
+                out[i] = stream->base + zipf_rank(stream);
+                break;
+            case WG_REF_WORKING_SET:
+                if (n > 0 && n % c->shift_every == 0) {
+                    stream->set[below(&stream->state, c->working_set)] = below(&stream->state, c->pages);
+                }
+                out[i] = stream->set[below(&stream->state, c->working_set)];
+                break;
+            default:
+                out[i] = below(&stream->state, c->pages);
+                break;
+        }
+    }
+    stream->produced += count;
+}
+
+// ---- streaming paging ----
+
+static void rebase_lru(int *last_used, int frame_count, int *now) {
+    // Replace timestamps by their rank so 'now' fits an int for any stream length
+    int next = 0;
+    for (int rank = 0; rank < frame_count; rank++) {
+        int slot = -1;
+        for (int j = 0; j < frame_count; j++) {
+            if (last_used[j] >= next && (slot < 0 || last_used[j] < last_used[slot])) slot = j;
+        }
+        if (slot < 0) break;
+        next = last_used[slot] + 1;
+        last_used[slot] = -2 - rank;    // park ranked slots out of the search range
+    }
+    for (int j = 0; j < frame_count; j++) {
+        if (last_used[j] <= -2) last_used[j] = -2 - last_used[j];
+    }
+    *now = frame_count;
+}
+
+static int stream_paging(WgRefPattern pattern, long long refs, int frame_count, int pages,
+                         unsigned long long seed) {
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    WgRefConfig config;
+    wg_default_ref_config(&config, pattern);
+    if (pages > 0) config.pages = pages;
+    config.seed = seed;
+    WgRefStream stream;
+    int *batch = arena_alloc(arena, sizeof(int) * WORKLOAD_BATCH);
+    int *fifo_frames = arena_alloc(arena, sizeof(int) * (size_t)frame_count);
+    int *lru_frames = arena_alloc(arena, sizeof(int) * (size_t)frame_count);
+    int *last_used = arena_alloc(arena, sizeof(int) * (size_t)frame_count);
+    int *clock_frames = arena_alloc(arena, sizeof(int) * (size_t)frame_count);
+    unsigned char *referenced = arena_calloc(arena, (size_t)frame_count, 1);
+    if (batch == NULL || fifo_frames == NULL || lru_frames == NULL || last_used == NULL ||
+        clock_frames == NULL || referenced == NULL || !wg_ref_init(&stream, &config, arena)) {
+        printf("Not enough memory for the %s reference stream.\n", wg_ref_pattern_name(pattern));
+        arena_release(arena, mark);
+        return 0;
+    }
+    for (int j = 0; j < frame_count; j++) {
+        fifo_frames[j] = lru_frames[j] = clock_frames[j] = -1;
+        last_used[j] = -1;
+    }
+    int fifo_next = 0, clock_hand = 0, now = 0;
+    long long fifo_faults = 0, lru_faults = 0, clock_faults = 0;
+    double generate_seconds = 0.0, start = monotonic_seconds();
+    for (long long done = 0; done < refs;) {
+        int count = refs - done < WORKLOAD_BATCH ? (int)(refs - done) : WORKLOAD_BATCH;
+        double t = monotonic_seconds();
+        wg_ref_batch(&stream, batch, count);
+        generate_seconds += monotonic_seconds() - t;
+        for (int i = 0; i < count; i++) fifo_faults += fifo_reference(fifo_frames, frame_count, &fifo_next, batch[i]);
+        if (now > LRU_REBASE_AT) rebase_lru(last_used, frame_count, &now);
+        for (int i = 0; i < count; i++) lru_faults += lru_reference(lru_frames, last_used, frame_count, batch[i], now++);
+        for (int i = 0; i < count; i++) {
+            clock_faults += clock_reference(clock_frames, referenced, frame_count, &clock_hand, batch[i]);
+        }
+        done += count;
+    }
+    double seconds = monotonic_seconds() - start;
+    printf("%-12s %14lld %8.2f%% %8.2f%% %8.2f%% %10.1f M/s %10.1f M/s\n", wg_ref_pattern_name(pattern), refs,
+           100.0 * fifo_faults / refs, 100.0 * lru_faults / refs, 100.0 * clock_faults / refs,
+           generate_seconds > 0.0 ? refs / generate_seconds / 1e6 : 0.0,
+           seconds > 0.0 ? refs / seconds / 1e6 : 0.0);
+    arena_release(arena, mark);
+    return 1;
+}
+
+// ---- streaming scheduling ----
+
+typedef enum {
+    STREAM_FCFS,
+    STREAM_RR,
+    STREAM_PRIORITY,            // non-preemptive, lower value first, FIFO within a level
+    STREAM_POLICIES
+} StreamPolicy;
+
+static const char *stream_policy_names[STREAM_POLICIES] = {"FCFS", "Round Robin", "Priority"};
+
+// Lazily refilled window onto an unbounded arrival stream
+typedef struct {
+    WgProcessStream stream;
+    WgProcess *batch;
+    int size;
+    int next;
+    long long remaining;
+} ArrivalCursor;
+
+static const WgProcess *cursor_peek(ArrivalCursor *cursor) {
+    if (cursor->next == cursor->size) {
+        if (cursor->remaining == 0) return NULL;
+        int count = cursor->remaining < WORKLOAD_BATCH ? (int)cursor->remaining : WORKLOAD_BATCH;
+        wg_process_batch(&cursor->stream, cursor->batch, count);
+        cursor->remaining -= count;
+        cursor->size = count;
+        cursor->next = 0;
+    }
+    return &cursor->batch[cursor->next];
+}
+
+typedef struct {
+    long long arrival;
+    long long sequence;
+    int remaining;
+    int burst;
+    int priority;
+} ReadyJob;
+
+// Growable ring (round robin) or binary heap (priority) of ready jobs
+typedef struct {
+    Arena *arena;               // the run's arena; jobs grow inside it
+    ReadyJob *jobs;
+    long long head;
+    long long count;
+    long long capacity;
+    long long peak;
+} ReadyQueue;
+
+static int ready_grow(ReadyQueue *queue, int ring) {
+    long long capacity = queue->capacity > 0 ? queue->capacity * 2 : 1024;
+    ReadyJob *jobs;
+    if (!ring || queue->head == 0) {
+        // Nothing wraps, so the jobs keep their slots
+        jobs = arena_grow(queue->arena, queue->jobs, sizeof(ReadyJob) * (size_t)queue->capacity,
+                          sizeof(ReadyJob) * (size_t)capacity);
+        if (jobs == NULL) return 0;
+    } else {
+        jobs = arena_alloc(queue->arena, sizeof(ReadyJob) * (size_t)capacity);
+        if (jobs == NULL) return 0;
+        for (long long i = 0; i < queue->count; i++) {
+            jobs[i] = queue->jobs[(queue->head + i) % queue->capacity];
+        }
+    }
+    queue->jobs = jobs;
+    queue->head = 0;
+    queue->capacity = capacity;
+    return 1;
+}
+
+static int ring_push(ReadyQueue *queue, ReadyJob job) {
+    if (queue->count == queue->capacity && !ready_grow(queue, 1)) return 0;
+    queue->jobs[(queue->head + queue->count++) % queue->capacity] = job;
+    if (queue->count > queue->peak) queue->peak = queue->count;
+    return 1;
+}
+
+static ReadyJob ring_pop(ReadyQueue *queue) {
+    ReadyJob job = queue->jobs[queue->head];
+    queue->head = (queue->head + 1) % queue->capacity;
+    queue->count--;
+    return job;
+}
+
+static int job_before(const ReadyJob *a, const ReadyJob *b) {
+    return a->priority != b->priority ? a->priority < b->priority : a->sequence < b->sequence;
+}
+
+static int heap_push_job(ReadyQueue *queue, ReadyJob job) {
+    if (queue->count == queue->capacity && !ready_grow(queue, 0)) return 0;
+    long long i = queue->count++;
+    while (i > 0 && job_before(&job, &queue->jobs[(i - 1) / 2])) {
+        queue->jobs[i] = queue->jobs[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    queue->jobs[i] = job;
+    if (queue->count > queue->peak) queue->peak = queue->count;
+    return 1;
+}
+
+static ReadyJob heap_pop_job(ReadyQueue *queue) {
+    ReadyJob top = queue->jobs[0];
+    ReadyJob last = queue->jobs[--queue->count];
+    long long i = 0;
+    for (;;) {
+        long long child = 2 * i + 1;
+        if (child >= queue->count) break;
+        if (child + 1 < queue->count && job_before(&queue->jobs[child + 1], &queue->jobs[child])) child++;
+        if (!job_before(&queue->jobs[child], &last)) break;
+        queue->jobs[i] = queue->jobs[child];
+        i = child;
+    }
+    if (queue->count > 0) queue->jobs[i] = last;
+    return top;
+}
+
+typedef struct {
+    long long jobs;
+    long long context_switches;
+    long long max_wait;
+    long long peak_queue;
+    long long makespan;
+    long long busy;
+    double avg_wait;
+    double avg_turnaround;
+    double seconds;
+} StreamSchedResult;
+
+static int stream_scheduling(StreamPolicy policy, const WgProcessConfig *config, long long jobs, int quantum,
+                             StreamSchedResult *result) {
+    memset(result, 0, sizeof(*result));
+    Arena *arena = run_arena();
+    ArenaMark mark = arena_mark(arena);
+    ArrivalCursor cursor;
+    memset(&cursor, 0, sizeof(cursor));
+    wg_process_init(&cursor.stream, config);
+    cursor.batch = arena_alloc(arena, sizeof(WgProcess) * WORKLOAD_BATCH);
+    cursor.remaining = jobs;
+    ReadyQueue queue;
+    memset(&queue, 0, sizeof(queue));
+    queue.arena = arena;
+    if (cursor.batch == NULL) return 0;
+
+    double start = monotonic_seconds();
+    long long now = 0, sequence = 0, wait_sum = 0, turnaround_sum = 0;
+    int ok = 1;
+    for (;;) {
+        // Admit everything that has arrived; jump ahead if the CPU would idle
+        const WgProcess *arrival = cursor_peek(&cursor);
+        if (queue.count == 0 && arrival != NULL && arrival->arrival > now) now = arrival->arrival;
+        while (ok && arrival != NULL && arrival->arrival <= now) {
+            ReadyJob job = {arrival->arrival, sequence++, arrival->burst, arrival->burst, arrival->priority};
+            ok = policy == STREAM_PRIORITY ? heap_push_job(&queue, job) : ring_push(&queue, job);
+            cursor.next++;
+            arrival = cursor_peek(&cursor);
+        }
+        if (!ok || queue.count == 0) break;
+
+        ReadyJob job = policy == STREAM_PRIORITY ? heap_pop_job(&queue) : ring_pop(&queue);
+        int slice = policy == STREAM_RR && job.remaining > quantum ? quantum : job.remaining;
+        now += slice;
+        result->busy += slice;
+        job.remaining -= slice;
+        result->context_switches++;
+        if (job.remaining > 0) {
+            // Arrivals during the slice queue ahead of the preempted job
+            arrival = cursor_peek(&cursor);
+            while (ok && arrival != NULL && arrival->arrival <= now) {
+                ReadyJob next = {arrival->arrival, sequence++, arrival->burst, arrival->burst, arrival->priority};
+                ok = ring_push(&queue, next);
+                cursor.next++;
+                arrival = cursor_peek(&cursor);
+            }
+            if (ok) ok = ring_push(&queue, job);
+            continue;
+        }
+        long long turnaround = now - job.arrival;
+        long long wait = turnaround - job.burst;
+        turnaround_sum += turnaround;
+        wait_sum += wait;
+        if (wait > result->max_wait) result->max_wait = wait;
+        result->jobs++;
+    }
+    result->seconds = monotonic_seconds() - start;
+    result->makespan = now;
+    result->peak_queue = queue.peak;
+    result->avg_wait = result->jobs > 0 ? (double)wait_sum / result->jobs : 0.0;
+    result->avg_turnaround = result->jobs > 0 ? (double)turnaround_sum / result->jobs : 0.0;
+    arena_release(arena, mark);
+    return ok;
+}
+
+// ---- command line ----
+
+static void print_usage() {
+    printf("Usage: workload paging [pattern|all] [refs] [frames] [--pages N] [--seed N]\n");
+    printf("       workload sched [poisson|diurnal] [exp|pareto] [jobs] [load] [--quantum Q] [--seed N]\n");
+    printf("       workload trace <pattern> [refs] [--pages N] [--seed N]   (page numbers on stdout)\n");
+    printf("Patterns: uniform zipf loop phased working_set\n");
+}
+
+int workload_command(int argc, char *argv[]) {
+    const char *positional[8];
+    int count = 0, pages = 0, quantum = 4;
+    unsigned long long seed = 1;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--pages") == 0 && i + 1 < argc) {
+            pages = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--quantum") == 0 && i + 1 < argc) {
+            quantum = atoi(argv[++i]);
+        } else if (count < 8) {
+            positional[count++] = argv[i];
+        }
+    }
+    const char *mode = count > 0 ? positional[0] : "";
+
+    if (strcmp(mode, "paging") == 0) {
+        int pattern = count > 1 && strcmp(positional[1], "all") != 0 ? wg_ref_pattern_from_name(positional[1]) : -2;
+        long long refs = count > 2 ? atoll(positional[2]) : 2000000;
+        int frames = count > 3 ? atoi(positional[3]) : 64;
+        if (pattern == -1 || refs < 1 || frames < 1) {
+            print_usage();
+            return 1;
+        }
+        run_arena_reset();
+        printf("=== STREAMING PAGE REPLACEMENT: %lld references per pattern, %d frames ===\n", refs, frames);
+        printf("%-12s %14s %9s %9s %9s %14s %14s\n", "Pattern", "References", "FIFO", "LRU", "CLOCK",
+               "Generated", "End to end");
+        for (int p = 0; p < WG_REF_PATTERNS; p++) {
+            if (pattern >= 0 && p != pattern) continue;
+            if (!stream_paging((WgRefPattern)p, refs, frames, pages, seed)) return 1;
+        }
+        run_arena_reset();
+        return 0;
+    }
+
+    if (strcmp(mode, "sched") == 0) {
+        WgProcessConfig config;
+        wg_default_process_config(&config);
+        config.seed = seed;
+        int next = 1;
+        if (next < count && (strcmp(positional[next], "poisson") == 0 || strcmp(positional[next], "diurnal") == 0)) {
+            config.arrivals = strcmp(positional[next++], "diurnal") == 0 ? WG_ARRIVAL_DIURNAL : WG_ARRIVAL_POISSON;
+        }
+        if (next < count && (strcmp(positional[next], "exp") == 0 || strcmp(positional[next], "pareto") == 0)) {
+            config.bursts = strcmp(positional[next++], "pareto") == 0 ? WG_BURST_PARETO : WG_BURST_EXPONENTIAL;
+        }
+        long long jobs = next < count ? atoll(positional[next++]) : 10000000;
+        double load = next < count ? atof(positional[next++]) : 0.9;
+        if (next < count || jobs < 1 || load <= 0.0 || quantum < 1) {
+            print_usage();
+            return 1;
+        }
+        config.arrival_rate = load / config.burst_mean;
+        run_arena_reset();
+        printf("=== STREAMING CPU SCHEDULING: %lld jobs, %s arrivals, %s bursts (mean %.0f), load %.2f ===\n",
+               jobs, config.arrivals == WG_ARRIVAL_DIURNAL ? "diurnal" : "Poisson",
+               config.bursts == WG_BURST_PARETO ? "Pareto" : "exponential", config.burst_mean, load);
+        printf("%-12s %12s %12s %14s %12s %12s %12s %10s\n", "Policy", "Avg wait", "Avg TAT", "Max wait",
+               "Peak queue", "Dispatches", "Utilization", "Jobs/s");
+        for (int p = 0; p < STREAM_POLICIES; p++) {
+            StreamSchedResult result;
+            // Every policy replays the same seeded stream
+            if (!stream_scheduling((StreamPolicy)p, &config, jobs, quantum, &result)) {
+                printf("%-12s ready queue outgrew memory\n", stream_policy_names[p]);
+                continue;
+            }
+            printf("%-12s %12.1f %12.1f %14lld %12lld %12lld %11.1f%% %8.1f M\n", stream_policy_names[p],
+                   result.avg_wait, result.avg_turnaround, result.max_wait, result.peak_queue,
+                   result.context_switches, result.makespan > 0 ? 100.0 * result.busy / result.makespan : 0.0,
+                   result.seconds > 0.0 ? result.jobs / result.seconds / 1e6 : 0.0);
+        }
+        run_arena_reset();
+        return 0;
+    }
+
+    if (strcmp(mode, "trace") == 0 && count > 1 && wg_ref_pattern_from_name(positional[1]) >= 0) {
+        long long refs = count > 2 ? atoll(positional[2]) : 100000;
+        WgRefConfig config;
+        wg_default_ref_config(&config, (WgRefPattern)wg_ref_pattern_from_name(positional[1]));
+        if (pages > 0) config.pages = pages;
+        config.seed = seed;
+        run_arena_reset();
+        WgRefStream stream;
+        int *batch = arena_alloc(run_arena(), sizeof(int) * WORKLOAD_BATCH);
+        if (batch == NULL || !wg_ref_init(&stream, &config, run_arena())) {
+            printf("Not enough memory for the reference stream.\n");
+            return 1;
+        }
+        for (long long done = 0; done < refs;) {
+            int n = refs - done < WORKLOAD_BATCH ? (int)(refs - done) : WORKLOAD_BATCH;
+            wg_ref_batch(&stream, batch, n);
+            for (int i = 0; i < n; i++) printf("%d\n", batch[i]);
+            done += n;
+        }
+        run_arena_reset();
+        return 0;
+    }
+
+    print_usage();
+    return 1;
+}
@@ -0,0 +1,102 @@
+/*
+ * workload_gen.h - Header for the streaming process-arrival and page-reference generators
+ */
+
+#ifndef WORKLOAD_GEN_H
+#define WORKLOAD_GEN_H
+
+#include "arena.h"
+
+#define WG_DAY_PROFILE_HOURS 24
+
+typedef enum {
+    WG_ARRIVAL_POISSON,
+    WG_ARRIVAL_DIURNAL          // Poisson with an hour-of-day rate profile
+} WgArrivalPattern;
+
+typedef enum {
+    WG_BURST_EXPONENTIAL,
+    WG_BURST_PARETO             // heavy tail: a few jobs carry most of the CPU time
+} WgBurstDistribution;
+
+typedef enum {
+    WG_REF_UNIFORM,
+    WG_REF_ZIPF,                // page k referenced with weight 1 / k^s
+    WG_REF_LOOP,                // cyclic scan, the LRU/FIFO worst case
+    WG_REF_PHASED,              // Zipf inside a locality that jumps every phase
+    WG_REF_WORKING_SET,         // working set that drifts one page at a time
+    WG_REF_PATTERNS
+} WgRefPattern;
+
+typedef struct {
+    WgArrivalPattern arrivals;
+    double arrival_rate;        // jobs per tick, averaged over a day
+    int day_ticks;              // ticks per simulated day for the diurnal profile
+    WgBurstDistribution bursts;
+    double burst_mean;
+    double pareto_alpha;        // > 1; smaller is heavier
+    int burst_max;              // 0 = uncapped
+    int priority_levels;        // priorities 1..levels
+    unsigned long long seed;
+} WgProcessConfig;
+
+typedef struct {
+    long long arrival;
+    int burst;
+    int priority;
+} WgProcess;
+
+typedef struct {
+    WgProcessConfig config;
+    unsigned long long state;
+    double clock;
+    double profile[WG_DAY_PROFILE_HOURS];   // rate multipliers relative to the peak
+    long long produced;
+} WgProcessStream;
+
+typedef struct {
+    WgRefPattern pattern;
+    int pages;                  // address space size
+    double zipf_exponent;
+    int loop_length;
+    int working_set;            // locality size for phased and working-set patterns
+    long long phase_length;     // references per phase (phased)
+    int shift_every;            // references between working-set replacements
+    double noise;               // share of references uniform over all pages
+    unsigned long long seed;
+} WgRefConfig;
+
+typedef struct {
+    WgRefConfig config;
+    unsigned long long state;
+    long long produced;
+    const double *zipf_cdf;
+    const int *zipf_guide;      // first rank whose CDF reaches each 1/n step
+    int zipf_size;
+    int *set;                   // current working set
+    int base;                   // current phase locality
+    int loop_position;
+} WgRefStream;
+
+// Distribution primitives shared with the other simulations
+unsigned long long wg_next(unsigned long long *state);
+double wg_uniform(unsigned long long *state);
+double wg_exponential(unsigned long long *state, double mean);
+
+// Order statistics and sort keys shared with the other simulations
+double wg_select_kth(double *values, int count, int k);
+int wg_compare_packed(const void *a, const void *b);
+
+void wg_default_process_config(WgProcessConfig *config);
+void wg_process_init(WgProcessStream *stream, const WgProcessConfig *config);
+void wg_process_batch(WgProcessStream *stream, WgProcess *out, int count);
+
+const char *wg_ref_pattern_name(WgRefPattern pattern);
+int wg_ref_pattern_from_name(const char *name);
+void wg_default_ref_config(WgRefConfig *config, WgRefPattern pattern);
+int wg_ref_init(WgRefStream *stream, const WgRefConfig *config, Arena *arena);
+void wg_ref_batch(WgRefStream *stream, int *out, int count);
+
+int workload_command(int argc, char *argv[]);
+
+#endif // WORKLOAD_GEN_H